@@ -8,27 +8,46 @@
 
 AugmentedMagicMirror::AugmentedMagicMirror(_In_ HINSTANCE Instance)
 	:Instance(Instance), Window(), GraphicsDevice(CreateGraphicsContext())
-	,RenderContext(GraphicsDevice->CreateRenderContext(Window, NoseCamera, LeftEyeCamera, RightEyeCamera))
+	,EyeCameras(Vector3(0.0f, 0.0f, 50.0f), SettingsFile::Monitor::GetMonitorHeight())
+	,RenderContext(GraphicsDevice->CreateRenderContext(Window, NoseCamera, EyeCameras.GetEye(StereoFrameCamera::Eye_Left), EyeCameras.GetEye(StereoFrameCamera::Eye_Right)))
 	,Kinect(SettingsFile::Kinect::GetKinectOffset())
-	,HeadTracker(NoseCamera, LeftEyeCamera, RightEyeCamera, Kinect), DepthMesh(*GraphicsDevice)
+	,TemporalDepthFilter(Kinect::DepthImageWidth, Kinect::DepthImageHeigth)
+	,DepthHoleFilling(Kinect::DepthImageWidth, Kinect::DepthImageHeigth)
+	,BackgroundDepthModel(Kinect::DepthImageWidth, Kinect::DepthImageHeigth
+		, static_cast<unsigned>(SettingsFile::Background::GetLearnDuration() * Kinect::DepthFrameRate)
+		, SettingsFile::Background::GetDropBackground(), Utility::GetApplicationFilePath(BackgroundDepthModel::DefaultFilename))
+	,DepthRegionOfInterest(Kinect)
+	,HeadTracker(NoseCamera, EyeCameras, Kinect
+		, static_cast<HeadTracker::PoseFilterType>(SettingsFile::HeadTracking::GetPoseFilter()), SettingsFile::HeadTracking::GetLatency()
+		, SettingsFile::HeadTracking::GetLateLatching())
+	,DepthMesh(*GraphicsDevice)
+	,OcclusionDepthBuffer(Kinect)
 	,CubeMesh(GraphicsDevice->CreateMesh())
 	, NoseCamera(Vector3(0.0f, 0.0f, 50.0f), SettingsFile::Monitor::GetMonitorHeight())
-	, LeftEyeCamera(Vector3(0.0f, 0.0f, 50.0f), SettingsFile::Monitor::GetMonitorHeight())
-	, RightEyeCamera(Vector3(0.0f, 0.0f, 50.0f), SettingsFile::Monitor::GetMonitorHeight())
 {
 	Window.KeyPressed += std::make_pair(&Kinect, &Kinect::KeyPressedCallback);
+	Window.KeyPressed += std::make_pair(&TemporalDepthFilter, &TemporalDepthFilter::KeyPressedCallback);
+	Window.KeyPressed += std::make_pair(&DepthHoleFilling, &DepthHoleFilling::KeyPressedCallback);
+	Window.KeyPressed += std::make_pair(&BackgroundDepthModel, &BackgroundDepthModel::KeyPressedCallback);
+	Window.KeyPressed += std::make_pair(&DepthRegionOfInterest, &DepthRegionOfInterest::KeyPressedCallback);
 	Window.KeyPressed += std::make_pair(&HeadTracker, &HeadTracker::KeyPressedCallback);
 	Window.KeyPressed += std::make_pair(&DepthMesh, &DepthMesh::KeyPressedCallback);
 	Window.KeyPressed += std::make_pair(&NoseCamera, &FrameCamera::KeyPressedCallback);
-	Window.KeyPressed += std::make_pair(&LeftEyeCamera, &FrameCamera::KeyPressedCallback);
-	Window.KeyPressed += std::make_pair(&RightEyeCamera, &FrameCamera::KeyPressedCallback);
+	Window.KeyPressed += std::make_pair(&EyeCameras, &StereoFrameCamera::KeyPressedCallback);
+
+	RenderContext->CameraLatching += std::make_pair(&HeadTracker, &HeadTracker::CameraLatchingCallback);
+	RenderContext->StereoCameraLatching += std::make_pair(&HeadTracker, &HeadTracker::StereoCameraLatchingCallback);
+
+	Kinect.AddDepthFilter(TemporalDepthFilter);
+	Kinect.AddDepthFilter(DepthHoleFilling);
+	Kinect.AddDepthFilter(BackgroundDepthModel);
 
 	float MonitorHeight = SettingsFile::Monitor::GetMonitorHeight();
 	float MonitorHalfHeight = MonitorHeight / 2.f;
 	constexpr float ElementsDistance = -180.f;
 	constexpr float ElementsLength = 50.f;
 
-	Cubes = {
+	const TransformList Cubes = {
 		Transform(Vector3(-MonitorHalfHeight,-MonitorHalfHeight, ElementsDistance - ElementsLength),		 Quaternion(),                   Vector3(2.f)),
 		Transform(Vector3(-MonitorHalfHeight, MonitorHalfHeight,ElementsDistance - ElementsLength),		 Quaternion(90.f,   0.f,  0.f), Vector3(2.f)),
 		Transform(Vector3(MonitorHalfHeight,-MonitorHalfHeight, ElementsDistance - ElementsLength),		 Quaternion(90.f,  90.f,  0.f), Vector3(2.f)),
@@ -45,12 +64,22 @@ AugmentedMagicMirror::AugmentedMagicMirror(_In_ HINSTANCE Instance)
 		Transform(Vector3(-30.f, 0.0f, ElementsDistance), Quaternion(0.f, -45.f,  0.f), Vector3(5.0f)),
 		Transform(Vector3(0.f, -10.0f, -100.0f), Quaternion(0.f, -45.f,  180.f), Vector3(5.0f))
 	};
+
+	Scene.Reserve(Cubes.size() + 1);
+
+	for (const Transform & Cube : Cubes)
+	{
+		Scene.AddNode(SceneGraph::Root, Cube, CubeMesh.get());
+	}
 }
 
 int AugmentedMagicMirror::Run(_In_ int CmdShow)
 {
 	OptionalInt OptionalQuitMessage;
 
+	// Only refers to the object lists, kept across frames so it is not reallocated
+	RenderContext::MeshList DrawCalls;
+
 	Initialize(CmdShow);
 
 	do {
@@ -59,11 +88,23 @@ int AugmentedMagicMirror::Run(_In_ int CmdShow)
 		GraphicsDevice->Update();
 		Kinect.Update();
 
-		RenderContext->Render({ 
-			RenderContext::ObjectList(*CubeMesh, Cubes), 
-			/*RenderContext::ObjectList(*CubeMesh, { Transform(NoseCamera.GetPosition()),  Transform(LeftEyeCamera.GetPosition()),  Transform(RightEyeCamera.GetPosition()) }), */
-			DepthMesh.GetRenderObjectList() 
-		});
+		// The head tracking only marks the cameras, they are recalculated once per frame; late latched cameras again right before drawing
+		FrameCamera::Resolve({ &NoseCamera });
+		EyeCameras.Resolve();
+
+		// Only the subtrees of moved nodes are recomposed
+		Scene.Update();
+
+		DrawCalls.clear();
+
+		for (const RenderContext::ObjectList & Objects : Scene.GetDrawCalls())
+		{
+			DrawCalls.push_back(Objects);
+		}
+
+		DrawCalls.push_back(DepthMesh.GetRenderObjectList());
+
+		RenderContext->Render(DrawCalls);
 
 	} while (!OptionalQuitMessage.first);
 
@@ -81,6 +122,7 @@ void AugmentedMagicMirror::Initialize(_In_ int CmdShow)
 	CubeMesh->CreateCube();
 	Kinect.Initialize();
 	DepthMesh.Create(Kinect);
+	RenderContext->SetOcclusionDepth(OcclusionDepthBuffer, DepthMesh.GetRenderObjectList().first);
 
 	Window.Show(CmdShow);
 }
@@ -6,12 +6,18 @@
 #include "Kinect.h"
 #include "HeadTracker.h"
 #include "DepthMesh.h"
+#include "BackgroundDepthModel.h"
+#include "DepthHoleFilling.h"
+#include "DepthRegionOfInterest.h"
+#include "OcclusionDepthBuffer.h"
+#include "TemporalDepthFilter.h"
 
 #include "DirectionalFoVCamera.h"
 #include "FrameCamera.h"
+#include "StereoFrameCamera.h"
 
 #include "Mesh.h"
-#include "Transform.h"
+#include "SceneGraph.h"
 
 class AugmentedMagicMirror
 {
@@ -27,17 +33,24 @@ private:
 
 	MainWindow Window;
 	PGraphicsContext GraphicsDevice;
+
+	// Constructed before the render context and the head tracker, which are handed its eyes
+	StereoFrameCamera EyeCameras;
+
 	PRenderContext RenderContext;
 	Kinect Kinect;
+	TemporalDepthFilter TemporalDepthFilter;
+	DepthHoleFilling DepthHoleFilling;
+	BackgroundDepthModel BackgroundDepthModel;
+	DepthRegionOfInterest DepthRegionOfInterest;
 	HeadTracker HeadTracker;
 	DepthMesh DepthMesh;
+	OcclusionDepthBuffer OcclusionDepthBuffer;
 
 	FrameCamera NoseCamera;
-	FrameCamera LeftEyeCamera;
-	FrameCamera RightEyeCamera;
 
 	PMesh CubeMesh;
-	TransformList Cubes;
+	SceneGraph Scene;
 
 	void Initialize(_In_ int CmdShow);
 	void Release();
@@ -0,0 +1,234 @@
+// BackgroundDepthModel.cpp : Learns the static background of the depth image and removes it from incoming frames
+//
+
+#include "stdafx.h"
+#include "BackgroundDepthModel.h"
+
+namespace
+{
+	// Pixels need to be valid in this share of the learned frames to become background
+	constexpr float MinValidRatio = 0.8f;
+
+	// Pixels varying more than this while learning were moving and are never background
+	constexpr float MaxDeviation = 40.f;
+
+	// A pixel is foreground if it is at least Tolerance + Depth / 2^ToleranceShift in front of the background
+	constexpr UINT16 Tolerance = 30;
+	constexpr int ToleranceShift = 6;
+	constexpr float DeviationFactor = 3.f;
+
+	constexpr UINT16 NoBackground = 0xFFFF;
+}
+
+const std::wstring BackgroundDepthModel::DefaultFilename = L"BackgroundModel.bin";
+
+BackgroundDepthModel::BackgroundDepthModel(_In_ unsigned Width, _In_ unsigned Height, _In_ unsigned LearnFrameCount, _In_ bool DropBackground, _In_ const std::wstring & Path)
+	:Width(Width), Height(Height), LearnFrameCount(LearnFrameCount), DropBackground(DropBackground), Path(Path)
+	, BackgroundDepth(Width * Height, 0), ForegroundLimit(Width * Height, NoBackground)
+	, LearnedFrameCount(0)
+	, SubtractTime(L"Background Subtraction")
+{
+	if (Path.empty() || !Load(Path))
+	{
+		Learn();
+	}
+}
+
+void BackgroundDepthModel::Apply(_Inout_ DepthPixelList & DepthPixels)
+{
+	if (DepthPixels.size() != BackgroundDepth.size())
+	{
+		return;
+	}
+
+	if (!IsLearned())
+	{
+		Accumulate(DepthPixels);
+		return;
+	}
+
+	SubtractTime.Start();
+
+	unsigned BandCount = (Height + RowsPerBand - 1) / RowsPerBand;
+
+	concurrency::parallel_for(0u, BandCount, [&](unsigned Band)
+	{
+		unsigned FirstRow = Band * RowsPerBand;
+		SubtractRows(DepthPixels, FirstRow, (std::min)(FirstRow + RowsPerBand, Height));
+	});
+
+	SubtractTime.Stop();
+}
+
+void BackgroundDepthModel::Learn()
+{
+	DepthSum.assign(Width * Height, 0);
+	DepthSquareSum.assign(Width * Height, 0);
+	ValidCount.assign(Width * Height, 0);
+	LearnedFrameCount = 0;
+}
+
+bool BackgroundDepthModel::IsLearned() const
+{
+	return LearnedFrameCount >= LearnFrameCount;
+}
+
+bool BackgroundDepthModel::Load(_In_ const std::wstring & Path)
+{
+	std::ifstream File(Path, std::ios::binary);
+
+	if (!File)
+	{
+		return false;
+	}
+
+	UINT32 Header[4] = {};
+	File.read(reinterpret_cast<char *>(Header), sizeof(Header));
+
+	if (!File || (Header[0] != FileMagic) || (Header[1] != FileVersion) || (Header[2] != Width) || (Header[3] != Height))
+	{
+		return false;
+	}
+
+	DepthPixelList LoadedDepth(Width * Height);
+	DepthPixelList LoadedLimit(Width * Height);
+	File.read(reinterpret_cast<char *>(LoadedDepth.data()), LoadedDepth.size() * sizeof(DepthPixelList::value_type));
+	File.read(reinterpret_cast<char *>(LoadedLimit.data()), LoadedLimit.size() * sizeof(DepthPixelList::value_type));
+
+	if (!File)
+	{
+		return false;
+	}
+
+	BackgroundDepth.swap(LoadedDepth);
+	ForegroundLimit.swap(LoadedLimit);
+	LearnedFrameCount = LearnFrameCount;
+
+	return true;
+}
+
+bool BackgroundDepthModel::Save(_In_ const std::wstring & Path) const
+{
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+
+	if (!File)
+	{
+		return false;
+	}
+
+	UINT32 Header[4] = { FileMagic, FileVersion, Width, Height };
+	File.write(reinterpret_cast<const char *>(Header), sizeof(Header));
+	File.write(reinterpret_cast<const char *>(BackgroundDepth.data()), BackgroundDepth.size() * sizeof(DepthPixelList::value_type));
+	File.write(reinterpret_cast<const char *>(ForegroundLimit.data()), ForegroundLimit.size() * sizeof(DepthPixelList::value_type));
+
+	return static_cast<bool>(File);
+}
+
+void BackgroundDepthModel::KeyPressedCallback(_In_ const WPARAM & VirtualKey)
+{
+	if (VirtualKey == 'B')
+	{
+		Learn();
+	}
+}
+
+void BackgroundDepthModel::Accumulate(_In_ const DepthPixelList & DepthPixels)
+{
+	concurrency::parallel_for(0u, Height, [&](unsigned Row)
+	{
+		size_t RowBegin = static_cast<size_t>(Row) * Width;
+
+		for (size_t Index = RowBegin; Index < RowBegin + Width; ++Index)
+		{
+			UINT32 Depth = DepthPixels[Index];
+
+			if (Depth != 0)
+			{
+				DepthSum[Index] += Depth;
+				DepthSquareSum[Index] += static_cast<UINT64>(Depth) * Depth;
+				++ValidCount[Index];
+			}
+		}
+	});
+
+	if (++LearnedFrameCount == LearnFrameCount)
+	{
+		FinishLearning();
+	}
+}
+
+void BackgroundDepthModel::FinishLearning()
+{
+	UINT16 MinValidCount = static_cast<UINT16>(LearnFrameCount * MinValidRatio);
+
+	for (size_t Index = 0; Index < BackgroundDepth.size(); ++Index)
+	{
+		BackgroundDepth[Index] = 0;
+		ForegroundLimit[Index] = NoBackground;
+
+		if ((ValidCount[Index] == 0) || (ValidCount[Index] < MinValidCount))
+		{
+			continue;
+		}
+
+		double Mean = static_cast<double>(DepthSum[Index]) / ValidCount[Index];
+		double Variance = static_cast<double>(DepthSquareSum[Index]) / ValidCount[Index] - Mean * Mean;
+		float Deviation = static_cast<float>(std::sqrt(std::fmax(Variance, 0.0)));
+
+		if (Deviation > MaxDeviation)
+		{
+			continue;
+		}
+
+		UINT16 Depth = static_cast<UINT16>(Mean + 0.5);
+		float PixelTolerance = std::fmax(static_cast<float>(Tolerance + (Depth >> ToleranceShift)), DeviationFactor * Deviation);
+
+		BackgroundDepth[Index] = Depth;
+		ForegroundLimit[Index] = static_cast<UINT16>(std::fmax(Depth - PixelTolerance, 1.f));
+	}
+
+	DepthSum.clear();
+	DepthSquareSum.clear();
+	ValidCount.clear();
+
+	if (!Path.empty() && !Save(Path))
+	{
+		Utility::Log(L"Background model could not be saved");
+	}
+}
+
+void BackgroundDepthModel::SubtractRows(_Inout_ DepthPixelList & DepthPixels, _In_ unsigned FirstRow, _In_ unsigned LastRow) const
+{
+	constexpr size_t PixelsPerStep = sizeof(__m128i) / sizeof(UINT16);
+
+	const __m128i Zero = _mm_setzero_si128();
+
+	size_t Begin = static_cast<size_t>(FirstRow) * Width;
+	size_t End = static_cast<size_t>(LastRow) * Width;
+	size_t VectorEnd = Begin + ((End - Begin) / PixelsPerStep) * PixelsPerStep;
+
+	UINT16 * Depth = DepthPixels.data();
+	const UINT16 * Background = BackgroundDepth.data();
+	const UINT16 * Limit = ForegroundLimit.data();
+
+	for (size_t Index = Begin; Index < VectorEnd; Index += PixelsPerStep)
+	{
+		__m128i New = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Depth + Index));
+		__m128i PixelLimit = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Limit + Index));
+
+		// Unsigned New >= Limit; invalid pixels never match, as the limit is at least one
+		__m128i IsBackground = _mm_cmpeq_epi16(_mm_subs_epu16(PixelLimit, New), Zero);
+		__m128i Replacement = DropBackground ? Zero : _mm_loadu_si128(reinterpret_cast<const __m128i *>(Background + Index));
+		__m128i Result = _mm_or_si128(_mm_and_si128(IsBackground, Replacement), _mm_andnot_si128(IsBackground, New));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(Depth + Index), Result);
+	}
+
+	for (size_t Index = VectorEnd; Index < End; ++Index)
+	{
+		if (Depth[Index] >= Limit[Index])
+		{
+			Depth[Index] = DropBackground ? 0 : Background[Index];
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "DepthFilter.h"
+#include "PerformanceCounter.h"
+
+class BackgroundDepthModel : public DepthFilter
+{
+public:
+	static const std::wstring DefaultFilename;
+
+	// The model is loaded from Path if possible and learned over the next LearnFrameCount frames otherwise.
+	// A learned model is saved to Path, an empty Path keeps the model in memory only.
+	BackgroundDepthModel(_In_ unsigned Width, _In_ unsigned Height, _In_ unsigned LearnFrameCount, _In_ bool DropBackground, _In_ const std::wstring & Path = L"");
+
+	virtual void Apply(_Inout_ DepthPixelList & DepthPixels);
+
+	void Learn();
+	bool IsLearned() const;
+
+	bool Load(_In_ const std::wstring & Path);
+	bool Save(_In_ const std::wstring & Path) const;
+
+	void KeyPressedCallback(_In_ const WPARAM & VirtualKey);
+
+private:
+	static const UINT32 FileMagic = 0x424D4D41; // "AMMB"
+	static const UINT32 FileVersion = 1;
+	static constexpr unsigned RowsPerBand = 16;
+
+	const unsigned Width;
+	const unsigned Height;
+	const unsigned LearnFrameCount;
+	const bool DropBackground;
+	const std::wstring Path;
+
+	// Pixels at or behind ForegroundLimit belong to the background and are replaced by BackgroundDepth
+	DepthPixelList BackgroundDepth;
+	DepthPixelList ForegroundLimit;
+
+	// Per pixel statistics while learning
+	std::vector<UINT32> DepthSum;
+	std::vector<UINT64> DepthSquareSum;
+	std::vector<UINT16> ValidCount;
+	unsigned LearnedFrameCount;
+
+	PerformanceCounter SubtractTime;
+
+	void Accumulate(_In_ const DepthPixelList & DepthPixels);
+	void FinishLearning();
+	void SubtractRows(_Inout_ DepthPixelList & DepthPixels, _In_ unsigned FirstRow, _In_ unsigned LastRow) const;
+};
@@ -0,0 +1,2762 @@
+// Benchmark.cpp : Headless benchmarks on recorded or synthetic sensor data
+//
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+#include "BackgroundDepthModel.h"
+#include "BoundingVolumeHierarchy.h"
+#include "DepthHoleFilling.h"
+#include "DepthNormals.h"
+#include "DepthOccupancyGrid.h"
+#include "DepthQuadtree.h"
+#include "DepthRecording.h"
+#include "DepthRegionOfInterest.h"
+#include "DepthStatistics.h"
+#include "FaceRecording.h"
+#include "FrameCamera.h"
+#include "HeadPivotModel.h"
+#include "HeadTracker.h"
+#include "HierarchicalDepthBuffer.h"
+#include "KalmanPoseFilter.h"
+#include "Kinect.h"
+#include "OcclusionDepthBuffer.h"
+#include "OneEuroPoseFilter.h"
+#include "PerformanceCounter.h"
+#include "ReferenceRenderer.h"
+#include "SceneGraph.h"
+#include "SimdMath.h"
+#include "StereoFrameCamera.h"
+#include "TemporalDepthFilter.h"
+#include "TransformArray.h"
+#include "UserArbitration.h"
+#include "ViewFrustum.h"
+
+namespace Benchmark
+{
+	static const std::wstring Switch = L"-benchmark";
+	static const std::wstring ResultFilename = L"Benchmark.csv";
+	static constexpr size_t SyntheticFrameCount = 150;
+	static constexpr size_t SyntheticFaceFrameCount = 900;
+	static constexpr unsigned Passes = 5;
+
+	typedef std::vector<std::wstring> ArgumentList;
+
+	class Results
+	{
+	public:
+		Results()
+			:FailureCount(0)
+		{
+			Lines << L"Benchmark,Metric,Value,Unit" << std::endl;
+		}
+
+		void SetBenchmark(_In_ const std::wstring & Name)
+		{
+			Benchmark = Name;
+		}
+
+		void Add(_In_ const std::wstring & Metric, _In_ double Value, _In_ const std::wstring & Unit)
+		{
+			Lines << Benchmark << L"," << Metric << L"," << Value << L"," << Unit << std::endl;
+		}
+
+		void Add(_In_ const PerformanceCounter & Counter)
+		{
+			Add(Counter.GetName() + L" Average", Counter.GetAverage(), Counter.GetUnit());
+			Add(Counter.GetName() + L" Minimum", Counter.GetMinimum(), Counter.GetUnit());
+			Add(Counter.GetName() + L" Maximum", Counter.GetMaximum(), Counter.GetUnit());
+		}
+
+		// A condition the benchmark has to meet, e.g. two paths drawing the same positions; the run fails otherwise
+		void Check(_In_ const std::wstring & Metric, _In_ bool Condition)
+		{
+			Add(Metric, Condition ? 1.0 : 0.0, L"passed");
+
+			if (!Condition)
+			{
+				Utility::Log((L"Benchmark " + Benchmark + L" failed: " + Metric).c_str());
+				++FailureCount;
+			}
+		}
+
+		bool HasFailed() const
+		{
+			return FailureCount != 0;
+		}
+
+		bool Write(_In_ const std::wstring & Path) const
+		{
+			std::wofstream File(Path, std::ios::trunc);
+			File << Lines.str();
+
+			return static_cast<bool>(File);
+		}
+
+	private:
+		std::wstring Benchmark;
+		std::wstringstream Lines;
+		unsigned FailureCount;
+	};
+
+	// Stands in for a graphics mesh where only the mesh an object belongs to matters, it is never drawn
+	class PlaceholderMesh : public Mesh
+	{
+	public:
+		virtual size_t UpdateVertices(_In_ const VertexList &, _In_ const ByteRangeList &) { return 0; }
+		virtual void UpdateIndices(_In_ const IndexList &) {}
+
+	protected:
+		virtual void Create(_In_ const VertexList &, _In_ const IndexList &) {}
+	};
+
+	typedef void(*BenchmarkFunction)(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	typedef std::vector<std::pair<std::wstring, BenchmarkFunction>> BenchmarkList;
+
+	static ArgumentList SplitCommandLine(_In_ LPCWSTR CommandLine);
+	static DepthRecording LoadDepthFrames(_In_ const ArgumentList & Arguments);
+	static double GetChangedPixelRatio(_In_ const DepthRecording::Frame & Previous, _In_ const DepthRecording::Frame & Current);
+	static double GetHoleRatio(_In_ const DepthRecording::Frame & Frame);
+	static Kinect::CameraSpaceTable CreatePinholeTable(_In_ unsigned Width, _In_ unsigned Height);
+	static Kinect::CameraSpacePointList ProjectDepthFrame(_In_ const DepthRecording::Frame & Frame, _In_ unsigned Width, _In_ unsigned Height);
+	static bool GetForegroundJoints(_In_ const DepthRecording::Frame & Frame, _In_ unsigned Width, _Out_ Kinect::DepthSpacePointList & DepthSpaceJoints, _Out_ Kinect::CameraSpacePointList & CameraSpaceJoints);
+	static FaceRecording LoadFaceFrames(_In_ const ArgumentList & Arguments, _Out_ bool & IsSynthetic);
+	static Vector3List GetReferencePositions(_In_ const FaceRecording & Recording, _In_ bool IsSynthetic, _In_ unsigned Point);
+	static Vector3 GetReferencePosition(_In_ const FaceRecording & Recording, _In_ const Vector3List & Reference, _In_ double Time);
+	static std::vector<bool> GetRestingFrames(_In_ const FaceRecording & Recording, _In_ const Vector3List & Reference);
+
+	static void RunTemporalDepthFilter(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunDepthHoleFilling(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunBackgroundDepthModel(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunDepthQuadtree(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunDepthRegionOfInterest(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunDepthNormals(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunDepthOccupancyGrid(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunOcclusionDepthBuffer(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunHierarchicalDepthBuffer(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunDepthStatistics(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunPoseFilter(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunHeadPivotModel(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunHeadTracker(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunUserArbitration(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunTransformArray(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunSimdMath(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunViewFrustum(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunSceneGraph(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunBoundingVolumeHierarchy(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunStereoFrameCamera(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunInstancing(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+	static void RunSinglePassStereo(_In_ const ArgumentList & Arguments, _Inout_ Results & Results);
+
+	static const BenchmarkList & GetBenchmarks()
+	{
+		static const BenchmarkList Benchmarks =
+		{
+			{ L"temporalfilter", &RunTemporalDepthFilter },
+			{ L"holefilling", &RunDepthHoleFilling },
+			{ L"background", &RunBackgroundDepthModel },
+			{ L"quadtree", &RunDepthQuadtree },
+			{ L"roi", &RunDepthRegionOfInterest },
+			{ L"normals", &RunDepthNormals },
+			{ L"occupancy", &RunDepthOccupancyGrid },
+			{ L"occlusion", &RunOcclusionDepthBuffer },
+			{ L"hiz", &RunHierarchicalDepthBuffer },
+			{ L"statistics", &RunDepthStatistics },
+			{ L"posefilter", &RunPoseFilter },
+			{ L"headpivot", &RunHeadPivotModel },
+			{ L"headtracker", &RunHeadTracker },
+			{ L"arbitration", &RunUserArbitration },
+			{ L"transforms", &RunTransformArray },
+			{ L"math", &RunSimdMath },
+			{ L"frustum", &RunViewFrustum },
+			{ L"scenegraph", &RunSceneGraph },
+			{ L"bvh", &RunBoundingVolumeHierarchy },
+			{ L"stereo", &RunStereoFrameCamera },
+			{ L"instancing", &RunInstancing },
+			{ L"singlepass", &RunSinglePassStereo },
+		};
+
+		return Benchmarks;
+	}
+
+	bool IsRequested(_In_ LPCWSTR CommandLine)
+	{
+		ArgumentList Arguments = SplitCommandLine(CommandLine);
+
+		return !Arguments.empty() && (Arguments[0] == Switch);
+	}
+
+	int Run(_In_ LPCWSTR CommandLine)
+	{
+		ArgumentList Arguments = SplitCommandLine(CommandLine);
+
+		if (Arguments.size() < 2)
+		{
+			Utility::Log(L"Usage: -benchmark <Name|all> [Arguments]");
+			return 1;
+		}
+
+		const std::wstring & Name = Arguments[1];
+		ArgumentList BenchmarkArguments(Arguments.begin() + 2, Arguments.end());
+		Results Results;
+		bool Found = false;
+
+		for (auto & Benchmark : GetBenchmarks())
+		{
+			if ((Name == L"all") || (Name == Benchmark.first))
+			{
+				Results.SetBenchmark(Benchmark.first);
+				Benchmark.second(BenchmarkArguments, Results);
+				Found = true;
+			}
+		}
+
+		if (!Found)
+		{
+			Utility::Log((L"Unknown benchmark: " + Name).c_str());
+			return 1;
+		}
+
+		// The results are written even when a check failed, to see what differed
+		bool IsWritten = Results.Write(Utility::GetApplicationFilePath(ResultFilename));
+
+		return (IsWritten && !Results.HasFailed()) ? 0 : 1;
+	}
+
+	static ArgumentList SplitCommandLine(_In_ LPCWSTR CommandLine)
+	{
+		ArgumentList Arguments;
+		std::wistringstream Stream((CommandLine != nullptr) ? CommandLine : L"");
+		std::wstring Argument;
+
+		while (Stream >> Argument)
+		{
+			Arguments.push_back(Argument);
+		}
+
+		return Arguments;
+	}
+
+	static DepthRecording LoadDepthFrames(_In_ const ArgumentList & Arguments)
+	{
+		DepthRecording Recording(Kinect::DepthImageWidth, Kinect::DepthImageHeigth);
+
+		// The first argument optionally names a recording made with the 'R' key; synthetic frames are used otherwise
+		if (!Arguments.empty() && Recording.Load(Arguments[0]))
+		{
+			return Recording;
+		}
+
+		return DepthRecording::CreateSynthetic(Kinect::DepthImageWidth, Kinect::DepthImageHeigth, SyntheticFrameCount);
+	}
+
+	static double GetChangedPixelRatio(_In_ const DepthRecording::Frame & Previous, _In_ const DepthRecording::Frame & Current)
+	{
+		constexpr int ChangeThreshold = 10;
+
+		size_t ChangedPixels = 0;
+
+		for (size_t Index = 0; Index < Current.size(); ++Index)
+		{
+			if (std::abs(static_cast<int>(Current[Index]) - static_cast<int>(Previous[Index])) > ChangeThreshold)
+			{
+				++ChangedPixels;
+			}
+		}
+
+		return static_cast<double>(ChangedPixels) / static_cast<double>(Current.size());
+	}
+
+	static double GetHoleRatio(_In_ const DepthRecording::Frame & Frame)
+	{
+		size_t Holes = std::count(Frame.begin(), Frame.end(), static_cast<UINT16>(0));
+
+		return static_cast<double>(Holes) / static_cast<double>(Frame.size());
+	}
+
+	static Kinect::CameraSpaceTable CreatePinholeTable(_In_ unsigned Width, _In_ unsigned Height)
+	{
+		// Pinhole model with the nominal depth camera intrinsics, standing in for the sensors depth to camera space table
+		constexpr float FocalLength = 365.f;
+
+		Kinect::CameraSpaceTable Table(Width * Height);
+		float CenterX = Width * 0.5f;
+		float CenterY = Height * 0.5f;
+
+		for (unsigned Y = 0; Y < Height; ++Y)
+			for (unsigned X = 0; X < Width; ++X)
+			{
+				Table[X + Y * Width] = { (X - CenterX) / FocalLength, (CenterY - Y) / FocalLength };
+			}
+
+		return Table;
+	}
+
+	static Kinect::CameraSpacePointList ProjectDepthFrame(_In_ const DepthRecording::Frame & Frame, _In_ unsigned Width, _In_ unsigned Height)
+	{
+		constexpr float InvalidValue = -std::numeric_limits<float>::infinity();
+
+		Kinect::CameraSpaceTable Table = CreatePinholeTable(Width, Height);
+		Kinect::CameraSpacePointList Points(Frame.size());
+
+		for (size_t Index = 0; Index < Frame.size(); ++Index)
+		{
+			float Z = Frame[Index] * 0.001f;
+
+			Points[Index] = (Frame[Index] == 0) ? CameraSpacePoint{ InvalidValue, InvalidValue, InvalidValue } :
+				CameraSpacePoint{ Table[Index].X * Z, Table[Index].Y * Z, Z };
+		}
+
+		return Points;
+	}
+
+	static bool GetForegroundJoints(_In_ const DepthRecording::Frame & Frame, _In_ unsigned Width, _Out_ Kinect::DepthSpacePointList & DepthSpaceJoints, _Out_ Kinect::CameraSpacePointList & CameraSpaceJoints)
+	{
+		// Recordings carry no body data; the extremes of everything closer than two meters stand in for the joints of the user
+		constexpr UINT16 ForegroundDepth = 2000;
+
+		unsigned Left = Width;
+		unsigned Top = static_cast<unsigned>(Frame.size() / Width);
+		unsigned Right = 0;
+		unsigned Bottom = 0;
+		UINT16 NearestDepth = ForegroundDepth;
+
+		for (size_t Index = 0; Index < Frame.size(); ++Index)
+		{
+			UINT16 Depth = Frame[Index];
+
+			if ((Depth == 0) || (Depth >= ForegroundDepth))
+			{
+				continue;
+			}
+
+			unsigned X = static_cast<unsigned>(Index % Width);
+			unsigned Y = static_cast<unsigned>(Index / Width);
+
+			Left = (std::min)(Left, X);
+			Top = (std::min)(Top, Y);
+			Right = (std::max)(Right, X);
+			Bottom = (std::max)(Bottom, Y);
+			NearestDepth = (std::min)(NearestDepth, Depth);
+		}
+
+		DepthSpaceJoints.clear();
+		CameraSpaceJoints.clear();
+
+		if (Left > Right)
+		{
+			return false;
+		}
+
+		float Z = NearestDepth * 0.001f;
+
+		DepthSpaceJoints.push_back({ static_cast<float>(Left), static_cast<float>(Top) });
+		DepthSpaceJoints.push_back({ static_cast<float>(Right), static_cast<float>(Bottom) });
+		CameraSpaceJoints.assign(DepthSpaceJoints.size(), CameraSpacePoint{ 0.f, 0.f, Z });
+
+		return true;
+	}
+
+	static FaceRecording LoadFaceFrames(_In_ const ArgumentList & Arguments, _Out_ bool & IsSynthetic)
+	{
+		FaceRecording Recording;
+
+		// The first argument optionally names a face recording made with the 'R' key; a synthetic head is used otherwise
+		IsSynthetic = Arguments.empty() || !Recording.Load(Arguments[0]);
+
+		return IsSynthetic ? FaceRecording::CreateSynthetic(SyntheticFaceFrameCount) : Recording;
+	}
+
+	static Vector3List GetReferencePositions(_In_ const FaceRecording & Recording, _In_ bool IsSynthetic, _In_ unsigned Point)
+	{
+		// Recordings have no ground truth, a centered moving average over a quarter second stands in for it
+		constexpr size_t AverageRadius = 3;
+
+		const FaceRecording::FrameList & Frames = Recording.GetFrames();
+		Vector3List Reference(Frames.size());
+
+		for (size_t Index = 0; Index < Frames.size(); ++Index)
+		{
+			if (IsSynthetic)
+			{
+				CameraSpacePoint Position = FaceRecording::GetSyntheticFrame(Frames[Index].Time, Frames.size()).Points[Point];
+				Reference[Index] = Vector3(Position.X, Position.Y, Position.Z);
+				continue;
+			}
+
+			size_t First = (Index > AverageRadius) ? Index - AverageRadius : 0;
+			size_t Last = (std::min)(Index + AverageRadius, Frames.size() - 1);
+			Vector3 Sum;
+
+			for (size_t Neighbour = First; Neighbour <= Last; ++Neighbour)
+			{
+				const CameraSpacePoint & Position = Frames[Neighbour].Points[Point];
+				Sum = Vector3(Sum.X + Position.X, Sum.Y + Position.Y, Sum.Z + Position.Z);
+			}
+
+			Reference[Index] = DirectX::XMVectorScale(Sum, 1.f / (Last - First + 1));
+		}
+
+		return Reference;
+	}
+
+	static Vector3 GetReferencePosition(_In_ const FaceRecording & Recording, _In_ const Vector3List & Reference, _In_ double Time)
+	{
+		const FaceRecording::FrameList & Frames = Recording.GetFrames();
+
+		auto Next = std::lower_bound(Frames.begin(), Frames.end(), Time, [](const FaceRecording::Frame & Face, double Time) { return Face.Time < Time; });
+
+		if (Next == Frames.begin())
+		{
+			return Reference.front();
+		}
+
+		if (Next == Frames.end())
+		{
+			return Reference.back();
+		}
+
+		size_t Index = Next - Frames.begin();
+		double Interval = Frames[Index].Time - Frames[Index - 1].Time;
+		float Weight = (Interval > 0.0) ? static_cast<float>((Time - Frames[Index - 1].Time) / Interval) : 1.f;
+
+		return DirectX::XMVectorLerp(Reference[Index - 1], Reference[Index], Weight);
+	}
+
+	static std::vector<bool> GetRestingFrames(_In_ const FaceRecording & Recording, _In_ const Vector3List & Reference)
+	{
+		// The head rests while the reference is slower than RestSpeed
+		constexpr float RestSpeed = 0.02f;
+
+		const FaceRecording::FrameList & Frames = Recording.GetFrames();
+		std::vector<bool> IsResting(Frames.size(), true);
+
+		for (size_t Index = 1; Index + 1 < Frames.size(); ++Index)
+		{
+			DirectX::XMVECTOR Distance = DirectX::XMVectorSubtract(Reference[Index + 1], Reference[Index - 1]);
+			double Interval = Frames[Index + 1].Time - Frames[Index - 1].Time;
+
+			IsResting[Index] = DirectX::XMVectorGetX(DirectX::XMVector3Length(Distance)) < RestSpeed * Interval;
+		}
+
+		return IsResting;
+	}
+
+	static void RunTemporalDepthFilter(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		TemporalDepthFilter Filter(Recording.GetWidth(), Recording.GetHeight());
+		PerformanceCounter FilterTime(L"Filter Time", L"ms", 0);
+		PerformanceCounter RawChanges(L"Changed Pixels Raw", L"ratio", 0);
+		PerformanceCounter FilteredChanges(L"Changed Pixels Filtered", L"ratio", 0);
+
+		DepthRecording::Frame PreviousRaw;
+		DepthRecording::Frame PreviousFiltered;
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			Filter.Reset();
+
+			for (const DepthRecording::Frame & Frame : Frames)
+			{
+				DepthRecording::Frame FilteredFrame(Frame);
+
+				FilterTime.Start();
+				Filter.Apply(FilteredFrame);
+				FilterTime.Stop();
+
+				// Stability is measured on the first pass only, the later passes only add timing samples
+				if ((Pass == 0) && !PreviousRaw.empty())
+				{
+					RawChanges.AddSample(GetChangedPixelRatio(PreviousRaw, Frame));
+					FilteredChanges.AddSample(GetChangedPixelRatio(PreviousFiltered, FilteredFrame));
+				}
+
+				PreviousRaw = Frame;
+				PreviousFiltered = FilteredFrame;
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(FilterTime);
+		Results.Add(L"Changed Pixels Raw", RawChanges.GetAverage(), L"ratio");
+		Results.Add(L"Changed Pixels Filtered", FilteredChanges.GetAverage(), L"ratio");
+	}
+
+	static void RunDepthHoleFilling(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		DepthHoleFilling Filter(Recording.GetWidth(), Recording.GetHeight());
+		PerformanceCounter SingleCoreTime(L"Fill Time Single Core", L"ms", 0);
+		PerformanceCounter ParallelTime(L"Fill Time Parallel", L"ms", 0);
+		PerformanceCounter RawHoles(L"Holes Raw", L"ratio", 0);
+		PerformanceCounter FilledHoles(L"Holes Filled", L"ratio", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const DepthRecording::Frame & Frame : Frames)
+			{
+				DepthRecording::Frame SingleCoreFrame(Frame);
+				DepthRecording::Frame ParallelFrame(Frame);
+
+				Filter.SetParallel(false);
+				SingleCoreTime.Start();
+				Filter.Apply(SingleCoreFrame);
+				SingleCoreTime.Stop();
+
+				Filter.SetParallel(true);
+				ParallelTime.Start();
+				Filter.Apply(ParallelFrame);
+				ParallelTime.Stop();
+
+				if (Pass == 0)
+				{
+					RawHoles.AddSample(GetHoleRatio(Frame));
+					FilledHoles.AddSample(GetHoleRatio(ParallelFrame));
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(SingleCoreTime);
+		Results.Add(ParallelTime);
+		Results.Add(L"Holes Raw", RawHoles.GetAverage(), L"ratio");
+		Results.Add(L"Holes Filled", FilledHoles.GetAverage(), L"ratio");
+	}
+
+	static void RunBackgroundDepthModel(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		constexpr unsigned LearnFrameCount = Kinect::DepthFrameRate;
+
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		// The model is learned from the first second of the recording and kept in memory only
+		BackgroundDepthModel Model(Recording.GetWidth(), Recording.GetHeight(), LearnFrameCount, true);
+		PerformanceCounter SubtractionTime(L"Subtraction Time", L"ms", 0);
+		PerformanceCounter RawValidPixels(L"Valid Pixels Raw", L"ratio", 0);
+		PerformanceCounter ForegroundPixels(L"Valid Pixels Foreground", L"ratio", 0);
+
+		for (size_t FrameIndex = 0; (FrameIndex < LearnFrameCount) && (FrameIndex < Frames.size()); ++FrameIndex)
+		{
+			DepthRecording::Frame LearnFrame(Frames[FrameIndex]);
+			Model.Apply(LearnFrame);
+		}
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const DepthRecording::Frame & Frame : Frames)
+			{
+				DepthRecording::Frame ForegroundFrame(Frame);
+
+				SubtractionTime.Start();
+				Model.Apply(ForegroundFrame);
+				SubtractionTime.Stop();
+
+				if (Pass == 0)
+				{
+					RawValidPixels.AddSample(1.0 - GetHoleRatio(Frame));
+					ForegroundPixels.AddSample(1.0 - GetHoleRatio(ForegroundFrame));
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(SubtractionTime);
+		Results.Add(L"Valid Pixels Raw", RawValidPixels.GetAverage(), L"ratio");
+		Results.Add(L"Valid Pixels Foreground", ForegroundPixels.GetAverage(), L"ratio");
+	}
+
+	static void RunDepthQuadtree(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		std::vector<Kinect::CameraSpacePointList> FramePoints;
+		for (const DepthRecording::Frame & Frame : Frames)
+		{
+			FramePoints.push_back(ProjectDepthFrame(Frame, Recording.GetWidth(), Recording.GetHeight()));
+		}
+
+		DepthQuadtree Quadtree(Recording.GetWidth(), Recording.GetHeight());
+		DepthRegion FullRegion{ 0, 0, Recording.GetWidth(), Recording.GetHeight() };
+		PerformanceCounter BuildTime(L"Build Time", L"ms", 0);
+		PerformanceCounter DecimatedTriangles(L"Triangles Decimated", L"count", 0);
+		PerformanceCounter ValidTriangles(L"Triangles Valid Cells", L"count", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const Kinect::CameraSpacePointList & Points : FramePoints)
+			{
+				BuildTime.Start();
+				Quadtree.Build(Points, true, FullRegion);
+				BuildTime.Stop();
+
+				if (Pass == 0)
+				{
+					DecimatedTriangles.AddSample(static_cast<double>(Quadtree.GetTriangleCount()));
+
+					Quadtree.Build(Points, false, FullRegion);
+					ValidTriangles.AddSample(static_cast<double>(Quadtree.GetTriangleCount()));
+				}
+			}
+		}
+
+		// The triangle count of the fixed grid created by Mesh::CreatePlane
+		double GridTriangles = 2.0 * (Recording.GetWidth() - 1) * (Recording.GetHeight() - 1);
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(BuildTime);
+		Results.Add(L"Triangles Grid", GridTriangles, L"count");
+		Results.Add(L"Triangles Valid Cells", ValidTriangles.GetAverage(), L"count");
+		Results.Add(L"Triangles Decimated", DecimatedTriangles.GetAverage(), L"count");
+		Results.Add(L"Triangle Reduction", 1.0 - DecimatedTriangles.GetAverage() / GridTriangles, L"ratio");
+	}
+
+	static void RunDepthRegionOfInterest(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		// The region and the conversion work on the fixed sensor resolution
+		if ((Recording.GetWidth() != Kinect::DepthImageWidth) || (Recording.GetHeight() != Kinect::DepthImageHeigth))
+		{
+			Utility::Log(L"Region of interest benchmark needs recordings in the depth sensor resolution");
+			return;
+		}
+
+		// The sensor is not opened, the region of interest is driven by stand-in joints
+		Kinect Kinect(Vector3(0.f, 0.f, 0.f));
+		DepthRegionOfInterest RegionOfInterest(Kinect);
+		Kinect::CameraSpaceTable Table = CreatePinholeTable(Recording.GetWidth(), Recording.GetHeight());
+		Kinect::CameraSpacePointList Points(Recording.GetWidth() * Recording.GetHeight());
+		Kinect::DepthSpacePointList DepthSpaceJoints;
+		Kinect::CameraSpacePointList CameraSpaceJoints;
+		DepthQuadtree Quadtree(Recording.GetWidth(), Recording.GetHeight());
+		const DepthRegion FullRegion{ 0, 0, Recording.GetWidth(), Recording.GetHeight() };
+
+		PerformanceCounter FullConversionTime(L"Conversion Time Full", L"ms", 0);
+		PerformanceCounter RegionConversionTime(L"Conversion Time Region", L"ms", 0);
+		PerformanceCounter FullBuildTime(L"Build Time Full", L"ms", 0);
+		PerformanceCounter RegionBuildTime(L"Build Time Region", L"ms", 0);
+		PerformanceCounter RegionArea(L"Region Area", L"ratio", 0);
+		PerformanceCounter FullTriangles(L"Triangles Full", L"count", 0);
+		PerformanceCounter RegionTriangles(L"Triangles Region", L"count", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const DepthRecording::Frame & Frame : Frames)
+			{
+				GetForegroundJoints(Frame, Recording.GetWidth(), DepthSpaceJoints, CameraSpaceJoints);
+				Kinect.BodyJointsUpdated(DepthSpaceJoints, CameraSpaceJoints);
+
+				const DepthRegion & Region = RegionOfInterest.GetRegion();
+
+				FullConversionTime.Start();
+				Kinect::MapDepthRegionToCameraSpace(Frame, Table, FullRegion, Points);
+				FullConversionTime.Stop();
+
+				FullBuildTime.Start();
+				Quadtree.Build(Points, true, FullRegion);
+				FullBuildTime.Stop();
+
+				if (Pass == 0)
+				{
+					FullTriangles.AddSample(static_cast<double>(Quadtree.GetTriangleCount()));
+				}
+
+				RegionConversionTime.Start();
+				Kinect::MapDepthRegionToCameraSpace(Frame, Table, Region, Points);
+				RegionConversionTime.Stop();
+
+				RegionBuildTime.Start();
+				Quadtree.Build(Points, true, Region);
+				RegionBuildTime.Stop();
+
+				if (Pass == 0)
+				{
+					RegionTriangles.AddSample(static_cast<double>(Quadtree.GetTriangleCount()));
+					RegionArea.AddSample(static_cast<double>(Region.GetWidth() * Region.GetHeight()) / static_cast<double>(Frame.size()));
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(L"Region Area", RegionArea.GetAverage(), L"ratio");
+		Results.Add(FullConversionTime);
+		Results.Add(RegionConversionTime);
+		Results.Add(FullBuildTime);
+		Results.Add(RegionBuildTime);
+		Results.Add(L"Triangles Full", FullTriangles.GetAverage(), L"count");
+		Results.Add(L"Triangles Region", RegionTriangles.GetAverage(), L"count");
+	}
+
+	static void RunDepthNormals(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		if ((Recording.GetWidth() != Kinect::DepthImageWidth) || (Recording.GetHeight() != Kinect::DepthImageHeigth))
+		{
+			Utility::Log(L"Normals benchmark needs recordings in the depth sensor resolution");
+			return;
+		}
+
+		Kinect::CameraSpaceTable Table = CreatePinholeTable(Recording.GetWidth(), Recording.GetHeight());
+		Kinect::CameraSpacePointList Points(Recording.GetWidth() * Recording.GetHeight());
+		Kinect::NormalList Normals(Points.size());
+		const DepthRegion FullRegion{ 0, 0, Recording.GetWidth(), Recording.GetHeight() };
+
+		PerformanceCounter ConversionTime(L"Conversion Time", L"ms", 0);
+		PerformanceCounter EstimationTime(L"Estimation Time Separate", L"ms", 0);
+		PerformanceCounter FusedTime(L"Conversion Time Fused", L"ms", 0);
+		PerformanceCounter NormalPixels(L"Pixels With Normal", L"ratio", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const DepthRecording::Frame & Frame : Frames)
+			{
+				ConversionTime.Start();
+				Kinect::MapDepthRegionToCameraSpace(Frame, Table, FullRegion, Points);
+				ConversionTime.Stop();
+
+				EstimationTime.Start();
+				DepthNormals::Estimate(Points, FullRegion, Normals);
+				EstimationTime.Stop();
+
+				FusedTime.Start();
+				DepthNormals::MapDepthRegionToCameraSpace(Frame, Table, FullRegion, Points, Normals);
+				FusedTime.Stop();
+
+				if (Pass == 0)
+				{
+					size_t WithNormal = Normals.size() - std::count(Normals.begin(), Normals.end(), DepthNormals::NoNormal);
+					NormalPixels.AddSample(static_cast<double>(WithNormal) / static_cast<double>(Normals.size()));
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(ConversionTime);
+		Results.Add(EstimationTime);
+		Results.Add(FusedTime);
+		Results.Add(L"Pixels With Normal", NormalPixels.GetAverage(), L"ratio");
+	}
+
+	static void RunDepthOccupancyGrid(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		constexpr unsigned QueriesPerAxis = 10;
+		constexpr unsigned RaysPerAxis = 32;
+		constexpr float SphereRadius = 0.1f;
+		constexpr float RayLength = 5.f;
+
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		if ((Recording.GetWidth() != Kinect::DepthImageWidth) || (Recording.GetHeight() != Kinect::DepthImageHeigth))
+		{
+			Utility::Log(L"Occupancy benchmark needs recordings in the depth sensor resolution");
+			return;
+		}
+
+		std::vector<Kinect::CameraSpacePointList> FramePoints;
+		for (const DepthRecording::Frame & Frame : Frames)
+		{
+			FramePoints.push_back(ProjectDepthFrame(Frame, Recording.GetWidth(), Recording.GetHeight()));
+		}
+
+		// Queries in meters around the sensor; the world Z axis points towards the user as for the depth mesh
+		Vector3List Positions;
+		for (unsigned Z = 0; Z < QueriesPerAxis; ++Z)
+			for (unsigned Y = 0; Y < QueriesPerAxis; ++Y)
+				for (unsigned X = 0; X < QueriesPerAxis; ++X)
+				{
+					Positions.push_back(Vector3(-2.f + 4.f * X / QueriesPerAxis, -1.5f + 3.f * Y / QueriesPerAxis, -1.f - 3.f * Z / QueriesPerAxis));
+				}
+
+		Vector3List Directions;
+		for (unsigned Y = 0; Y < RaysPerAxis; ++Y)
+			for (unsigned X = 0; X < RaysPerAxis; ++X)
+			{
+				Directions.push_back(DirectX::XMVector3Normalize(Vector3(-0.7f + 1.4f * X / RaysPerAxis, -0.6f + 1.2f * Y / RaysPerAxis, -1.f)));
+			}
+
+		DepthOccupancyGrid Grid;
+		const DepthRegion FullRegion{ 0, 0, Recording.GetWidth(), Recording.GetHeight() };
+
+		PerformanceCounter BuildTime(L"Build Time", L"ms", 0);
+		PerformanceCounter PointTime(L"Point Query Time", L"ms", 0);
+		PerformanceCounter SphereTime(L"Sphere Query Time", L"ms", 0);
+		PerformanceCounter RayTime(L"Ray Query Time", L"ms", 0);
+		PerformanceCounter OccupiedVoxels(L"Occupied Voxels", L"count", 0);
+		PerformanceCounter SphereHits(L"Sphere Hits", L"ratio", 0);
+		PerformanceCounter RayHits(L"Ray Hits", L"ratio", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const Kinect::CameraSpacePointList & Points : FramePoints)
+			{
+				BuildTime.Start();
+				Grid.Build(Points, FullRegion);
+				BuildTime.Stop();
+
+				size_t PointHitCount = 0;
+				PointTime.Start();
+				for (const Vector3 & Position : Positions)
+				{
+					PointHitCount += Grid.IsOccupied(Position) ? 1 : 0;
+				}
+				PointTime.Stop();
+
+				size_t SphereHitCount = 0;
+				SphereTime.Start();
+				for (const Vector3 & Position : Positions)
+				{
+					SphereHitCount += Grid.IntersectsSphere(Position, SphereRadius) ? 1 : 0;
+				}
+				SphereTime.Stop();
+
+				size_t RayHitCount = 0;
+				float Distance;
+				RayTime.Start();
+				for (const Vector3 & Direction : Directions)
+				{
+					RayHitCount += Grid.IntersectRay(Vector3(), Direction, RayLength, Distance) ? 1 : 0;
+				}
+				RayTime.Stop();
+
+				if (Pass == 0)
+				{
+					OccupiedVoxels.AddSample(static_cast<double>(Grid.GetOccupiedCount()));
+					SphereHits.AddSample(static_cast<double>(SphereHitCount) / Positions.size());
+					RayHits.AddSample(static_cast<double>(RayHitCount) / Directions.size());
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(BuildTime);
+		Results.Add(L"Point Queries", static_cast<double>(Positions.size()), L"count");
+		Results.Add(PointTime);
+		Results.Add(L"Sphere Queries", static_cast<double>(Positions.size()), L"count");
+		Results.Add(SphereTime);
+		Results.Add(L"Ray Queries", static_cast<double>(Directions.size()), L"count");
+		Results.Add(RayTime);
+		Results.Add(L"Occupied Voxels", OccupiedVoxels.GetAverage(), L"count");
+		Results.Add(L"Sphere Hits", SphereHits.GetAverage(), L"ratio");
+		Results.Add(L"Ray Hits", RayHits.GetAverage(), L"ratio");
+	}
+
+	static void RunOcclusionDepthBuffer(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		// A full HD output in front of a 30cm high frame, with eyes 6.4cm apart 60cm before it
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr float FrameHeight = 30.f;
+		constexpr float EyeDistance = 60.f;
+		constexpr float HalfEyeSeparation = 3.2f;
+
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		if ((Recording.GetWidth() != Kinect::DepthImageWidth) || (Recording.GetHeight() != Kinect::DepthImageHeigth))
+		{
+			Utility::Log(L"Occlusion benchmark needs recordings in the depth sensor resolution");
+			return;
+		}
+
+		std::vector<Kinect::CameraSpacePointList> FramePoints;
+		for (const DepthRecording::Frame & Frame : Frames)
+		{
+			FramePoints.push_back(ProjectDepthFrame(Frame, Recording.GetWidth(), Recording.GetHeight()));
+		}
+
+		// The sensor is not opened, the occlusion buffer is fed through the depth vertices event
+		Kinect Kinect(Vector3(0.f, 0.f, 0.f));
+		OcclusionDepthBuffer Buffer(Kinect);
+		DepthQuadtree Quadtree(Recording.GetWidth(), Recording.GetHeight());
+		Kinect::NormalList Normals(Recording.GetWidth() * Recording.GetHeight(), 0);
+		const DepthRegion FullRegion{ 0, 0, Recording.GetWidth(), Recording.GetHeight() };
+
+		std::array<FrameCamera, 2> Eyes = { FrameCamera(Vector3(-HalfEyeSeparation, 0.f, EyeDistance), FrameHeight), FrameCamera(Vector3(HalfEyeSeparation, 0.f, EyeDistance), FrameHeight) };
+		for (Camera & Eye : Eyes)
+		{
+			Eye.UpdateCamera(OutputSize);
+			Eye.Resolve();
+		}
+
+		// GPU time cannot be measured without a device; the mesh path is represented by its CPU work and its triangle load
+		PerformanceCounter MeshBuildTime(L"Mesh Build Time", L"ms", 0);
+		PerformanceCounter UpdateTime(L"Occlusion Update Time", L"ms", 0);
+		PerformanceCounter RasterizeTime(L"Occlusion Rasterize Time Per Eye", L"ms", 0);
+		PerformanceCounter MeshTriangles(L"Mesh Triangles Per Eye", L"count", 0);
+		PerformanceCounter OccludedPixels(L"Occluded Pixels", L"ratio", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const Kinect::CameraSpacePointList & Points : FramePoints)
+			{
+				MeshBuildTime.Start();
+				Quadtree.Build(Points, true, FullRegion);
+				MeshBuildTime.Stop();
+
+				UpdateTime.Start();
+				Kinect.DepthVerticesUpdated(Points, Normals, FullRegion);
+				UpdateTime.Stop();
+
+				for (const FrameCamera & Eye : Eyes)
+				{
+					RasterizeTime.Start();
+					Buffer.Rasterize(Eye, OutputSize.first, OutputSize.second);
+					RasterizeTime.Stop();
+				}
+
+				if (Pass == 0)
+				{
+					const std::vector<float> & Depth = Buffer.GetDepth();
+					size_t Occluded = Depth.size() - std::count(Depth.begin(), Depth.end(), 1.f);
+
+					MeshTriangles.AddSample(static_cast<double>(Quadtree.GetTriangleCount()));
+					OccludedPixels.AddSample(static_cast<double>(Occluded) / static_cast<double>(Depth.size()));
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(MeshBuildTime);
+		Results.Add(L"Mesh Triangles Per Eye", MeshTriangles.GetAverage(), L"count");
+		Results.Add(L"Mesh Triangles Full Grid Per Eye", static_cast<double>(2 * (Recording.GetWidth() - 1) * (Recording.GetHeight() - 1)), L"count");
+		Results.Add(UpdateTime);
+		Results.Add(RasterizeTime);
+		Results.Add(L"Occlusion Upload Per Eye", static_cast<double>(Buffer.GetWidth() * Buffer.GetHeight() * sizeof(float)), L"bytes");
+		Results.Add(L"Occluded Pixels", OccludedPixels.GetAverage(), L"ratio");
+	}
+
+	static void RunHierarchicalDepthBuffer(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		// Cubes on a grid behind the frame, as seen by one eye of a full HD output
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr float FrameHeight = 30.f;
+		constexpr float EyeDistance = 60.f;
+		constexpr unsigned ObjectsPerAxis = 10;
+		constexpr unsigned ObjectLayers = 4;
+		constexpr float ObjectSize = 4.f;
+
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		if ((Recording.GetWidth() != Kinect::DepthImageWidth) || (Recording.GetHeight() != Kinect::DepthImageHeigth))
+		{
+			Utility::Log(L"Hierarchical depth benchmark needs recordings in the depth sensor resolution");
+			return;
+		}
+
+		std::vector<Kinect::CameraSpacePointList> FramePoints;
+		for (const DepthRecording::Frame & Frame : Frames)
+		{
+			FramePoints.push_back(ProjectDepthFrame(Frame, Recording.GetWidth(), Recording.GetHeight()));
+		}
+
+		Kinect Kinect(Vector3(0.f, 0.f, 0.f));
+		OcclusionDepthBuffer Buffer(Kinect);
+		HierarchicalDepthBuffer HierarchicalDepth;
+		Kinect::NormalList Normals(Recording.GetWidth() * Recording.GetHeight(), 0);
+		const DepthRegion FullRegion{ 0, 0, Recording.GetWidth(), Recording.GetHeight() };
+		const Mesh::Bounds CubeBounds = { { -0.5f, -0.5f, -0.5f },{ 0.5f, 0.5f, 0.5f } };
+
+		FrameCamera Eye(Vector3(0.f, 0.f, EyeDistance), FrameHeight);
+		static_cast<Camera &>(Eye).UpdateCamera(OutputSize);
+		Eye.Resolve();
+
+		TransformList Objects;
+		for (unsigned Z = 0; Z < ObjectLayers; ++Z)
+			for (unsigned Y = 0; Y < ObjectsPerAxis; ++Y)
+				for (unsigned X = 0; X < ObjectsPerAxis; ++X)
+				{
+					Vector3 Position(-40.f + 80.f * X / ObjectsPerAxis, -25.f + 50.f * Y / ObjectsPerAxis, -180.f - 40.f * Z);
+					Objects.push_back(Transform(Position, Quaternion(), Vector3(ObjectSize)));
+				}
+
+		TransformList VisibleObjects;
+
+		PerformanceCounter BuildTime(L"Build Time", L"ms", 0);
+		PerformanceCounter CullTime(L"Cull Time", L"ms", 0);
+		PerformanceCounter CulledObjects(L"Culled Objects", L"ratio", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const Kinect::CameraSpacePointList & Points : FramePoints)
+			{
+				Kinect.DepthVerticesUpdated(Points, Normals, FullRegion);
+				Buffer.Rasterize(Eye, OutputSize.first, OutputSize.second);
+
+				BuildTime.Start();
+				HierarchicalDepth.Build(Buffer);
+				BuildTime.Stop();
+
+				CullTime.Start();
+				size_t Culled = HierarchicalDepth.Cull(CubeBounds, Objects, Eye, VisibleObjects);
+				CullTime.Stop();
+
+				if (Pass == 0)
+				{
+					CulledObjects.AddSample(static_cast<double>(Culled) / static_cast<double>(Objects.size()));
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(L"Objects", static_cast<double>(Objects.size()), L"count");
+		Results.Add(L"Levels", static_cast<double>(HierarchicalDepth.GetLevelCount()), L"count");
+		Results.Add(BuildTime);
+		Results.Add(CullTime);
+		Results.Add(L"Culled Objects", CulledObjects.GetAverage(), L"ratio");
+	}
+
+	static void RunDepthStatistics(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		DepthRecording Recording = LoadDepthFrames(Arguments);
+		const DepthRecording::FrameList & Frames = Recording.GetFrames();
+
+		if ((Recording.GetWidth() != Kinect::DepthImageWidth) || (Recording.GetHeight() != Kinect::DepthImageHeigth))
+		{
+			Utility::Log(L"Statistics benchmark needs recordings in the depth sensor resolution");
+			return;
+		}
+
+		Kinect::CameraSpaceTable Table = CreatePinholeTable(Recording.GetWidth(), Recording.GetHeight());
+		Kinect::CameraSpacePointList Points(Recording.GetWidth() * Recording.GetHeight());
+		Kinect::NormalList Normals(Points.size());
+		const DepthRegion FullRegion{ 0, 0, Recording.GetWidth(), Recording.GetHeight() };
+		DepthStatistics Statistics;
+
+		PerformanceCounter ConversionTime(L"Conversion Time", L"ms", 0);
+		PerformanceCounter StatisticsTime(L"Conversion Time With Statistics", L"ms", 0);
+		PerformanceCounter ValidRatio(L"Valid Ratio", L"ratio", 0);
+		PerformanceCounter NearestDepth(L"Nearest Depth", L"m", 0);
+		PerformanceCounter MedianDepth(L"Median Depth", L"m", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (const DepthRecording::Frame & Frame : Frames)
+			{
+				ConversionTime.Start();
+				DepthNormals::MapDepthRegionToCameraSpace(Frame, Table, FullRegion, Points, Normals);
+				ConversionTime.Stop();
+
+				StatisticsTime.Start();
+				Statistics.Begin();
+				DepthNormals::MapDepthRegionToCameraSpace(Frame, Table, FullRegion, Points, Normals, &Statistics);
+				Statistics.End();
+				StatisticsTime.Stop();
+
+				if (Pass == 0)
+				{
+					ValidRatio.AddSample(Statistics.GetValidRatio());
+					NearestDepth.AddSample(Statistics.GetNearestDepth());
+					MedianDepth.AddSample(Statistics.GetPercentile(0.5f));
+				}
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(ConversionTime);
+		Results.Add(StatisticsTime);
+		Results.Add(L"Statistics Overhead", StatisticsTime.GetAverage() / ConversionTime.GetAverage() - 1.0, L"ratio");
+		Results.Add(L"Valid Ratio", ValidRatio.GetAverage(), L"ratio");
+		Results.Add(L"Nearest Depth", NearestDepth.GetAverage(), L"m");
+		Results.Add(L"Median Depth", MedianDepth.GetAverage(), L"m");
+	}
+
+	static void RunPoseFilter(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		// The default latency from the face frame to its display, the predicting filters extrapolate over it
+		constexpr double Latency = 0.05;
+		constexpr size_t WarmUpFrameCount = 10;
+		constexpr int MaxLag = 200;
+		constexpr float MetersToMillimeters = 1000.f;
+
+		bool IsSynthetic = false;
+		FaceRecording Recording = LoadFaceFrames(Arguments, IsSynthetic);
+		const FaceRecording::FrameList & Frames = Recording.GetFrames();
+
+		if (Frames.size() <= 2 * WarmUpFrameCount)
+		{
+			Utility::Log(L"Pose filter benchmark needs a longer face recording");
+			return;
+		}
+
+		std::array<Vector3List, FaceRecording::PointCount> References;
+
+		for (unsigned Point = 0; Point < FaceRecording::PointCount; ++Point)
+		{
+			References[Point] = GetReferencePositions(Recording, IsSynthetic, Point);
+		}
+
+		// The head rests while the nose rests
+		std::vector<bool> IsResting = GetRestingFrames(Recording, References[0]);
+
+		struct Configuration
+		{
+			std::wstring Name;
+			PoseFilter * Filter;
+			double Prediction;
+		};
+
+		OneEuroPoseFilter OneEuroFilter;
+		KalmanPoseFilter KalmanFilter;
+
+		const std::array<Configuration, 5> Configurations = { {
+			{ L"None", nullptr, 0.0 },
+			{ L"One Euro", &OneEuroFilter, 0.0 },
+			{ L"Kalman", &KalmanFilter, 0.0 },
+			{ L"One Euro Predicted", &OneEuroFilter, Latency },
+			{ L"Kalman Predicted", &KalmanFilter, Latency },
+		} };
+
+		Vector3List Positions(Frames.size());
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+
+		for (const Configuration & Setup : Configurations)
+		{
+			PerformanceCounter UpdateTime(Setup.Name + L" Update Time", L"us", 0);
+			PerformanceCounter RestJitter(Setup.Name + L" Rest Jitter", L"mm", 0);
+			PerformanceCounter MotionError(Setup.Name + L" Motion Error", L"mm", 0);
+			std::vector<double> LagErrors(2 * MaxLag + 1, 0.0);
+
+			for (unsigned Point = 0; Point < FaceRecording::PointCount; ++Point)
+			{
+				const Vector3List & Reference = References[Point];
+
+				for (unsigned Pass = 0; Pass < Passes; ++Pass)
+				{
+					double StartTime = PerformanceCounter::GetTime();
+
+					if (Setup.Filter != nullptr)
+					{
+						Setup.Filter->Reset();
+					}
+
+					for (size_t Index = 0; Index < Frames.size(); ++Index)
+					{
+						const CameraSpacePoint & Measured = Frames[Index].Points[Point];
+						Positions[Index] = Vector3(Measured.X, Measured.Y, Measured.Z);
+
+						if (Setup.Filter != nullptr)
+						{
+							Setup.Filter->Update(Positions[Index], Frames[Index].Time);
+							Positions[Index] = Setup.Filter->Predict(Frames[Index].Time + Setup.Prediction);
+						}
+					}
+
+					UpdateTime.AddSample((PerformanceCounter::GetTime() - StartTime) * 1000000.0 / Frames.size());
+				}
+
+				// Errors against the reference at the time the position is displayed, which is the same with and without prediction
+				for (size_t Index = WarmUpFrameCount; Index < Frames.size(); ++Index)
+				{
+					double DisplayTime = Frames[Index].Time + Latency;
+					auto GetError = [&](double Time) { return DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(Positions[Index], GetReferencePosition(Recording, Reference, Time)))); };
+
+					if (IsResting[Index])
+					{
+						RestJitter.AddSample(GetError(DisplayTime) * MetersToMillimeters);
+						continue;
+					}
+
+					MotionError.AddSample(GetError(DisplayTime) * MetersToMillimeters);
+
+					// The lag is the delay of the reference that matches the positions best, in steps of a millisecond
+					for (int Lag = -MaxLag; Lag <= MaxLag; ++Lag)
+					{
+						double Error = GetError(DisplayTime - Lag * 0.001);
+						LagErrors[Lag + MaxLag] += Error * Error;
+					}
+				}
+			}
+
+			int Lag = static_cast<int>(std::min_element(LagErrors.begin(), LagErrors.end()) - LagErrors.begin()) - MaxLag;
+
+			Results.Add(Setup.Name + L" Update Time", UpdateTime.GetAverage(), L"us");
+			Results.Add(Setup.Name + L" Rest Jitter", RestJitter.GetAverage(), L"mm");
+			Results.Add(Setup.Name + L" Motion Error", MotionError.GetAverage(), L"mm");
+			Results.Add(Setup.Name + L" Lag", static_cast<double>(Lag), L"ms");
+		}
+	}
+
+	static void RunHeadPivotModel(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		// Size of the Kinect high definition face model, its vertices are blended from the animation units
+		constexpr size_t FaceModelVertexCount = 1347;
+		constexpr size_t AnimationUnitCount = 17;
+		constexpr float MetersToMillimeters = 1000.f;
+
+		bool IsSynthetic = false;
+		FaceRecording Recording = LoadFaceFrames(Arguments, IsSynthetic);
+		const FaceRecording::FrameList & Frames = Recording.GetFrames();
+
+		if (Frames.empty())
+		{
+			Utility::Log(L"Head pivot benchmark needs a face recording");
+			return;
+		}
+
+		// Fitted once from the first frame, like the head tracker does for each user
+		HeadPivotModel Model;
+		Model.Fit(Frames.front().Points, Frames.front().Pose);
+
+		// The face model SDK is not available headless; blending and placing as many vertices stands in for it as a lower bound of its cost
+		std::vector<DirectX::XMFLOAT3> MeanVertices(FaceModelVertexCount);
+		std::vector<DirectX::XMFLOAT3> AnimationUnitBases(FaceModelVertexCount * AnimationUnitCount);
+		std::array<float, AnimationUnitCount> AnimationUnits;
+		Kinect::CameraSpacePointList FaceVertices(FaceModelVertexCount);
+
+		for (size_t Index = 0; Index < MeanVertices.size(); ++Index)
+		{
+			float Angle = Index * 0.1f;
+			MeanVertices[Index] = { 0.08f * std::sin(Angle), 0.1f * std::cos(Angle * 0.7f), -0.1f };
+		}
+
+		for (size_t Index = 0; Index < AnimationUnitBases.size(); ++Index)
+		{
+			AnimationUnitBases[Index] = { 0.001f * (Index % 7), 0.001f * (Index % 5), 0.001f * (Index % 3) };
+		}
+
+		for (size_t Unit = 0; Unit < AnimationUnits.size(); ++Unit)
+		{
+			AnimationUnits[Unit] = 0.05f * Unit;
+		}
+
+		std::vector<TrackedFacePoints> PivotPoints(Frames.size());
+
+		PerformanceCounter PivotModelTime(L"Pivot Model Time", L"us", 0);
+		PerformanceCounter FaceModelTime(L"Face Model Time", L"us", 0);
+		PerformanceCounter PointError(L"Point Error", L"mm", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			double StartTime = PerformanceCounter::GetTime();
+
+			for (size_t Index = 0; Index < Frames.size(); ++Index)
+			{
+				Model.GetPoints(Frames[Index].Pose, PivotPoints[Index]);
+			}
+
+			PivotModelTime.AddSample((PerformanceCounter::GetTime() - StartTime) * 1000000.0 / Frames.size());
+			StartTime = PerformanceCounter::GetTime();
+
+			for (const FaceRecording::Frame & Face : Frames)
+			{
+				DirectX::XMVECTOR Pivot = DirectX::XMVectorSet(Face.Pose.HeadPivot.X, Face.Pose.HeadPivot.Y, Face.Pose.HeadPivot.Z, 0.f);
+				DirectX::XMVECTOR Orientation = DirectX::XMVectorSet(Face.Pose.Orientation.x, Face.Pose.Orientation.y, Face.Pose.Orientation.z, Face.Pose.Orientation.w);
+
+				for (size_t Index = 0; Index < FaceModelVertexCount; ++Index)
+				{
+					DirectX::XMVECTOR Vertex = DirectX::XMLoadFloat3(&MeanVertices[Index]);
+
+					for (size_t Unit = 0; Unit < AnimationUnitCount; ++Unit)
+					{
+						Vertex = DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat3(&AnimationUnitBases[Index * AnimationUnitCount + Unit]), DirectX::XMVectorReplicate(AnimationUnits[Unit]), Vertex);
+					}
+
+					DirectX::XMFLOAT3 Placed;
+					DirectX::XMStoreFloat3(&Placed, DirectX::XMVectorAdd(Pivot, DirectX::XMVector3Rotate(Vertex, Orientation)));
+					FaceVertices[Index] = { Placed.x, Placed.y, Placed.z };
+				}
+			}
+
+			FaceModelTime.AddSample((PerformanceCounter::GetTime() - StartTime) * 1000000.0 / Frames.size());
+		}
+
+		// The recorded points are taken from the whole face model, that is aligned to the expressions as well
+		for (size_t Index = 0; Index < Frames.size(); ++Index)
+		{
+			for (unsigned Point = 0; Point < TrackedFacePointCount; ++Point)
+			{
+				const CameraSpacePoint & Expected = Frames[Index].Points[Point];
+				const CameraSpacePoint & Placed = PivotPoints[Index][Point];
+				DirectX::XMVECTOR Difference = DirectX::XMVectorSet(Placed.X - Expected.X, Placed.Y - Expected.Y, Placed.Z - Expected.Z, 0.f);
+
+				PointError.AddSample(DirectX::XMVectorGetX(DirectX::XMVector3Length(Difference)) * MetersToMillimeters);
+			}
+		}
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+		Results.Add(PivotModelTime);
+		Results.Add(FaceModelTime);
+		Results.Add(L"Speedup", FaceModelTime.GetAverage() / PivotModelTime.GetAverage(), L"ratio");
+		Results.Add(PointError);
+	}
+
+	static void RunHeadTracker(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		// Face frames are replayed at their recorded times through the head tracker into the cameras, which are resolved
+		// at the render rate like the application does; the tracker works in meters with the cameras on the same scale
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr double RenderRate = 60.0;
+		constexpr float Latency = 0.05f;
+		constexpr float FrameHeight = 0.3f;
+		constexpr size_t WarmUpFrameCount = 10;
+		constexpr int MaxLag = 200;
+		constexpr float MetersToMillimeters = 1000.f;
+
+		bool IsSynthetic = false;
+		FaceRecording Recording = LoadFaceFrames(Arguments, IsSynthetic);
+		const FaceRecording::FrameList & Frames = Recording.GetFrames();
+
+		if (Frames.size() <= 2 * WarmUpFrameCount)
+		{
+			Utility::Log(L"Head tracker benchmark needs a longer face recording");
+			return;
+		}
+
+		// The nose drives the camera of the mono view
+		const Vector3List Reference = GetReferencePositions(Recording, IsSynthetic, 0);
+		const std::vector<bool> IsResting = GetRestingFrames(Recording, Reference);
+
+		const std::array<std::pair<std::wstring, HeadTracker::PoseFilterType>, HeadTracker::PoseFilterType_Count> Configurations = { {
+			{ L"None", HeadTracker::PoseFilterType_None },
+			{ L"One Euro", HeadTracker::PoseFilterType_OneEuro },
+			{ L"Kalman", HeadTracker::PoseFilterType_Kalman },
+		} };
+
+		Results.Add(L"Frames", static_cast<double>(Frames.size()), L"count");
+
+		for (const auto & Setup : Configurations)
+		{
+			PerformanceCounter FrameTime(Setup.first + L" Frame Time", L"us", 0);
+			PerformanceCounter ResolveTime(Setup.first + L" Resolve Time", L"us", 0);
+			PerformanceCounter RestJitter(Setup.first + L" Rest Jitter", L"mm", 0);
+			PerformanceCounter MotionError(Setup.first + L" Motion Error", L"mm", 0);
+			std::vector<double> LagErrors(2 * MaxLag + 1, 0.0);
+			std::vector<bool> IsDisplayed(Frames.size(), false);
+			Vector3List Positions(Frames.size());
+			size_t RenderFrameCount = 0;
+			unsigned ResolveCount = 0;
+
+			for (unsigned Pass = 0; Pass < Passes; ++Pass)
+			{
+				// The sensor is not opened, the tracker gets the recorded poses directly
+				Kinect Kinect(Vector3(0.f, 0.f, 0.f));
+				FrameCamera NoseCamera(Vector3(), FrameHeight);
+				StereoFrameCamera EyeCameras(Vector3(), FrameHeight);
+				HeadTracker Tracker(NoseCamera, EyeCameras, Kinect, Setup.second, Latency, false);
+
+				const std::array<FrameCamera *, 3> Cameras = { &NoseCamera, &EyeCameras.GetEye(StereoFrameCamera::Eye_Left), &EyeCameras.GetEye(StereoFrameCamera::Eye_Right) };
+
+				for (Camera * View : Cameras)
+				{
+					View->UpdateCamera(OutputSize);
+					View->Resolve();
+				}
+
+				std::array<unsigned, 3> InitialResolveCounts;
+				std::transform(Cameras.begin(), Cameras.end(), InitialResolveCounts.begin(), [](const FrameCamera * View) { return View->GetResolveCount(); });
+
+				Tracker.FitModel(Frames.front().Points, Frames.front().Pose);
+
+				size_t Next = 0;
+				RenderFrameCount = 0;
+
+				for (double RenderTime = Frames.front().Time; Next < Frames.size(); RenderTime += 1.0 / RenderRate)
+				{
+					for (; (Next < Frames.size()) && (Frames[Next].Time <= RenderTime); ++Next)
+					{
+						const FaceRecording::Frame & Face = Frames[Next];
+
+						double StartTime = PerformanceCounter::GetTime();
+						Tracker.UpdatePose(Face.Pose, Vector3(0.f, 0.f, 0.f), 1.f, Face.Time);
+						FrameTime.AddSample((PerformanceCounter::GetTime() - StartTime) * 1000000.0);
+					}
+
+					double StartTime = PerformanceCounter::GetTime();
+					FrameCamera::Resolve({ Cameras[0], Cameras[1], Cameras[2] });
+					ResolveTime.AddSample((PerformanceCounter::GetTime() - StartTime) * 1000000.0);
+
+					++RenderFrameCount;
+
+					// Only the last face frame before a render frame is displayed; the view of a frame camera is the translation to its position
+					if (Next > 0)
+					{
+						const DirectX::XMFLOAT4X4 & View = Cameras[0]->GetViewMatrix();
+						Positions[Next - 1] = Vector3(-View.m[0][3], -View.m[1][3], -View.m[2][3]);
+						IsDisplayed[Next - 1] = true;
+					}
+				}
+
+				ResolveCount = 0;
+				for (size_t Index = 0; Index < Cameras.size(); ++Index)
+				{
+					ResolveCount += Cameras[Index]->GetResolveCount() - InitialResolveCounts[Index];
+				}
+			}
+
+			// Errors against the reference at the time the position is displayed, like the pose filter benchmark
+			for (size_t Index = WarmUpFrameCount; Index < Frames.size(); ++Index)
+			{
+				if (!IsDisplayed[Index])
+				{
+					continue;
+				}
+
+				double DisplayTime = Frames[Index].Time + Latency;
+				auto GetError = [&](double Time) { return DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(Positions[Index], GetReferencePosition(Recording, Reference, Time)))); };
+
+				if (IsResting[Index])
+				{
+					RestJitter.AddSample(GetError(DisplayTime) * MetersToMillimeters);
+					continue;
+				}
+
+				MotionError.AddSample(GetError(DisplayTime) * MetersToMillimeters);
+
+				for (int Lag = -MaxLag; Lag <= MaxLag; ++Lag)
+				{
+					double Error = GetError(DisplayTime - Lag * 0.001);
+					LagErrors[Lag + MaxLag] += Error * Error;
+				}
+			}
+
+			int Lag = static_cast<int>(std::min_element(LagErrors.begin(), LagErrors.end()) - LagErrors.begin()) - MaxLag;
+
+			Results.Add(FrameTime);
+			Results.Add(ResolveTime);
+			Results.Add(Setup.first + L" Rest Jitter", RestJitter.GetAverage(), L"mm");
+			Results.Add(Setup.first + L" Motion Error", MotionError.GetAverage(), L"mm");
+			Results.Add(Setup.first + L" Lag", static_cast<double>(Lag), L"ms");
+			Results.Add(Setup.first + L" Render Frames", static_cast<double>(RenderFrameCount), L"count");
+			Results.Add(Setup.first + L" Camera Resolves", static_cast<double>(ResolveCount), L"count");
+			Results.Add(Setup.first + L" Camera Resolves Per Render Frame", static_cast<double>(ResolveCount) / (RenderFrameCount * TrackedFacePointCount), L"ratio");
+		}
+	}
+
+	static void RunUserArbitration(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// A minute of a busy shop at the body frame rate: the user in front of the mirror loses its body for a few frames
+		// every seven seconds and comes back with a new tracking id, a passer-by crosses the view every ten seconds and a
+		// companion stands aside for half a minute, leaning in close for a third of a second once
+		constexpr double FrameRate = 30.0;
+		constexpr size_t FrameCount = 60 * 30;
+		constexpr size_t BodyCount = 3;
+		constexpr size_t UserSlot = 1;
+
+		struct BodyFrame
+		{
+			std::array<bool, BodyCount> IsTracked;
+			std::array<UINT64, BodyCount> TrackingIds;
+			std::array<CameraSpacePoint, BodyCount> Heads;
+		};
+
+		std::vector<BodyFrame> Frames(FrameCount);
+
+		for (size_t Index = 0; Index < FrameCount; ++Index)
+		{
+			double Time = Index / FrameRate;
+			BodyFrame & Frame = Frames[Index];
+
+			double CrossingTime = std::fmod(Time, 10.0);
+			float PasserX = static_cast<float>(-1.5 + CrossingTime * 0.5);
+			Frame.IsTracked[0] = (CrossingTime < 6.0) && (std::abs(PasserX) <= 1.2f);
+			Frame.TrackingIds[0] = 100 + static_cast<UINT64>(Time / 10.0);
+			Frame.Heads[0] = { PasserX, 0.2f, 2.2f };
+
+			size_t Dropout = static_cast<size_t>(Time / 7.0);
+			Frame.IsTracked[UserSlot] = (std::fmod(Time, 7.0) >= 3.0 / FrameRate);
+			Frame.TrackingIds[UserSlot] = 200 + Dropout;
+			Frame.Heads[UserSlot] = { 0.05f * static_cast<float>(std::sin(Time)), 0.1f, 0.9f };
+
+			bool IsLeaningIn = (Time >= 20.0) && (Time < 20.0 + 10.0 / FrameRate);
+			Frame.IsTracked[2] = (Time >= 15.0) && (Time < 45.0);
+			Frame.TrackingIds[2] = 300;
+			Frame.Heads[2] = IsLeaningIn ? CameraSpacePoint{ 0.1f, 0.1f, 0.6f } : CameraSpacePoint{ 0.6f, 0.1f, 1.4f };
+		}
+
+		// The previous policy keeps the tracked body while it is tracked and takes the first tracked body of the array otherwise
+		auto FollowFirstBody = [&](const BodyFrame & Frame, UINT64 Current)
+		{
+			for (size_t Slot = 0; Slot < BodyCount; ++Slot)
+			{
+				if (Frame.IsTracked[Slot] && (Frame.TrackingIds[Slot] == Current))
+				{
+					return Current;
+				}
+			}
+
+			for (size_t Slot = 0; Slot < BodyCount; ++Slot)
+			{
+				if (Frame.IsTracked[Slot])
+				{
+					return Frame.TrackingIds[Slot];
+				}
+			}
+
+			return UINT64(0);
+		};
+
+		PerformanceCounter UpdateTime(L"Arbitration Update Time", L"us", 0);
+		std::array<std::vector<UINT64>, 2> Followed = { std::vector<UINT64>(FrameCount, 0), std::vector<UINT64>(FrameCount, 0) };
+		std::array<unsigned, 2> Handoffs = { 0, 0 };
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			UserArbitration Arbitration;
+			UserArbitration::CandidateList Candidates;
+			UINT64 Current = 0;
+			Handoffs[0] = 0;
+
+			for (size_t Index = 0; Index < FrameCount; ++Index)
+			{
+				const BodyFrame & Frame = Frames[Index];
+				UINT64 Next = FollowFirstBody(Frame, Current);
+				Handoffs[0] += ((Current != 0) && (Next != 0) && (Next != Current)) ? 1 : 0;
+				Followed[0][Index] = Current = (Next != 0) ? Next : Current;
+
+				Candidates.clear();
+				for (size_t Slot = 0; Slot < BodyCount; ++Slot)
+				{
+					if (Frame.IsTracked[Slot])
+					{
+						Candidates.push_back({ Frame.TrackingIds[Slot], Frame.Heads[Slot] });
+					}
+				}
+
+				double StartTime = PerformanceCounter::GetTime();
+				Followed[1][Index] = Arbitration.Update(Candidates, Index / FrameRate);
+				UpdateTime.AddSample((PerformanceCounter::GetTime() - StartTime) * 1000000.0);
+			}
+
+			Handoffs[1] = Arbitration.GetHandoffCount();
+		}
+
+		// A face alignment restarts with every switch of the tracking id, including the new id of the returning user
+		const std::array<std::wstring, 2> Names = { L"First Body", L"Arbitration" };
+
+		for (size_t Policy = 0; Policy < Names.size(); ++Policy)
+		{
+			size_t UserFrames = 0;
+			size_t FollowedUserFrames = 0;
+			size_t Restarts = 0;
+
+			for (size_t Index = 0; Index < FrameCount; ++Index)
+			{
+				const BodyFrame & Frame = Frames[Index];
+
+				if (Frame.IsTracked[UserSlot])
+				{
+					++UserFrames;
+					FollowedUserFrames += (Followed[Policy][Index] == Frame.TrackingIds[UserSlot]) ? 1 : 0;
+				}
+
+				Restarts += ((Index > 0) && (Followed[Policy][Index] != Followed[Policy][Index - 1])) ? 1 : 0;
+			}
+
+			Results.Add(Names[Policy] + L" Handoffs", static_cast<double>(Handoffs[Policy]), L"count");
+			Results.Add(Names[Policy] + L" Face Alignment Restarts", static_cast<double>(Restarts), L"count");
+			Results.Add(Names[Policy] + L" User Followed", static_cast<double>(FollowedUserFrames) / UserFrames, L"ratio");
+		}
+
+		Results.Add(UpdateTime);
+	}
+
+	static void RunTransformArray(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// Objects bob up and down, either all of them or a tenth of them each frame
+		constexpr size_t FrameCount = 60;
+		constexpr size_t PartialStride = 10;
+		constexpr float Step = 0.1f;
+		const std::array<size_t, 3> ObjectCounts = { 10, 1000, 100000 };
+
+		for (size_t ObjectCount : ObjectCounts)
+		{
+			const std::wstring Prefix = std::to_wstring(ObjectCount) + L" ";
+
+			TransformList Objects;
+			Objects.reserve(ObjectCount);
+
+			for (size_t Index = 0; Index < ObjectCount; ++Index)
+			{
+				Vector3 Position(static_cast<float>(Index % 100), static_cast<float>((Index / 100) % 100), -static_cast<float>(Index / 10000));
+				Quaternion Rotation(static_cast<float>(Index % 360), static_cast<float>((Index * 7) % 360), static_cast<float>((Index * 13) % 360));
+				Objects.push_back(Transform(Position, Rotation, Vector3(0.5f + (Index % 4) * 0.25f)));
+			}
+
+			TransformArray Array(Objects);
+			Array.Update();
+
+			PerformanceCounter ListTime(Prefix + L"Transform List Time", L"ms", 0);
+			PerformanceCounter ArrayTime(Prefix + L"Transform Array Time", L"ms", 0);
+			PerformanceCounter PartialListTime(Prefix + L"Partial Transform List Time", L"ms", 0);
+			PerformanceCounter PartialArrayTime(Prefix + L"Partial Transform Array Time", L"ms", 0);
+			size_t PartialUpdates = 0;
+
+			auto Offset = [&](size_t Index, size_t Frame)
+			{
+				const Vector3 & Position = Objects[Index].GetPosition();
+				return Vector3(Position.X, Position.Y + ((Frame & 1) ? Step : -Step), Position.Z);
+			};
+
+			for (unsigned Pass = 0; Pass < Passes; ++Pass)
+			{
+				for (size_t Frame = 0; Frame < FrameCount; ++Frame)
+				{
+					ArrayTime.Start();
+					for (size_t Index = 0; Index < ObjectCount; ++Index)
+					{
+						Array.SetPosition(Index, Offset(Index, Frame));
+					}
+					Array.Update();
+					ArrayTime.Stop();
+
+					ListTime.Start();
+					for (size_t Index = 0; Index < ObjectCount; ++Index)
+					{
+						Objects[Index].UpdatePosition(Offset(Index, Frame));
+					}
+					ListTime.Stop();
+				}
+
+				for (size_t Frame = 0; Frame < FrameCount; ++Frame)
+				{
+					PartialArrayTime.Start();
+					for (size_t Index = Frame % PartialStride; Index < ObjectCount; Index += PartialStride)
+					{
+						Array.SetPosition(Index, Offset(Index, Frame));
+					}
+					PartialUpdates = Array.Update();
+					PartialArrayTime.Stop();
+
+					PartialListTime.Start();
+					for (size_t Index = Frame % PartialStride; Index < ObjectCount; Index += PartialStride)
+					{
+						Objects[Index].UpdatePosition(Offset(Index, Frame));
+					}
+					PartialListTime.Stop();
+				}
+			}
+
+			// Both paths have to arrive at the same matrices
+			float MatrixError = 0.f;
+
+			for (size_t Index = 0; Index < ObjectCount; ++Index)
+			{
+				const DirectX::XMFLOAT4X4 & Expected = Objects[Index].GetMatrix();
+				const DirectX::XMFLOAT4X4 & Actual = Array.GetMatrix(Index);
+
+				for (unsigned Row = 0; Row < 4; ++Row)
+					for (unsigned Column = 0; Column < 4; ++Column)
+					{
+						MatrixError = (std::max)(MatrixError, std::abs(Expected.m[Row][Column] - Actual.m[Row][Column]));
+					}
+			}
+
+			Results.Add(ListTime);
+			Results.Add(ArrayTime);
+			Results.Add(Prefix + L"Transform Array Speedup", ListTime.GetAverage() / ArrayTime.GetAverage(), L"ratio");
+			Results.Add(PartialListTime);
+			Results.Add(PartialArrayTime);
+			Results.Add(Prefix + L"Partial Transform Array Speedup", PartialListTime.GetAverage() / PartialArrayTime.GetAverage(), L"ratio");
+			Results.Add(Prefix + L"Partial Updated Objects", static_cast<double>(PartialUpdates), L"count");
+			Results.Add(Prefix + L"Matrix Error", MatrixError, L"absolute");
+		}
+	}
+
+	static void RunSimdMath(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		constexpr size_t SampleCount = 10000;
+
+		struct Sample
+		{
+			DirectX::XMFLOAT4 Eye;
+			DirectX::XMFLOAT4 Direction;
+			DirectX::XMFLOAT4 Rotation;
+			DirectX::XMFLOAT4X4 Matrix;
+			float Left;
+			float Right;
+			float Bottom;
+			float Top;
+			float FoV;
+		};
+
+		UINT32 RandomState = 0x12345678;
+
+		auto NextRandom = [&RandomState](float Minimum, float Maximum)
+		{
+			RandomState = RandomState * 1664525u + 1013904223u;
+			return Minimum + (Maximum - Minimum) * static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+		};
+
+		// Eyes and frames like the mirror's, random unit rotations and random matrices
+		std::vector<Sample> Samples(SampleCount);
+
+		for (Sample & Input : Samples)
+		{
+			Input.Eye = { NextRandom(-50.f, 50.f), NextRandom(-30.f, 30.f), NextRandom(20.f, 200.f), 0.f };
+			Input.Direction = { NextRandom(-1.f, 1.f), NextRandom(-1.f, 1.f), NextRandom(-1.f, -0.1f), 0.f };
+			DirectX::XMStoreFloat4(&Input.Rotation, DirectX::XMQuaternionNormalize(DirectX::XMVectorSet(NextRandom(-1.f, 1.f), NextRandom(-1.f, 1.f), NextRandom(-1.f, 1.f), NextRandom(0.1f, 1.f))));
+
+			for (unsigned Row = 0; Row < 4; ++Row)
+				for (unsigned Column = 0; Column < 4; ++Column)
+				{
+					Input.Matrix.m[Row][Column] = NextRandom(-2.f, 2.f);
+				}
+
+			Input.Left = -Input.Eye.x - NextRandom(20.f, 40.f);
+			Input.Right = -Input.Eye.x + NextRandom(20.f, 40.f);
+			Input.Bottom = -Input.Eye.y - NextRandom(10.f, 20.f);
+			Input.Top = -Input.Eye.y + NextRandom(10.f, 20.f);
+			Input.FoV = NextRandom(30.f, 120.f);
+		}
+
+		// Distance of two floats in units in the last place, through their ordered bit patterns
+		auto GetUlpDistance = [](float A, float B)
+		{
+			INT32 BitsA;
+			INT32 BitsB;
+			std::memcpy(&BitsA, &A, sizeof(A));
+			std::memcpy(&BitsB, &B, sizeof(B));
+
+			INT64 OrderedA = (BitsA < 0) ? INT64((std::numeric_limits<INT32>::min)()) - BitsA : BitsA;
+			INT64 OrderedB = (BitsB < 0) ? INT64((std::numeric_limits<INT32>::min)()) - BitsB : BitsB;
+			return static_cast<double>(std::abs(OrderedA - OrderedB));
+		};
+
+		std::vector<DirectX::XMFLOAT4X4> SimdOutputs(SampleCount);
+		std::vector<DirectX::XMFLOAT4X4> DirectXOutputs(SampleCount);
+
+		auto Compare = [&](const std::wstring & Name, auto SimdOperation, auto DirectXOperation)
+		{
+			PerformanceCounter SimdTime(Name + L" SimdMath Time", L"ms", 0);
+			PerformanceCounter DirectXTime(Name + L" DirectXMath Time", L"ms", 0);
+
+			for (unsigned Pass = 0; Pass < Passes; ++Pass)
+			{
+				SimdTime.Start();
+				for (size_t Index = 0; Index < SampleCount; ++Index)
+				{
+					SimdOperation(Samples[Index], &SimdOutputs[Index].m[0][0]);
+				}
+				SimdTime.Stop();
+
+				DirectXTime.Start();
+				for (size_t Index = 0; Index < SampleCount; ++Index)
+				{
+					DirectXOperation(Samples[Index], DirectXOutputs[Index]);
+				}
+				DirectXTime.Stop();
+			}
+
+			double Difference = 0.0;
+
+			for (size_t Index = 0; Index < SampleCount; ++Index)
+				for (unsigned Row = 0; Row < 4; ++Row)
+					for (unsigned Column = 0; Column < 4; ++Column)
+					{
+						Difference = (std::max)(Difference, GetUlpDistance(SimdOutputs[Index].m[Row][Column], DirectXOutputs[Index].m[Row][Column]));
+					}
+
+			Results.Add(SimdTime);
+			Results.Add(DirectXTime);
+			Results.Add(Name + L" Difference", Difference, L"ulp");
+		};
+
+		// Vector results are stored in the first row
+		auto Load = [](const DirectX::XMFLOAT4 & Value) { return SimdMath::LoadFloat4(&Value.x); };
+		const SimdMath::Vector Up = SimdMath::Set(0.f, 1.f, 0.f, 0.f);
+		const DirectX::XMVECTOR DirectXUp = DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f);
+
+		Results.Add(std::wstring(SimdMath::GetBackendName()) + L" Backend", 1.0, L"flag");
+		Results.Add(L"Samples", static_cast<double>(SampleCount), L"count");
+
+		Compare(L"Look To",
+			[&](const Sample & Input, float * Output) { SimdMath::StoreFloat4x4(Output, SimdMath::MatrixLookToRH(Load(Input.Eye), Load(Input.Direction), Up)); },
+			[&](const Sample & Input, DirectX::XMFLOAT4X4 & Output) { DirectX::XMStoreFloat4x4(&Output, DirectX::XMMatrixLookToRH(DirectX::XMLoadFloat4(&Input.Eye), DirectX::XMLoadFloat4(&Input.Direction), DirectXUp)); });
+
+		Compare(L"Off Center Perspective",
+			[&](const Sample & Input, float * Output) { SimdMath::StoreFloat4x4(Output, SimdMath::MatrixPerspectiveOffCenterRH(Input.Left, Input.Right, Input.Bottom, Input.Top, Input.Eye.z, 1000.f)); },
+			[&](const Sample & Input, DirectX::XMFLOAT4X4 & Output) { DirectX::XMStoreFloat4x4(&Output, DirectX::XMMatrixPerspectiveOffCenterRH(Input.Left, Input.Right, Input.Bottom, Input.Top, Input.Eye.z, 1000.f)); });
+
+		Compare(L"FoV Perspective",
+			[&](const Sample & Input, float * Output) { SimdMath::StoreFloat4x4(Output, SimdMath::MatrixPerspectiveFovRH(SimdMath::ConvertToRadians(Input.FoV), 16.f / 9.f, 0.001f, 100.f)); },
+			[&](const Sample & Input, DirectX::XMFLOAT4X4 & Output) { DirectX::XMStoreFloat4x4(&Output, DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(Input.FoV), 16.f / 9.f, 0.001f, 100.f)); });
+
+		Compare(L"Quaternion Rotation",
+			[&](const Sample & Input, float * Output) { SimdMath::StoreFloat4(Output, SimdMath::Vector3Rotate(Load(Input.Direction), Load(Input.Rotation))); },
+			[&](const Sample & Input, DirectX::XMFLOAT4X4 & Output) { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4 *>(Output.m[0]), DirectX::XMVector3Rotate(DirectX::XMLoadFloat4(&Input.Direction), DirectX::XMLoadFloat4(&Input.Rotation))); });
+
+		Compare(L"Quaternion Inverse Rotation",
+			[&](const Sample & Input, float * Output) { SimdMath::StoreFloat4(Output, SimdMath::Vector3InverseRotate(Load(Input.Direction), Load(Input.Rotation))); },
+			[&](const Sample & Input, DirectX::XMFLOAT4X4 & Output) { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4 *>(Output.m[0]), DirectX::XMVector3InverseRotate(DirectX::XMLoadFloat4(&Input.Direction), DirectX::XMLoadFloat4(&Input.Rotation))); });
+
+		Compare(L"Quaternion Matrix",
+			[&](const Sample & Input, float * Output) { SimdMath::StoreFloat4x4(Output, SimdMath::MatrixRotationQuaternion(Load(Input.Rotation))); },
+			[&](const Sample & Input, DirectX::XMFLOAT4X4 & Output) { DirectX::XMStoreFloat4x4(&Output, DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(&Input.Rotation))); });
+
+		Compare(L"Matrix Multiply",
+			[&](const Sample & Input, float * Output)
+			{
+				SimdMath::Matrix Value = SimdMath::LoadFloat4x4(&Input.Matrix.m[0][0]);
+				SimdMath::StoreFloat4x4(Output, SimdMath::MatrixMultiply(Value, SimdMath::MatrixTranspose(Value)));
+			},
+			[&](const Sample & Input, DirectX::XMFLOAT4X4 & Output)
+			{
+				DirectX::XMMATRIX Value = DirectX::XMLoadFloat4x4(&Input.Matrix);
+				DirectX::XMStoreFloat4x4(&Output, DirectX::XMMatrixMultiply(Value, DirectX::XMMatrixTranspose(Value)));
+			});
+	}
+
+	static void RunViewFrustum(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// Decorations scattered around the mirror, most of them outside the view through the frame, seen by both eyes
+		// of a full HD output while the head sways sideways
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr float FrameHeight = 30.f;
+		constexpr float EyeDistance = 60.f;
+		constexpr float EyeSeparation = 6.4f;
+		constexpr float SwayDistance = 20.f;
+		constexpr size_t ObjectCount = 800;
+		constexpr size_t FrameCount = 60;
+		const Mesh::Bounds CubeBounds = { { -0.5f, -0.5f, -0.5f },{ 0.5f, 0.5f, 0.5f } };
+
+		UINT32 RandomState = 0x12345678;
+
+		auto NextRandom = [&RandomState](float Minimum, float Maximum)
+		{
+			RandomState = RandomState * 1664525u + 1013904223u;
+			return Minimum + (Maximum - Minimum) * static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+		};
+
+		TransformList Objects;
+		Objects.reserve(ObjectCount);
+
+		for (size_t Index = 0; Index < ObjectCount; ++Index)
+		{
+			Vector3 Position(NextRandom(-200.f, 200.f), NextRandom(-120.f, 120.f), NextRandom(-300.f, 40.f));
+			Quaternion Rotation(NextRandom(0.f, 360.f), NextRandom(0.f, 360.f), NextRandom(0.f, 360.f));
+			Objects.push_back(Transform(Position, Rotation, Vector3(NextRandom(2.f, 8.f))));
+		}
+
+		FrameCamera LeftEye(Vector3(-0.5f * EyeSeparation, 0.f, EyeDistance), FrameHeight);
+		FrameCamera RightEye(Vector3(0.5f * EyeSeparation, 0.f, EyeDistance), FrameHeight);
+		static_cast<Camera &>(LeftEye).UpdateCamera(OutputSize);
+		static_cast<Camera &>(RightEye).UpdateCamera(OutputSize);
+
+		TransformList LeftVisible;
+		TransformList RightVisible;
+		TransformList UnionVisible;
+
+		PerformanceCounter PerEyeTime(L"Per Eye Cull Time", L"ms", 0);
+		PerformanceCounter UnionTime(L"Union Cull Time", L"ms", 0);
+		PerformanceCounter VisibleObjects(L"Visible Objects", L"ratio", 0);
+		size_t MissedObjects = 0;
+		size_t ExtraObjects = 0;
+
+		// The visible lists keep the order of the objects, so they are walked along with them
+		auto IsNextVisible = [](const Transform & Object, const TransformList & Visible, size_t & Index)
+		{
+			if (Index >= Visible.size())
+			{
+				return false;
+			}
+
+			const Vector3 & Position = Visible[Index].GetPosition();
+			bool IsVisible = (Position.X == Object.GetPosition().X) && (Position.Y == Object.GetPosition().Y) && (Position.Z == Object.GetPosition().Z);
+			Index += IsVisible ? 1 : 0;
+			return IsVisible;
+		};
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (size_t Frame = 0; Frame < FrameCount; ++Frame)
+			{
+				float Sway = SwayDistance * std::sin(DirectX::XM_2PI * Frame / FrameCount);
+				static_cast<Camera &>(LeftEye).UpdateCamera(Vector3(Sway - 0.5f * EyeSeparation, 0.f, EyeDistance));
+				static_cast<Camera &>(RightEye).UpdateCamera(Vector3(Sway + 0.5f * EyeSeparation, 0.f, EyeDistance));
+				FrameCamera::Resolve({ &LeftEye, &RightEye });
+
+				PerEyeTime.Start();
+				ViewFrustum(LeftEye).Cull(CubeBounds, Objects, LeftVisible);
+				ViewFrustum(RightEye).Cull(CubeBounds, Objects, RightVisible);
+				PerEyeTime.Stop();
+
+				UnionTime.Start();
+				ViewFrustum::Union(ViewFrustum(LeftEye), ViewFrustum(RightEye)).Cull(CubeBounds, Objects, UnionVisible);
+				UnionTime.Stop();
+
+				if (Pass > 0)
+				{
+					continue;
+				}
+
+				VisibleObjects.AddSample(static_cast<double>(UnionVisible.size()) / static_cast<double>(Objects.size()));
+
+				size_t LeftIndex = 0;
+				size_t RightIndex = 0;
+				size_t UnionIndex = 0;
+
+				for (const Transform & Object : Objects)
+				{
+					bool IsVisibleToLeftEye = IsNextVisible(Object, LeftVisible, LeftIndex);
+					bool IsVisibleToRightEye = IsNextVisible(Object, RightVisible, RightIndex);
+					bool IsVisibleInUnion = IsNextVisible(Object, UnionVisible, UnionIndex);
+
+					MissedObjects += ((IsVisibleToLeftEye || IsVisibleToRightEye) && !IsVisibleInUnion) ? 1 : 0;
+					ExtraObjects += (!IsVisibleToLeftEye && !IsVisibleToRightEye && IsVisibleInUnion) ? 1 : 0;
+				}
+			}
+		}
+
+		Results.Add(L"Objects", static_cast<double>(Objects.size()), L"count");
+		Results.Add(PerEyeTime);
+		Results.Add(UnionTime);
+		Results.Add(L"Union Speedup", PerEyeTime.GetAverage() / UnionTime.GetAverage(), L"ratio");
+		Results.Add(L"Visible Objects", VisibleObjects.GetAverage(), L"ratio");
+		Results.Add(L"Missed Objects", static_cast<double>(MissedObjects), L"count");
+		Results.Add(L"Extra Objects", static_cast<double>(ExtraObjects), L"count");
+	}
+
+	static void RunSceneGraph(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// 10000 objects either in 100 groups of 100 or in 10 chains of 1000; each frame the whole scene, one branch and
+		// every hundredth object move
+		constexpr size_t FrameCount = 60;
+		constexpr size_t BranchCount = 100;
+		constexpr size_t ChainCount = 10;
+		constexpr size_t ChainLength = 1000;
+		constexpr size_t ScatteredStride = 100;
+		constexpr float Step = 0.1f;
+
+		PlaceholderMesh ObjectMesh;
+
+		// The parents are kept as indices into the nodes for the reference matrices
+		constexpr size_t NoParent = (std::numeric_limits<size_t>::max)();
+
+		struct Hierarchy
+		{
+			std::wstring Name;
+			SceneGraph Scene;
+			std::vector<SceneGraph::NodeHandle> Nodes;
+			std::vector<size_t> Parents;
+			SceneGraph::NodeHandle Branch;
+		};
+
+		std::array<Hierarchy, 2> Hierarchies;
+		Hierarchies[0].Name = L"Wide";
+		Hierarchies[1].Name = L"Deep";
+
+		PerformanceCounter WideBuildTime(L"Wide Build Time", L"ms", 0);
+		PerformanceCounter DeepBuildTime(L"Deep Build Time", L"ms", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (Hierarchy & Entry : Hierarchies)
+			{
+				Entry.Scene.Clear();
+				Entry.Nodes.clear();
+				Entry.Parents.clear();
+			}
+
+			// Both are added depth first
+			WideBuildTime.Start();
+			Hierarchy & Wide = Hierarchies[0];
+			Wide.Scene.Reserve(BranchCount * BranchCount + 1);
+
+			for (size_t Group = 0; Group < BranchCount; ++Group)
+			{
+				size_t GroupIndex = Wide.Nodes.size();
+				SceneGraph::NodeHandle GroupNode = Wide.Scene.AddNode(SceneGraph::Root, Transform(Vector3(10.f * Group, 0.f, -100.f), Quaternion(0.f, 3.6f * Group, 0.f)), &ObjectMesh);
+				Wide.Nodes.push_back(GroupNode);
+				Wide.Parents.push_back(NoParent);
+
+				for (size_t Leaf = 1; Leaf < BranchCount; ++Leaf)
+				{
+					Wide.Nodes.push_back(Wide.Scene.AddNode(GroupNode, Transform(Vector3(0.f, 2.f * Leaf, 0.f), Quaternion(), Vector3(0.5f)), &ObjectMesh));
+					Wide.Parents.push_back(GroupIndex);
+				}
+			}
+
+			Wide.Scene.Update();
+			WideBuildTime.Stop();
+
+			DeepBuildTime.Start();
+			Hierarchy & Deep = Hierarchies[1];
+			Deep.Scene.Reserve(ChainCount * ChainLength + 1);
+
+			for (size_t Chain = 0; Chain < ChainCount; ++Chain)
+			{
+				SceneGraph::NodeHandle Parent = SceneGraph::Root;
+
+				for (size_t Link = 0; Link < ChainLength; ++Link)
+				{
+					Vector3 Position = (Link == 0) ? Vector3(10.f * Chain, 0.f, -100.f) : Vector3(0.f, 0.1f, 0.f);
+					Deep.Parents.push_back((Link == 0) ? NoParent : Deep.Nodes.size() - 1);
+
+					Parent = Deep.Scene.AddNode(Parent, Transform(Position, Quaternion(0.f, 0.f, 0.1f)), &ObjectMesh);
+					Deep.Nodes.push_back(Parent);
+				}
+			}
+
+			Deep.Scene.Update();
+			DeepBuildTime.Stop();
+		}
+
+		// A group of the wide hierarchy and the middle of a chain of the deep one
+		Hierarchies[0].Branch = Hierarchies[0].Nodes[BranchCount * BranchCount / 2];
+		Hierarchies[1].Branch = Hierarchies[1].Nodes[ChainLength / 2];
+
+		Results.Add(L"Objects", static_cast<double>(Hierarchies[0].Nodes.size()), L"count");
+		Results.Add(WideBuildTime);
+		Results.Add(DeepBuildTime);
+
+		for (Hierarchy & Entry : Hierarchies)
+		{
+			SceneGraph & Scene = Entry.Scene;
+			const std::wstring Prefix = Entry.Name + L" ";
+
+			PerformanceCounter FullTime(Prefix + L"Full Update Time", L"ms", 0);
+			PerformanceCounter BranchTime(Prefix + L"Branch Update Time", L"ms", 0);
+			PerformanceCounter ScatteredTime(Prefix + L"Scattered Update Time", L"ms", 0);
+			size_t BranchNodes = 0;
+			size_t ScatteredNodes = 0;
+
+			const Transform RootTransform = Scene.GetLocalTransform(SceneGraph::Root);
+			const Transform BranchTransform = Scene.GetLocalTransform(Entry.Branch);
+
+			for (unsigned Pass = 0; Pass < Passes; ++Pass)
+			{
+				for (size_t Frame = 0; Frame < FrameCount; ++Frame)
+				{
+					float Offset = (Frame & 1) ? Step : -Step;
+
+					Scene.SetLocalPosition(SceneGraph::Root, Vector3(RootTransform.GetPosition().X + Offset, RootTransform.GetPosition().Y, RootTransform.GetPosition().Z));
+					FullTime.Start();
+					Scene.Update();
+					FullTime.Stop();
+
+					Scene.SetLocalPosition(Entry.Branch, Vector3(BranchTransform.GetPosition().X + Offset, BranchTransform.GetPosition().Y, BranchTransform.GetPosition().Z));
+					BranchTime.Start();
+					BranchNodes = Scene.Update();
+					BranchTime.Stop();
+
+					for (size_t Index = ScatteredStride - 1; Index < Entry.Nodes.size(); Index += ScatteredStride)
+					{
+						const Vector3 Position = Scene.GetLocalTransform(Entry.Nodes[Index]).GetPosition();
+						Scene.SetLocalPosition(Entry.Nodes[Index], Vector3(Position.X, Position.Y + Offset, Position.Z));
+					}
+
+					ScatteredTime.Start();
+					ScatteredNodes = Scene.Update();
+					ScatteredTime.Stop();
+				}
+			}
+
+			// The world matrices against composing each object's local matrices up to the root
+			auto GetLocal = [&](SceneGraph::NodeHandle Node) { return DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&Scene.GetLocalTransform(Node).GetMatrix())); };
+			float MatrixError = 0.f;
+
+			for (size_t Index = 0; Index < Entry.Nodes.size(); Index += ScatteredStride / 10)
+			{
+				DirectX::XMMATRIX Reference = GetLocal(Entry.Nodes[Index]);
+
+				for (size_t Ancestor = Entry.Parents[Index]; Ancestor != NoParent; Ancestor = Entry.Parents[Ancestor])
+				{
+					Reference = Reference * GetLocal(Entry.Nodes[Ancestor]);
+				}
+
+				DirectX::XMFLOAT4X4 Expected;
+				DirectX::XMStoreFloat4x4(&Expected, DirectX::XMMatrixTranspose(Reference * GetLocal(SceneGraph::Root)));
+				const DirectX::XMFLOAT4X4 & World = Scene.GetWorldMatrix(Entry.Nodes[Index]);
+
+				for (unsigned Row = 0; Row < 4; ++Row)
+					for (unsigned Column = 0; Column < 4; ++Column)
+					{
+						MatrixError = (std::max)(MatrixError, std::abs(World.m[Row][Column] - Expected.m[Row][Column]));
+					}
+			}
+
+			Results.Add(FullTime);
+			Results.Add(BranchTime);
+			Results.Add(ScatteredTime);
+			Results.Add(Prefix + L"Branch Updated Objects", static_cast<double>(BranchNodes), L"count");
+			Results.Add(Prefix + L"Scattered Updated Objects", static_cast<double>(ScatteredNodes), L"count");
+			Results.Add(Prefix + L"Draw Lists", static_cast<double>(Scene.GetDrawCalls().size()), L"count");
+			Results.Add(Prefix + L"Matrix Error", MatrixError, L"absolute");
+		}
+	}
+
+	static void RunBoundingVolumeHierarchy(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// 10000 decorations scattered around the mirror; each frame every hundredth or every object sways a little, then
+		// the view through the frame, spheres around random points and rays through the frame are queried with the tree
+		// and by testing every object
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr float FrameHeight = 30.f;
+		constexpr float EyeDistance = 60.f;
+		constexpr size_t ObjectCount = 10000;
+		constexpr size_t FrameCount = 60;
+		constexpr size_t MovedStride = 100;
+		constexpr size_t QueryCount = 100;
+		constexpr float SphereRadius = 20.f;
+		constexpr float Step = 0.5f;
+		const Mesh::Bounds CubeBounds = { { -0.5f, -0.5f, -0.5f },{ 0.5f, 0.5f, 0.5f } };
+
+		UINT32 RandomState = 0x12345678;
+
+		auto NextRandom = [&RandomState](float Minimum, float Maximum)
+		{
+			RandomState = RandomState * 1664525u + 1013904223u;
+			return Minimum + (Maximum - Minimum) * static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+		};
+
+		TransformList Objects;
+		Objects.reserve(ObjectCount);
+
+		for (size_t Index = 0; Index < ObjectCount; ++Index)
+		{
+			Vector3 Position(NextRandom(-400.f, 400.f), NextRandom(-240.f, 240.f), NextRandom(-600.f, 40.f));
+			Quaternion Rotation(NextRandom(0.f, 360.f), NextRandom(0.f, 360.f), NextRandom(0.f, 360.f));
+			Objects.push_back(Transform(Position, Rotation, Vector3(NextRandom(2.f, 8.f))));
+		}
+
+		std::vector<Mesh::Bounds> WorldBounds(ObjectCount);
+
+		for (size_t Index = 0; Index < ObjectCount; ++Index)
+		{
+			WorldBounds[Index] = BoundingVolumeHierarchy::GetWorldBounds(CubeBounds, Objects[Index]);
+		}
+
+		FrameCamera Eye(Vector3(0.f, 0.f, EyeDistance), FrameHeight);
+		static_cast<Camera &>(Eye).UpdateCamera(OutputSize);
+		Eye.Resolve();
+		const ViewFrustum Frustum(Eye);
+
+		BoundingVolumeHierarchy Hierarchy;
+		PerformanceCounter BuildTime(L"Build Time", L"ms", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			BuildTime.Start();
+			Hierarchy.Build(WorldBounds);
+			BuildTime.Stop();
+		}
+
+		Results.Add(L"Objects", static_cast<double>(ObjectCount), L"count");
+		Results.Add(L"Nodes", static_cast<double>(Hierarchy.GetNodeCount()), L"count");
+		Results.Add(L"Depth", static_cast<double>(Hierarchy.GetDepth()), L"count");
+		Results.Add(BuildTime);
+
+		// The reference queries test every object
+		auto QuerySphereLinear = [&WorldBounds](const Vector3 & Center, float Radius, BoundingVolumeHierarchy::ObjectIndexList & Found)
+		{
+			Found.clear();
+
+			for (size_t Index = 0; Index < WorldBounds.size(); ++Index)
+			{
+				const Mesh::Bounds & Box = WorldBounds[Index];
+				float X = (std::max)((std::max)(Box.Minimum.x - Center.X, Center.X - Box.Maximum.x), 0.f);
+				float Y = (std::max)((std::max)(Box.Minimum.y - Center.Y, Center.Y - Box.Maximum.y), 0.f);
+				float Z = (std::max)((std::max)(Box.Minimum.z - Center.Z, Center.Z - Box.Maximum.z), 0.f);
+
+				if (X * X + Y * Y + Z * Z <= Radius * Radius)
+				{
+					Found.push_back(Index);
+				}
+			}
+		};
+
+		auto IntersectRayLinear = [&WorldBounds](const Vector3 & Origin, const Vector3 & Direction, float & Nearest)
+		{
+			const float Start[3] = { Origin.X, Origin.Y, Origin.Z };
+			const float Inverse[3] = { 1.f / Direction.X, 1.f / Direction.Y, 1.f / Direction.Z };
+			bool IsHit = false;
+
+			for (const Mesh::Bounds & Box : WorldBounds)
+			{
+				const float Minimum[3] = { Box.Minimum.x, Box.Minimum.y, Box.Minimum.z };
+				const float Maximum[3] = { Box.Maximum.x, Box.Maximum.y, Box.Maximum.z };
+				float Enter = 0.f;
+				float Exit = Nearest;
+
+				for (unsigned Axis = 0; Axis < 3; ++Axis)
+				{
+					float Near = (Minimum[Axis] - Start[Axis]) * Inverse[Axis];
+					float Far = (Maximum[Axis] - Start[Axis]) * Inverse[Axis];
+					Enter = (std::max)(Enter, (std::min)(Near, Far));
+					Exit = (std::min)(Exit, (std::max)(Near, Far));
+				}
+
+				if (Enter <= Exit)
+				{
+					Nearest = Enter;
+					IsHit = true;
+				}
+			}
+
+			return IsHit;
+		};
+
+		auto MoveObject = [&](size_t Index, float Offset)
+		{
+			Vector3 Position = Objects[Index].GetPosition();
+			Objects[Index].UpdatePosition(Vector3(Position.X + Offset, Position.Y, Position.Z - Offset));
+			WorldBounds[Index] = BoundingVolumeHierarchy::GetWorldBounds(CubeBounds, Objects[Index]);
+			Hierarchy.UpdateObject(Index, WorldBounds[Index]);
+		};
+
+		PerformanceCounter RefitTime(L"Refit Time (1% Moved)", L"ms", 0);
+		PerformanceCounter FullRefitTime(L"Refit Time (All Moved)", L"ms", 0);
+		PerformanceCounter RefitNodes(L"Refit Nodes (1% Moved)", L"count", 0);
+		PerformanceCounter FrustumTime(L"Frustum Query Time", L"ms", 0);
+		PerformanceCounter LinearFrustumTime(L"Linear Frustum Query Time", L"ms", 0);
+		PerformanceCounter SphereTime(L"Sphere Query Time", L"ms", 0);
+		PerformanceCounter LinearSphereTime(L"Linear Sphere Query Time", L"ms", 0);
+		PerformanceCounter RayTime(L"Ray Query Time", L"ms", 0);
+		PerformanceCounter LinearRayTime(L"Linear Ray Query Time", L"ms", 0);
+		PerformanceCounter VisibleObjects(L"Visible Objects", L"ratio", 0);
+		size_t Mismatches = 0;
+
+		BoundingVolumeHierarchy::ObjectIndexList Found;
+		BoundingVolumeHierarchy::ObjectIndexList LinearFound;
+		std::vector<Vector3> SphereCenters(QueryCount);
+		std::vector<Vector3> RayDirections(QueryCount);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			for (size_t Frame = 0; Frame < FrameCount; ++Frame)
+			{
+				float Offset = (Frame & 1) ? Step : -Step;
+
+				for (size_t Index = Frame % MovedStride; Index < ObjectCount; Index += MovedStride)
+				{
+					MoveObject(Index, Offset);
+				}
+
+				RefitTime.Start();
+				RefitNodes.AddSample(static_cast<double>(Hierarchy.Refit()));
+				RefitTime.Stop();
+
+				// Sways everything back and forth, so the tree does not degrade over the passes
+				if (Frame % 10 == 0)
+				{
+					for (size_t Index = 0; Index < ObjectCount; ++Index)
+					{
+						MoveObject(Index, (Frame & 2) ? Step : -Step);
+					}
+
+					FullRefitTime.Start();
+					Hierarchy.Refit();
+					FullRefitTime.Stop();
+				}
+
+				FrustumTime.Start();
+				Hierarchy.QueryFrustum(Frustum, Found);
+				FrustumTime.Stop();
+
+				LinearFrustumTime.Start();
+				LinearFound.clear();
+
+				for (size_t Index = 0; Index < ObjectCount; ++Index)
+				{
+					if (Frustum.Classify(WorldBounds[Index]) != ViewFrustum::Containment_Outside)
+					{
+						LinearFound.push_back(Index);
+					}
+				}
+
+				LinearFrustumTime.Stop();
+
+				VisibleObjects.AddSample(static_cast<double>(Found.size()) / static_cast<double>(ObjectCount));
+				std::sort(Found.begin(), Found.end());
+				Mismatches += (Found != LinearFound) ? 1 : 0;
+
+				for (size_t Query = 0; Query < QueryCount; ++Query)
+				{
+					SphereCenters[Query] = Vector3(NextRandom(-400.f, 400.f), NextRandom(-240.f, 240.f), NextRandom(-600.f, 40.f));
+					RayDirections[Query] = Vector3(NextRandom(-0.5f, 0.5f), NextRandom(-0.3f, 0.3f), -1.f);
+				}
+
+				for (size_t Query = 0; Query < QueryCount; ++Query)
+				{
+					SphereTime.Start();
+					Hierarchy.QuerySphere(SphereCenters[Query], SphereRadius, Found);
+					SphereTime.Stop();
+
+					LinearSphereTime.Start();
+					QuerySphereLinear(SphereCenters[Query], SphereRadius, LinearFound);
+					LinearSphereTime.Stop();
+
+					std::sort(Found.begin(), Found.end());
+					Mismatches += (Found != LinearFound) ? 1 : 0;
+				}
+
+				for (size_t Query = 0; Query < QueryCount; ++Query)
+				{
+					const Vector3 Origin(0.f, 0.f, EyeDistance);
+					size_t Object = 0;
+					float Distance = 0.f;
+					float LinearDistance = (std::numeric_limits<float>::max)();
+
+					RayTime.Start();
+					bool IsHit = Hierarchy.IntersectRay(Origin, RayDirections[Query], LinearDistance, Object, Distance);
+					RayTime.Stop();
+
+					LinearRayTime.Start();
+					bool IsLinearHit = IntersectRayLinear(Origin, RayDirections[Query], LinearDistance);
+					LinearRayTime.Stop();
+
+					Mismatches += ((IsHit != IsLinearHit) || (IsHit && Distance != LinearDistance)) ? 1 : 0;
+				}
+			}
+		}
+
+		Results.Add(RefitTime);
+		Results.Add(FullRefitTime);
+		Results.Add(RefitNodes);
+		Results.Add(FrustumTime);
+		Results.Add(LinearFrustumTime);
+		Results.Add(SphereTime);
+		Results.Add(LinearSphereTime);
+		Results.Add(RayTime);
+		Results.Add(LinearRayTime);
+		Results.Add(L"Frustum Query Speedup", LinearFrustumTime.GetAverage() / FrustumTime.GetAverage(), L"ratio");
+		Results.Add(L"Sphere Query Speedup", LinearSphereTime.GetAverage() / SphereTime.GetAverage(), L"ratio");
+		Results.Add(L"Ray Query Speedup", LinearRayTime.GetAverage() / RayTime.GetAverage(), L"ratio");
+		Results.Add(L"Visible Objects", VisibleObjects.GetAverage(), L"ratio");
+		Results.Add(L"Query Mismatches", static_cast<double>(Mismatches), L"count");
+	}
+
+	static void RunStereoFrameCamera(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// Eyes of a head moving in front of the mirror, resolved once per position by the stereo rig, by resolving two
+		// frame cameras together and by resolving each camera alone like the late latching does
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr float FrameHeight = 30.f;
+		constexpr float EyeSeparation = 6.4f;
+		constexpr size_t PositionCount = 10000;
+
+		UINT32 RandomState = 0x12345678;
+
+		auto NextRandom = [&RandomState](float Minimum, float Maximum)
+		{
+			RandomState = RandomState * 1664525u + 1013904223u;
+			return Minimum + (Maximum - Minimum) * static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+		};
+
+		std::vector<Vector3> HeadPositions(PositionCount);
+
+		for (Vector3 & Position : HeadPositions)
+		{
+			Position = Vector3(NextRandom(-50.f, 50.f), NextRandom(-30.f, 30.f), NextRandom(20.f, 200.f));
+		}
+
+		StereoFrameCamera Rig(Vector3(0.f, 0.f, 50.f), FrameHeight);
+		std::array<FrameCamera, StereoFrameCamera::Eye_Count> BatchedEyes = { { FrameCamera(Vector3(0.f, 0.f, 50.f), FrameHeight), FrameCamera(Vector3(0.f, 0.f, 50.f), FrameHeight) } };
+		std::array<FrameCamera, StereoFrameCamera::Eye_Count> SingleEyes = BatchedEyes;
+
+		auto ForEachEye = [&](auto Function)
+		{
+			for (unsigned Eye = 0; Eye < StereoFrameCamera::Eye_Count; ++Eye)
+			{
+				Function(Eye, static_cast<Camera &>(Rig.GetEye(static_cast<StereoFrameCamera::Eye>(Eye))), static_cast<Camera &>(BatchedEyes[Eye]), static_cast<Camera &>(SingleEyes[Eye]));
+			}
+		};
+
+		ForEachEye([&](unsigned, Camera & RigEye, Camera & BatchedEye, Camera & SingleEye)
+		{
+			RigEye.UpdateCamera(OutputSize);
+			BatchedEye.UpdateCamera(OutputSize);
+			SingleEye.UpdateCamera(OutputSize);
+		});
+
+		// The largest difference of the matrices to the rig, in units in the last place
+		auto GetUlpDistance = [](const DirectX::XMFLOAT4X4 & A, const DirectX::XMFLOAT4X4 & B)
+		{
+			double Distance = 0.0;
+
+			for (unsigned Row = 0; Row < 4; ++Row)
+				for (unsigned Column = 0; Column < 4; ++Column)
+				{
+					INT32 BitsA;
+					INT32 BitsB;
+					std::memcpy(&BitsA, &A.m[Row][Column], sizeof(BitsA));
+					std::memcpy(&BitsB, &B.m[Row][Column], sizeof(BitsB));
+
+					INT64 OrderedA = (BitsA < 0) ? INT64((std::numeric_limits<INT32>::min)()) - BitsA : BitsA;
+					INT64 OrderedB = (BitsB < 0) ? INT64((std::numeric_limits<INT32>::min)()) - BitsB : BitsB;
+					Distance = (std::max)(Distance, static_cast<double>(std::abs(OrderedA - OrderedB)));
+				}
+
+			return Distance;
+		};
+
+		// Each eye is moved before every resolve, so all of them recalculate both eyes
+		auto MoveEyes = [&](const Vector3 & Head, Camera & LeftEye, Camera & RightEye)
+		{
+			LeftEye.UpdateCamera(Vector3(Head.X - 0.5f * EyeSeparation, Head.Y, Head.Z));
+			RightEye.UpdateCamera(Vector3(Head.X + 0.5f * EyeSeparation, Head.Y, Head.Z));
+		};
+
+		PerformanceCounter RigTime(L"Rig Resolve Time", L"ms", 0);
+		PerformanceCounter BatchedTime(L"Batched Resolve Time", L"ms", 0);
+		PerformanceCounter SingleTime(L"Single Resolve Time", L"ms", 0);
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			RigTime.Start();
+
+			for (const Vector3 & Head : HeadPositions)
+			{
+				MoveEyes(Head, Rig.GetEye(StereoFrameCamera::Eye_Left), Rig.GetEye(StereoFrameCamera::Eye_Right));
+				Rig.Resolve();
+			}
+
+			RigTime.Stop();
+			BatchedTime.Start();
+
+			for (const Vector3 & Head : HeadPositions)
+			{
+				MoveEyes(Head, BatchedEyes[StereoFrameCamera::Eye_Left], BatchedEyes[StereoFrameCamera::Eye_Right]);
+				FrameCamera::Resolve({ &BatchedEyes[StereoFrameCamera::Eye_Left], &BatchedEyes[StereoFrameCamera::Eye_Right] });
+			}
+
+			BatchedTime.Stop();
+			SingleTime.Start();
+
+			for (const Vector3 & Head : HeadPositions)
+			{
+				MoveEyes(Head, SingleEyes[StereoFrameCamera::Eye_Left], SingleEyes[StereoFrameCamera::Eye_Right]);
+				SingleEyes[StereoFrameCamera::Eye_Left].Resolve();
+				SingleEyes[StereoFrameCamera::Eye_Right].Resolve();
+			}
+
+			SingleTime.Stop();
+		}
+
+		double BatchedDistance = 0.0;
+		double SingleDistance = 0.0;
+		double ConstantsDistance = 0.0;
+		StereoFrameCamera::StereoConstants Constants;
+
+		// The matrices of every position, the rig against the other two and the packed constants against the rig
+		for (const Vector3 & Head : HeadPositions)
+		{
+			MoveEyes(Head, Rig.GetEye(StereoFrameCamera::Eye_Left), Rig.GetEye(StereoFrameCamera::Eye_Right));
+			MoveEyes(Head, BatchedEyes[StereoFrameCamera::Eye_Left], BatchedEyes[StereoFrameCamera::Eye_Right]);
+			MoveEyes(Head, SingleEyes[StereoFrameCamera::Eye_Left], SingleEyes[StereoFrameCamera::Eye_Right]);
+
+			Rig.Resolve();
+			FrameCamera::Resolve({ &BatchedEyes[StereoFrameCamera::Eye_Left], &BatchedEyes[StereoFrameCamera::Eye_Right] });
+			SingleEyes[StereoFrameCamera::Eye_Left].Resolve();
+			SingleEyes[StereoFrameCamera::Eye_Right].Resolve();
+			Rig.GetConstants(Constants);
+
+			ForEachEye([&](unsigned Eye, Camera & RigEye, Camera & BatchedEye, Camera & SingleEye)
+			{
+				BatchedDistance = (std::max)(BatchedDistance, GetUlpDistance(RigEye.GetViewMatrix(), BatchedEye.GetViewMatrix()));
+				BatchedDistance = (std::max)(BatchedDistance, GetUlpDistance(RigEye.GetProjectionMatrix(), BatchedEye.GetProjectionMatrix()));
+				SingleDistance = (std::max)(SingleDistance, GetUlpDistance(RigEye.GetViewMatrix(), SingleEye.GetViewMatrix()));
+				SingleDistance = (std::max)(SingleDistance, GetUlpDistance(RigEye.GetProjectionMatrix(), SingleEye.GetProjectionMatrix()));
+				ConstantsDistance = (std::max)(ConstantsDistance, GetUlpDistance(Constants.View[Eye], RigEye.GetViewMatrix()));
+				ConstantsDistance = (std::max)(ConstantsDistance, GetUlpDistance(Constants.Projection[Eye], RigEye.GetProjectionMatrix()));
+			});
+		}
+
+		Results.Add(RigTime);
+		Results.Add(BatchedTime);
+		Results.Add(SingleTime);
+		Results.Add(L"Rig Speedup Over Batched", BatchedTime.GetAverage() / RigTime.GetAverage(), L"ratio");
+		Results.Add(L"Rig Speedup Over Single", SingleTime.GetAverage() / RigTime.GetAverage(), L"ratio");
+		Results.Add(L"Batched Difference", BatchedDistance, L"ulp");
+		Results.Add(L"Single Difference", SingleDistance, L"ulp");
+		Results.Add(L"Constants Difference", ConstantsDistance, L"ulp");
+		Results.Add(L"Constants Size", static_cast<double>(sizeof(StereoFrameCamera::StereoConstants)), L"bytes");
+	}
+
+	static void RunInstancing(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// The cubes of the mirror scene, 1000 decorations around them and the depth plane drawn in row ranges, each
+		// drawn with the object constants per object and instanced from one upload
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr float FrameHeight = 30.f;
+		constexpr float HalfHeight = FrameHeight / 2.f;
+		constexpr float ElementsDistance = -180.f;
+		constexpr float ElementsLength = 50.f;
+		constexpr size_t DecorationCount = 1000;
+		constexpr unsigned PlaneWidth = 64;
+		constexpr unsigned PlaneHeight = 48;
+		constexpr UINT PlaneRowIndices = 6 * (PlaneWidth - 1);
+		constexpr size_t PlaneDrawRanges = 3;
+
+		UINT32 RandomState = 0x12345678;
+
+		auto NextRandom = [&RandomState](float Minimum, float Maximum)
+		{
+			RandomState = RandomState * 1664525u + 1013904223u;
+			return Minimum + (Maximum - Minimum) * static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+		};
+
+		Reference::Mesh CubeMesh;
+		Reference::Mesh DecorationMesh;
+		Reference::Mesh PlaneMesh;
+		CubeMesh.CreateCube();
+		DecorationMesh.CreateCube();
+		PlaneMesh.CreatePlane(PlaneWidth, PlaneHeight);
+
+		Mesh::VertexList PlaneVertices(PlaneWidth * PlaneHeight);
+		for (size_t Index = 0; Index < PlaneVertices.size(); ++Index)
+		{
+			PlaneVertices[Index].Position = DirectX::XMFLOAT3(static_cast<float>(Index % PlaneWidth) - 32.f, static_cast<float>(Index / PlaneWidth) - 24.f, NextRandom(-120.f, -80.f));
+		}
+		PlaneMesh.UpdateVertices(PlaneVertices);
+		PlaneMesh.SetDrawRanges({ { 8 * PlaneRowIndices, 10 * PlaneRowIndices }, { 20 * PlaneRowIndices, 12 * PlaneRowIndices }, { 36 * PlaneRowIndices, 4 * PlaneRowIndices } });
+
+		TransformList Cubes;
+		for (float Y : { -HalfHeight, HalfHeight })
+			for (float X : { -HalfHeight, HalfHeight })
+			{
+				Cubes.push_back(Transform(Vector3(X, Y, ElementsDistance - ElementsLength), Quaternion(90.f, 90.f, 0.f), Vector3(2.f)));
+				Cubes.push_back(Transform(Vector3(X, Y, ElementsDistance + ElementsLength), Quaternion(0.f, 90.f, 0.f), Vector3(2.f)));
+				Cubes.push_back(Transform(Vector3(X, Y, ElementsDistance), Quaternion(), Vector3(1.0f, 1.0f, (2 * ElementsLength) - 2.0f)));
+			}
+		Cubes.push_back(Transform(Vector3(30.f, 0.0f, ElementsDistance), Quaternion(), Vector3(7.5f)));
+		Cubes.push_back(Transform(Vector3(-30.f, 0.0f, ElementsDistance), Quaternion(0.f, -45.f, 0.f), Vector3(5.0f)));
+		Cubes.push_back(Transform(Vector3(0.f, -10.0f, -100.0f), Quaternion(0.f, -45.f, 180.f), Vector3(5.0f)));
+
+		TransformList Decorations(DecorationCount);
+		for (Transform & Decoration : Decorations)
+		{
+			Decoration = Transform(Vector3(NextRandom(-100.f, 100.f), NextRandom(-60.f, 60.f), NextRandom(-300.f, -60.f)), Quaternion(NextRandom(0.f, 360.f), NextRandom(0.f, 360.f), 0.f), Vector3(NextRandom(0.5f, 3.f)));
+		}
+
+		const TransformList Plane = { Transform() };
+		const std::array<std::pair<const Reference::Mesh *, const TransformList *>, 3> DrawCalls = { { { &CubeMesh, &Cubes }, { &DecorationMesh, &Decorations }, { &PlaneMesh, &Plane } } };
+
+		FrameCamera View(Vector3(0.f, 0.f, 50.f), FrameHeight);
+		static_cast<Camera &>(View).UpdateCamera(OutputSize);
+		View.Resolve();
+
+		Reference::RenderingContext PerObjectContext;
+		Reference::RenderingContext InstancedContext;
+		InstanceBuffer Instances;
+		InstanceBuffer::RangeList InstanceRanges;
+		Instances.Reserve(Cubes.size() + Decorations.size() + Plane.size());
+
+		PerformanceCounter PackTime(L"Pack Time", L"ms", 0);
+		size_t Mismatches = 0;
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			PerObjectContext.Reset();
+			PerObjectContext.Prepare(View);
+
+			for (const auto & DrawCall : DrawCalls)
+			{
+				DrawCall.first->Render(PerObjectContext, *DrawCall.second);
+			}
+
+			PackTime.Start();
+			Instances.Clear();
+			InstanceRanges.clear();
+
+			for (const auto & DrawCall : DrawCalls)
+			{
+				InstanceRanges.push_back(Instances.Append(*DrawCall.second));
+			}
+
+			PackTime.Stop();
+
+			InstancedContext.Reset();
+			InstancedContext.Prepare(View);
+			InstancedContext.UploadInstances(Instances);
+
+			for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+			{
+				DrawCalls[Index].first->Render(InstancedContext, InstanceRanges[Index]);
+			}
+
+			// The plane is a single object, so both paths draw the vertices in the same order
+			const std::vector<DirectX::XMFLOAT4> & PerObjectPositions = PerObjectContext.GetPositions();
+			const std::vector<DirectX::XMFLOAT4> & InstancedPositions = InstancedContext.GetPositions();
+			Mismatches += (std::max)(PerObjectPositions.size(), InstancedPositions.size()) - (std::min)(PerObjectPositions.size(), InstancedPositions.size());
+
+			for (size_t Index = 0; Index < (std::min)(PerObjectPositions.size(), InstancedPositions.size()); ++Index)
+			{
+				Mismatches += (std::memcmp(&PerObjectPositions[Index], &InstancedPositions[Index], sizeof(DirectX::XMFLOAT4)) != 0) ? 1 : 0;
+			}
+		}
+
+		const Reference::RenderingContext::Statistics & PerObject = PerObjectContext.GetStatistics();
+		const Reference::RenderingContext::Statistics & Instanced = InstancedContext.GetStatistics();
+
+		Results.Add(L"Objects", static_cast<double>(Instances.GetCount()), L"count");
+		Results.Add(L"Vertices", static_cast<double>(Instanced.VertexCount), L"count");
+		Results.Add(L"Per Object Draws", static_cast<double>(PerObject.DrawCount), L"count");
+		Results.Add(L"Instanced Draws", static_cast<double>(Instanced.DrawCount), L"count");
+		Results.Add(L"Per Object Uploads", static_cast<double>(PerObject.UploadCount), L"count");
+		Results.Add(L"Instanced Uploads", static_cast<double>(Instanced.UploadCount), L"count");
+		Results.Add(L"Per Object Uploaded Size", static_cast<double>(PerObject.UploadedBytes), L"bytes");
+		Results.Add(L"Instanced Uploaded Size", static_cast<double>(Instanced.UploadedBytes), L"bytes");
+		Results.Add(L"Draw Reduction", static_cast<double>(PerObject.DrawCount) / static_cast<double>(Instanced.DrawCount), L"ratio");
+		Results.Add(PackTime);
+		Results.Add(L"Position Mismatches", static_cast<double>(Mismatches), L"count");
+
+		// The cubes are drawn whole and the plane in its draw ranges; per object every object is drawn and uploaded on its
+		// own, instanced each range is drawn once for all objects of its mesh from one upload
+		const size_t ObjectCount = Cubes.size() + Decorations.size() + Plane.size();
+		Results.Check(L"Same Positions", (Mismatches == 0) && (Instanced.VertexCount > 0));
+		Results.Check(L"Expected Draws", (PerObject.DrawCount == Cubes.size() + Decorations.size() + PlaneDrawRanges) && (Instanced.DrawCount == 2 + PlaneDrawRanges));
+		Results.Check(L"Expected Uploads", (PerObject.UploadCount == 1 + ObjectCount) && (Instanced.UploadCount == 2) && (Instanced.UploadedBytes == 2 * sizeof(DirectX::XMFLOAT4X4) + ObjectCount * sizeof(DirectX::XMFLOAT4X4)));
+	}
+
+	static void RunSinglePassStereo(_In_ const ArgumentList & Arguments, _Inout_ Results & Results)
+	{
+		UNREFERENCED_PARAMETER(Arguments);
+
+		// The decorations and the depth plane of the instancing benchmark drawn for both eyes of a rig, once per eye into
+		// its slice and once with every instance expanded to both eyes
+		const Window::WindowSize OutputSize(1920, 1080);
+		constexpr float FrameHeight = 30.f;
+		constexpr float EyeSeparation = 6.4f;
+		constexpr size_t DecorationCount = 1000;
+		constexpr unsigned PlaneWidth = 64;
+		constexpr unsigned PlaneHeight = 48;
+		constexpr UINT PlaneRowIndices = 6 * (PlaneWidth - 1);
+		constexpr size_t PlaneDrawRanges = 3;
+
+		UINT32 RandomState = 0x12345678;
+
+		auto NextRandom = [&RandomState](float Minimum, float Maximum)
+		{
+			RandomState = RandomState * 1664525u + 1013904223u;
+			return Minimum + (Maximum - Minimum) * static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+		};
+
+		Reference::Mesh CubeMesh;
+		Reference::Mesh PlaneMesh;
+		CubeMesh.CreateCube();
+		PlaneMesh.CreatePlane(PlaneWidth, PlaneHeight);
+
+		Mesh::VertexList PlaneVertices(PlaneWidth * PlaneHeight);
+		for (size_t Index = 0; Index < PlaneVertices.size(); ++Index)
+		{
+			PlaneVertices[Index].Position = DirectX::XMFLOAT3(static_cast<float>(Index % PlaneWidth) - 32.f, static_cast<float>(Index / PlaneWidth) - 24.f, NextRandom(-120.f, -80.f));
+		}
+		PlaneMesh.UpdateVertices(PlaneVertices);
+		PlaneMesh.SetDrawRanges({ { 8 * PlaneRowIndices, 10 * PlaneRowIndices }, { 20 * PlaneRowIndices, 12 * PlaneRowIndices }, { 36 * PlaneRowIndices, 4 * PlaneRowIndices } });
+
+		TransformList Decorations(DecorationCount);
+		for (Transform & Decoration : Decorations)
+		{
+			Decoration = Transform(Vector3(NextRandom(-100.f, 100.f), NextRandom(-60.f, 60.f), NextRandom(-300.f, -60.f)), Quaternion(NextRandom(0.f, 360.f), NextRandom(0.f, 360.f), 0.f), Vector3(NextRandom(0.5f, 3.f)));
+		}
+
+		const TransformList Plane = { Transform() };
+		const std::array<std::pair<const Reference::Mesh *, const TransformList *>, 2> DrawCalls = { { { &CubeMesh, &Decorations }, { &PlaneMesh, &Plane } } };
+
+		StereoFrameCamera Rig(Vector3(0.f, 0.f, 50.f), FrameHeight);
+		Camera & LeftEye = Rig.GetEye(StereoFrameCamera::Eye_Left);
+		Camera & RightEye = Rig.GetEye(StereoFrameCamera::Eye_Right);
+		LeftEye.UpdateCamera(OutputSize);
+		RightEye.UpdateCamera(OutputSize);
+		LeftEye.UpdateCamera(Vector3(-0.5f * EyeSeparation, 0.f, 50.f));
+		RightEye.UpdateCamera(Vector3(0.5f * EyeSeparation, 0.f, 50.f));
+		Rig.Resolve();
+
+		Reference::RenderingContext TwoPassContext;
+		Reference::RenderingContext SinglePassContext;
+		InstanceBuffer Instances;
+		InstanceBuffer::RangeList InstanceRanges;
+		Instances.Reserve(Decorations.size() + Plane.size());
+
+		for (const auto & DrawCall : DrawCalls)
+		{
+			InstanceRanges.push_back(Instances.Append(*DrawCall.second));
+		}
+
+		size_t TwoPassDraws = 0;
+		size_t SinglePassDraws = 0;
+		size_t Mismatches = 0;
+
+		for (unsigned Pass = 0; Pass < Passes; ++Pass)
+		{
+			// Like RenderEye, the instances are uploaded with the first eye and drawn again for the second
+			TwoPassContext.Reset();
+			TwoPassContext.Prepare(LeftEye, StereoFrameCamera::Eye_Left);
+			TwoPassContext.UploadInstances(Instances);
+
+			for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+			{
+				TwoPassDraws += DrawCalls[Index].first->Render(TwoPassContext, InstanceRanges[Index]);
+			}
+
+			TwoPassContext.Prepare(RightEye, StereoFrameCamera::Eye_Right);
+
+			for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+			{
+				TwoPassDraws += DrawCalls[Index].first->Render(TwoPassContext, InstanceRanges[Index]);
+			}
+
+			SinglePassContext.Reset();
+			SinglePassContext.PrepareStereo(LeftEye, RightEye);
+			SinglePassContext.UploadInstances(Instances);
+
+			for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+			{
+				SinglePassDraws += DrawCalls[Index].first->Render(SinglePassContext, InstanceRanges[Index], StereoFrameCamera::Eye_Count);
+			}
+
+			// The instances of an object are next to each other, so each slice receives the vertices in the same order
+			for (UINT Slice = 0; Slice < Reference::RenderingContext::SliceCount; ++Slice)
+			{
+				const std::vector<DirectX::XMFLOAT4> & TwoPassPositions = TwoPassContext.GetPositions(Slice);
+				const std::vector<DirectX::XMFLOAT4> & SinglePassPositions = SinglePassContext.GetPositions(Slice);
+				Mismatches += (std::max)(TwoPassPositions.size(), SinglePassPositions.size()) - (std::min)(TwoPassPositions.size(), SinglePassPositions.size());
+
+				for (size_t Index = 0; Index < (std::min)(TwoPassPositions.size(), SinglePassPositions.size()); ++Index)
+				{
+					Mismatches += (std::memcmp(&TwoPassPositions[Index], &SinglePassPositions[Index], sizeof(DirectX::XMFLOAT4)) != 0) ? 1 : 0;
+				}
+			}
+		}
+
+		const Reference::RenderingContext::Statistics & TwoPass = TwoPassContext.GetStatistics();
+		const Reference::RenderingContext::Statistics & SinglePass = SinglePassContext.GetStatistics();
+
+		Results.Add(L"Objects", static_cast<double>(Instances.GetCount()), L"count");
+		Results.Add(L"Vertices", static_cast<double>(SinglePass.VertexCount), L"count");
+		Results.Add(L"Two Pass Draws", static_cast<double>(TwoPassDraws / Passes), L"count");
+		Results.Add(L"Single Pass Draws", static_cast<double>(SinglePassDraws / Passes), L"count");
+		Results.Add(L"Two Pass Uploads", static_cast<double>(TwoPass.UploadCount), L"count");
+		Results.Add(L"Single Pass Uploads", static_cast<double>(SinglePass.UploadCount), L"count");
+		Results.Add(L"Two Pass Uploaded Size", static_cast<double>(TwoPass.UploadedBytes), L"bytes");
+		Results.Add(L"Single Pass Uploaded Size", static_cast<double>(SinglePass.UploadedBytes), L"bytes");
+		Results.Add(L"Draw Reduction", static_cast<double>(TwoPassDraws) / static_cast<double>(SinglePassDraws), L"ratio");
+		Results.Add(L"Position Mismatches", static_cast<double>(Mismatches), L"count");
+
+		// Each eye draws the decorations and the plane ranges once; the single pass draws them once for both eyes. Both
+		// upload the instances once, the two passes the constants of each eye and the single pass those of both together.
+		const size_t DrawsPerEye = 1 + PlaneDrawRanges;
+		Results.Check(L"Same Positions", (Mismatches == 0) && (SinglePass.VertexCount > 0));
+		Results.Check(L"Expected Draws", (TwoPassDraws == Passes * StereoFrameCamera::Eye_Count * DrawsPerEye) && (SinglePassDraws == Passes * DrawsPerEye) && (SinglePass.DrawCount == DrawsPerEye));
+		Results.Check(L"Expected Uploads", (TwoPass.UploadCount == StereoFrameCamera::Eye_Count + 1) && (SinglePass.UploadCount == 2) && (SinglePass.UploadedBytes == sizeof(StereoFrameCamera::StereoConstants) + Instances.GetSize()));
+	}
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+namespace Benchmark
+{
+	// Benchmarks run headless, i.e. without window, graphics device or Kinect, and are started with
+	// "-benchmark <Name> [Arguments]". Results are written as CSV next to the executable.
+	bool IsRequested(_In_ LPCWSTR CommandLine);
+	int Run(_In_ LPCWSTR CommandLine);
+};
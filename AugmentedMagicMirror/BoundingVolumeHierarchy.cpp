@@ -0,0 +1,503 @@
+// BoundingVolumeHierarchy.cpp : Tree of boxes for culling and picking many objects
+//
+
+#include "stdafx.h"
+#include "BoundingVolumeHierarchy.h"
+
+#include "ViewFrustum.h"
+
+namespace
+{
+	float GetAxis(_In_ const DirectX::XMFLOAT3 & Value, _In_ unsigned Axis)
+	{
+		return (&Value.x)[Axis];
+	}
+
+	Mesh::Bounds GetEmptyBounds()
+	{
+		const float Infinity = std::numeric_limits<float>::infinity();
+		return { { Infinity, Infinity, Infinity },{ -Infinity, -Infinity, -Infinity } };
+	}
+
+	void Grow(_Inout_ Mesh::Bounds & Box, _In_ const Mesh::Bounds & Other)
+	{
+		Box.Minimum = { (std::min)(Box.Minimum.x, Other.Minimum.x), (std::min)(Box.Minimum.y, Other.Minimum.y), (std::min)(Box.Minimum.z, Other.Minimum.z) };
+		Box.Maximum = { (std::max)(Box.Maximum.x, Other.Maximum.x), (std::max)(Box.Maximum.y, Other.Maximum.y), (std::max)(Box.Maximum.z, Other.Maximum.z) };
+	}
+
+	// Half the surface area, the traversal cost of a box is proportional to it
+	float GetHalfArea(_In_ const Mesh::Bounds & Box)
+	{
+		float X = Box.Maximum.x - Box.Minimum.x;
+		float Y = Box.Maximum.y - Box.Minimum.y;
+		float Z = Box.Maximum.z - Box.Minimum.z;
+
+		return (X < 0.f) ? 0.f : X * Y + Y * Z + Z * X;
+	}
+
+	bool IsEqual(_In_ const Mesh::Bounds & First, _In_ const Mesh::Bounds & Second)
+	{
+		return (First.Minimum.x == Second.Minimum.x) && (First.Minimum.y == Second.Minimum.y) && (First.Minimum.z == Second.Minimum.z)
+			&& (First.Maximum.x == Second.Maximum.x) && (First.Maximum.y == Second.Maximum.y) && (First.Maximum.z == Second.Maximum.z);
+	}
+}
+
+void BoundingVolumeHierarchy::Build(_In_ const std::vector<Mesh::Bounds> & ObjectBounds)
+{
+	Bounds = ObjectBounds;
+	Nodes.clear();
+	MovedObjects.clear();
+	IsMoved.assign(Bounds.size(), 0);
+	ObjectLeaves.assign(Bounds.size(), 0);
+	ObjectOrder.resize(Bounds.size());
+
+	if (Bounds.empty())
+	{
+		return;
+	}
+
+	std::vector<DirectX::XMFLOAT3> Centers(Bounds.size());
+	for (size_t Object = 0; Object < Bounds.size(); ++Object)
+	{
+		const Mesh::Bounds & Box = Bounds[Object];
+		Centers[Object] = { 0.5f * (Box.Minimum.x + Box.Maximum.x), 0.5f * (Box.Minimum.y + Box.Maximum.y), 0.5f * (Box.Minimum.z + Box.Maximum.z) };
+		ObjectOrder[Object] = static_cast<UINT32>(Object);
+	}
+
+	// A binary tree with at least one object per leaf has less than twice as many nodes as objects, the nodes are
+	// never reallocated while they are referenced
+	Nodes.reserve(2 * Bounds.size());
+	Nodes.push_back({ GetEmptyBounds(), 0, static_cast<UINT32>(Bounds.size()), 0, NoParent });
+
+	std::vector<UINT32> Pending = { 0 };
+
+	while (!Pending.empty())
+	{
+		UINT32 NodeIndex = Pending.back();
+		Pending.pop_back();
+
+		if (Subdivide(NodeIndex, Centers))
+		{
+			Pending.push_back(Nodes[NodeIndex].LeftChild);
+			Pending.push_back(Nodes[NodeIndex].LeftChild + 1);
+			continue;
+		}
+
+		const Node & Leaf = Nodes[NodeIndex];
+		for (UINT32 Index = Leaf.FirstObject; Index < Leaf.FirstObject + Leaf.ObjectCount; ++Index)
+		{
+			ObjectLeaves[ObjectOrder[Index]] = NodeIndex;
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::Build(_In_ const Mesh::Bounds & LocalBounds, _In_ const TransformList & Objects)
+{
+	std::vector<Mesh::Bounds> ObjectBounds;
+	ObjectBounds.reserve(Objects.size());
+
+	for (const Transform & Object : Objects)
+	{
+		ObjectBounds.push_back(GetWorldBounds(LocalBounds, Object));
+	}
+
+	Build(ObjectBounds);
+}
+
+void BoundingVolumeHierarchy::UpdateObject(_In_ size_t Object, _In_ const Mesh::Bounds & WorldBounds)
+{
+	Bounds[Object] = WorldBounds;
+
+	if (!IsMoved[Object])
+	{
+		IsMoved[Object] = 1;
+		MovedObjects.push_back(static_cast<UINT32>(Object));
+	}
+}
+
+void BoundingVolumeHierarchy::UpdateObject(_In_ size_t Object, _In_ const Mesh::Bounds & LocalBounds, _In_ const Transform & ObjectTransform)
+{
+	UpdateObject(Object, GetWorldBounds(LocalBounds, ObjectTransform));
+}
+
+size_t BoundingVolumeHierarchy::Refit()
+{
+	size_t ChangedCount = 0;
+
+	for (UINT32 Object : MovedObjects)
+	{
+		IsMoved[Object] = 0;
+
+		// The path up ends where a box does not change, the boxes above it only depend on it through this path
+		UINT32 NodeIndex = ObjectLeaves[Object];
+		Mesh::Bounds Box = GetObjectsBounds(Nodes[NodeIndex]);
+
+		while (!IsEqual(Box, Nodes[NodeIndex].Box))
+		{
+			Nodes[NodeIndex].Box = Box;
+			++ChangedCount;
+
+			NodeIndex = Nodes[NodeIndex].Parent;
+			if (NodeIndex == NoParent)
+			{
+				break;
+			}
+
+			const Node & Parent = Nodes[NodeIndex];
+			Box = Nodes[Parent.LeftChild].Box;
+			Grow(Box, Nodes[Parent.LeftChild + 1].Box);
+		}
+	}
+
+	MovedObjects.clear();
+
+	return ChangedCount;
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(_In_ const ViewFrustum & Frustum, _Out_ ObjectIndexList & Objects) const
+{
+	Objects.clear();
+
+	if (Nodes.empty())
+	{
+		return;
+	}
+
+	std::vector<UINT32> Pending = { 0 };
+
+	while (!Pending.empty())
+	{
+		const Node & Current = Nodes[Pending.back()];
+		Pending.pop_back();
+
+		ViewFrustum::Containment Containment = Frustum.Classify(Current.Box);
+
+		if (Containment == ViewFrustum::Containment_Outside)
+		{
+			continue;
+		}
+
+		// The whole subtree is visible without testing its nodes
+		if (Containment == ViewFrustum::Containment_Inside)
+		{
+			Objects.insert(Objects.end(), ObjectOrder.begin() + Current.FirstObject, ObjectOrder.begin() + Current.FirstObject + Current.ObjectCount);
+			continue;
+		}
+
+		if (!Current.IsLeaf())
+		{
+			Pending.push_back(Current.LeftChild);
+			Pending.push_back(Current.LeftChild + 1);
+			continue;
+		}
+
+		for (UINT32 Index = Current.FirstObject; Index < Current.FirstObject + Current.ObjectCount; ++Index)
+		{
+			if (Frustum.Classify(Bounds[ObjectOrder[Index]]) != ViewFrustum::Containment_Outside)
+			{
+				Objects.push_back(ObjectOrder[Index]);
+			}
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::QuerySphere(_In_ const Vector3 & Center, _In_ float Radius, _Out_ ObjectIndexList & Objects) const
+{
+	Objects.clear();
+
+	if (Nodes.empty())
+	{
+		return;
+	}
+
+	// The squared distance from the center to the nearest point of the box
+	auto Overlaps = [&](const Mesh::Bounds & Box)
+	{
+		float X = (std::max)((std::max)(Box.Minimum.x - Center.X, Center.X - Box.Maximum.x), 0.f);
+		float Y = (std::max)((std::max)(Box.Minimum.y - Center.Y, Center.Y - Box.Maximum.y), 0.f);
+		float Z = (std::max)((std::max)(Box.Minimum.z - Center.Z, Center.Z - Box.Maximum.z), 0.f);
+
+		return X * X + Y * Y + Z * Z <= Radius * Radius;
+	};
+
+	std::vector<UINT32> Pending = { 0 };
+
+	while (!Pending.empty())
+	{
+		const Node & Current = Nodes[Pending.back()];
+		Pending.pop_back();
+
+		if (!Overlaps(Current.Box))
+		{
+			continue;
+		}
+
+		if (!Current.IsLeaf())
+		{
+			Pending.push_back(Current.LeftChild);
+			Pending.push_back(Current.LeftChild + 1);
+			continue;
+		}
+
+		for (UINT32 Index = Current.FirstObject; Index < Current.FirstObject + Current.ObjectCount; ++Index)
+		{
+			if (Overlaps(Bounds[ObjectOrder[Index]]))
+			{
+				Objects.push_back(ObjectOrder[Index]);
+			}
+		}
+	}
+}
+
+bool BoundingVolumeHierarchy::IntersectRay(_In_ const Vector3 & Origin, _In_ const Vector3 & Direction, _In_ float MaxDistance, _Out_ size_t & Object, _Out_ float & Distance) const
+{
+	Object = 0;
+	Distance = MaxDistance;
+
+	if (Nodes.empty())
+	{
+		return false;
+	}
+
+	// Slab test, axis parallel directions give infinite inverses which the comparisons handle
+	const std::array<float, 3> RayOrigin = { Origin.X, Origin.Y, Origin.Z };
+	const std::array<float, 3> InverseDirection = { 1.f / Direction.X, 1.f / Direction.Y, 1.f / Direction.Z };
+	const float Missed = std::numeric_limits<float>::infinity();
+
+	auto GetEntry = [&](const Mesh::Bounds & Box)
+	{
+		float Entry = 0.f;
+		float Exit = Distance;
+
+		for (unsigned Axis = 0; Axis < 3; ++Axis)
+		{
+			float Near = (GetAxis(Box.Minimum, Axis) - RayOrigin[Axis]) * InverseDirection[Axis];
+			float Far = (GetAxis(Box.Maximum, Axis) - RayOrigin[Axis]) * InverseDirection[Axis];
+
+			Entry = (std::max)(Entry, (std::min)(Near, Far));
+			Exit = (std::min)(Exit, (std::max)(Near, Far));
+		}
+
+		return (Entry <= Exit) ? Entry : Missed;
+	};
+
+	bool Hit = false;
+	std::vector<std::pair<UINT32, float>> Pending = { { 0, GetEntry(Nodes[0].Box) } };
+
+	while (!Pending.empty())
+	{
+		std::pair<UINT32, float> Entry = Pending.back();
+		Pending.pop_back();
+
+		// Nearer hits were found since the node was pushed
+		if (Entry.second > Distance)
+		{
+			continue;
+		}
+
+		const Node & Current = Nodes[Entry.first];
+
+		if (Current.IsLeaf())
+		{
+			for (UINT32 Index = Current.FirstObject; Index < Current.FirstObject + Current.ObjectCount; ++Index)
+			{
+				float ObjectEntry = GetEntry(Bounds[ObjectOrder[Index]]);
+
+				if ((ObjectEntry != Missed) && (ObjectEntry <= Distance))
+				{
+					Distance = ObjectEntry;
+					Object = ObjectOrder[Index];
+					Hit = true;
+				}
+			}
+
+			continue;
+		}
+
+		// The nearer child is visited first
+		std::pair<UINT32, float> Left(Current.LeftChild, GetEntry(Nodes[Current.LeftChild].Box));
+		std::pair<UINT32, float> Right(Current.LeftChild + 1, GetEntry(Nodes[Current.LeftChild + 1].Box));
+
+		if (Left.second < Right.second)
+		{
+			std::swap(Left, Right);
+		}
+
+		for (const std::pair<UINT32, float> & Child : { Left, Right })
+		{
+			if ((Child.second != Missed) && (Child.second <= Distance))
+			{
+				Pending.push_back(Child);
+			}
+		}
+	}
+
+	return Hit;
+}
+
+size_t BoundingVolumeHierarchy::GetNodeCount() const
+{
+	return Nodes.size();
+}
+
+size_t BoundingVolumeHierarchy::GetDepth() const
+{
+	size_t Depth = 0;
+
+	for (UINT32 Leaf : ObjectLeaves)
+	{
+		size_t LeafDepth = 0;
+
+		for (UINT32 NodeIndex = Leaf; NodeIndex != NoParent; NodeIndex = Nodes[NodeIndex].Parent)
+		{
+			++LeafDepth;
+		}
+
+		Depth = (std::max)(Depth, LeafDepth);
+	}
+
+	return Depth;
+}
+
+Mesh::Bounds BoundingVolumeHierarchy::GetWorldBounds(_In_ const Mesh::Bounds & LocalBounds, _In_ const Transform & Object)
+{
+	// The matrix is stored transposed, the extent grows by the absolute rotation and scale
+	const DirectX::XMFLOAT4X4 & Matrix = Object.GetMatrix();
+	const std::array<float, 3> LocalCenter = { 0.5f * (LocalBounds.Minimum.x + LocalBounds.Maximum.x), 0.5f * (LocalBounds.Minimum.y + LocalBounds.Maximum.y), 0.5f * (LocalBounds.Minimum.z + LocalBounds.Maximum.z) };
+	const std::array<float, 3> LocalExtent = { 0.5f * (LocalBounds.Maximum.x - LocalBounds.Minimum.x), 0.5f * (LocalBounds.Maximum.y - LocalBounds.Minimum.y), 0.5f * (LocalBounds.Maximum.z - LocalBounds.Minimum.z) };
+
+	std::array<float, 3> Center;
+	std::array<float, 3> Extent;
+
+	for (unsigned Row = 0; Row < 3; ++Row)
+	{
+		Center[Row] = Matrix.m[Row][3];
+		Extent[Row] = 0.f;
+
+		for (unsigned Column = 0; Column < 3; ++Column)
+		{
+			Center[Row] += Matrix.m[Row][Column] * LocalCenter[Column];
+			Extent[Row] += std::abs(Matrix.m[Row][Column]) * LocalExtent[Column];
+		}
+	}
+
+	return { { Center[0] - Extent[0], Center[1] - Extent[1], Center[2] - Extent[2] },{ Center[0] + Extent[0], Center[1] + Extent[1], Center[2] + Extent[2] } };
+}
+
+bool BoundingVolumeHierarchy::Subdivide(_In_ UINT32 NodeIndex, _In_ const std::vector<DirectX::XMFLOAT3> & Centers)
+{
+	Node & Current = Nodes[NodeIndex];
+	Current.Box = GetObjectsBounds(Current);
+
+	if (Current.ObjectCount <= MaxLeafObjects)
+	{
+		return false;
+	}
+
+	auto First = ObjectOrder.begin() + Current.FirstObject;
+	auto Last = First + Current.ObjectCount;
+
+	Mesh::Bounds CenterBounds = GetEmptyBounds();
+	for (auto Object = First; Object != Last; ++Object)
+	{
+		Grow(CenterBounds, { Centers[*Object], Centers[*Object] });
+	}
+
+	// The objects are binned by their centers along each axis, a split between two bins costs the areas of both sides
+	// times their object counts
+	float BestCost = std::numeric_limits<float>::infinity();
+	unsigned BestAxis = 0;
+	unsigned BestSplit = 0;
+
+	for (unsigned Axis = 0; Axis < 3; ++Axis)
+	{
+		float Minimum = GetAxis(CenterBounds.Minimum, Axis);
+		float Length = GetAxis(CenterBounds.Maximum, Axis) - Minimum;
+
+		if (Length <= 0.f)
+		{
+			continue;
+		}
+
+		std::array<Mesh::Bounds, BinCount> BinBounds;
+		std::array<UINT32, BinCount> BinCounts = {};
+		BinBounds.fill(GetEmptyBounds());
+
+		float Scale = BinCount / Length;
+
+		for (auto Object = First; Object != Last; ++Object)
+		{
+			unsigned Bin = (std::min)(static_cast<unsigned>((GetAxis(Centers[*Object], Axis) - Minimum) * Scale), BinCount - 1);
+			Grow(BinBounds[Bin], Bounds[*Object]);
+			++BinCounts[Bin];
+		}
+
+		// Sweeps from the right for the right sides, then from the left
+		std::array<float, BinCount> RightCosts;
+		Mesh::Bounds RightBounds = GetEmptyBounds();
+		UINT32 RightCount = 0;
+
+		for (unsigned Bin = BinCount - 1; Bin > 0; --Bin)
+		{
+			Grow(RightBounds, BinBounds[Bin]);
+			RightCount += BinCounts[Bin];
+			RightCosts[Bin] = GetHalfArea(RightBounds) * RightCount;
+		}
+
+		Mesh::Bounds LeftBounds = GetEmptyBounds();
+		UINT32 LeftCount = 0;
+
+		for (unsigned Split = 1; Split < BinCount; ++Split)
+		{
+			Grow(LeftBounds, BinBounds[Split - 1]);
+			LeftCount += BinCounts[Split - 1];
+
+			float Cost = GetHalfArea(LeftBounds) * LeftCount + RightCosts[Split];
+
+			if ((LeftCount > 0) && (LeftCount < Current.ObjectCount) && (Cost < BestCost))
+			{
+				BestCost = Cost;
+				BestAxis = Axis;
+				BestSplit = Split;
+			}
+		}
+	}
+
+	UINT32 LeftCount = 0;
+
+	if (BestSplit > 0)
+	{
+		float Minimum = GetAxis(CenterBounds.Minimum, BestAxis);
+		float Scale = BinCount / (GetAxis(CenterBounds.Maximum, BestAxis) - Minimum);
+
+		auto IsLeft = [&](UINT32 Object) { return (std::min)(static_cast<unsigned>((GetAxis(Centers[Object], BestAxis) - Minimum) * Scale), BinCount - 1) < BestSplit; };
+		LeftCount = static_cast<UINT32>(std::partition(First, Last, IsLeft) - First);
+	}
+	else
+	{
+		// All centers coincide, the objects are halved as they are
+		LeftCount = Current.ObjectCount / 2;
+	}
+
+	UINT32 LeftChild = static_cast<UINT32>(Nodes.size());
+	UINT32 FirstObject = Current.FirstObject;
+	UINT32 ObjectCount = Current.ObjectCount;
+	Current.LeftChild = LeftChild;
+
+	Nodes.push_back({ GetEmptyBounds(), FirstObject, LeftCount, 0, NodeIndex });
+	Nodes.push_back({ GetEmptyBounds(), FirstObject + LeftCount, ObjectCount - LeftCount, 0, NodeIndex });
+
+	return true;
+}
+
+Mesh::Bounds BoundingVolumeHierarchy::GetObjectsBounds(_In_ const Node & Leaf) const
+{
+	Mesh::Bounds Box = GetEmptyBounds();
+
+	for (UINT32 Index = Leaf.FirstObject; Index < Leaf.FirstObject + Leaf.ObjectCount; ++Index)
+	{
+		Grow(Box, Bounds[ObjectOrder[Index]]);
+	}
+
+	return Box;
+}
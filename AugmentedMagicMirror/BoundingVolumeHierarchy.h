@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Mesh.h"
+#include "Transform.h"
+
+class ViewFrustum;
+
+// Binary tree of boxes over the world space boxes of many objects, for culling and picking without testing every
+// object. The tree is built top down, splitting each node where the surface area heuristic estimates the cheapest
+// traversal among a few candidate planes per axis. Moved objects only refit the boxes on the path to the root, which
+// keeps the tree valid but slowly worse; it should be built again once most objects have moved far.
+class BoundingVolumeHierarchy
+{
+public:
+	typedef std::vector<size_t> ObjectIndexList;
+
+	// Object indices refer to the order of the boxes or objects given
+	void Build(_In_ const std::vector<Mesh::Bounds> & ObjectBounds);
+	void Build(_In_ const Mesh::Bounds & LocalBounds, _In_ const TransformList & Objects);
+
+	// Takes the new box of a moved object, the tree is refit on the next Refit
+	void UpdateObject(_In_ size_t Object, _In_ const Mesh::Bounds & WorldBounds);
+	void UpdateObject(_In_ size_t Object, _In_ const Mesh::Bounds & LocalBounds, _In_ const Transform & ObjectTransform);
+
+	// Grows or shrinks the boxes above the moved objects; returns the number of changed nodes
+	size_t Refit();
+
+	// Replace Objects with the objects whose boxes are not completely outside, respectively overlap the sphere
+	void QueryFrustum(_In_ const ViewFrustum & Frustum, _Out_ ObjectIndexList & Objects) const;
+	void QuerySphere(_In_ const Vector3 & Center, _In_ float Radius, _Out_ ObjectIndexList & Objects) const;
+
+	// The nearest object box hit; Distance is along Direction in its units, i.e. in world units for a normalized Direction
+	bool IntersectRay(_In_ const Vector3 & Origin, _In_ const Vector3 & Direction, _In_ float MaxDistance, _Out_ size_t & Object, _Out_ float & Distance) const;
+
+	size_t GetNodeCount() const;
+	size_t GetDepth() const;
+
+	// The box around the local bounds transformed by the object matrix
+	static Mesh::Bounds GetWorldBounds(_In_ const Mesh::Bounds & LocalBounds, _In_ const Transform & Object);
+
+private:
+	static constexpr UINT32 MaxLeafObjects = 4;
+	static constexpr unsigned BinCount = 12;
+	static constexpr UINT32 NoParent = 0xFFFFFFFF;
+
+	// The objects of a subtree are a contiguous range of ObjectOrder. Leaves have no children; the right child of
+	// an inner node follows its left child.
+	struct Node
+	{
+		Mesh::Bounds Box;
+		UINT32 FirstObject;
+		UINT32 ObjectCount;
+		UINT32 LeftChild;
+		UINT32 Parent;
+
+		bool IsLeaf() const { return LeftChild == 0; }
+	};
+
+	std::vector<Node> Nodes;
+	std::vector<UINT32> ObjectOrder;
+	std::vector<UINT32> ObjectLeaves;
+	std::vector<Mesh::Bounds> Bounds;
+
+	std::vector<UINT32> MovedObjects;
+	std::vector<UINT8> IsMoved;
+
+	// Returns false when the node stays a leaf
+	bool Subdivide(_In_ UINT32 NodeIndex, _In_ const std::vector<DirectX::XMFLOAT3> & Centers);
+	Mesh::Bounds GetObjectsBounds(_In_ const Node & Leaf) const;
+};
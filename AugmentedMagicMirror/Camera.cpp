@@ -7,22 +7,42 @@
 const Vector3 Camera::Up(0.0f, 1.0f, 0.0f);
 
 Camera::Camera(_In_ const Vector3 & Position)
-	:Position(Position), AspectRatio(1.f)
+	:Position(Position), AspectRatio(1.f), Dirty(true), ResolveCount(0)
 {
 }
 
 void Camera::UpdateCamera(_In_ const Window::WindowSize & Size)
 {
 	AspectRatio = static_cast<float>(Size.first) / static_cast<float>(Size.second);
-
-	UpdateCamera();
+	Dirty = true;
 }
 
 void Camera::UpdateCamera(_In_ const Vector3 & Position)
 {
 	this->Position = Position;
+	Dirty = true;
+}
+
+void Camera::Resolve()
+{
+	if (!Dirty)
+	{
+		return;
+	}
 
 	UpdateCamera();
+	Dirty = false;
+	++ResolveCount;
+}
+
+bool Camera::IsDirty() const
+{
+	return Dirty;
+}
+
+unsigned Camera::GetResolveCount() const
+{
+	return ResolveCount;
 }
 
 const DirectX::XMFLOAT4X4 & Camera::GetViewMatrix() const
@@ -7,10 +7,17 @@ class Camera
 public:
 	Camera(_In_ const Vector3 & Position);
 
+	// Only mark the matrices as outdated, Resolve recalculates them once, i.e. right before rendering
 	virtual void UpdateCamera(_In_ const Window::WindowSize & Size);
 	virtual void UpdateCamera(_In_ const Vector3 & Position);
+
+	// Recalculates the matrices right away
 	virtual void UpdateCamera() = 0;
 
+	void Resolve();
+	bool IsDirty() const;
+	unsigned GetResolveCount() const;
+
 	const DirectX::XMFLOAT4X4 & GetViewMatrix() const;
 	const DirectX::XMFLOAT4X4 & GetProjectionMatrix() const;
 
@@ -24,5 +31,7 @@ protected:
 
 	Vector3 Position;
 	float AspectRatio;
-};
 
+	bool Dirty;
+	unsigned ResolveCount;
+};
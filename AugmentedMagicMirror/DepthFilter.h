@@ -0,0 +1,15 @@
+#pragma once
+
+class DepthFilter;
+typedef std::vector<DepthFilter *> DepthFilterList;
+
+class DepthFilter
+{
+public:
+	typedef std::vector<UINT16> DepthPixelList;
+
+	virtual ~DepthFilter() = default;
+
+	// Filters the raw depth image (in millimetres, 0 = invalid) in place before it is mapped to camera space
+	virtual void Apply(_Inout_ DepthPixelList & DepthPixels) = 0;
+};
@@ -0,0 +1,165 @@
+// DepthHoleFilling.cpp : Closes holes in the depth image with an edge preserving push-pull pyramid
+//
+
+#include "stdafx.h"
+#include "DepthHoleFilling.h"
+
+namespace
+{
+	// Only samples this close to the nearest sample of a 2x2 block are merged, so the foreground
+	// and the background are never averaged across a silhouette
+	constexpr UINT16 EdgeTolerance = 50;
+}
+
+DepthHoleFilling::DepthHoleFilling(_In_ unsigned Width, _In_ unsigned Height)
+	:Width(Width), Height(Height)
+	, Enabled(true), IsParallel(true)
+	, FillTime(L"Depth Hole Filling")
+{
+	unsigned LevelWidth = Width;
+	unsigned LevelHeight = Height;
+
+	for (Level & PyramidLevel : Levels)
+	{
+		LevelWidth = (LevelWidth + 1) / 2;
+		LevelHeight = (LevelHeight + 1) / 2;
+
+		PyramidLevel.Width = LevelWidth;
+		PyramidLevel.Height = LevelHeight;
+		PyramidLevel.Pixels.resize(LevelWidth * LevelHeight);
+	}
+}
+
+void DepthHoleFilling::Apply(_Inout_ DepthPixelList & DepthPixels)
+{
+	if (!Enabled || (DepthPixels.size() != Width * Height))
+	{
+		return;
+	}
+
+	FillTime.Start();
+
+	// Push: build the pyramid from the finest to the coarsest level
+	Push(DepthPixels.data(), Width, Height, Levels[0]);
+
+	for (unsigned LevelIndex = 1; LevelIndex < LevelCount; ++LevelIndex)
+	{
+		const Level & Source = Levels[LevelIndex - 1];
+		Push(Source.Pixels.data(), Source.Width, Source.Height, Levels[LevelIndex]);
+	}
+
+	// Pull: fill the remaining holes of each level from the next coarser one
+	for (unsigned LevelIndex = LevelCount - 1; LevelIndex > 0; --LevelIndex)
+	{
+		Level & Target = Levels[LevelIndex - 1];
+		Pull(Levels[LevelIndex], Target.Pixels.data(), Target.Width, Target.Height);
+	}
+
+	Pull(Levels[0], DepthPixels.data(), Width, Height);
+
+	FillTime.Stop();
+}
+
+void DepthHoleFilling::SetParallel(_In_ bool IsParallel)
+{
+	this->IsParallel = IsParallel;
+}
+
+void DepthHoleFilling::KeyPressedCallback(_In_ const WPARAM & VirtualKey)
+{
+	if (VirtualKey == 'H')
+	{
+		Enabled = !Enabled;
+	}
+}
+
+template<typename TileFunction>
+void DepthHoleFilling::ForEachTile(_In_ unsigned RowCount, _In_ const TileFunction & Function)
+{
+	unsigned TileCount = (RowCount + RowsPerTile - 1) / RowsPerTile;
+
+	auto ProcessTile = [&](unsigned Tile)
+	{
+		unsigned FirstRow = Tile * RowsPerTile;
+		Function(FirstRow, (std::min)(FirstRow + RowsPerTile, RowCount));
+	};
+
+	if (IsParallel)
+	{
+		concurrency::parallel_for(0u, TileCount, ProcessTile);
+	}
+	else
+	{
+		for (unsigned Tile = 0; Tile < TileCount; ++Tile)
+		{
+			ProcessTile(Tile);
+		}
+	}
+}
+
+void DepthHoleFilling::Push(_In_ const UINT16 * Source, _In_ unsigned SourceWidth, _In_ unsigned SourceHeight, _Inout_ Level & Target)
+{
+	UINT16 * TargetPixels = Target.Pixels.data();
+	unsigned TargetWidth = Target.Width;
+
+	ForEachTile(Target.Height, [=](unsigned FirstRow, unsigned LastRow)
+	{
+		for (unsigned Y = FirstRow; Y < LastRow; ++Y)
+		{
+			const UINT16 * UpperRow = Source + (2 * Y) * SourceWidth;
+			const UINT16 * LowerRow = Source + (std::min)(2 * Y + 1, SourceHeight - 1) * SourceWidth;
+
+			for (unsigned X = 0; X < TargetWidth; ++X)
+			{
+				unsigned Left = 2 * X;
+				unsigned Right = (std::min)(Left + 1, SourceWidth - 1);
+				std::array<UINT16, 4> Samples = { UpperRow[Left], UpperRow[Right], LowerRow[Left], LowerRow[Right] };
+
+				UINT16 Nearest = (std::numeric_limits<UINT16>::max)();
+				for (UINT16 Sample : Samples)
+				{
+					if ((Sample != 0) && (Sample < Nearest))
+					{
+						Nearest = Sample;
+					}
+				}
+
+				unsigned Sum = 0;
+				unsigned Count = 0;
+				for (UINT16 Sample : Samples)
+				{
+					if ((Sample != 0) && (Sample - Nearest <= EdgeTolerance))
+					{
+						Sum += Sample;
+						++Count;
+					}
+				}
+
+				TargetPixels[X + Y * TargetWidth] = (Count != 0) ? static_cast<UINT16>(Sum / Count) : 0;
+			}
+		}
+	});
+}
+
+void DepthHoleFilling::Pull(_In_ const Level & Source, _Inout_ UINT16 * Target, _In_ unsigned TargetWidth, _In_ unsigned TargetHeight)
+{
+	const UINT16 * SourcePixels = Source.Pixels.data();
+	unsigned SourceWidth = Source.Width;
+
+	ForEachTile(TargetHeight, [=](unsigned FirstRow, unsigned LastRow)
+	{
+		for (unsigned Y = FirstRow; Y < LastRow; ++Y)
+		{
+			UINT16 * TargetRow = Target + Y * TargetWidth;
+			const UINT16 * SourceRow = SourcePixels + (Y / 2) * SourceWidth;
+
+			for (unsigned X = 0; X < TargetWidth; ++X)
+			{
+				if (TargetRow[X] == 0)
+				{
+					TargetRow[X] = SourceRow[X / 2];
+				}
+			}
+		}
+	});
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "DepthFilter.h"
+#include "PerformanceCounter.h"
+
+class DepthHoleFilling : public DepthFilter
+{
+public:
+	DepthHoleFilling(_In_ unsigned Width, _In_ unsigned Height);
+
+	virtual void Apply(_Inout_ DepthPixelList & DepthPixels);
+
+	void SetParallel(_In_ bool IsParallel);
+
+	void KeyPressedCallback(_In_ const WPARAM & VirtualKey);
+
+private:
+	// Holes up to 2^LevelCount pixels wide are closed
+	static constexpr unsigned LevelCount = 4;
+	static constexpr unsigned RowsPerTile = 8;
+
+	struct Level
+	{
+		unsigned Width;
+		unsigned Height;
+		DepthPixelList Pixels;
+	};
+
+	const unsigned Width;
+	const unsigned Height;
+	std::array<Level, LevelCount> Levels;
+
+	bool Enabled;
+	bool IsParallel;
+	PerformanceCounter FillTime;
+
+	template<typename TileFunction>
+	void ForEachTile(_In_ unsigned RowCount, _In_ const TileFunction & Function);
+
+	void Push(_In_ const UINT16 * Source, _In_ unsigned SourceWidth, _In_ unsigned SourceHeight, _Inout_ Level & Target);
+	void Pull(_In_ const Level & Source, _Inout_ UINT16 * Target, _In_ unsigned TargetWidth, _In_ unsigned TargetHeight);
+};
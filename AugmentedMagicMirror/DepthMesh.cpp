@@ -4,21 +4,28 @@
 #include "stdafx.h"
 #include "DepthMesh.h"
 
+#include "DepthNormals.h"
 #include "GraphicsContext.h"
 
 DepthMesh::DepthMesh(_In_ GraphicsContext & DeviceContext)
-	:PlaneMesh(DeviceContext.CreateMesh()), ColorizeDepth(false)
+	:PlaneMesh(DeviceContext.CreateMesh()), Quadtree(Kinect::DepthImageWidth, Kinect::DepthImageHeigth)
+	, RealWorldToVirtualScale(1.f), ColorizeNear(0.7f), ColorizeFar(3.0f), ColorizeDepth(false), ShadeDepth(false), Decimate(true), IsGridIndexed(true), UploadSize(L"Depth Mesh Upload", L"bytes")
 {
 }
 
 void DepthMesh::Create(_In_ Kinect & Kinect)
 {
 	PlaneMesh->CreatePlane(Kinect::DepthImageWidth, Kinect::DepthImageHeigth);
+	UploadedIndices = Mesh::CreatePlaneIndices(Kinect::DepthImageWidth, Kinect::DepthImageHeigth);
 
 	Instances.push_back(Transform(Kinect.GetOffset(), Quaternion(), Vector3(Kinect.GetRealWorldToVirutalScale(), Kinect.GetRealWorldToVirutalScale(), -Kinect.GetRealWorldToVirutalScale())));
 
+	RealWorldToVirtualScale = Kinect.GetRealWorldToVirutalScale();
+	OccupancyGrid.SetWorldTransform(Kinect.GetOffset(), RealWorldToVirtualScale);
+
 	Kinect.OffsetUpdated += std::make_pair(this, &DepthMesh::OffsetUpdatedCallback);
 	Kinect.DepthVerticesUpdated += std::make_pair(this, &DepthMesh::DepthVerticesUpdatedCallback);
+	Kinect.DepthStatisticsUpdated += std::make_pair(this, &DepthMesh::DepthStatisticsUpdatedCallback);
 }
 
 RenderContext::ObjectList DepthMesh::GetRenderObjectList() const
@@ -26,12 +33,25 @@ RenderContext::ObjectList DepthMesh::GetRenderObjectList() const
 	return RenderContext::ObjectList( *PlaneMesh, Instances );
 }
 
+const DepthOccupancyGrid & DepthMesh::GetOccupancyGrid() const
+{
+	return OccupancyGrid;
+}
+
 void DepthMesh::KeyPressedCallback(const WPARAM & VirtualKey)
 {
 	if (VirtualKey == 'F')
 	{
 		ColorizeDepth = !ColorizeDepth;
 	}
+	else if (VirtualKey == 'N')
+	{
+		ShadeDepth = !ShadeDepth;
+	}
+	else if (VirtualKey == 'M')
+	{
+		Decimate = !Decimate;
+	}
 }
 
 void DepthMesh::OffsetUpdatedCallback(const Vector3 & Offset)
@@ -40,20 +60,179 @@ void DepthMesh::OffsetUpdatedCallback(const Vector3 & Offset)
 	{
 		Object.UpdatePosition(Offset);
 	}
+
+	OccupancyGrid.SetWorldTransform(Offset, RealWorldToVirtualScale);
+}
+
+void DepthMesh::DepthStatisticsUpdatedCallback(_In_ const DepthStatistics & Statistics)
+{
+	if (Statistics.GetValidCount() == 0)
+	{
+		return;
+	}
+
+	float Near = Statistics.GetPercentile(ColorizeLowerPercentile);
+	float Far = (std::max)(Statistics.GetPercentile(ColorizeUpperPercentile), Near + ColorizeMinimumRange);
+
+	// Eased towards the frame's range, so single frames do not make the colors flicker
+	ColorizeNear += (Near - ColorizeNear) * ColorizeAdaption;
+	ColorizeFar += (Far - ColorizeFar) * ColorizeAdaption;
 }
 
-void DepthMesh::DepthVerticesUpdatedCallback(_In_ const Kinect::CameraSpacePointList & DepthVertices)
+void DepthMesh::DepthVerticesUpdatedCallback(_In_ const Kinect::CameraSpacePointList & DepthVertices, _In_ const Kinect::NormalList & Normals, _In_ const DepthRegion & Region)
 {
 	VertexCache.resize(DepthVertices.size());
+
+	// Only the rows of the region of interest are current, the others keep their last vertices and are not drawn
+	size_t First = Region.Top * Kinect::DepthImageWidth;
+	size_t Last = Region.Bottom * Kinect::DepthImageWidth;
 	
-	std::transform(DepthVertices.begin(), DepthVertices.end(), VertexCache.begin(), [ColorizeDepth = this->ColorizeDepth](auto Vertex)
+	std::transform(DepthVertices.begin() + First, DepthVertices.begin() + Last, Normals.begin() + First, VertexCache.begin() + First, [ColorizeDepth = this->ColorizeDepth, ShadeDepth = this->ShadeDepth, MinDist = this->ColorizeNear, MaxDist = this->ColorizeFar](auto Vertex, auto Normal)
 	{ 
-		constexpr float MinDist = 0.7f;
-		constexpr float MaxDist = 3.0f;
+		constexpr float ShadedGray = 0.8f;
 		float Value = (!ColorizeDepth) ?  0.0f : std::fmaxf(0.f, std::fminf(1.f, 1.0f - (Vertex.Z - MinDist) / (MaxDist - MinDist)));
-		return Mesh::Vertex({ { Vertex.X, Vertex.Y, Vertex.Z },{ 0.0f, 0.0f, Value, 0.0f } });
+
+		// A black mesh stays black when lit, shading therefore starts from gray
+		if (ShadeDepth)
+		{
+			return Mesh::Vertex({ { Vertex.X, Vertex.Y, Vertex.Z },{ ShadedGray, ShadedGray, (std::max)(ShadedGray, Value), 0.0f }, Normal });
+		}
+
+		return Mesh::Vertex({ { Vertex.X, Vertex.Y, Vertex.Z },{ 0.0f, 0.0f, Value, 0.0f }, DepthNormals::NoNormal });
 	});
 	
-	PlaneMesh->UpdateVertices(VertexCache);
+	OccupancyGrid.Build(DepthVertices, Region);
+	size_t IndexBytes = UpdateIndices(DepthVertices, Region);
+
+	UploadSize.AddSample(static_cast<double>(IndexBytes + PlaneMesh->UpdateVertices(UploadedVertices, UpdateDirtyBands(Region))));
+}
+
+size_t DepthMesh::UpdateIndices(_In_ const Kinect::CameraSpacePointList & DepthVertices, _In_ const DepthRegion & Region)
+{
+	if (Decimate)
+	{
+		Quadtree.Build(DepthVertices, true, Region);
+		PlaneMesh->SetDrawRanges({});
+		IsGridIndexed = false;
+		return SubmitIndices(Quadtree.GetIndices());
+	}
+
+	size_t IndexBytes = 0;
+
+	if (!IsGridIndexed)
+	{
+		IndexBytes = SubmitIndices(Mesh::CreatePlaneIndices(Kinect::DepthImageWidth, Kinect::DepthImageHeigth));
+		IsGridIndexed = true;
+	}
+
+	// The cells of a grid row are contiguous, so the region is drawn with one index range per row
+	constexpr UINT IndicesPerCell = 6;
+	constexpr UINT CellsPerRow = Kinect::DepthImageWidth - 1;
+
+	// Right and Bottom are exclusive, so the last cell of the region starts one vertex before them, like in the quadtree
+	UINT FirstCell = Region.Left;
+	UINT LastCell = (std::min)(Region.Right, Kinect::DepthImageWidth) - 1;
+	UINT LastRow = (std::min)(Region.Bottom, Kinect::DepthImageHeigth) - 1;
+
+	Mesh::IndexRangeList Ranges;
+	for (UINT Row = Region.Top; (Row < LastRow) && (FirstCell < LastCell); ++Row)
+	{
+		UINT First = (Row * CellsPerRow + FirstCell) * IndicesPerCell;
+		UINT Count = (LastCell - FirstCell) * IndicesPerCell;
+
+		if (!Ranges.empty() && (Ranges.back().First + Ranges.back().Count == First))
+		{
+			Ranges.back().Count += Count;
+		}
+		else
+		{
+			Ranges.push_back({ First, Count });
+		}
+	}
+
+	PlaneMesh->SetDrawRanges(Ranges);
+
+	return IndexBytes;
+}
+
+size_t DepthMesh::SubmitIndices(_In_ const Mesh::IndexList & Indices)
+{
+	// A static scene decimates to the same indices frame after frame, which need no upload
+	if (Indices == UploadedIndices)
+	{
+		return 0;
+	}
+
+	PlaneMesh->UpdateIndices(Indices);
+	UploadedIndices = Indices;
+
+	return Indices.size() * sizeof(Mesh::IndexList::value_type);
+}
+
+Mesh::ByteRangeList DepthMesh::UpdateDirtyBands(_In_ const DepthRegion & Region)
+{
+	constexpr size_t BandSize = RowsPerBand * Kinect::DepthImageWidth;
+
+	size_t BandCount = (VertexCache.size() + BandSize - 1) / BandSize;
+	size_t FirstRegionBand = Region.Top / RowsPerBand;
+	size_t LastRegionBand = (Region.Bottom + RowsPerBand - 1) / RowsPerBand;
+
+	// Everything is dirty until the first frame has been uploaded
+	if (UploadedVertices.size() != VertexCache.size())
+	{
+		UploadedVertices = VertexCache;
+		DirtyBands.assign(BandCount, true);
+	}
+	else
+	{
+		DirtyBands.assign(BandCount, false);
+
+		// Bands outside the region of interest did not change
+		concurrency::parallel_for(FirstRegionBand, LastRegionBand, [this, BandSize](size_t Band)
+		{
+			size_t First = Band * BandSize;
+			size_t Last = (std::min)(First + BandSize, VertexCache.size());
+
+			for (size_t Index = First; Index < Last; ++Index)
+			{
+				const Mesh::Vertex & Current = VertexCache[Index];
+				const Mesh::Vertex & Uploaded = UploadedVertices[Index];
+
+				// Invalid points are -inf on both sides, their NaN difference does not count as change;
+				// normals follow the depth, only switching shading on or off has to be detected
+				if ((std::fabs(Current.Position.z - Uploaded.Position.z) > DirtyThreshold) || (Current.Color.z != Uploaded.Color.z) ||
+					((Current.Normal == DepthNormals::NoNormal) != (Uploaded.Normal == DepthNormals::NoNormal)))
+				{
+					std::copy(VertexCache.begin() + First, VertexCache.begin() + Last, UploadedVertices.begin() + First);
+					DirtyBands[Band] = true;
+					break;
+				}
+			}
+		});
+	}
+
+	// Neighbouring dirty bands are merged into a single range
+	Mesh::ByteRangeList DirtyRanges;
+	for (size_t Band = 0; Band < BandCount; ++Band)
+	{
+		if (!DirtyBands[Band])
+		{
+			continue;
+		}
+
+		size_t Offset = Band * BandSize * sizeof(Mesh::Vertex);
+		size_t Size = ((std::min)((Band + 1) * BandSize, VertexCache.size()) - Band * BandSize) * sizeof(Mesh::Vertex);
+
+		if (!DirtyRanges.empty() && (DirtyRanges.back().Offset + DirtyRanges.back().Size == Offset))
+		{
+			DirtyRanges.back().Size += Size;
+		}
+		else
+		{
+			DirtyRanges.push_back({ Offset, Size });
+		}
+	}
+
+	return DirtyRanges;
 }
 
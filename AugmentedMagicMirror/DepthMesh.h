@@ -1,7 +1,10 @@
 #pragma once
 
+#include "DepthOccupancyGrid.h"
+#include "DepthQuadtree.h"
 #include "Kinect.h"
 #include "Mesh.h"
+#include "PerformanceCounter.h"
 #include "RenderContext.h"
 #include "Transform.h"
 
@@ -15,6 +18,7 @@ public:
 	void Create(_In_ Kinect & Kinect);
 
 	RenderContext::ObjectList GetRenderObjectList() const;
+	const DepthOccupancyGrid & GetOccupancyGrid() const;
 
 	void KeyPressedCallback(_In_ const WPARAM & VirtualKey);
 
@@ -22,11 +26,39 @@ private:
 	PMesh PlaneMesh;
 	TransformList Instances;
 
+	// Vertices are compared and uploaded in bands of depth image rows
+	static constexpr unsigned RowsPerBand = 8;
+	static constexpr float DirtyThreshold = 0.005f;
+
+	// The colorize range follows the depth percentiles of the frames, starting from the usual distance of a user
+	static constexpr float ColorizeLowerPercentile = 0.02f;
+	static constexpr float ColorizeUpperPercentile = 0.98f;
+	static constexpr float ColorizeMinimumRange = 0.5f;
+	static constexpr float ColorizeAdaption = 0.1f;
+
 	Mesh::VertexList VertexCache;
+	Mesh::VertexList UploadedVertices;
+	Mesh::IndexList UploadedIndices;
+	std::vector<char> DirtyBands;
+	DepthQuadtree Quadtree;
+	DepthOccupancyGrid OccupancyGrid;
+	float RealWorldToVirtualScale;
+	float ColorizeNear;
+	float ColorizeFar;
 
 	bool ColorizeDepth;
+	bool ShadeDepth;
+	bool Decimate;
+	bool IsGridIndexed;
+	PerformanceCounter UploadSize;
 
 	void OffsetUpdatedCallback(_In_ const Vector3 & Offset);
-	void DepthVerticesUpdatedCallback(_In_ const Kinect::CameraSpacePointList & DepthVertices);
+	void DepthStatisticsUpdatedCallback(_In_ const DepthStatistics & Statistics);
+	void DepthVerticesUpdatedCallback(_In_ const Kinect::CameraSpacePointList & DepthVertices, _In_ const Kinect::NormalList & Normals, _In_ const DepthRegion & Region);
+
+	// Both return the number of index bytes uploaded; indices equal to the last submitted ones are not uploaded again
+	size_t UpdateIndices(_In_ const Kinect::CameraSpacePointList & DepthVertices, _In_ const DepthRegion & Region);
+	size_t SubmitIndices(_In_ const Mesh::IndexList & Indices);
+	Mesh::ByteRangeList UpdateDirtyBands(_In_ const DepthRegion & Region);
 };
 
@@ -0,0 +1,268 @@
+// DepthNormals.cpp : Normals of the depth point grid from central differences
+//
+
+#include "stdafx.h"
+#include "DepthNormals.h"
+
+namespace
+{
+	constexpr unsigned Width = Kinect::DepthImageWidth;
+	constexpr unsigned Height = Kinect::DepthImageHeigth;
+	constexpr float MillimetersToMeters = 0.001f;
+
+	// Projects four normals onto the octahedron |x| + |y| + |z| = 1, folds the half facing the sensor over the
+	// diagonals and packs x and y into signed normalized 16 bit values; lanes outside ValidMask get NoNormal
+	__m128i PackOctahedral(_In_ __m128 NormalX, _In_ __m128 NormalY, _In_ __m128 NormalZ, _In_ __m128 ValidMask)
+	{
+		const __m128 SignMask = _mm_set1_ps(-0.f);
+		const __m128 One = _mm_set1_ps(1.f);
+		const __m128 SNormScale = _mm_set1_ps(32767.f);
+
+		__m128 Length = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(SignMask, NormalX), _mm_andnot_ps(SignMask, NormalY)), _mm_andnot_ps(SignMask, NormalZ));
+		ValidMask = _mm_and_ps(ValidMask, _mm_cmpgt_ps(Length, _mm_setzero_ps()));
+
+		__m128 InverseLength = _mm_div_ps(One, Length);
+		__m128 U = _mm_mul_ps(NormalX, InverseLength);
+		__m128 V = _mm_mul_ps(NormalY, InverseLength);
+
+		__m128 FoldedU = _mm_or_ps(_mm_sub_ps(One, _mm_andnot_ps(SignMask, V)), _mm_and_ps(SignMask, U));
+		__m128 FoldedV = _mm_or_ps(_mm_sub_ps(One, _mm_andnot_ps(SignMask, U)), _mm_and_ps(SignMask, V));
+		__m128 IsFolded = _mm_cmplt_ps(NormalZ, _mm_setzero_ps());
+
+		U = _mm_or_ps(_mm_and_ps(IsFolded, FoldedU), _mm_andnot_ps(IsFolded, U));
+		V = _mm_or_ps(_mm_and_ps(IsFolded, FoldedV), _mm_andnot_ps(IsFolded, V));
+
+		__m128i PackedU = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(U, SNormScale)), _mm_set1_epi32(0xFFFF));
+		__m128i PackedV = _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(V, SNormScale)), 16);
+		__m128i Packed = _mm_or_si128(PackedU, PackedV);
+
+		// The one normal packing to zero would read as NoNormal, it is moved by one unit
+		Packed = _mm_or_si128(Packed, _mm_and_si128(_mm_cmpeq_epi32(Packed, _mm_setzero_si128()), _mm_set1_epi32(1)));
+
+		return _mm_and_si128(Packed, _mm_castps_si128(ValidMask));
+	}
+
+	// The normal is the cross product of the vertical (bottom to top) and the horizontal (left to right) difference,
+	// which points towards the sensor for surfaces seen by it
+	__m128i PackNormals(_In_ __m128 HorizontalX, _In_ __m128 HorizontalY, _In_ __m128 HorizontalZ, _In_ __m128 VerticalX, _In_ __m128 VerticalY, _In_ __m128 VerticalZ, _In_ __m128 ValidMask)
+	{
+		__m128 NormalX = _mm_sub_ps(_mm_mul_ps(VerticalY, HorizontalZ), _mm_mul_ps(VerticalZ, HorizontalY));
+		__m128 NormalY = _mm_sub_ps(_mm_mul_ps(VerticalZ, HorizontalX), _mm_mul_ps(VerticalX, HorizontalZ));
+		__m128 NormalZ = _mm_sub_ps(_mm_mul_ps(VerticalX, HorizontalY), _mm_mul_ps(VerticalY, HorizontalX));
+
+		return PackOctahedral(NormalX, NormalY, NormalZ, ValidMask);
+	}
+
+	// Loads and stores four consecutive pixels, or broadcasts a single one for the remainder of a row
+	template<unsigned Count>
+	struct Pixels;
+
+	template<>
+	struct Pixels<4>
+	{
+		static __m128 LoadDepth(_In_ const UINT16 * Depth)
+		{
+			__m128i Values = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(Depth)), _mm_setzero_si128());
+			return _mm_mul_ps(_mm_cvtepi32_ps(Values), _mm_set1_ps(MillimetersToMeters));
+		}
+
+		static void LoadRays(_In_ const PointF * Rays, _Out_ __m128 & RayX, _Out_ __m128 & RayY)
+		{
+			__m128 Low = _mm_loadu_ps(&Rays[0].X);
+			__m128 High = _mm_loadu_ps(&Rays[2].X);
+
+			RayX = _mm_shuffle_ps(Low, High, _MM_SHUFFLE(2, 0, 2, 0));
+			RayY = _mm_shuffle_ps(Low, High, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		static void LoadPoints(_In_ const CameraSpacePoint * Points, _Out_ __m128 & X, _Out_ __m128 & Y, _Out_ __m128 & Z)
+		{
+			X = _mm_set_ps(Points[3].X, Points[2].X, Points[1].X, Points[0].X);
+			Y = _mm_set_ps(Points[3].Y, Points[2].Y, Points[1].Y, Points[0].Y);
+			Z = _mm_set_ps(Points[3].Z, Points[2].Z, Points[1].Z, Points[0].Z);
+		}
+
+		static void StoreNormals(_In_ __m128i Packed, _Out_ UINT32 * Normals)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(Normals), Packed);
+		}
+	};
+
+	template<>
+	struct Pixels<1>
+	{
+		static __m128 LoadDepth(_In_ const UINT16 * Depth)
+		{
+			return _mm_set1_ps(Depth[0] * MillimetersToMeters);
+		}
+
+		static void LoadRays(_In_ const PointF * Rays, _Out_ __m128 & RayX, _Out_ __m128 & RayY)
+		{
+			RayX = _mm_set1_ps(Rays[0].X);
+			RayY = _mm_set1_ps(Rays[0].Y);
+		}
+
+		static void LoadPoints(_In_ const CameraSpacePoint * Points, _Out_ __m128 & X, _Out_ __m128 & Y, _Out_ __m128 & Z)
+		{
+			X = _mm_set1_ps(Points[0].X);
+			Y = _mm_set1_ps(Points[0].Y);
+			Z = _mm_set1_ps(Points[0].Z);
+		}
+
+		static void StoreNormals(_In_ __m128i Packed, _Out_ UINT32 * Normals)
+		{
+			Normals[0] = static_cast<UINT32>(_mm_cvtsi128_si32(Packed));
+		}
+	};
+
+	template<unsigned Count>
+	void EstimatePixels(_In_ const CameraSpacePoint * Points, _In_ size_t Index, _Out_ UINT32 * Normals)
+	{
+		__m128 LeftX, LeftY, LeftZ, RightX, RightY, RightZ, UpX, UpY, UpZ, DownX, DownY, DownZ, CenterX, CenterY, CenterZ;
+
+		Pixels<Count>::LoadPoints(Points + Index - 1, LeftX, LeftY, LeftZ);
+		Pixels<Count>::LoadPoints(Points + Index + 1, RightX, RightY, RightZ);
+		Pixels<Count>::LoadPoints(Points + Index - Width, UpX, UpY, UpZ);
+		Pixels<Count>::LoadPoints(Points + Index + Width, DownX, DownY, DownZ);
+		Pixels<Count>::LoadPoints(Points + Index, CenterX, CenterY, CenterZ);
+
+		// Invalid points are -inf and fail the comparison
+		const __m128 Zero = _mm_setzero_ps();
+		__m128 ValidMask = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(LeftZ, Zero), _mm_cmpgt_ps(RightZ, Zero)), _mm_and_ps(_mm_cmpgt_ps(UpZ, Zero), _mm_cmpgt_ps(DownZ, Zero)));
+		ValidMask = _mm_and_ps(ValidMask, _mm_cmpgt_ps(CenterZ, Zero));
+
+		__m128i Packed = PackNormals(_mm_sub_ps(RightX, LeftX), _mm_sub_ps(RightY, LeftY), _mm_sub_ps(RightZ, LeftZ),
+			_mm_sub_ps(UpX, DownX), _mm_sub_ps(UpY, DownY), _mm_sub_ps(UpZ, DownZ), ValidMask);
+
+		Pixels<Count>::StoreNormals(Packed, Normals + Index);
+	}
+
+	template<unsigned Count>
+	void MapPixels(_In_ const UINT16 * Depth, _In_ const PointF * Rays, _In_ size_t Index, _Out_ CameraSpacePoint * Points, _Out_ UINT32 * Normals)
+	{
+		__m128 RayX, RayY;
+		__m128 Left = Pixels<Count>::LoadDepth(Depth + Index - 1);
+		__m128 Right = Pixels<Count>::LoadDepth(Depth + Index + 1);
+		__m128 Up = Pixels<Count>::LoadDepth(Depth + Index - Width);
+		__m128 Down = Pixels<Count>::LoadDepth(Depth + Index + Width);
+		__m128 Center = Pixels<Count>::LoadDepth(Depth + Index);
+
+		const __m128 Zero = _mm_setzero_ps();
+		__m128 IsCenterValid = _mm_cmpgt_ps(Center, Zero);
+		__m128 ValidMask = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(Left, Zero), _mm_cmpgt_ps(Right, Zero)), _mm_and_ps(_mm_cmpgt_ps(Up, Zero), _mm_cmpgt_ps(Down, Zero)));
+		ValidMask = _mm_and_ps(ValidMask, IsCenterValid);
+
+		// The neighbours are converted as well, so the normals need no second pass over the points
+		Pixels<Count>::LoadRays(Rays + Index - 1, RayX, RayY);
+		__m128 LeftX = _mm_mul_ps(RayX, Left);
+		__m128 LeftY = _mm_mul_ps(RayY, Left);
+
+		Pixels<Count>::LoadRays(Rays + Index + 1, RayX, RayY);
+		__m128 RightX = _mm_mul_ps(RayX, Right);
+		__m128 RightY = _mm_mul_ps(RayY, Right);
+
+		Pixels<Count>::LoadRays(Rays + Index - Width, RayX, RayY);
+		__m128 UpX = _mm_mul_ps(RayX, Up);
+		__m128 UpY = _mm_mul_ps(RayY, Up);
+
+		Pixels<Count>::LoadRays(Rays + Index + Width, RayX, RayY);
+		__m128 DownX = _mm_mul_ps(RayX, Down);
+		__m128 DownY = _mm_mul_ps(RayY, Down);
+
+		__m128i Packed = PackNormals(_mm_sub_ps(RightX, LeftX), _mm_sub_ps(RightY, LeftY), _mm_sub_ps(Right, Left),
+			_mm_sub_ps(UpX, DownX), _mm_sub_ps(UpY, DownY), _mm_sub_ps(Up, Down), ValidMask);
+
+		Pixels<Count>::StoreNormals(Packed, Normals + Index);
+
+		// Same convention as the coordinate mapper: pixels without depth become -inf
+		const __m128 Invalid = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+		Pixels<Count>::LoadRays(Rays + Index, RayX, RayY);
+
+		alignas(16) std::array<float, 4> X, Y, Z;
+		_mm_store_ps(X.data(), _mm_or_ps(_mm_and_ps(IsCenterValid, _mm_mul_ps(RayX, Center)), _mm_andnot_ps(IsCenterValid, Invalid)));
+		_mm_store_ps(Y.data(), _mm_or_ps(_mm_and_ps(IsCenterValid, _mm_mul_ps(RayY, Center)), _mm_andnot_ps(IsCenterValid, Invalid)));
+		_mm_store_ps(Z.data(), _mm_or_ps(_mm_and_ps(IsCenterValid, Center), _mm_andnot_ps(IsCenterValid, Invalid)));
+
+		for (unsigned Lane = 0; Lane < Count; ++Lane)
+		{
+			Points[Index + Lane] = { X[Lane], Y[Lane], Z[Lane] };
+		}
+	}
+
+	bool IsBorder(_In_ unsigned X, _In_ unsigned Y)
+	{
+		return (X == 0) || (Y == 0) || (X + 1 >= Width) || (Y + 1 >= Height);
+	}
+}
+
+UINT32 DepthNormals::Pack(_In_ float X, _In_ float Y, _In_ float Z)
+{
+	__m128 ValidMask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+	return static_cast<UINT32>(_mm_cvtsi128_si32(PackOctahedral(_mm_set1_ps(X), _mm_set1_ps(Y), _mm_set1_ps(Z), ValidMask)));
+}
+
+void DepthNormals::Estimate(_In_ const Kinect::CameraSpacePointList & Points, _In_ const DepthRegion & Region, _Inout_ Kinect::NormalList & Normals)
+{
+	concurrency::parallel_for(Region.Top, Region.Bottom, [&](unsigned Y)
+	{
+		for (unsigned X = Region.Left; X < Region.Right;)
+		{
+			size_t Index = X + Y * Width;
+
+			if (IsBorder(X, Y))
+			{
+				Normals[Index] = NoNormal;
+				++X;
+			}
+			else if ((X + 4 <= Region.Right) && (X + 4 < Width))
+			{
+				EstimatePixels<4>(Points.data(), Index, Normals.data());
+				X += 4;
+			}
+			else
+			{
+				EstimatePixels<1>(Points.data(), Index, Normals.data());
+				++X;
+			}
+		}
+	});
+}
+
+void DepthNormals::MapDepthRegionToCameraSpace(_In_ const DepthFilter::DepthPixelList & DepthPixels, _In_ const Kinect::CameraSpaceTable & Table, _In_ const DepthRegion & Region, _Inout_ Kinect::CameraSpacePointList & Points, _Inout_ Kinect::NormalList & Normals, _Inout_opt_ DepthStatistics * Statistics)
+{
+	const float InvalidValue = -std::numeric_limits<float>::infinity();
+
+	concurrency::parallel_for(Region.Top, Region.Bottom, [&](unsigned Y)
+	{
+		for (unsigned X = Region.Left; X < Region.Right;)
+		{
+			size_t Index = X + Y * Width;
+
+			if (IsBorder(X, Y))
+			{
+				float Z = DepthPixels[Index] * MillimetersToMeters;
+
+				Points[Index] = (DepthPixels[Index] == 0) ? CameraSpacePoint{ InvalidValue, InvalidValue, InvalidValue } :
+					CameraSpacePoint{ Table[Index].X * Z, Table[Index].Y * Z, Z };
+				Normals[Index] = NoNormal;
+				++X;
+			}
+			else if ((X + 4 <= Region.Right) && (X + 4 < Width))
+			{
+				MapPixels<4>(DepthPixels.data(), Table.data(), Index, Points.data(), Normals.data());
+				X += 4;
+			}
+			else
+			{
+				MapPixels<1>(DepthPixels.data(), Table.data(), Index, Points.data(), Normals.data());
+				++X;
+			}
+		}
+
+		if (Statistics != nullptr)
+		{
+			Statistics->AddRow(&DepthPixels[Region.Left + Y * Width], Region.GetWidth());
+		}
+	});
+}
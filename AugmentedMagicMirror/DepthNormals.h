@@ -0,0 +1,24 @@
+#pragma once
+
+#include "DepthRegion.h"
+#include "DepthStatistics.h"
+#include "Kinect.h"
+
+// Estimates the normals of the organized depth point grid with central differences between the horizontal
+// and vertical neighbours of each pixel. Normals face the sensor and are packed octahedral into two signed
+// normalized 16 bit values, the layout of the NORMAL vertex attribute.
+class DepthNormals
+{
+public:
+	// Marks pixels without a normal, i.e. invalid pixels, pixels with an invalid neighbour and the image border
+	static constexpr UINT32 NoNormal = 0;
+
+	static UINT32 Pack(_In_ float X, _In_ float Y, _In_ float Z);
+
+	// Separate pass over points converted before; only normals inside Region are written
+	static void Estimate(_In_ const Kinect::CameraSpacePointList & Points, _In_ const DepthRegion & Region, _Inout_ Kinect::NormalList & Normals);
+
+	// Kinect::MapDepthRegionToCameraSpace with the normals estimated in the same sweep over the depth pixels;
+	// each converted row is added to Statistics, if given, while it is still in the cache
+	static void MapDepthRegionToCameraSpace(_In_ const DepthFilter::DepthPixelList & DepthPixels, _In_ const Kinect::CameraSpaceTable & Table, _In_ const DepthRegion & Region, _Inout_ Kinect::CameraSpacePointList & Points, _Inout_ Kinect::NormalList & Normals, _Inout_opt_ DepthStatistics * Statistics = nullptr);
+};
@@ -0,0 +1,260 @@
+// DepthOccupancyGrid.cpp : Voxel occupancy of the depth points for interaction queries
+//
+
+#include "stdafx.h"
+#include "DepthOccupancyGrid.h"
+
+DepthOccupancyGrid::DepthOccupancyGrid()
+	:Occupancy((VoxelCount + WordBits - 1) / WordBits), Offset(), RealWorldToVirtualScale(1.f)
+	, BuildTime(L"Depth Occupancy")
+{
+	for (std::atomic<UINT64> & Word : Occupancy)
+	{
+		Word.store(0, std::memory_order_relaxed);
+	}
+}
+
+void DepthOccupancyGrid::SetWorldTransform(_In_ const Vector3 & Offset, _In_ float RealWorldToVirtualScale)
+{
+	this->Offset = Offset;
+	this->RealWorldToVirtualScale = RealWorldToVirtualScale;
+}
+
+void DepthOccupancyGrid::Build(_In_ const Kinect::CameraSpacePointList & Points, _In_ const DepthRegion & Region)
+{
+	constexpr float InverseVoxelSize = 1.f / VoxelSize;
+
+	if (Points.size() != Kinect::DepthImageWidth * Kinect::DepthImageHeigth)
+	{
+		return;
+	}
+
+	BuildTime.Start();
+
+	for (std::atomic<UINT64> & Word : Occupancy)
+	{
+		Word.store(0, std::memory_order_relaxed);
+	}
+
+	concurrency::parallel_for(Region.Top, Region.Bottom, [&](unsigned Y)
+	{
+		size_t LastVoxel = VoxelCount;
+
+		for (unsigned X = Region.Left; X < Region.Right; ++X)
+		{
+			const CameraSpacePoint & Point = Points[X + Y * Kinect::DepthImageWidth];
+
+			float VoxelX = (Point.X - MinimumX) * InverseVoxelSize;
+			float VoxelY = (Point.Y - MinimumY) * InverseVoxelSize;
+			float VoxelZ = (Point.Z - MinimumZ) * InverseVoxelSize;
+
+			// Invalid points are -inf and fail the comparisons
+			if (!((VoxelX >= 0.f) && (VoxelX < SizeX) && (VoxelY >= 0.f) && (VoxelY < SizeY) && (VoxelZ >= 0.f) && (VoxelZ < SizeZ)))
+			{
+				continue;
+			}
+
+			size_t Voxel = static_cast<size_t>(VoxelX) + SizeX * (static_cast<size_t>(VoxelY) + SizeY * static_cast<size_t>(VoxelZ));
+
+			// Neighbouring pixels mostly fall into the same voxel, which is set only once
+			if (Voxel == LastVoxel)
+			{
+				continue;
+			}
+
+			LastVoxel = Voxel;
+			Occupancy[Voxel / WordBits].fetch_or(UINT64(1) << (Voxel % WordBits), std::memory_order_relaxed);
+		}
+	});
+
+	BuildTime.Stop();
+}
+
+bool DepthOccupancyGrid::IsOccupied(_In_ const Vector3 & Position) const
+{
+	float X, Y, Z;
+	ToVoxelSpace(Position, X, Y, Z);
+
+	return IsVoxelOccupied(static_cast<int>(std::floor(X)), static_cast<int>(std::floor(Y)), static_cast<int>(std::floor(Z)));
+}
+
+bool DepthOccupancyGrid::IsOccupied(_In_ const Transform & Object) const
+{
+	return IsOccupied(Object.GetPosition());
+}
+
+bool DepthOccupancyGrid::IntersectsSphere(_In_ const Vector3 & Center, _In_ float Radius) const
+{
+	float CenterX, CenterY, CenterZ;
+	ToVoxelSpace(Center, CenterX, CenterY, CenterZ);
+
+	float VoxelRadius = Radius / (RealWorldToVirtualScale * VoxelSize);
+	float SquaredRadius = VoxelRadius * VoxelRadius;
+
+	int FirstX = (std::max)(0, static_cast<int>(std::floor(CenterX - VoxelRadius)));
+	int FirstY = (std::max)(0, static_cast<int>(std::floor(CenterY - VoxelRadius)));
+	int FirstZ = (std::max)(0, static_cast<int>(std::floor(CenterZ - VoxelRadius)));
+	int LastX = (std::min)(static_cast<int>(SizeX) - 1, static_cast<int>(std::floor(CenterX + VoxelRadius)));
+	int LastY = (std::min)(static_cast<int>(SizeY) - 1, static_cast<int>(std::floor(CenterY + VoxelRadius)));
+	int LastZ = (std::min)(static_cast<int>(SizeZ) - 1, static_cast<int>(std::floor(CenterZ + VoxelRadius)));
+
+	// Distance from the center to the closest point of the voxel
+	auto Distance = [](float Center, int Voxel)
+	{
+		return (std::max)((std::max)(Voxel - Center, Center - (Voxel + 1)), 0.f);
+	};
+
+	for (int Z = FirstZ; Z <= LastZ; ++Z)
+		for (int Y = FirstY; Y <= LastY; ++Y)
+			for (int X = FirstX; X <= LastX; ++X)
+			{
+				if (!IsVoxelOccupied(X, Y, Z))
+				{
+					continue;
+				}
+
+				float DistanceX = Distance(CenterX, X);
+				float DistanceY = Distance(CenterY, Y);
+				float DistanceZ = Distance(CenterZ, Z);
+
+				if (DistanceX * DistanceX + DistanceY * DistanceY + DistanceZ * DistanceZ <= SquaredRadius)
+				{
+					return true;
+				}
+			}
+
+	return false;
+}
+
+bool DepthOccupancyGrid::IntersectsSphere(_In_ const Transform & Object, _In_ float Radius) const
+{
+	return IntersectsSphere(Object.GetPosition(), Radius);
+}
+
+bool DepthOccupancyGrid::IntersectRay(_In_ const Vector3 & Origin, _In_ const Vector3 & Direction, _In_ float MaxDistance, _Out_ float & Distance) const
+{
+	const float Infinity = std::numeric_limits<float>::infinity();
+	const float VoxelsPerUnit = 1.f / (RealWorldToVirtualScale * VoxelSize);
+	const std::array<int, 3> Size = { SizeX, SizeY, SizeZ };
+
+	std::array<float, 3> Start;
+	ToVoxelSpace(Origin, Start[0], Start[1], Start[2]);
+	std::array<float, 3> Step = { Direction.X * VoxelsPerUnit, Direction.Y * VoxelsPerUnit, -Direction.Z * VoxelsPerUnit };
+
+	Distance = MaxDistance;
+
+	// Clip the ray to the grid
+	float Enter = 0.f;
+	float Exit = MaxDistance;
+
+	for (size_t Axis = 0; Axis < 3; ++Axis)
+	{
+		if (Step[Axis] == 0.f)
+		{
+			if ((Start[Axis] < 0.f) || (Start[Axis] >= Size[Axis]))
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		float Near = -Start[Axis] / Step[Axis];
+		float Far = (Size[Axis] - Start[Axis]) / Step[Axis];
+
+		Enter = (std::max)(Enter, (std::min)(Near, Far));
+		Exit = (std::min)(Exit, (std::max)(Near, Far));
+	}
+
+	if (!(Enter <= Exit))
+	{
+		return false;
+	}
+
+	// Walk the voxels along the ray from the entry point
+	std::array<int, 3> Voxel;
+	std::array<int, 3> VoxelStep;
+	std::array<float, 3> NextBoundary;
+	std::array<float, 3> BoundaryDistance;
+
+	for (size_t Axis = 0; Axis < 3; ++Axis)
+	{
+		float Position = Start[Axis] + Step[Axis] * Enter;
+		Voxel[Axis] = (std::min)((std::max)(static_cast<int>(std::floor(Position)), 0), Size[Axis] - 1);
+
+		if (Step[Axis] > 0.f)
+		{
+			VoxelStep[Axis] = 1;
+			NextBoundary[Axis] = (Voxel[Axis] + 1 - Start[Axis]) / Step[Axis];
+			BoundaryDistance[Axis] = 1.f / Step[Axis];
+		}
+		else if (Step[Axis] < 0.f)
+		{
+			VoxelStep[Axis] = -1;
+			NextBoundary[Axis] = (Voxel[Axis] - Start[Axis]) / Step[Axis];
+			BoundaryDistance[Axis] = -1.f / Step[Axis];
+		}
+		else
+		{
+			VoxelStep[Axis] = 0;
+			NextBoundary[Axis] = Infinity;
+			BoundaryDistance[Axis] = Infinity;
+		}
+	}
+
+	for (float Current = Enter; Current <= Exit;)
+	{
+		if (IsVoxelOccupied(Voxel[0], Voxel[1], Voxel[2]))
+		{
+			Distance = Current;
+			return true;
+		}
+
+		size_t Axis = (NextBoundary[0] < NextBoundary[1]) ? ((NextBoundary[0] < NextBoundary[2]) ? 0 : 2) : ((NextBoundary[1] < NextBoundary[2]) ? 1 : 2);
+
+		Current = NextBoundary[Axis];
+		NextBoundary[Axis] += BoundaryDistance[Axis];
+		Voxel[Axis] += VoxelStep[Axis];
+
+		if ((Voxel[Axis] < 0) || (Voxel[Axis] >= Size[Axis]))
+		{
+			return false;
+		}
+	}
+
+	return false;
+}
+
+size_t DepthOccupancyGrid::GetOccupiedCount() const
+{
+	size_t Count = 0;
+
+	for (const std::atomic<UINT64> & Word : Occupancy)
+	{
+		Count += std::bitset<WordBits>(Word.load(std::memory_order_relaxed)).count();
+	}
+
+	return Count;
+}
+
+void DepthOccupancyGrid::ToVoxelSpace(_In_ const Vector3 & Position, _Out_ float & X, _Out_ float & Y, _Out_ float & Z) const
+{
+	// The depth mesh is placed with its Z axis mirrored
+	const float VoxelsPerUnit = 1.f / (RealWorldToVirtualScale * VoxelSize);
+
+	X = (Position.X - Offset.X) * VoxelsPerUnit - MinimumX / VoxelSize;
+	Y = (Position.Y - Offset.Y) * VoxelsPerUnit - MinimumY / VoxelSize;
+	Z = (Offset.Z - Position.Z) * VoxelsPerUnit - MinimumZ / VoxelSize;
+}
+
+bool DepthOccupancyGrid::IsVoxelOccupied(_In_ int X, _In_ int Y, _In_ int Z) const
+{
+	if ((X < 0) || (Y < 0) || (Z < 0) || (X >= static_cast<int>(SizeX)) || (Y >= static_cast<int>(SizeY)) || (Z >= static_cast<int>(SizeZ)))
+	{
+		return false;
+	}
+
+	size_t Voxel = X + SizeX * (Y + SizeY * static_cast<size_t>(Z));
+
+	return (Occupancy[Voxel / WordBits].load(std::memory_order_relaxed) & (UINT64(1) << (Voxel % WordBits))) != 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "DepthRegion.h"
+#include "Kinect.h"
+#include "PerformanceCounter.h"
+#include "Transform.h"
+
+// Bitset of the voxels occupied by depth points, rebuilt every depth frame, for interaction queries of virtual
+// objects against the user. The grid covers the sensor's useful range; queries take virtual world positions.
+class DepthOccupancyGrid
+{
+public:
+	DepthOccupancyGrid();
+
+	// Maps virtual world positions to sensor space the same way the depth mesh is placed
+	void SetWorldTransform(_In_ const Vector3 & Offset, _In_ float RealWorldToVirtualScale);
+
+	void Build(_In_ const Kinect::CameraSpacePointList & Points, _In_ const DepthRegion & Region);
+
+	bool IsOccupied(_In_ const Vector3 & Position) const;
+	bool IsOccupied(_In_ const Transform & Object) const;
+
+	bool IntersectsSphere(_In_ const Vector3 & Center, _In_ float Radius) const;
+	bool IntersectsSphere(_In_ const Transform & Object, _In_ float Radius) const;
+
+	// Distance is along Direction in its units, i.e. in virtual world units for a normalized Direction
+	bool IntersectRay(_In_ const Vector3 & Origin, _In_ const Vector3 & Direction, _In_ float MaxDistance, _Out_ float & Distance) const;
+
+	size_t GetOccupiedCount() const;
+
+private:
+	// 5cm voxels over 5m x 4m x 4m in front of the sensor
+	static constexpr float VoxelSize = 0.05f;
+	static constexpr unsigned SizeX = 100;
+	static constexpr unsigned SizeY = 80;
+	static constexpr unsigned SizeZ = 80;
+	static constexpr float MinimumX = -2.5f;
+	static constexpr float MinimumY = -2.0f;
+	static constexpr float MinimumZ = 0.5f;
+
+	static constexpr size_t VoxelCount = SizeX * SizeY * SizeZ;
+	static constexpr size_t WordBits = 64;
+
+	// Depth rows are inserted in parallel, so words are set atomically
+	std::vector<std::atomic<UINT64>> Occupancy;
+
+	Vector3 Offset;
+	float RealWorldToVirtualScale;
+
+	PerformanceCounter BuildTime;
+
+	// Voxel coordinates as floats, voxel (X, Y, Z) spans [X, X + 1) in each direction
+	void ToVoxelSpace(_In_ const Vector3 & Position, _Out_ float & X, _Out_ float & Y, _Out_ float & Z) const;
+	bool IsVoxelOccupied(_In_ int X, _In_ int Y, _In_ int Z) const;
+};
@@ -0,0 +1,312 @@
+// DepthQuadtree.cpp : Adaptive, crack free triangulation of the depth point grid
+//
+
+#include "stdafx.h"
+#include "DepthQuadtree.h"
+
+namespace
+{
+	// Deviation from the bilinear interpolation of the node corners allowed in a planar node, in meters
+	constexpr float PlanarTolerance = 0.004f;
+	constexpr float PlanarToleranceSlope = 0.004f;
+}
+
+DepthQuadtree::DepthQuadtree(_In_ unsigned Width, _In_ unsigned Height)
+	:Width(Width), Height(Height), Region{ 0, 0, Width, Height }
+	, Depth(Width * Height)
+	, BuildTime(L"Depth Quadtree")
+{
+	// Nodes cover grid cells, i.e. the quads between four neighbouring points
+	unsigned CellsX = Width - 1;
+	unsigned CellsY = Height - 1;
+
+	for (unsigned LevelIndex = 0; LevelIndex < LevelCount; ++LevelIndex)
+	{
+		Level & NodeLevel = Levels[LevelIndex];
+		NodeLevel.Size = 1u << LevelIndex;
+		NodeLevel.NodesX = (CellsX + NodeLevel.Size - 1) / NodeLevel.Size;
+		NodeLevel.NodesY = (CellsY + NodeLevel.Size - 1) / NodeLevel.Size;
+		NodeLevel.Split.assign(NodeLevel.NodesX * NodeLevel.NodesY, false);
+	}
+
+	// Enough for the full resolution, so emitting never reallocates
+	RootRowIndices.resize(Levels[LevelCount - 1].NodesY);
+	for (Mesh::IndexList & RowIndices : RootRowIndices)
+	{
+		RowIndices.reserve(Levels[LevelCount - 1].Size * CellsX * 6);
+	}
+	Indices.reserve(CellsX * CellsY * 6);
+}
+
+void DepthQuadtree::Build(_In_ const Kinect::CameraSpacePointList & Points, _In_ bool Decimate, _In_ const DepthRegion & Region)
+{
+	if ((Points.size() != Depth.size()) || (Region.Right > Width) || (Region.Bottom > Height))
+	{
+		return;
+	}
+
+	BuildTime.Start();
+
+	this->Region = Region;
+
+	// The planarity test streams through a dense depth plane instead of the interleaved points; rows outside the region are never read
+	std::transform(Points.begin() + Region.Top * Width, Points.begin() + Region.Bottom * Width, Depth.begin() + Region.Top * Width, [](const CameraSpacePoint & Point) { return Point.Z; });
+
+	if (Decimate)
+	{
+		for (unsigned LevelIndex = 1; LevelIndex < LevelCount; ++LevelIndex)
+		{
+			SplitLevel(LevelIndex);
+		}
+	}
+	else
+	{
+		for (unsigned LevelIndex = 1; LevelIndex < LevelCount; ++LevelIndex)
+		{
+			std::fill(Levels[LevelIndex].Split.begin(), Levels[LevelIndex].Split.end(), static_cast<char>(true));
+		}
+	}
+
+	const Level & Root = Levels[LevelCount - 1];
+
+	concurrency::parallel_for(0u, Root.NodesY, [&](unsigned RootY)
+	{
+		Mesh::IndexList & Target = RootRowIndices[RootY];
+		Target.clear();
+
+		for (unsigned RootX = 0; RootX < Root.NodesX; ++RootX)
+		{
+			EmitNode(LevelCount - 1, RootX, RootY, Target);
+		}
+	});
+
+	Indices.clear();
+	for (const Mesh::IndexList & RowIndices : RootRowIndices)
+	{
+		Indices.insert(Indices.end(), RowIndices.begin(), RowIndices.end());
+	}
+
+	BuildTime.Stop();
+}
+
+const Mesh::IndexList & DepthQuadtree::GetIndices() const
+{
+	return Indices;
+}
+
+size_t DepthQuadtree::GetTriangleCount() const
+{
+	return Indices.size() / 3;
+}
+
+void DepthQuadtree::SplitLevel(_In_ unsigned LevelIndex)
+{
+	Level & NodeLevel = Levels[LevelIndex];
+
+	// Levels are processed from fine to coarse, so the children and their neighbours are final here
+	concurrency::parallel_for(0u, NodeLevel.NodesY, [&](unsigned Y)
+	{
+		for (unsigned X = 0; X < NodeLevel.NodesX; ++X)
+		{
+			bool Split = (LevelIndex > 1) &&
+				(IsSplit(LevelIndex - 1, 2 * X, 2 * Y) || IsSplit(LevelIndex - 1, 2 * X + 1, 2 * Y) ||
+				 IsSplit(LevelIndex - 1, 2 * X, 2 * Y + 1) || IsSplit(LevelIndex - 1, 2 * X + 1, 2 * Y + 1) ||
+				 HasSplitNeighbourChild(LevelIndex, X, Y));
+
+			NodeLevel.Split[X + Y * NodeLevel.NodesX] = Split || !IsPlanar(NodeLevel.Size, X * NodeLevel.Size, Y * NodeLevel.Size);
+		}
+	});
+}
+
+bool DepthQuadtree::IsPlanar(_In_ unsigned Size, _In_ unsigned X, _In_ unsigned Y) const
+{
+	// Nodes reaching over the region or the image border are never planar
+	if ((X < Region.Left) || (Y < Region.Top) || (X + Size >= Region.Right) || (Y + Size >= Region.Bottom))
+	{
+		return false;
+	}
+
+	const float * Row = Depth.data() + X + Y * Width;
+	const float * LastRow = Row + Size * Width;
+
+	float TopLeft = Row[0];
+	float TopRight = Row[Size];
+	float BottomLeft = LastRow[0];
+	float BottomRight = LastRow[Size];
+
+	// Invalid points are -inf, which fails the comparisons below as well
+	float MaxDeviation = PlanarTolerance + PlanarToleranceSlope * (std::min)((std::min)(TopLeft, TopRight), (std::min)(BottomLeft, BottomRight));
+	if (!(MaxDeviation > 0.f))
+	{
+		return false;
+	}
+
+	const float InverseSize = 1.f / Size;
+	const __m128 AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 Tolerance = _mm_set1_ps(MaxDeviation);
+	const __m128 Steps = _mm_set_ps(3.f * InverseSize, 2.f * InverseSize, InverseSize, 0.f);
+
+	for (unsigned RowIndex = 0; RowIndex <= Size; ++RowIndex, Row += Width)
+	{
+		float Weight = RowIndex * InverseSize;
+		float Left = TopLeft + (BottomLeft - TopLeft) * Weight;
+		float Right = TopRight + (BottomRight - TopRight) * Weight;
+		float Slope = Right - Left;
+
+		unsigned Column = 0;
+
+		// Four points per step; the last column and nodes of size two are tested scalar
+		for (; Column + 4 <= Size; Column += 4)
+		{
+			__m128 Expected = _mm_add_ps(_mm_set1_ps(Left + Slope * Column * InverseSize), _mm_mul_ps(_mm_set1_ps(Slope), Steps));
+			__m128 Deviation = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(Row + Column), Expected), AbsMask);
+
+			if (_mm_movemask_ps(_mm_cmple_ps(Deviation, Tolerance)) != 0xF)
+			{
+				return false;
+			}
+		}
+
+		for (; Column <= Size; ++Column)
+		{
+			float Expected = Left + Slope * Column * InverseSize;
+
+			if (!(std::fabs(Row[Column] - Expected) <= MaxDeviation))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool DepthQuadtree::IsSplit(_In_ unsigned LevelIndex, _In_ int X, _In_ int Y) const
+{
+	const Level & NodeLevel = Levels[LevelIndex];
+
+	if ((LevelIndex == 0) || (X < 0) || (Y < 0) || (X >= static_cast<int>(NodeLevel.NodesX)) || (Y >= static_cast<int>(NodeLevel.NodesY)))
+	{
+		return false;
+	}
+
+	return NodeLevel.Split[X + Y * NodeLevel.NodesX] != 0;
+}
+
+bool DepthQuadtree::HasSplitNeighbourChild(_In_ unsigned LevelIndex, _In_ unsigned X, _In_ unsigned Y) const
+{
+	// Leaving this node unsplit next to a split child of a neighbour would break the 2:1 restriction
+	int ChildLevel = LevelIndex - 1;
+	int Left = 2 * X;
+	int Top = 2 * Y;
+
+	return IsSplit(ChildLevel, Left - 1, Top) || IsSplit(ChildLevel, Left - 1, Top + 1) ||
+		IsSplit(ChildLevel, Left + 2, Top) || IsSplit(ChildLevel, Left + 2, Top + 1) ||
+		IsSplit(ChildLevel, Left, Top - 1) || IsSplit(ChildLevel, Left + 1, Top - 1) ||
+		IsSplit(ChildLevel, Left, Top + 2) || IsSplit(ChildLevel, Left + 1, Top + 2);
+}
+
+void DepthQuadtree::EmitNode(_In_ unsigned LevelIndex, _In_ unsigned X, _In_ unsigned Y, _Inout_ Mesh::IndexList & Target) const
+{
+	const Level & NodeLevel = Levels[LevelIndex];
+
+	if ((X >= NodeLevel.NodesX) || (Y >= NodeLevel.NodesY))
+	{
+		return;
+	}
+
+	// Nodes without a cell inside the region are skipped with all their children
+	if (((X + 1) * NodeLevel.Size <= Region.Left) || ((Y + 1) * NodeLevel.Size <= Region.Top) ||
+		(X * NodeLevel.Size + 1 >= Region.Right) || (Y * NodeLevel.Size + 1 >= Region.Bottom))
+	{
+		return;
+	}
+
+	if (LevelIndex == 0)
+	{
+		EmitCell(X, Y, Target);
+	}
+	else if (IsSplit(LevelIndex, X, Y))
+	{
+		EmitNode(LevelIndex - 1, 2 * X, 2 * Y, Target);
+		EmitNode(LevelIndex - 1, 2 * X + 1, 2 * Y, Target);
+		EmitNode(LevelIndex - 1, 2 * X, 2 * Y + 1, Target);
+		EmitNode(LevelIndex - 1, 2 * X + 1, 2 * Y + 1, Target);
+	}
+	else
+	{
+		EmitLeaf(LevelIndex, X, Y, Target);
+	}
+}
+
+void DepthQuadtree::EmitCell(_In_ unsigned X, _In_ unsigned Y, _Inout_ Mesh::IndexList & Target) const
+{
+	if ((X < Region.Left) || (Y < Region.Top) || (X + 1 >= Region.Right) || (Y + 1 >= Region.Bottom))
+	{
+		return;
+	}
+
+	Mesh::Index UpperLeft = X + Y * Width;
+	bool IsUpperLeftValid = std::isfinite(Depth[UpperLeft]);
+	bool IsUpperRightValid = std::isfinite(Depth[UpperLeft + 1]);
+	bool IsLowerLeftValid = std::isfinite(Depth[UpperLeft + Width]);
+	bool IsLowerRightValid = std::isfinite(Depth[UpperLeft + Width + 1]);
+
+	// Same winding as Mesh::CreatePlane; triangles touching invalid points are dropped
+	if (IsUpperLeftValid && IsUpperRightValid && IsLowerLeftValid)
+	{
+		Target.push_back(UpperLeft);
+		Target.push_back(UpperLeft + 1);
+		Target.push_back(UpperLeft + Width);
+	}
+
+	if (IsUpperRightValid && IsLowerRightValid && IsLowerLeftValid)
+	{
+		Target.push_back(UpperLeft + 1);
+		Target.push_back(UpperLeft + Width + 1);
+		Target.push_back(UpperLeft + Width);
+	}
+}
+
+void DepthQuadtree::EmitLeaf(_In_ unsigned LevelIndex, _In_ unsigned X, _In_ unsigned Y, _Inout_ Mesh::IndexList & Target) const
+{
+	unsigned Size = Levels[LevelIndex].Size;
+	unsigned Half = Size / 2;
+
+	Mesh::Index TopLeft = X * Size + Y * Size * Width;
+	Mesh::Index TopRight = TopLeft + Size;
+	Mesh::Index BottomLeft = TopLeft + Size * Width;
+	Mesh::Index BottomRight = BottomLeft + Size;
+
+	bool IsTopFiner = IsSplit(LevelIndex, X, static_cast<int>(Y) - 1);
+	bool IsRightFiner = IsSplit(LevelIndex, X + 1, Y);
+	bool IsBottomFiner = IsSplit(LevelIndex, X, Y + 1);
+	bool IsLeftFiner = IsSplit(LevelIndex, static_cast<int>(X) - 1, Y);
+
+	if (!IsTopFiner && !IsRightFiner && !IsBottomFiner && !IsLeftFiner)
+	{
+		Target.insert(Target.end(), { TopLeft, TopRight, BottomLeft, TopRight, BottomRight, BottomLeft });
+		return;
+	}
+
+	// Fan around the center through the edge midpoints shared with finer neighbours
+	std::array<Mesh::Index, 9> Outline;
+	size_t OutlineSize = 0;
+
+	Outline[OutlineSize++] = TopLeft;
+	if (IsTopFiner) Outline[OutlineSize++] = TopLeft + Half;
+	Outline[OutlineSize++] = TopRight;
+	if (IsRightFiner) Outline[OutlineSize++] = TopRight + Half * Width;
+	Outline[OutlineSize++] = BottomRight;
+	if (IsBottomFiner) Outline[OutlineSize++] = BottomLeft + Half;
+	Outline[OutlineSize++] = BottomLeft;
+	if (IsLeftFiner) Outline[OutlineSize++] = TopLeft + Half * Width;
+	Outline[OutlineSize] = TopLeft;
+
+	Mesh::Index Center = TopLeft + Half + Half * Width;
+
+	for (size_t Corner = 0; Corner < OutlineSize; ++Corner)
+	{
+		Target.insert(Target.end(), { Outline[Corner], Outline[Corner + 1], Center });
+	}
+}
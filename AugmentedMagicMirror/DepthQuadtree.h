@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Kinect.h"
+#include "Mesh.h"
+#include "PerformanceCounter.h"
+
+// Triangulates the organized depth point grid with a restricted quadtree: planar regions get coarse
+// triangles, silhouettes stay at full resolution. Neighbouring leaves differ at most by one level and
+// coarse leaves fan to the midpoints of finer neighbours, so the mesh has no cracks.
+class DepthQuadtree
+{
+public:
+	DepthQuadtree(_In_ unsigned Width, _In_ unsigned Height);
+
+	// Without decimation every valid grid cell is emitted, like the full plane; only cells inside the region are emitted
+	void Build(_In_ const Kinect::CameraSpacePointList & Points, _In_ bool Decimate, _In_ const DepthRegion & Region);
+
+	const Mesh::IndexList & GetIndices() const;
+	size_t GetTriangleCount() const;
+
+private:
+	// Leaves span 1 to 16 grid cells in each direction
+	static constexpr unsigned LevelCount = 5;
+
+	struct Level
+	{
+		unsigned Size;
+		unsigned NodesX;
+		unsigned NodesY;
+		std::vector<char> Split;
+	};
+
+	const unsigned Width;
+	const unsigned Height;
+
+	std::array<Level, LevelCount> Levels;
+	DepthRegion Region;
+	std::vector<float> Depth;
+	std::vector<Mesh::IndexList> RootRowIndices;
+	Mesh::IndexList Indices;
+
+	PerformanceCounter BuildTime;
+
+	void SplitLevel(_In_ unsigned LevelIndex);
+	bool IsPlanar(_In_ unsigned Size, _In_ unsigned X, _In_ unsigned Y) const;
+	bool IsSplit(_In_ unsigned LevelIndex, _In_ int X, _In_ int Y) const;
+	bool HasSplitNeighbourChild(_In_ unsigned LevelIndex, _In_ unsigned X, _In_ unsigned Y) const;
+
+	void EmitNode(_In_ unsigned LevelIndex, _In_ unsigned X, _In_ unsigned Y, _Inout_ Mesh::IndexList & Target) const;
+	void EmitCell(_In_ unsigned X, _In_ unsigned Y, _Inout_ Mesh::IndexList & Target) const;
+	void EmitLeaf(_In_ unsigned LevelIndex, _In_ unsigned X, _In_ unsigned Y, _Inout_ Mesh::IndexList & Target) const;
+};
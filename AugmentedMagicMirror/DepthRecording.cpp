@@ -0,0 +1,150 @@
+// DepthRecording.cpp : A sequence of raw depth frames that can be stored to and replayed from disk
+//
+
+#include "stdafx.h"
+#include "DepthRecording.h"
+
+const std::wstring DepthRecording::DefaultFilename = L"DepthRecording.bin";
+
+DepthRecording::DepthRecording(_In_ unsigned Width, _In_ unsigned Height, _In_ size_t MaxFrameCount)
+	:Width(Width), Height(Height), MaxFrameCount(MaxFrameCount)
+{
+}
+
+DepthRecording DepthRecording::CreateSynthetic(_In_ unsigned Width, _In_ unsigned Height, _In_ size_t FrameCount)
+{
+	constexpr UINT16 WallDepth = 3000;
+	constexpr UINT16 UserDepth = 1500;
+	constexpr float NoiseRatio = 0.01f;
+
+	DepthRecording Recording(Width, Height, FrameCount);
+	UINT32 RandomState = 0x12345678;
+
+	auto NextRandom = [&RandomState]()
+	{
+		RandomState = RandomState * 1664525u + 1013904223u;
+		return static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+	};
+
+	for (size_t FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+	{
+		Frame DepthPixels(Width * Height);
+
+		// An ellipse standing in for the user, slowly swaying in front of a static wall
+		float CenterX = Width * (0.5f + 0.15f * std::sin(static_cast<float>(FrameIndex) * 0.05f));
+		float CenterY = Height * 0.55f;
+		float RadiusX = Width * 0.15f;
+		float RadiusY = Height * 0.4f;
+
+		for (unsigned Y = 0; Y < Height; ++Y)
+			for (unsigned X = 0; X < Width; ++X)
+			{
+				float DistanceX = (X - CenterX) / RadiusX;
+				float DistanceY = (Y - CenterY) / RadiusY;
+				float Distance = DistanceX * DistanceX + DistanceY * DistanceY;
+
+				UINT16 Depth = (Distance <= 1.0f) ? UserDepth : WallDepth;
+				float Noise = (NextRandom() - 0.5f) * 2.0f * NoiseRatio * Depth;
+
+				// Silhouette edges drop out randomly, like hair or dark clothing does
+				bool IsEdge = std::fabs(Distance - 1.0f) < 0.05f;
+				bool IsDropout = IsEdge && (NextRandom() < 0.5f);
+
+				DepthPixels[X + Y * Width] = IsDropout ? 0 : static_cast<UINT16>(Depth + Noise);
+			}
+
+		Recording.AddFrame(DepthPixels);
+	}
+
+	return Recording;
+}
+
+// Only the Visual C++ file streams open wide paths, the portable build reads and writes streams
+#ifndef USE_PORTABLE
+bool DepthRecording::Load(_In_ const std::wstring & Path)
+{
+	std::ifstream File(Path, std::ios::binary);
+
+	return File && Load(File);
+}
+
+bool DepthRecording::Save(_In_ const std::wstring & Path) const
+{
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+
+	return File && Save(File);
+}
+#endif // !USE_PORTABLE
+
+bool DepthRecording::Load(_Inout_ std::istream & Stream)
+{
+	UINT32 Header[5] = {};
+	Stream.read(reinterpret_cast<char *>(Header), sizeof(Header));
+
+	if (!Stream || (Header[0] != FileMagic) || (Header[1] != FileVersion))
+	{
+		return false;
+	}
+
+	Width = Header[2];
+	Height = Header[3];
+	Frames.assign(Header[4], Frame(Width * Height));
+
+	for (Frame & DepthPixels : Frames)
+	{
+		Stream.read(reinterpret_cast<char *>(DepthPixels.data()), DepthPixels.size() * sizeof(Frame::value_type));
+	}
+
+	if (!Stream)
+	{
+		Frames.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool DepthRecording::Save(_Inout_ std::ostream & Stream) const
+{
+	UINT32 Header[5] = { FileMagic, FileVersion, Width, Height, static_cast<UINT32>(Frames.size()) };
+	Stream.write(reinterpret_cast<const char *>(Header), sizeof(Header));
+
+	for (const Frame & DepthPixels : Frames)
+	{
+		Stream.write(reinterpret_cast<const char *>(DepthPixels.data()), DepthPixels.size() * sizeof(Frame::value_type));
+	}
+
+	return static_cast<bool>(Stream);
+}
+
+bool DepthRecording::AddFrame(_In_ const Frame & DepthPixels)
+{
+	if ((Frames.size() >= MaxFrameCount) || (DepthPixels.size() != Width * Height))
+	{
+		return false;
+	}
+
+	Frames.push_back(DepthPixels);
+
+	return true;
+}
+
+void DepthRecording::Clear()
+{
+	Frames.clear();
+}
+
+unsigned DepthRecording::GetWidth() const
+{
+	return Width;
+}
+
+unsigned DepthRecording::GetHeight() const
+{
+	return Height;
+}
+
+const DepthRecording::FrameList & DepthRecording::GetFrames() const
+{
+	return Frames;
+}
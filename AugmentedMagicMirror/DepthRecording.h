@@ -0,0 +1,39 @@
+#pragma once
+
+#include "DepthFilter.h"
+
+class DepthRecording
+{
+public:
+	typedef DepthFilter::DepthPixelList Frame;
+	typedef std::vector<Frame> FrameList;
+
+	static const std::wstring DefaultFilename;
+
+	DepthRecording(_In_ unsigned Width, _In_ unsigned Height, _In_ size_t MaxFrameCount = 300);
+
+	static DepthRecording CreateSynthetic(_In_ unsigned Width, _In_ unsigned Height, _In_ size_t FrameCount);
+
+	bool Load(_In_ const std::wstring & Path);
+	bool Save(_In_ const std::wstring & Path) const;
+
+	// The same as the files, e.g. to check that a recording is replayed the way it was recorded
+	bool Load(_Inout_ std::istream & Stream);
+	bool Save(_Inout_ std::ostream & Stream) const;
+
+	bool AddFrame(_In_ const Frame & DepthPixels);
+	void Clear();
+
+	unsigned GetWidth() const;
+	unsigned GetHeight() const;
+	const FrameList & GetFrames() const;
+
+private:
+	static const UINT32 FileMagic = 0x444D4D41; // "AMMD"
+	static const UINT32 FileVersion = 1;
+
+	unsigned Width;
+	unsigned Height;
+	size_t MaxFrameCount;
+	FrameList Frames;
+};
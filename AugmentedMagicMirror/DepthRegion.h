@@ -0,0 +1,20 @@
+#pragma once
+
+// A rectangle of depth image pixels; Right and Bottom are exclusive
+struct DepthRegion
+{
+	unsigned Left;
+	unsigned Top;
+	unsigned Right;
+	unsigned Bottom;
+
+	unsigned GetWidth() const
+	{
+		return Right - Left;
+	}
+
+	unsigned GetHeight() const
+	{
+		return Bottom - Top;
+	}
+};
@@ -0,0 +1,121 @@
+// DepthRegionOfInterest.cpp : Crops the depth processing to the region around the tracked user
+//
+
+#include "stdafx.h"
+#include "DepthRegionOfInterest.h"
+
+namespace
+{
+	// Joints are inside the body, so the region is padded by about half a torso plus a few pixels of sensor noise
+	constexpr float PaddingMeters = 0.2f;
+	constexpr float PaddingPixels = 8.f;
+	constexpr float FocalLength = 365.f;
+
+	// The region grows at once but only shrinks this many pixels per body frame, so it does not flicker
+	constexpr unsigned ShrinkStep = 4;
+}
+
+DepthRegionOfInterest::DepthRegionOfInterest(_In_ ::Kinect & Kinect)
+	:Kinect(Kinect), Region(GetFullRegion()), Enabled(true)
+{
+	Kinect.BodyJointsUpdated += std::make_pair(this, &DepthRegionOfInterest::BodyJointsUpdatedCallback);
+}
+
+const DepthRegion & DepthRegionOfInterest::GetRegion() const
+{
+	return Region;
+}
+
+void DepthRegionOfInterest::KeyPressedCallback(_In_ const WPARAM & VirtualKey)
+{
+	if (VirtualKey == 'O')
+	{
+		Enabled = !Enabled;
+		SetRegion(GetFullRegion());
+	}
+}
+
+void DepthRegionOfInterest::BodyJointsUpdatedCallback(_In_ const Kinect::DepthSpacePointList & DepthSpaceJoints, _In_ const Kinect::CameraSpacePointList & CameraSpaceJoints)
+{
+	DepthRegion JointRegion;
+
+	if (!Enabled || !GetJointRegion(DepthSpaceJoints, CameraSpaceJoints, JointRegion))
+	{
+		SetRegion(GetFullRegion());
+		return;
+	}
+
+	auto Shrink = [](unsigned Current, unsigned Target)
+	{
+		if (Current < Target)
+		{
+			return (std::min)(Current + ShrinkStep, Target);
+		}
+
+		return (Current > Target + ShrinkStep) ? (Current - ShrinkStep) : Target;
+	};
+
+	DepthRegion NewRegion;
+	NewRegion.Left = (JointRegion.Left < Region.Left) ? JointRegion.Left : Shrink(Region.Left, JointRegion.Left);
+	NewRegion.Top = (JointRegion.Top < Region.Top) ? JointRegion.Top : Shrink(Region.Top, JointRegion.Top);
+	NewRegion.Right = (JointRegion.Right > Region.Right) ? JointRegion.Right : Shrink(Region.Right, JointRegion.Right);
+	NewRegion.Bottom = (JointRegion.Bottom > Region.Bottom) ? JointRegion.Bottom : Shrink(Region.Bottom, JointRegion.Bottom);
+
+	SetRegion(NewRegion);
+}
+
+bool DepthRegionOfInterest::GetJointRegion(_In_ const Kinect::DepthSpacePointList & DepthSpaceJoints, _In_ const Kinect::CameraSpacePointList & CameraSpaceJoints, _Out_ DepthRegion & JointRegion) const
+{
+	float Left = (std::numeric_limits<float>::max)();
+	float Top = (std::numeric_limits<float>::max)();
+	float Right = std::numeric_limits<float>::lowest();
+	float Bottom = std::numeric_limits<float>::lowest();
+	float NearestDepth = (std::numeric_limits<float>::max)();
+
+	for (size_t Index = 0; (Index < DepthSpaceJoints.size()) && (Index < CameraSpaceJoints.size()); ++Index)
+	{
+		const DepthSpacePoint & Joint = DepthSpaceJoints[Index];
+		float Depth = CameraSpaceJoints[Index].Z;
+
+		if (!std::isfinite(Joint.X) || !std::isfinite(Joint.Y) || !(Depth > 0.f))
+		{
+			continue;
+		}
+
+		Left = std::fmin(Left, Joint.X);
+		Top = std::fmin(Top, Joint.Y);
+		Right = std::fmax(Right, Joint.X);
+		Bottom = std::fmax(Bottom, Joint.Y);
+		NearestDepth = std::fmin(NearestDepth, Depth);
+	}
+
+	if (Left > Right)
+	{
+		return false;
+	}
+
+	float Padding = PaddingPixels + FocalLength * PaddingMeters / NearestDepth;
+
+	auto Clamp = [](float Value, unsigned Maximum)
+	{
+		return static_cast<unsigned>(std::fmax(0.f, std::fmin(Value, static_cast<float>(Maximum))));
+	};
+
+	JointRegion.Left = Clamp(std::floor(Left - Padding), Kinect::DepthImageWidth);
+	JointRegion.Top = Clamp(std::floor(Top - Padding), Kinect::DepthImageHeigth);
+	JointRegion.Right = Clamp(std::ceil(Right + Padding) + 1.f, Kinect::DepthImageWidth);
+	JointRegion.Bottom = Clamp(std::ceil(Bottom + Padding) + 1.f, Kinect::DepthImageHeigth);
+
+	return (JointRegion.Left < JointRegion.Right) && (JointRegion.Top < JointRegion.Bottom);
+}
+
+void DepthRegionOfInterest::SetRegion(_In_ const DepthRegion & NewRegion)
+{
+	Region = NewRegion;
+	Kinect.SetDepthRegion(Region);
+}
+
+DepthRegion DepthRegionOfInterest::GetFullRegion()
+{
+	return { 0, 0, Kinect::DepthImageWidth, Kinect::DepthImageHeigth };
+}
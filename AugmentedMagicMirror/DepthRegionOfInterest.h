@@ -0,0 +1,27 @@
+#pragma once
+
+#include "DepthRegion.h"
+#include "Kinect.h"
+
+// Restricts the depth processing to a padded rectangle around the joints of the tracked body,
+// as only the user can occlude virtual content. Without a tracked body the whole image is used.
+class DepthRegionOfInterest
+{
+public:
+	DepthRegionOfInterest(_In_ Kinect & Kinect);
+
+	const DepthRegion & GetRegion() const;
+
+	void KeyPressedCallback(_In_ const WPARAM & VirtualKey);
+
+private:
+	Kinect & Kinect;
+	DepthRegion Region;
+	bool Enabled;
+
+	void BodyJointsUpdatedCallback(_In_ const Kinect::DepthSpacePointList & DepthSpaceJoints, _In_ const Kinect::CameraSpacePointList & CameraSpaceJoints);
+	bool GetJointRegion(_In_ const Kinect::DepthSpacePointList & DepthSpaceJoints, _In_ const Kinect::CameraSpacePointList & CameraSpaceJoints, _Out_ DepthRegion & JointRegion) const;
+	void SetRegion(_In_ const DepthRegion & NewRegion);
+
+	static DepthRegion GetFullRegion();
+};
@@ -0,0 +1,154 @@
+// DepthStatistics.cpp : Valid ratio, nearest depth and depth histogram of the depth frames
+//
+
+#include "stdafx.h"
+#include "DepthStatistics.h"
+
+namespace
+{
+	constexpr float MillimetersToMeters = 0.001f;
+	constexpr unsigned PixelsPerVector = 8;
+}
+
+DepthStatistics::Accumulator::Accumulator()
+	:Bins(), PixelCount(0), ValidCount(0), Nearest(std::numeric_limits<UINT16>::max()), SampleLane(0)
+{
+}
+
+DepthStatistics::DepthStatistics()
+	:ValidRatio(L"Valid Depth", L"ratio"), NearestDepth(L"Nearest Depth", L"m"), MedianDepth(L"Median Depth", L"m")
+{
+}
+
+void DepthStatistics::Begin()
+{
+	RowAccumulators.clear();
+}
+
+void DepthStatistics::AddRow(_In_reads_(Count) const UINT16 * DepthPixels, _In_ unsigned Count)
+{
+	Accumulator & Row = RowAccumulators.local();
+
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i SignFlip = _mm_set1_epi16(static_cast<short>(0x8000));
+	const __m128i LastBin = _mm_set1_epi16(BinCount - 1);
+
+	// SSE2 only has a signed 16 bit minimum, so the unsigned depths are compared with flipped sign bits
+	__m128i Nearest = _mm_xor_si128(_mm_set1_epi16(static_cast<short>(Row.Nearest)), SignFlip);
+
+	// Each lane counts up to one invalid pixel per vector, a row has far less than 2^15 vectors
+	__m128i InvalidCounts = _mm_setzero_si128();
+	alignas(16) std::array<UINT16, PixelsPerVector> Bins;
+
+	unsigned X = 0;
+	for (; X + PixelsPerVector <= Count; X += PixelsPerVector)
+	{
+		__m128i Depth = _mm_loadu_si128(reinterpret_cast<const __m128i *>(DepthPixels + X));
+
+		// Invalid pixels are 0 and are raised to the maximum for the minimum
+		__m128i IsInvalid = _mm_cmpeq_epi16(Depth, Zero);
+		InvalidCounts = _mm_sub_epi16(InvalidCounts, IsInvalid);
+		Nearest = _mm_min_epi16(Nearest, _mm_xor_si128(_mm_or_si128(Depth, IsInvalid), SignFlip));
+
+		// SSE2 has no scatter, the sampled pixel of the vector rotates through the lanes so the samples do not form columns
+		_mm_store_si128(reinterpret_cast<__m128i *>(Bins.data()), _mm_min_epi16(_mm_srli_epi16(Depth, BinShift), LastBin));
+		++Row.Bins[Bins[Row.SampleLane]];
+		Row.SampleLane = (Row.SampleLane + 1) % PixelsPerVector;
+	}
+
+	Nearest = _mm_min_epi16(Nearest, _mm_shuffle_epi32(Nearest, _MM_SHUFFLE(1, 0, 3, 2)));
+	Nearest = _mm_min_epi16(Nearest, _mm_shuffle_epi32(Nearest, _MM_SHUFFLE(2, 3, 0, 1)));
+	Nearest = _mm_min_epi16(Nearest, _mm_shufflelo_epi16(Nearest, _MM_SHUFFLE(2, 3, 0, 1)));
+	Row.Nearest = static_cast<UINT16>(_mm_extract_epi16(_mm_xor_si128(Nearest, SignFlip), 0));
+
+	// Sums the eight lane counts
+	InvalidCounts = _mm_madd_epi16(InvalidCounts, _mm_set1_epi16(1));
+	InvalidCounts = _mm_add_epi32(InvalidCounts, _mm_shuffle_epi32(InvalidCounts, _MM_SHUFFLE(1, 0, 3, 2)));
+	InvalidCounts = _mm_add_epi32(InvalidCounts, _mm_shuffle_epi32(InvalidCounts, _MM_SHUFFLE(2, 3, 0, 1)));
+	UINT32 InvalidCount = static_cast<UINT32>(_mm_cvtsi128_si32(InvalidCounts));
+
+	for (; X < Count; ++X)
+	{
+		UINT16 Depth = DepthPixels[X];
+
+		InvalidCount += (Depth == 0) ? 1 : 0;
+		Row.Nearest = (Depth != 0) ? (std::min)(Row.Nearest, Depth) : Row.Nearest;
+	}
+
+	Row.PixelCount += Count;
+	Row.ValidCount += Count - InvalidCount;
+}
+
+void DepthStatistics::End()
+{
+	Frame = Accumulator();
+
+	RowAccumulators.combine_each([this](const Accumulator & Row)
+	{
+		for (unsigned Bin = 0; Bin < BinCount; ++Bin)
+		{
+			Frame.Bins[Bin] += Row.Bins[Bin];
+		}
+
+		Frame.PixelCount += Row.PixelCount;
+		Frame.ValidCount += Row.ValidCount;
+		Frame.Nearest = (std::min)(Frame.Nearest, Row.Nearest);
+	});
+
+	ValidRatio.AddSample(GetValidRatio());
+
+	if (Frame.ValidCount > 0)
+	{
+		NearestDepth.AddSample(GetNearestDepth());
+		MedianDepth.AddSample(GetPercentile(0.5f));
+	}
+}
+
+float DepthStatistics::GetValidRatio() const
+{
+	return (Frame.PixelCount > 0) ? static_cast<float>(Frame.ValidCount) / Frame.PixelCount : 0.f;
+}
+
+float DepthStatistics::GetNearestDepth() const
+{
+	return (Frame.ValidCount > 0) ? Frame.Nearest * MillimetersToMeters : 0.f;
+}
+
+float DepthStatistics::GetPercentile(_In_ float Percentile) const
+{
+	UINT32 SampleCount = std::accumulate(Frame.Bins.begin() + 1, Frame.Bins.end(), UINT32(0));
+
+	if (SampleCount == 0)
+	{
+		return 0.f;
+	}
+
+	// Linear within the bin the percentile falls into
+	float Target = Percentile * SampleCount;
+	float Accumulated = 0.f;
+
+	for (unsigned Bin = 1; Bin < BinCount; ++Bin)
+	{
+		float Count = static_cast<float>(Frame.Bins[Bin]);
+
+		if ((Count > 0.f) && (Accumulated + Count >= Target))
+		{
+			float Position = Bin + (std::max)(0.f, Target - Accumulated) / Count;
+			return Position * (1 << BinShift) * MillimetersToMeters;
+		}
+
+		Accumulated += Count;
+	}
+
+	return BinCount * (1 << BinShift) * MillimetersToMeters;
+}
+
+const DepthStatistics::Histogram & DepthStatistics::GetHistogram() const
+{
+	return Frame.Bins;
+}
+
+UINT32 DepthStatistics::GetValidCount() const
+{
+	return Frame.ValidCount;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "PerformanceCounter.h"
+
+// Per frame statistics of the depth pixels, gathered row by row while the rows are converted to camera space:
+// the ratio of valid pixels and the nearest depth over all pixels, and a histogram of the valid depths for
+// percentiles. The histogram samples one pixel out of eight, which keeps it within a few percent of the
+// conversion cost. Rows may be added in parallel between Begin and End; the values are published to the
+// performance counters.
+class DepthStatistics
+{
+public:
+	// 64mm bins up to 8.19m, deeper pixels are counted in the last bin
+	static constexpr unsigned BinShift = 6;
+	static constexpr unsigned BinCount = 128;
+	typedef std::array<UINT32, BinCount> Histogram;
+
+	DepthStatistics();
+
+	void Begin();
+	void AddRow(_In_reads_(Count) const UINT16 * DepthPixels, _In_ unsigned Count);
+	void End();
+
+	float GetValidRatio() const;
+
+	// In meters; 0 when there were no valid pixels
+	float GetNearestDepth() const;
+	float GetPercentile(_In_ float Percentile) const;
+
+	// Bin 0 holds the sampled invalid pixels, the sensor measures from 0.5m
+	const Histogram & GetHistogram() const;
+	UINT32 GetValidCount() const;
+
+private:
+	struct Accumulator
+	{
+		Accumulator();
+
+		Histogram Bins;
+		UINT32 PixelCount;
+		UINT32 ValidCount;
+		UINT16 Nearest;
+		unsigned SampleLane;
+	};
+
+	concurrency::combinable<Accumulator> RowAccumulators;
+	Accumulator Frame;
+
+	PerformanceCounter ValidRatio;
+	PerformanceCounter NearestDepth;
+	PerformanceCounter MedianDepth;
+};
@@ -4,6 +4,8 @@
 #include "stdafx.h"
 #include "DirectionalFoVCamera.h"
 
+#include "SimdMath.h"
+
 
 DirectionalFoVCamera::DirectionalFoVCamera(_In_ const Vector3 & Position, _In_ const Vector3 & LookDirection, _In_ float FoV)
 	:Camera(Position)
@@ -14,8 +16,9 @@ DirectionalFoVCamera::DirectionalFoVCamera(_In_ const Vector3 & Position, _In_ c
 
 void DirectionalFoVCamera::UpdateCamera()
 {
-	DirectX::XMStoreFloat4x4(&View, DirectX::XMMatrixTranspose(DirectX::XMMatrixLookToRH(Position, LookDirection, Up)));
+	SimdMath::Matrix LookTo = SimdMath::MatrixLookToRH(SimdMath::LoadFloat3(&Position.X), SimdMath::LoadFloat3(&LookDirection.X), SimdMath::LoadFloat3(&Up.X));
+	SimdMath::StoreFloat4x4(&View.m[0][0], SimdMath::MatrixTranspose(LookTo));
 
-	DirectX::XMMATRIX Perspective = DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(FoV), AspectRatio, 0.001f, 100.0f);
-	DirectX::XMStoreFloat4x4(&Projection, DirectX::XMMatrixTranspose(Perspective));
+	SimdMath::Matrix Perspective = SimdMath::MatrixPerspectiveFovRH(SimdMath::ConvertToRadians(FoV), AspectRatio, 0.001f, 100.0f);
+	SimdMath::StoreFloat4x4(&Projection.m[0][0], SimdMath::MatrixTranspose(Perspective));
 }
@@ -0,0 +1,12 @@
+#pragma once
+
+// Head pivot and orientation of the aligned face model, in camera space
+struct FacePose
+{
+	CameraSpacePoint HeadPivot;
+	Vector4 Orientation;
+};
+
+// The face points the head tracker places its cameras at: nose, left and right eye
+static constexpr unsigned TrackedFacePointCount = 3;
+typedef std::array<CameraSpacePoint, TrackedFacePointCount> TrackedFacePoints;
@@ -0,0 +1,188 @@
+// FaceRecording.cpp : A sequence of tracked face points that can be stored to and replayed from disk
+//
+
+#include "stdafx.h"
+#include "FaceRecording.h"
+
+namespace
+{
+	constexpr double FrameRate = 30.0;
+}
+
+const std::wstring FaceRecording::DefaultFilename = L"FaceRecording.bin";
+
+FaceRecording::FaceRecording(_In_ size_t MaxFrameCount)
+	:MaxFrameCount(MaxFrameCount)
+{
+}
+
+FaceRecording FaceRecording::CreateSynthetic(_In_ size_t FrameCount)
+{
+	// The face tracking jitters by a few millimetres and a fraction of a degree, the frames arrive with a few milliseconds jitter
+	constexpr float PivotNoise = 0.002f;
+	constexpr float OrientationNoise = 0.005f;
+	constexpr float PointNoise = 0.0005f;
+	constexpr double TimeNoise = 0.002;
+
+	FaceRecording Recording(FrameCount);
+	UINT32 RandomState = 0x12345678;
+
+	auto NextRandom = [&RandomState]()
+	{
+		RandomState = RandomState * 1664525u + 1013904223u;
+		return static_cast<float>(RandomState >> 8) / static_cast<float>(1 << 24);
+	};
+
+	// The sum of three uniform values is close enough to a normal distribution with the same deviation
+	auto NextNoise = [&NextRandom](float Deviation)
+	{
+		return (NextRandom() + NextRandom() + NextRandom() - 1.5f) * 2.f * Deviation;
+	};
+
+	for (size_t FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+	{
+		Frame Face = GetSyntheticFrame(FrameIndex / FrameRate + (NextRandom() - 0.5f) * TimeNoise, FrameCount);
+
+		// The pose noise moves all points alike, the points themselves only move a little against each other
+		DirectX::XMVECTOR PivotShift = DirectX::XMVectorSet(NextNoise(PivotNoise), NextNoise(PivotNoise), NextNoise(PivotNoise), 0.f);
+		DirectX::XMVECTOR Turn = DirectX::XMQuaternionRotationRollPitchYaw(NextNoise(OrientationNoise), NextNoise(OrientationNoise), NextNoise(OrientationNoise));
+		DirectX::XMVECTOR Pivot = DirectX::XMVectorSet(Face.Pose.HeadPivot.X, Face.Pose.HeadPivot.Y, Face.Pose.HeadPivot.Z, 0.f);
+
+		for (CameraSpacePoint & Point : Face.Points)
+		{
+			DirectX::XMVECTOR Offset = DirectX::XMVectorSubtract(DirectX::XMVectorSet(Point.X, Point.Y, Point.Z, 0.f), Pivot);
+			DirectX::XMFLOAT3 Moved;
+			DirectX::XMStoreFloat3(&Moved, DirectX::XMVectorAdd(DirectX::XMVectorAdd(Pivot, PivotShift), DirectX::XMVector3Rotate(Offset, Turn)));
+
+			Point = { Moved.x + NextNoise(PointNoise), Moved.y + NextNoise(PointNoise), Moved.z + NextNoise(PointNoise) };
+		}
+
+		DirectX::XMFLOAT3 MovedPivot;
+		DirectX::XMFLOAT4 MovedOrientation;
+		DirectX::XMStoreFloat3(&MovedPivot, DirectX::XMVectorAdd(Pivot, PivotShift));
+		DirectX::XMStoreFloat4(&MovedOrientation, DirectX::XMQuaternionMultiply(DirectX::XMVectorSet(Face.Pose.Orientation.x, Face.Pose.Orientation.y, Face.Pose.Orientation.z, Face.Pose.Orientation.w), Turn));
+
+		Face.Pose = { { MovedPivot.x, MovedPivot.y, MovedPivot.z }, { MovedOrientation.x, MovedOrientation.y, MovedOrientation.z, MovedOrientation.w } };
+
+		Recording.AddFrame(Face);
+	}
+
+	return Recording;
+}
+
+FaceRecording::Frame FaceRecording::GetSyntheticFrame(_In_ double Time, _In_ size_t FrameCount)
+{
+	// Offsets of the nose and the eyes from the head pivot, facing the sensor
+	static const std::array<DirectX::XMFLOAT3, PointCount> FaceOffsets = { {
+		{ 0.f, 0.03f, -0.1f },
+		{ -0.032f, 0.03f, -0.09f },
+		{ 0.032f, 0.03f, -0.09f },
+	} };
+
+	double RestDuration = (FrameCount / 3) / FrameRate;
+	double MotionTime = (std::max)(0.0, Time - RestDuration);
+
+	float HeadX = 0.15f * static_cast<float>(std::sin(DirectX::XM_2PI * 0.4 * MotionTime));
+	float HeadY = 0.3f;
+	float HeadZ = 1.6f + 0.1f * static_cast<float>(std::sin(DirectX::XM_2PI * 0.25 * MotionTime));
+	float Yaw = DirectX::XMConvertToRadians(20.f) * static_cast<float>(std::sin(DirectX::XM_2PI * 0.3 * MotionTime));
+
+	DirectX::XMVECTOR Pivot = DirectX::XMVectorSet(HeadX, HeadY, HeadZ, 0.f);
+	DirectX::XMVECTOR Orientation = DirectX::XMQuaternionRotationRollPitchYaw(0.f, Yaw, 0.f);
+
+	DirectX::XMFLOAT4 StoredOrientation;
+	DirectX::XMStoreFloat4(&StoredOrientation, Orientation);
+
+	Frame Face;
+	Face.Time = Time;
+	Face.Pose = { { HeadX, HeadY, HeadZ }, { StoredOrientation.x, StoredOrientation.y, StoredOrientation.z, StoredOrientation.w } };
+
+	for (unsigned Index = 0; Index < PointCount; ++Index)
+	{
+		DirectX::XMFLOAT3 Point;
+		DirectX::XMStoreFloat3(&Point, DirectX::XMVectorAdd(Pivot, DirectX::XMVector3Rotate(DirectX::XMLoadFloat3(&FaceOffsets[Index]), Orientation)));
+
+		Face.Points[Index] = { Point.x, Point.y, Point.z };
+	}
+
+	return Face;
+}
+
+bool FaceRecording::Load(_In_ const std::wstring & Path)
+{
+	std::ifstream File(Path, std::ios::binary);
+
+	return File && Load(File);
+}
+
+bool FaceRecording::Save(_In_ const std::wstring & Path) const
+{
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+
+	return File && Save(File);
+}
+
+bool FaceRecording::Load(_Inout_ std::istream & Stream)
+{
+	UINT32 Header[4] = {};
+	Stream.read(reinterpret_cast<char *>(Header), sizeof(Header));
+
+	if (!Stream || (Header[0] != FileMagic) || (Header[1] != FileVersion) || (Header[2] != PointCount))
+	{
+		return false;
+	}
+
+	Frames.resize(Header[3]);
+
+	for (Frame & Face : Frames)
+	{
+		Stream.read(reinterpret_cast<char *>(&Face.Time), sizeof(Face.Time));
+		Stream.read(reinterpret_cast<char *>(&Face.Pose), sizeof(Face.Pose));
+		Stream.read(reinterpret_cast<char *>(Face.Points.data()), Face.Points.size() * sizeof(CameraSpacePoint));
+	}
+
+	if (!Stream)
+	{
+		Frames.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool FaceRecording::Save(_Inout_ std::ostream & Stream) const
+{
+	UINT32 Header[4] = { FileMagic, FileVersion, PointCount, static_cast<UINT32>(Frames.size()) };
+	Stream.write(reinterpret_cast<const char *>(Header), sizeof(Header));
+
+	for (const Frame & Face : Frames)
+	{
+		Stream.write(reinterpret_cast<const char *>(&Face.Time), sizeof(Face.Time));
+		Stream.write(reinterpret_cast<const char *>(&Face.Pose), sizeof(Face.Pose));
+		Stream.write(reinterpret_cast<const char *>(Face.Points.data()), Face.Points.size() * sizeof(CameraSpacePoint));
+	}
+
+	return static_cast<bool>(Stream);
+}
+
+bool FaceRecording::AddFrame(_In_ const Frame & Face)
+{
+	if (Frames.size() >= MaxFrameCount)
+	{
+		return false;
+	}
+
+	Frames.push_back(Face);
+
+	return true;
+}
+
+void FaceRecording::Clear()
+{
+	Frames.clear();
+}
+
+const FaceRecording::FrameList & FaceRecording::GetFrames() const
+{
+	return Frames;
+}
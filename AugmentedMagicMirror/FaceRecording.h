@@ -0,0 +1,50 @@
+#pragma once
+
+#include "FacePose.h"
+
+// A sequence of tracked face points with their time stamps that can be stored to and replayed from disk,
+// e.g. to tune the head pose filters on real head motion
+class FaceRecording
+{
+public:
+	static constexpr unsigned PointCount = TrackedFacePointCount;
+
+	// The points are taken from the full face model, in camera space meters
+	struct Frame
+	{
+		double Time;
+		FacePose Pose;
+		TrackedFacePoints Points;
+	};
+
+	typedef std::vector<Frame> FrameList;
+
+	static const std::wstring DefaultFilename;
+
+	FaceRecording(_In_ size_t MaxFrameCount = 9000);
+
+	// Head at rest for the first third, then swaying sideways and back and forth while turning, with sensor like noise
+	static FaceRecording CreateSynthetic(_In_ size_t FrameCount);
+
+	// The noise free pose and points of the synthetic recording at Time
+	static Frame GetSyntheticFrame(_In_ double Time, _In_ size_t FrameCount);
+
+	bool Load(_In_ const std::wstring & Path);
+	bool Save(_In_ const std::wstring & Path) const;
+
+	// The same as the files, e.g. to check that a recording is replayed the way it was recorded
+	bool Load(_Inout_ std::istream & Stream);
+	bool Save(_Inout_ std::ostream & Stream) const;
+
+	bool AddFrame(_In_ const Frame & Face);
+	void Clear();
+
+	const FrameList & GetFrames() const;
+
+private:
+	static const UINT32 FileMagic = 0x464D4D41; // "AMMF"
+	static const UINT32 FileVersion = 2;
+
+	size_t MaxFrameCount;
+	FrameList Frames;
+};
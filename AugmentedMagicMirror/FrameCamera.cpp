@@ -4,6 +4,8 @@
 #include "stdafx.h"
 #include "FrameCamera.h"
 
+#include "SimdMath.h"
+
 
 FrameCamera::FrameCamera(_In_ const Vector3 & Position, _In_ float FrameHeight)
 	:Camera(Position)
@@ -13,14 +15,91 @@ FrameCamera::FrameCamera(_In_ const Vector3 & Position, _In_ float FrameHeight)
 
 void FrameCamera::UpdateCamera()
 {
-	DirectX::XMStoreFloat4x4(&View, DirectX::XMMatrixTranspose(DirectX::XMMatrixLookToRH(Position, Vector3(0.0f, 0.0f, -1.0f), Up)));
-
-	Vector3 InvertedPositon = DirectX::XMVectorNegate(Position);
+	// The horizontal and vertical terms in the lanes, like the stereo rig places them for each eye
 	float FrameHalfWidth = AspectRatio * FrameHalfHeight;
-	float NearZ = (Position.Z >= 0.0f) ? Position.Z : InvertedPositon.Z;
+	ProjectionTerms Terms = GetProjectionTerms(SimdMath::Set(FrameHalfWidth, FrameHalfHeight, FrameHalfWidth, FrameHalfHeight), SimdMath::Set(Position.X, Position.Y, Position.X, Position.Y), SimdMath::Replicate(Position.Z));
+
+	SetMatrices(Terms.Scale[0], Terms.Scale[1], Terms.Offset[0], Terms.Offset[1], Terms.Range[0], Terms.DepthOffset[0]);
+}
+
+void FrameCamera::Resolve(_In_ std::initializer_list<FrameCamera *> Cameras)
+{
+	constexpr size_t BatchSize = 4;
+
+	for (size_t First = 0; First < Cameras.size(); First += BatchSize)
+	{
+		Resolve(Cameras.begin() + First, (std::min)(Cameras.size() - First, BatchSize));
+	}
+}
+
+void FrameCamera::Resolve(_In_reads_(Count) FrameCamera * const * Cameras, _In_ size_t Count)
+{
+	if (std::none_of(Cameras, Cameras + Count, [](const FrameCamera * Camera) { return Camera->Dirty; }))
+	{
+		return;
+	}
+
+	// The camera values across the lanes; missing lanes repeat the last camera
+	auto Gather = [&](auto Value)
+	{
+		auto Lane = [&](size_t Index) { return Value(*Cameras[(std::min)(Index, Count - 1)]); };
+		return SimdMath::Set(Lane(0), Lane(1), Lane(2), Lane(3));
+	};
+
+	SimdMath::Vector Z = Gather([](const FrameCamera & Camera) { return Camera.Position.Z; });
+	SimdMath::Vector HalfHeight = Gather([](const FrameCamera & Camera) { return Camera.FrameHalfHeight; });
+	SimdMath::Vector HalfWidth = SimdMath::Multiply(Gather([](const FrameCamera & Camera) { return Camera.AspectRatio; }), HalfHeight);
+
+	ProjectionTerms Horizontal = GetProjectionTerms(HalfWidth, Gather([](const FrameCamera & Camera) { return Camera.Position.X; }), Z);
+	ProjectionTerms Vertical = GetProjectionTerms(HalfHeight, Gather([](const FrameCamera & Camera) { return Camera.Position.Y; }), Z);
+
+	for (size_t Lane = 0; Lane < Count; ++Lane)
+	{
+		FrameCamera & Camera = *Cameras[Lane];
+
+		if (!Camera.Dirty)
+		{
+			continue;
+		}
+
+		Camera.SetMatrices(Horizontal.Scale[Lane], Vertical.Scale[Lane], Horizontal.Offset[Lane], Vertical.Offset[Lane], Horizontal.Range[Lane], Horizontal.DepthOffset[Lane]);
+		Camera.Dirty = false;
+		++Camera.ResolveCount;
+	}
+}
+
+FrameCamera::ProjectionTerms FrameCamera::GetProjectionTerms(_In_ SimdMath::Vector HalfSize, _In_ SimdMath::Vector Position, _In_ SimdMath::Vector Z)
+{
+	// The frame is always looked at straight along -Z, so the projection is off center around the inverted position,
+	// like XMMatrixPerspectiveOffCenterRH with the frame as near plane
+	const SimdMath::Vector Far = SimdMath::Replicate(FarZ);
+	SimdMath::Vector NearZ = SimdMath::Abs(Z);
+	SimdMath::Vector InverseSize = SimdMath::Divide(SimdMath::Replicate(0.5f), HalfSize);
+	SimdMath::Vector Range = SimdMath::Divide(Far, SimdMath::Subtract(NearZ, Far));
+
+	ProjectionTerms Terms;
+	SimdMath::StoreFloat4(Terms.Scale.data(), SimdMath::Multiply(SimdMath::Add(NearZ, NearZ), InverseSize));
+	SimdMath::StoreFloat4(Terms.Offset.data(), SimdMath::Multiply(SimdMath::Add(Position, Position), SimdMath::Negate(InverseSize)));
+	SimdMath::StoreFloat4(Terms.Range.data(), Range);
+	SimdMath::StoreFloat4(Terms.DepthOffset.data(), SimdMath::Multiply(Range, NearZ));
+
+	return Terms;
+}
+
+void FrameCamera::SetMatrices(_In_ float ScaleX, _In_ float ScaleY, _In_ float OffsetX, _In_ float OffsetY, _In_ float Range, _In_ float DepthOffset)
+{
+	// The view is a translation; the matrices are stored transposed for the shaders
+	View = DirectX::XMFLOAT4X4(
+		1.f, 0.f, 0.f, -Position.X,
+		0.f, 1.f, 0.f, -Position.Y,
+		0.f, 0.f, 1.f, -Position.Z,
+		0.f, 0.f, 0.f, 1.f);
 
-	DirectX::XMMATRIX Perspective = DirectX::XMMatrixPerspectiveOffCenterRH(InvertedPositon.X - FrameHalfWidth, InvertedPositon.X + FrameHalfWidth, InvertedPositon.Y - FrameHalfHeight, InvertedPositon.Y + FrameHalfHeight, NearZ, 1000.f);
-	DirectX::XMStoreFloat4x4(&Projection, DirectX::XMMatrixTranspose(Perspective));
+	Projection = DirectX::XMFLOAT4X4(
+		ScaleX, 0.f, OffsetX, 0.f,
+		0.f, ScaleY, OffsetY, 0.f,
+		0.f, 0.f, Range, DepthOffset,
+		0.f, 0.f, -1.f, 0.f);
 }
 
 void FrameCamera::KeyPressedCallback(const WPARAM & VirtualKey)
@@ -30,7 +109,7 @@ void FrameCamera::KeyPressedCallback(const WPARAM & VirtualKey)
 	case VK_ADD:
 	case VK_SUBTRACT:
 		FrameHalfHeight += ((VirtualKey == VK_SUBTRACT) ? -1.f : 1.f) * 0.25f;
-		UpdateCamera();
+		Dirty = true;
 		break;
 	}
 }
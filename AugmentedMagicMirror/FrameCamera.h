@@ -1,5 +1,6 @@
 #pragma once
 #include "Camera.h"
+#include "SimdMath.h"
 class FrameCamera : public Camera
 {
 public:
@@ -7,9 +8,32 @@ public:
 
 	virtual void UpdateCamera();
 
+	using Camera::Resolve;
+
+	// Resolves the outdated cameras together, four at a time
+	static void Resolve(_In_ std::initializer_list<FrameCamera *> Cameras);
+
 	void KeyPressedCallback(const WPARAM & VirtualKey);
 
 private:
+	friend class StereoFrameCamera;
+
+	static constexpr float FarZ = 1000.f;
+
 	float FrameHalfHeight;
-};
 
+	// The off center projection terms of one axis of one camera per lane
+	struct ProjectionTerms
+	{
+		std::array<float, 4> Scale;
+		std::array<float, 4> Offset;
+		std::array<float, 4> Range;
+		std::array<float, 4> DepthOffset;
+	};
+
+	static void Resolve(_In_reads_(Count) FrameCamera * const * Cameras, _In_ size_t Count);
+
+	// Every path resolving a camera goes through these, so a camera gets the same matrices however it was resolved
+	static ProjectionTerms GetProjectionTerms(_In_ SimdMath::Vector HalfSize, _In_ SimdMath::Vector Position, _In_ SimdMath::Vector Z);
+	void SetMatrices(_In_ float ScaleX, _In_ float ScaleY, _In_ float OffsetX, _In_ float OffsetY, _In_ float Range, _In_ float DepthOffset);
+};
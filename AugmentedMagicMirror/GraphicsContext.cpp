@@ -6,7 +6,13 @@
 
 #include "Resource.h"
 
-void GraphicsContext::LoadAndCompileShader(_Out_ Microsoft::WRL::ComPtr<ID3DBlob> & VertexShader, _Out_ Microsoft::WRL::ComPtr<ID3DBlob> & PixelShader, _In_ DWORD ShaderResourceId, _In_ const std::string & ShaderModel)
+void GraphicsContext::LoadAndCompileShader(_Out_ Microsoft::WRL::ComPtr<ID3DBlob> & VertexShader, _Out_ Microsoft::WRL::ComPtr<ID3DBlob> & PixelShader, _In_ DWORD ShaderResourceId, _In_ const std::string & ShaderModel, _In_ const std::string & VertexEntryPoint, _In_ const std::string & PixelEntryPoint)
+{
+	LoadAndCompileShader(VertexShader, ShaderResourceId, std::string("vs_") + ShaderModel, VertexEntryPoint);
+	LoadAndCompileShader(PixelShader, ShaderResourceId, std::string("ps_") + ShaderModel, PixelEntryPoint);
+}
+
+void GraphicsContext::LoadAndCompileShader(_Out_ Microsoft::WRL::ComPtr<ID3DBlob> & Shader, _In_ DWORD ShaderResourceId, _In_ const std::string & Target, _In_ const std::string & EntryPoint)
 {
 	Microsoft::WRL::ComPtr<ID3DBlob> Error;
 
@@ -21,6 +27,5 @@ void GraphicsContext::LoadAndCompileShader(_Out_ Microsoft::WRL::ComPtr<ID3DBlob
 	UINT CompileFlags = 0;
 #endif
 
-	Utility::ThrowOnFail(D3DCompile(Content, ContentSize, nullptr, nullptr, nullptr, "VShader", (std::string("vs_") + ShaderModel).c_str(), CompileFlags, 0, &VertexShader, &Error), Error);
-	Utility::ThrowOnFail(D3DCompile(Content, ContentSize, nullptr, nullptr, nullptr, "PShader", (std::string("ps_") + ShaderModel).c_str(), CompileFlags, 0, &PixelShader, &Error), Error);
+	Utility::ThrowOnFail(D3DCompile(Content, ContentSize, nullptr, nullptr, nullptr, EntryPoint.c_str(), Target.c_str(), CompileFlags, 0, &Shader, &Error), Error);
 }
\ No newline at end of file
@@ -24,6 +24,9 @@ public:
 	virtual PRenderContext CreateRenderContext(_In_ Window & TargetWindow, _In_ Camera & NoseCamera, _In_ Camera & LeftEyeCamera, _In_ Camera & RighEyeCamera) = 0;
 	virtual PMesh CreateMesh() = 0;
 
-	static void LoadAndCompileShader(_Out_ Microsoft::WRL::ComPtr<ID3DBlob> & VertexShader, _Out_ Microsoft::WRL::ComPtr<ID3DBlob> & PixelShader, _In_ DWORD ShaderResourceId, _In_ const std::string & ShaderModel);
+	static void LoadAndCompileShader(_Out_ Microsoft::WRL::ComPtr<ID3DBlob> & VertexShader, _Out_ Microsoft::WRL::ComPtr<ID3DBlob> & PixelShader, _In_ DWORD ShaderResourceId, _In_ const std::string & ShaderModel, _In_ const std::string & VertexEntryPoint = "VShader", _In_ const std::string & PixelEntryPoint = "PShader");
+
+	// Compiles a single entry point, Target is the shader profile, e.g. gs_5_0
+	static void LoadAndCompileShader(_Out_ Microsoft::WRL::ComPtr<ID3DBlob> & Shader, _In_ DWORD ShaderResourceId, _In_ const std::string & Target, _In_ const std::string & EntryPoint);
 };
 
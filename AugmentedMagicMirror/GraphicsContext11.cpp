@@ -17,7 +17,7 @@ namespace D3DX11
 {
 	GraphicsContext::GraphicsContext()
 		: DefaultShader(*this)
-		, StereoEnabled(false)
+		, StereoEnabled(false), RenderTargetIndexFromVertexShader(false)
 		, StereoStatusEvent(NULL)
 		, StereoStatusEventCookie(NULL)
 	{
@@ -68,6 +68,11 @@ namespace D3DX11
 		return StereoEnabled;
 	}
 
+	bool GraphicsContext::IsRenderTargetIndexFromVertexShaderSupported() const
+	{
+		return RenderTargetIndexFromVertexShader;
+	}
+
 	PRenderContext GraphicsContext::CreateRenderContext(_In_ Window & TargetWindow, _In_ Camera & NoseCamera, _In_ Camera & LeftEyeCamera, _In_ Camera & RighEyeCamera)
 	{
 		return std::make_unique<RenderContext>(*this, TargetWindow, NoseCamera, LeftEyeCamera, RighEyeCamera);
@@ -115,6 +120,13 @@ namespace D3DX11
 		{
 			Utility::Throw(L"No Device was created!");
 		}
+
+		// Older runtimes do not know the options, the geometry shader fallback is used then
+		D3D11_FEATURE_DATA_D3D11_OPTIONS3 Options = {};
+		if (SUCCEEDED(Device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS3, &Options, sizeof(Options))))
+		{
+			RenderTargetIndexFromVertexShader = (Options.VPAndRTArrayIndexFromAnyShaderFeedingRasterizer != FALSE);
+		}
 	}
 
 	void GraphicsContext::RegisterStereoStatusEvent()
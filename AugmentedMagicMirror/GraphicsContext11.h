@@ -23,6 +23,9 @@ namespace D3DX11
 		RenderingContext & GetDefaultShader();
 		bool IsStereoEnabled() const;
 
+		// Whether the vertex shader may select the render target array slice, otherwise a geometry shader has to
+		bool IsRenderTargetIndexFromVertexShaderSupported() const;
+
 		Callback<void> StereoStatusChanged;
 
 		virtual PRenderContext CreateRenderContext(_In_ Window & TargetWindow, _In_ Camera & NoseCamera, _In_ Camera & LeftEyeCamera, _In_ Camera & RighEyeCamera);
@@ -35,6 +38,7 @@ namespace D3DX11
 
 		RenderingContext DefaultShader;
 		bool StereoEnabled;
+		bool RenderTargetIndexFromVertexShader;
 
 		HANDLE StereoStatusEvent;
 		DWORD StereoStatusEventCookie;
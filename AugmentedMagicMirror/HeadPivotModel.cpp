@@ -0,0 +1,49 @@
+// HeadPivotModel.cpp : Tracked face points placed relative to the head pivot
+//
+
+#include "stdafx.h"
+#include "HeadPivotModel.h"
+
+#include "SimdMath.h"
+
+HeadPivotModel::HeadPivotModel()
+	:Fitted(false), Offsets()
+{
+}
+
+void HeadPivotModel::Reset()
+{
+	Fitted = false;
+}
+
+bool HeadPivotModel::IsFitted() const
+{
+	return Fitted;
+}
+
+void HeadPivotModel::Fit(_In_ const TrackedFacePoints & Points, _In_ const FacePose & Pose)
+{
+	SimdMath::Vector Pivot = SimdMath::Set(Pose.HeadPivot.X, Pose.HeadPivot.Y, Pose.HeadPivot.Z, 0.f);
+	SimdMath::Vector Orientation = SimdMath::Set(Pose.Orientation.x, Pose.Orientation.y, Pose.Orientation.z, Pose.Orientation.w);
+
+	for (unsigned Index = 0; Index < TrackedFacePointCount; ++Index)
+	{
+		SimdMath::Vector Point = SimdMath::Set(Points[Index].X, Points[Index].Y, Points[Index].Z, 0.f);
+		SimdMath::StoreFloat3(Offsets[Index].data(), SimdMath::Vector3InverseRotate(SimdMath::Subtract(Point, Pivot), Orientation));
+	}
+
+	Fitted = true;
+}
+
+void HeadPivotModel::GetPoints(_In_ const FacePose & Pose, _Out_ TrackedFacePoints & Points) const
+{
+	SimdMath::Vector Pivot = SimdMath::Set(Pose.HeadPivot.X, Pose.HeadPivot.Y, Pose.HeadPivot.Z, 0.f);
+	SimdMath::Vector Orientation = SimdMath::Set(Pose.Orientation.x, Pose.Orientation.y, Pose.Orientation.z, Pose.Orientation.w);
+
+	for (unsigned Index = 0; Index < TrackedFacePointCount; ++Index)
+	{
+		SimdMath::Vector Point = SimdMath::Add(Pivot, SimdMath::Vector3Rotate(SimdMath::LoadFloat3(Offsets[Index].data()), Orientation));
+
+		Points[Index] = { SimdMath::GetX(Point), SimdMath::GetY(Point), SimdMath::GetZ(Point) };
+	}
+}
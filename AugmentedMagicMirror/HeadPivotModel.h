@@ -0,0 +1,24 @@
+#pragma once
+
+#include "FacePose.h"
+
+// Places the tracked face points relative to the head pivot instead of calculating the whole face model.
+// The offsets of the points are cached in the heads frame from one full face model fit, so they follow
+// the head pose afterwards but not the facial expressions, which hardly move the nose and eye points.
+class HeadPivotModel
+{
+public:
+	HeadPivotModel();
+
+	void Reset();
+	bool IsFitted() const;
+
+	// Caches the offsets of the Points, taken from the face model aligned with Pose
+	void Fit(_In_ const TrackedFacePoints & Points, _In_ const FacePose & Pose);
+
+	void GetPoints(_In_ const FacePose & Pose, _Out_ TrackedFacePoints & Points) const;
+
+private:
+	bool Fitted;
+	std::array<std::array<float, 3>, TrackedFacePointCount> Offsets;
+};
@@ -0,0 +1,31 @@
+// HeadPoseSlot.cpp : Lock-free hand over of the newest head pose to the renderer
+//
+
+#include "stdafx.h"
+#include "HeadPoseSlot.h"
+
+HeadPoseSlot::HeadPoseSlot()
+	:Samples(), Shared(0), WriteIndex(1), ReadIndex(2)
+{
+}
+
+void HeadPoseSlot::Publish(_In_ const Sample & NewSample)
+{
+	Samples[WriteIndex] = NewSample;
+
+	// Swaps the written sample in, the writer continues on the one that was shared
+	WriteIndex = Shared.exchange(WriteIndex | PublishedFlag, std::memory_order_acq_rel) & IndexMask;
+}
+
+bool HeadPoseSlot::Latch(_Out_ Sample & Newest)
+{
+	if (!(Shared.load(std::memory_order_acquire) & PublishedFlag))
+	{
+		return false;
+	}
+
+	ReadIndex = Shared.exchange(ReadIndex, std::memory_order_acq_rel) & IndexMask;
+	Newest = Samples[ReadIndex];
+
+	return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "FacePose.h"
+
+// Single slot handing the newest head pose from the face tracking to the renderer without locking. Triple buffered:
+// Publish never waits for the reader and Latch always gets the most recent complete sample, older ones are dropped.
+// One thread may publish and one thread may latch at a time.
+class HeadPoseSlot
+{
+public:
+	struct Sample
+	{
+		// Time the face frame was received, tracked points in camera space and their mapping into the virtual world
+		double Time;
+		TrackedFacePoints Points;
+		Vector3 Offset;
+		float RealWorldToVirutalScale;
+	};
+
+	HeadPoseSlot();
+
+	void Publish(_In_ const Sample & NewSample);
+
+	// Returns false and leaves Newest untouched if nothing was published since the last latch
+	bool Latch(_Out_ Sample & Newest);
+
+private:
+	static constexpr unsigned IndexMask = 0x3;
+	static constexpr unsigned PublishedFlag = 0x4;
+
+	std::array<Sample, 3> Samples;
+
+	// Index of the sample between writer and reader, flagged while it was not latched yet
+	std::atomic<unsigned> Shared;
+	unsigned WriteIndex;
+	unsigned ReadIndex;
+};
@@ -6,11 +6,43 @@
 
 #include "Camera.h"
 
-HeadTracker::HeadTracker(_In_ Camera & NoseCamera, _In_ Camera & LeftEyeCamera, _In_ Camera & RighEyeCamera, _In_ ::Kinect & Kinect)
-	:NoseCamera(NoseCamera), LeftEyeCamera(LeftEyeCamera), RighEyeCamera(RighEyeCamera), Kinect(Kinect)
-	, UpdateCameras(true)
+namespace
+{
+	constexpr float MetersToMillimeters = 1000.f;
+
+	const std::array<LPCWSTR, HeadTracker::PoseFilterType_Count> PoseFilterNames = { L"None", L"One Euro", L"Kalman" };
+}
+
+HeadTracker::TrackedPoint::TrackedPoint(_In_ ::Camera & Camera, _In_ HighDetailFacePoints VertexPoint)
+	:Camera(Camera), VertexPoint(VertexPoint)
+{
+}
+
+HeadTracker::HeadTracker(_In_ Camera & NoseCamera, _In_ StereoFrameCamera & EyeCameras, _In_ ::Kinect & Kinect, _In_ PoseFilterType FilterType, _In_ float Latency, _In_ bool LateLatching)
+	:TrackedPoints{ { { NoseCamera, HighDetailFacePoints_NoseTop }, { EyeCameras.GetEye(StereoFrameCamera::Eye_Left), HighDetailFacePoints_LefteyeMidtop }, { EyeCameras.GetEye(StereoFrameCamera::Eye_Right), HighDetailFacePoints_RighteyeMidtop } } }
+	, EyeCameras(EyeCameras), Kinect(Kinect), ModelPoints(), HasModelPoints(false), UpdateCameras(true), FilterType((FilterType < PoseFilterType_Count) ? FilterType : PoseFilterType_None), Latency(Latency)
+	, HasLatchedPose(false), LateLatching(LateLatching), PoseAge(L"Head Pose Age")
+	, IsRecording(false), PositionCount(0), Jitter(L"Head Jitter", L"mm"), Lag(L"Head Lag", L"mm")
 {
 	Kinect.FaceModelUpdated += std::make_pair(this, &HeadTracker::FaceModelUpdatedCallback);
+	Kinect.FacePoseUpdated += std::make_pair(this, &HeadTracker::FacePoseUpdatedCallback);
+}
+
+void HeadTracker::FitModel(_In_ const TrackedFacePoints & Points, _In_ const FacePose & Pose)
+{
+	PivotModel.Fit(Points, Pose);
+}
+
+void HeadTracker::UpdatePose(_In_ const FacePose & Pose, _In_ const Vector3 & Offset, _In_ float RealWorldToVirutalScale, _In_ double Time)
+{
+	HeadPoseSlot::Sample Sample = { Time, {}, Offset, RealWorldToVirutalScale };
+	PivotModel.GetPoints(Pose, Sample.Points);
+	PoseSlot.Publish(Sample);
+
+	if (!LateLatching)
+	{
+		LatchPose(Time);
+	}
 }
 
 void HeadTracker::KeyPressedCallback(const WPARAM & VirtualKey)
@@ -19,20 +51,234 @@ void HeadTracker::KeyPressedCallback(const WPARAM & VirtualKey)
 	{
 		UpdateCameras = !UpdateCameras;
 	}
+	else if (VirtualKey == 'K')
+	{
+		FilterType = static_cast<PoseFilterType>((FilterType + 1) % PoseFilterType_Count);
+		ResetFilters();
+
+		Utility::Log((std::wstring(L"Head pose filter: ") + PoseFilterNames[FilterType]).c_str());
+	}
+	else if (VirtualKey == 'L')
+	{
+		LateLatching = !LateLatching;
+		PoseAge.Reset();
+
+		Utility::Log(LateLatching ? L"Head pose late latching enabled" : L"Head pose late latching disabled");
+	}
+	else if (VirtualKey == 'R')
+	{
+		ToggleFaceRecording();
+	}
 }
 
-void HeadTracker::FaceModelUpdatedCallback(_In_ const Kinect::CameraSpacePointList & FaceVertices, _In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale)
+void HeadTracker::CameraLatchingCallback(_In_ const Camera & View)
+{
+	auto IsView = [&](const TrackedPoint & Point) { return &Point.Camera == &View; };
+	auto Point = std::find_if(TrackedPoints.begin(), TrackedPoints.end(), IsView);
+
+	if (Point == TrackedPoints.end())
+	{
+		return;
+	}
+
+	// While paused the cameras stay where they are instead of following the prediction
+	if (LateLatching && UpdateCameras)
+	{
+		Kinect.UpdateFace();
+		LatchPose(PerformanceCounter::GetTime());
+		Point->Camera.Resolve();
+	}
+
+	AddPoseAge();
+}
+
+void HeadTracker::StereoCameraLatchingCallback(_In_ const Camera & LeftEye, _In_ const Camera & RightEye)
+{
+	if ((&LeftEye != &EyeCameras.GetEye(StereoFrameCamera::Eye_Left)) || (&RightEye != &EyeCameras.GetEye(StereoFrameCamera::Eye_Right)))
+	{
+		return;
+	}
+
+	// Polled and latched once, both eyes are placed by the same pose
+	if (LateLatching && UpdateCameras)
+	{
+		Kinect.UpdateFace();
+		LatchPose(PerformanceCounter::GetTime());
+		EyeCameras.Resolve();
+	}
+
+	AddPoseAge();
+}
+
+void HeadTracker::FaceModelUpdatedCallback(_In_ const Kinect::CameraSpacePointList & FaceVertices, _In_ const FacePose & Pose)
+{
+	for (unsigned Index = 0; Index < TrackedFacePointCount; ++Index)
+	{
+		ModelPoints[Index] = FaceVertices[TrackedPoints[Index].VertexPoint];
+	}
+
+	FitModel(ModelPoints, Pose);
+	HasModelPoints = true;
+}
+
+void HeadTracker::FacePoseUpdatedCallback(_In_ const FacePose & Pose, _In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale)
 {
 	if (!UpdateCameras)
 		return;
 
-	UpdateCamera(FaceVertices, Offset, RealWorldToVirutalScale, NoseCamera, HighDetailFacePoints_NoseTop);
-	UpdateCamera(FaceVertices, Offset, RealWorldToVirutalScale, LeftEyeCamera, HighDetailFacePoints_LefteyeMidtop);
-	UpdateCamera(FaceVertices, Offset, RealWorldToVirutalScale, RighEyeCamera, HighDetailFacePoints_RighteyeMidtop);
+	if (!PivotModel.IsFitted())
+	{
+		Kinect.RequestFaceModel();
+		return;
+	}
+
+	double Time = PerformanceCounter::GetTime();
+
+	UpdatePose(Pose, Offset, RealWorldToVirutalScale, Time);
+
+	if (IsRecording)
+	{
+		RecordFace(Time, Pose);
+	}
+
+	HasModelPoints = false;
+}
+
+void HeadTracker::LatchPose(_In_ double Time)
+{
+	bool IsNewPose = PoseSlot.Latch(LatchedPose);
+	HasLatchedPose = HasLatchedPose || IsNewPose;
+
+	if (!HasLatchedPose)
+	{
+		return;
+	}
+
+	// Without a new face frame the filters still predict from the latch, which is what late latching gains
+	for (unsigned Index = 0; Index < TrackedFacePointCount; ++Index)
+	{
+		if (IsNewPose)
+		{
+			MeasurePoint(LatchedPose.Points[Index], LatchedPose.Time, TrackedPoints[Index]);
+		}
+
+		UpdateCamera(LatchedPose.Offset, LatchedPose.RealWorldToVirutalScale, Time, TrackedPoints[Index]);
+	}
+
+	if (IsNewPose)
+	{
+		UpdateMetrics();
+	}
 }
-void HeadTracker::UpdateCamera(_In_ const Kinect::CameraSpacePointList & FaceVertices, _In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale, _In_ Camera & Camera, _In_ HighDetailFacePoints VertexPoint)
+
+void HeadTracker::AddPoseAge()
+{
+	if (HasLatchedPose)
+	{
+		PoseAge.AddSample((PerformanceCounter::GetTime() - LatchedPose.Time) * 1000.0);
+	}
+}
+
+void HeadTracker::MeasurePoint(_In_ const CameraSpacePoint & Vertex, _In_ double Time, _Inout_ TrackedPoint & Point)
+{
+	Point.Measurement = Vector3(Vertex.X, Vertex.Y, Vertex.Z);
+
+	// Filtered in camera space, so the filters are independent of the Kinect offset and scale
+	if (PoseFilter * Filter = GetFilter(Point))
+	{
+		Filter->Update(Point.Measurement, Time);
+	}
+}
+
+void HeadTracker::UpdateCamera(_In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale, _In_ double LatchTime, _Inout_ TrackedPoint & Point)
+{
+	Point.Position = Point.Measurement;
+
+	if (PoseFilter * Filter = GetFilter(Point))
+	{
+		Point.Position = Filter->Predict(LatchTime + Latency);
+	}
+
+	const Vector3 & Position = Point.Position;
+	Point.Camera.UpdateCamera(Vector3((Position.X * RealWorldToVirutalScale) + Offset.X, (Position.Y * RealWorldToVirutalScale) + Offset.Y, (Position.Z * RealWorldToVirutalScale) + Offset.Z));
+}
+
+PoseFilter * HeadTracker::GetFilter(_In_ TrackedPoint & Point) const
+{
+	switch (FilterType)
+	{
+	case PoseFilterType_OneEuro:
+		return &Point.OneEuroFilter;
+	case PoseFilterType_Kalman:
+		return &Point.KalmanFilter;
+	default:
+		return nullptr;
+	}
+}
+
+void HeadTracker::ResetFilters()
 {
-	const CameraSpacePoint & Vertex = FaceVertices[VertexPoint];
+	for (TrackedPoint & Point : TrackedPoints)
+	{
+		Point.OneEuroFilter.Reset();
+		Point.KalmanFilter.Reset();
+	}
+
+	PositionCount = 0;
+}
+
+void HeadTracker::UpdateMetrics()
+{
+	const TrackedPoint & Nose = TrackedPoints.front();
+
+	// The second difference is close to zero for smooth motion, what remains is mostly jitter
+	if (PositionCount >= 2)
+	{
+		DirectX::XMVECTOR SecondDifference = DirectX::XMVectorAdd(DirectX::XMVectorSubtract(Nose.Position, DirectX::XMVectorScale(PreviousPosition, 2.f)), PrePreviousPosition);
+		Jitter.AddSample(DirectX::XMVectorGetX(DirectX::XMVector3Length(SecondDifference)) * MetersToMillimeters);
+	}
+
+	Lag.AddSample(DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(Nose.Measurement, Nose.Position))) * MetersToMillimeters);
+
+	PrePreviousPosition = PreviousPosition;
+	PreviousPosition = Nose.Position;
+	PositionCount = (std::min)(PositionCount + 1, 2u);
+}
+
+void HeadTracker::RecordFace(_In_ double Time, _In_ const FacePose & Pose)
+{
+	// The recording keeps the points of the whole face model, which is requested for every frame while recording
+	Kinect.RequestFaceModel();
+
+	if (!HasModelPoints)
+	{
+		return;
+	}
+
+	if (!Recording.AddFrame({ Time, Pose, ModelPoints }))
+	{
+		ToggleFaceRecording();
+	}
+}
+
+void HeadTracker::ToggleFaceRecording()
+{
+	if (!IsRecording)
+	{
+		Recording.Clear();
+		IsRecording = true;
+		Kinect.RequestFaceModel();
+		Utility::Log(L"Face recording started");
+		return;
+	}
+
+	IsRecording = false;
+
+	if (!Recording.Save(Utility::GetApplicationFilePath(FaceRecording::DefaultFilename)))
+	{
+		Utility::Log(L"Face recording could not be saved!");
+		return;
+	}
 
-	Camera.UpdateCamera(Vector3((Vertex.X * RealWorldToVirutalScale) + Offset.X, (Vertex.Y * RealWorldToVirutalScale) + Offset.Y, (Vertex.Z * RealWorldToVirutalScale) + Offset.Z));
+	Utility::Log(L"Face recording saved");
 }
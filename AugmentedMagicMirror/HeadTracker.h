@@ -1,24 +1,99 @@
 #pragma once
 
+#include "FaceRecording.h"
+#include "HeadPivotModel.h"
+#include "HeadPoseSlot.h"
 #include "Kinect.h"
+#include "KalmanPoseFilter.h"
+#include "OneEuroPoseFilter.h"
+#include "PerformanceCounter.h"
+#include "StereoFrameCamera.h"
 
 class Camera;
 
 class HeadTracker
 {
 public:
-	HeadTracker(_In_ Camera & NoseCamera, _In_ Camera & LeftEyeCamera, _In_ Camera & RighEyeCamera, _In_ Kinect & Kinect);
+	enum PoseFilterType
+	{
+		PoseFilterType_None,
+		PoseFilterType_OneEuro,
+		PoseFilterType_Kalman,
+		PoseFilterType_Count
+	};
+
+	// Latency is the time in seconds from placing the cameras to the display of the frame, the cameras are placed where the face is expected by then.
+	// Without late latching the cameras are placed when a face frame is received, with late latching when the renderer is about to use them.
+	HeadTracker(_In_ Camera & NoseCamera, _In_ StereoFrameCamera & EyeCameras, _In_ Kinect & Kinect, _In_ PoseFilterType FilterType = PoseFilterType_OneEuro, _In_ float Latency = 0.f, _In_ bool LateLatching = true);
+
+	// The tracked points of the whole face model fit the head pivot model, which has to be fitted before the pose is updated
+	void FitModel(_In_ const TrackedFacePoints & Points, _In_ const FacePose & Pose);
+
+	// Places the cameras by the head pose of the face frame received at Time, or leaves that to the latching with late latching
+	void UpdatePose(_In_ const FacePose & Pose, _In_ const Vector3 & Offset, _In_ float RealWorldToVirutalScale, _In_ double Time);
 
 	void KeyPressedCallback(_In_ const WPARAM & VirtualKey);
+	void CameraLatchingCallback(_In_ const Camera & View);
+	// Latches one pose for both eyes and resolves them together
+	void StereoCameraLatchingCallback(_In_ const Camera & LeftEye, _In_ const Camera & RightEye);
 private:
-	Camera & NoseCamera;
-	Camera & LeftEyeCamera;
-	Camera & RighEyeCamera;
+	struct TrackedPoint
+	{
+		TrackedPoint(_In_ ::Camera & Camera, _In_ HighDetailFacePoints VertexPoint);
+
+		::Camera & Camera;
+		HighDetailFacePoints VertexPoint;
+
+		OneEuroPoseFilter OneEuroFilter;
+		KalmanPoseFilter KalmanFilter;
+
+		// Last measured and filtered position in camera space
+		Vector3 Measurement;
+		Vector3 Position;
+	};
+
+	std::array<TrackedPoint, TrackedFacePointCount> TrackedPoints;
+	StereoFrameCamera & EyeCameras;
 	Kinect & Kinect;
 
+	// The points follow the head pose, the whole face model is only requested to fit the model and while recording
+	HeadPivotModel PivotModel;
+	TrackedFacePoints ModelPoints;
+	bool HasModelPoints;
+
 	bool UpdateCameras;
+	PoseFilterType FilterType;
+	const float Latency;
 
-	void FaceModelUpdatedCallback(_In_ const Kinect::CameraSpacePointList & FaceVertices, _In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale);
-	void UpdateCamera(_In_ const Kinect::CameraSpacePointList & FaceVertices, _In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale, _In_ Camera & Camera, _In_ HighDetailFacePoints VertexPoint);
-};
+	// The face frames publish the pose, the filters and cameras are updated from the newest pose when it is latched
+	HeadPoseSlot PoseSlot;
+	HeadPoseSlot::Sample LatchedPose;
+	bool HasLatchedPose;
+	bool LateLatching;
+
+	// Time from receiving the face frame of the latched pose to uploading the camera
+	PerformanceCounter PoseAge;
 
+	FaceRecording Recording;
+	bool IsRecording;
+
+	// Second difference and distance to the measurement of the filtered nose position
+	Vector3 PreviousPosition;
+	Vector3 PrePreviousPosition;
+	unsigned PositionCount;
+	PerformanceCounter Jitter;
+	PerformanceCounter Lag;
+
+	void FaceModelUpdatedCallback(_In_ const Kinect::CameraSpacePointList & FaceVertices, _In_ const FacePose & Pose);
+	void FacePoseUpdatedCallback(_In_ const FacePose & Pose, _In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale);
+	// Places the cameras where the head is expected Latency after the latch at Time, from the newest pose if there is one
+	void LatchPose(_In_ double Time);
+	void AddPoseAge();
+	void MeasurePoint(_In_ const CameraSpacePoint & Vertex, _In_ double Time, _Inout_ TrackedPoint & Point);
+	void UpdateCamera(_In_ const Vector3 & Offset, _In_ const float & RealWorldToVirutalScale, _In_ double LatchTime, _Inout_ TrackedPoint & Point);
+	PoseFilter * GetFilter(_In_ TrackedPoint & Point) const;
+	void ResetFilters();
+	void UpdateMetrics();
+	void RecordFace(_In_ double Time, _In_ const FacePose & Pose);
+	void ToggleFaceRecording();
+};
@@ -0,0 +1,219 @@
+// HierarchicalDepthBuffer.cpp : Hierarchical-Z occlusion culling of objects against the occlusion depth
+//
+
+#include "stdafx.h"
+#include "HierarchicalDepthBuffer.h"
+
+#include "Camera.h"
+
+HierarchicalDepthBuffer::HierarchicalDepthBuffer()
+	:BuildTime(L"Hierarchical Depth")
+{
+}
+
+void HierarchicalDepthBuffer::Build(_In_ const OcclusionDepthBuffer & Buffer)
+{
+	BuildTime.Start();
+
+	unsigned Width = Buffer.GetWidth();
+	unsigned Height = Buffer.GetHeight();
+	size_t LevelCount = 1;
+
+	for (unsigned Size = (std::max)(Width, Height); Size > 1; Size = (Size + 1) / 2)
+	{
+		++LevelCount;
+	}
+
+	Levels.resize(LevelCount);
+	Levels[0] = { Width, Height, Buffer.GetRasterizedDepth() };
+
+	// Odd sizes are rounded up, the last row and column are then reduced with themselves
+	for (size_t Index = 1; Index < LevelCount; ++Index)
+	{
+		const Level & Source = Levels[Index - 1];
+		Level & Target = Levels[Index];
+
+		Target.Width = (Source.Width + 1) / 2;
+		Target.Height = (Source.Height + 1) / 2;
+		Target.Depth.resize(Target.Width * Target.Height);
+
+		for (unsigned Y = 0; Y < Target.Height; ++Y)
+		{
+			const float * Upper = &Source.Depth[(2 * Y) * Source.Width];
+			const float * Lower = &Source.Depth[(std::min)(2 * Y + 1, Source.Height - 1) * Source.Width];
+			float * Row = &Target.Depth[Y * Target.Width];
+
+			for (unsigned X = 0; X < Target.Width; ++X)
+			{
+				unsigned Left = 2 * X;
+				unsigned Right = (std::min)(2 * X + 1, Source.Width - 1);
+
+				Row[X] = (std::max)((std::max)(Upper[Left], Upper[Right]), (std::max)(Lower[Left], Lower[Right]));
+			}
+		}
+	}
+
+	BuildTime.Stop();
+}
+
+size_t HierarchicalDepthBuffer::Cull(_In_ const Mesh::Bounds & LocalBounds, _In_ const TransformList & Objects, _In_ const Camera & View, _Out_ TransformList & VisibleObjects) const
+{
+	VisibleObjects.clear();
+
+	if (Levels.empty())
+	{
+		VisibleObjects = Objects;
+		return 0;
+	}
+
+	// The camera matrices are stored transposed for the shaders
+	DirectX::XMMATRIX ViewMatrix = DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&View.GetViewMatrix()));
+	DirectX::XMMATRIX ProjectionMatrix = DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&View.GetProjectionMatrix()));
+
+	DirectX::XMFLOAT4X4 ViewProjection;
+	DirectX::XMStoreFloat4x4(&ViewProjection, ViewMatrix * ProjectionMatrix);
+
+	std::array<__m128, 16> ViewProjectionElements;
+	for (unsigned Row = 0; Row < 4; ++Row)
+		for (unsigned Column = 0; Column < 4; ++Column)
+		{
+			ViewProjectionElements[Row * 4 + Column] = _mm_set1_ps(ViewProjection.m[Row][Column]);
+		}
+
+	const std::array<float, 2> CornersX = { LocalBounds.Minimum.x, LocalBounds.Maximum.x };
+	const std::array<float, 2> CornersY = { LocalBounds.Minimum.y, LocalBounds.Maximum.y };
+	const std::array<float, 2> CornersZ = { LocalBounds.Minimum.z, LocalBounds.Maximum.z };
+
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.f);
+	const __m128 HalfWidth = _mm_set1_ps(0.5f * Levels[0].Width);
+	const __m128 HalfHeight = _mm_set1_ps(0.5f * Levels[0].Height);
+	const float Infinity = std::numeric_limits<float>::infinity();
+
+	alignas(16) std::array<float, 4> MinimumX;
+	alignas(16) std::array<float, 4> MinimumY;
+	alignas(16) std::array<float, 4> MaximumX;
+	alignas(16) std::array<float, 4> MaximumY;
+	alignas(16) std::array<float, 4> NearestDepth;
+
+	size_t CulledCount = 0;
+
+	// Four objects at a time, each lane transforms the eight corners of one object's bounding box
+	for (size_t First = 0; First < Objects.size(); First += 4)
+	{
+		size_t Count = (std::min)(Objects.size() - First, size_t(4));
+
+		// Affine object matrices, element by element across the lanes; missing lanes repeat the last object
+		std::array<__m128, 12> World;
+		for (unsigned Row = 0; Row < 4; ++Row)
+			for (unsigned Column = 0; Column < 3; ++Column)
+			{
+				auto Element = [&](size_t Lane) { return Objects[First + (std::min)(Lane, Count - 1)].GetMatrix().m[Column][Row]; };
+				World[Row * 3 + Column] = _mm_set_ps(Element(3), Element(2), Element(1), Element(0));
+			}
+
+		__m128 ScreenMinimumX = _mm_set1_ps(Infinity);
+		__m128 ScreenMinimumY = _mm_set1_ps(Infinity);
+		__m128 ScreenMaximumX = _mm_set1_ps(-Infinity);
+		__m128 ScreenMaximumY = _mm_set1_ps(-Infinity);
+		__m128 Nearest = _mm_set1_ps(Infinity);
+		__m128 CrossesNearPlane = Zero;
+
+		for (unsigned Corner = 0; Corner < 8; ++Corner)
+		{
+			__m128 CornerX = _mm_set1_ps(CornersX[Corner & 1]);
+			__m128 CornerY = _mm_set1_ps(CornersY[(Corner >> 1) & 1]);
+			__m128 CornerZ = _mm_set1_ps(CornersZ[(Corner >> 2) & 1]);
+
+			auto TransformToWorld = [&](unsigned Column)
+			{
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(CornerX, World[Column]), _mm_mul_ps(CornerY, World[3 + Column])), _mm_add_ps(_mm_mul_ps(CornerZ, World[6 + Column]), World[9 + Column]));
+			};
+
+			__m128 WorldX = TransformToWorld(0);
+			__m128 WorldY = TransformToWorld(1);
+			__m128 WorldZ = TransformToWorld(2);
+
+			auto Project = [&](unsigned Column)
+			{
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(WorldX, ViewProjectionElements[Column]), _mm_mul_ps(WorldY, ViewProjectionElements[4 + Column])), _mm_add_ps(_mm_mul_ps(WorldZ, ViewProjectionElements[8 + Column]), ViewProjectionElements[12 + Column]));
+			};
+
+			__m128 ClipX = Project(0);
+			__m128 ClipY = Project(1);
+			__m128 ClipZ = Project(2);
+			__m128 ClipW = Project(3);
+
+			CrossesNearPlane = _mm_or_ps(CrossesNearPlane, _mm_or_ps(_mm_cmple_ps(ClipW, Zero), _mm_cmplt_ps(ClipZ, Zero)));
+
+			__m128 InverseW = _mm_div_ps(One, ClipW);
+			__m128 PixelX = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ClipX, InverseW), One), HalfWidth);
+			__m128 PixelY = _mm_mul_ps(_mm_sub_ps(One, _mm_mul_ps(ClipY, InverseW)), HalfHeight);
+
+			ScreenMinimumX = _mm_min_ps(ScreenMinimumX, PixelX);
+			ScreenMinimumY = _mm_min_ps(ScreenMinimumY, PixelY);
+			ScreenMaximumX = _mm_max_ps(ScreenMaximumX, PixelX);
+			ScreenMaximumY = _mm_max_ps(ScreenMaximumY, PixelY);
+			Nearest = _mm_min_ps(Nearest, _mm_mul_ps(ClipZ, InverseW));
+		}
+
+		_mm_store_ps(MinimumX.data(), ScreenMinimumX);
+		_mm_store_ps(MinimumY.data(), ScreenMinimumY);
+		_mm_store_ps(MaximumX.data(), ScreenMaximumX);
+		_mm_store_ps(MaximumY.data(), ScreenMaximumY);
+		_mm_store_ps(NearestDepth.data(), Nearest);
+		int NearPlaneLanes = _mm_movemask_ps(CrossesNearPlane);
+
+		// The pyramid lookup is scalar, it reads at most four texels per object
+		for (size_t Lane = 0; Lane < Count; ++Lane)
+		{
+			if (!(NearPlaneLanes & (1 << Lane)) && IsOccluded(MinimumX[Lane], MinimumY[Lane], MaximumX[Lane], MaximumY[Lane], NearestDepth[Lane]))
+			{
+				++CulledCount;
+				continue;
+			}
+
+			VisibleObjects.push_back(Objects[First + Lane]);
+		}
+	}
+
+	return CulledCount;
+}
+
+size_t HierarchicalDepthBuffer::GetLevelCount() const
+{
+	return Levels.size();
+}
+
+bool HierarchicalDepthBuffer::IsOccluded(_In_ float MinimumX, _In_ float MinimumY, _In_ float MaximumX, _In_ float MaximumY, _In_ float NearestDepth) const
+{
+	const Level & Base = Levels[0];
+
+	// Objects outside the view are left to the clipping
+	if (!((MaximumX >= 0.f) && (MaximumY >= 0.f) && (MinimumX < Base.Width) && (MinimumY < Base.Height)))
+	{
+		return false;
+	}
+
+	unsigned Left = static_cast<unsigned>((std::max)(MinimumX, 0.f));
+	unsigned Top = static_cast<unsigned>((std::max)(MinimumY, 0.f));
+	unsigned Right = static_cast<unsigned>((std::min)(MaximumX, Base.Width - 1.f));
+	unsigned Bottom = static_cast<unsigned>((std::min)(MaximumY, Base.Height - 1.f));
+
+	size_t LevelIndex = 0;
+	while ((LevelIndex + 1 < Levels.size()) && (((Right >> LevelIndex) - (Left >> LevelIndex) > 1) || ((Bottom >> LevelIndex) - (Top >> LevelIndex) > 1)))
+	{
+		++LevelIndex;
+	}
+
+	const Level & Lookup = Levels[LevelIndex];
+	float Farthest = 0.f;
+
+	for (unsigned Y = Top >> LevelIndex; Y <= (Bottom >> LevelIndex); ++Y)
+		for (unsigned X = Left >> LevelIndex; X <= (Right >> LevelIndex); ++X)
+		{
+			Farthest = (std::max)(Farthest, Lookup.Depth[X + Y * Lookup.Width]);
+		}
+
+	return NearestDepth > Farthest;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Mesh.h"
+#include "OcclusionDepthBuffer.h"
+#include "PerformanceCounter.h"
+#include "Transform.h"
+
+class Camera;
+
+// Pyramid of the farthest occlusion depth of each 2x2 block, for culling objects that are completely behind the user.
+// An object is culled when its nearest depth lies behind the farthest occluder depth of the texels its projected
+// bounding box covers, which are looked up on the level where the box spans at most 2x2 texels.
+class HierarchicalDepthBuffer
+{
+public:
+	HierarchicalDepthBuffer();
+
+	// Level 0 is the occlusion depth before its dilation, rasterized for the camera the objects are culled against;
+	// the dilation grows the occluder outwards, which would cull objects right beside the user
+	void Build(_In_ const OcclusionDepthBuffer & Buffer);
+
+	// Replaces VisibleObjects with the objects that are not fully occluded and returns the number of culled objects
+	size_t Cull(_In_ const Mesh::Bounds & LocalBounds, _In_ const TransformList & Objects, _In_ const Camera & View, _Out_ TransformList & VisibleObjects) const;
+
+	size_t GetLevelCount() const;
+
+private:
+	struct Level
+	{
+		unsigned Width;
+		unsigned Height;
+		std::vector<float> Depth;
+	};
+
+	std::vector<Level> Levels;
+
+	PerformanceCounter BuildTime;
+
+	bool IsOccluded(_In_ float MinimumX, _In_ float MinimumY, _In_ float MaximumX, _In_ float MaximumY, _In_ float NearestDepth) const;
+};
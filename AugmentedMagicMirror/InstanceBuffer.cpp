@@ -0,0 +1,50 @@
+// InstanceBuffer.cpp : Object matrices of a frame packed for instanced drawing
+//
+
+#include "stdafx.h"
+#include "InstanceBuffer.h"
+
+void InstanceBuffer::Reserve(_In_ size_t Count)
+{
+	Matrices.reserve(Count);
+}
+
+void InstanceBuffer::Clear()
+{
+	Matrices.clear();
+}
+
+InstanceBuffer::Range InstanceBuffer::Append(_In_ const TransformList & Objects)
+{
+	Range Instances = { static_cast<UINT>(Matrices.size()), static_cast<UINT>(Objects.size()) };
+
+	for (const Transform & Object : Objects)
+	{
+		Matrices.push_back(Object.GetMatrix());
+	}
+
+	return Instances;
+}
+
+InstanceBuffer::Range InstanceBuffer::Append(_In_reads_(Count) const DirectX::XMFLOAT4X4 * ObjectMatrices, _In_ size_t Count)
+{
+	Range Instances = { static_cast<UINT>(Matrices.size()), static_cast<UINT>(Count) };
+	Matrices.insert(Matrices.end(), ObjectMatrices, ObjectMatrices + Count);
+
+	return Instances;
+}
+
+const DirectX::XMFLOAT4X4 * InstanceBuffer::GetData() const
+{
+	return Matrices.data();
+}
+
+size_t InstanceBuffer::GetCount() const
+{
+	return Matrices.size();
+}
+
+size_t InstanceBuffer::GetSize() const
+{
+	return Matrices.size() * sizeof(DirectX::XMFLOAT4X4);
+}
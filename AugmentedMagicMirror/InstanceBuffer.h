@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Transform.h"
+
+// The object matrices of all objects drawn in a frame, packed back to back. The graphics backends upload them at once
+// as a per instance vertex buffer and draw each mesh once for all of its objects, instead of updating a constant
+// buffer and drawing for every object. The matrices stay transposed like the object matrices.
+class InstanceBuffer
+{
+public:
+	// The instances of one appended object list, i.e. the start instance and instance count of its draw
+	struct Range
+	{
+		UINT First;
+		UINT Count;
+	};
+	typedef std::vector<Range> RangeList;
+
+	void Reserve(_In_ size_t Count);
+	void Clear();
+
+	Range Append(_In_ const TransformList & Objects);
+	Range Append(_In_reads_(Count) const DirectX::XMFLOAT4X4 * ObjectMatrices, _In_ size_t Count);
+
+	const DirectX::XMFLOAT4X4 * GetData() const;
+	size_t GetCount() const;
+	size_t GetSize() const;
+
+private:
+	std::vector<DirectX::XMFLOAT4X4> Matrices;
+};
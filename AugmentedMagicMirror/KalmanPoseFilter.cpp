@@ -0,0 +1,77 @@
+// KalmanPoseFilter.cpp : Constant velocity Kalman filter for the head position
+//
+
+#include "stdafx.h"
+#include "KalmanPoseFilter.h"
+
+namespace
+{
+	// The head is assumed to be at rest when the filter starts, give or take one meter per second
+	constexpr float InitialVelocityVariance = 1.f;
+}
+
+KalmanPoseFilter::KalmanPoseFilter(_In_ float ProcessNoise, _In_ float MeasurementNoise)
+	:ProcessNoise(ProcessNoise), MeasurementVariance(MeasurementNoise * MeasurementNoise)
+{
+	Reset();
+}
+
+void KalmanPoseFilter::Reset()
+{
+	HasState = false;
+	LastTime = 0.0;
+	Axes = {};
+}
+
+void KalmanPoseFilter::Update(_In_ const Vector3 & Measurement, _In_ double Time)
+{
+	const std::array<float, AxisCount> Measured = { Measurement.X, Measurement.Y, Measurement.Z };
+	double Interval = Time - LastTime;
+
+	if (!HasState || (Interval > MaxInterval))
+	{
+		for (unsigned Axis = 0; Axis < AxisCount; ++Axis)
+		{
+			Axes[Axis] = { Measured[Axis], 0.f, MeasurementVariance, 0.f, InitialVelocityVariance };
+		}
+
+		HasState = true;
+		LastTime = Time;
+		return;
+	}
+
+	float Step = static_cast<float>((std::max)(Interval, 0.0));
+	float StepSquared = Step * Step;
+
+	for (unsigned Axis = 0; Axis < AxisCount; ++Axis)
+	{
+		AxisState & State = Axes[Axis];
+
+		// Prediction, with the process noise of a random acceleration integrated over the step
+		State.Position += State.Velocity * Step;
+		State.PositionVariance += Step * (2.f * State.Covariance + Step * State.VelocityVariance) + ProcessNoise * StepSquared * Step / 3.f;
+		State.Covariance += Step * State.VelocityVariance + ProcessNoise * StepSquared / 2.f;
+		State.VelocityVariance += ProcessNoise * Step;
+
+		// Correction with the measured position
+		float InverseInnovationVariance = 1.f / (State.PositionVariance + MeasurementVariance);
+		float PositionGain = State.PositionVariance * InverseInnovationVariance;
+		float VelocityGain = State.Covariance * InverseInnovationVariance;
+		float Innovation = Measured[Axis] - State.Position;
+
+		State.Position += PositionGain * Innovation;
+		State.Velocity += VelocityGain * Innovation;
+		State.VelocityVariance -= VelocityGain * State.Covariance;
+		State.PositionVariance *= 1.f - PositionGain;
+		State.Covariance *= 1.f - PositionGain;
+	}
+
+	LastTime = Time;
+}
+
+Vector3 KalmanPoseFilter::Predict(_In_ double Time) const
+{
+	float Step = static_cast<float>((std::min)(Time - LastTime, static_cast<double>(MaxInterval)));
+
+	return Vector3(Axes[0].Position + Axes[0].Velocity * Step, Axes[1].Position + Axes[1].Velocity * Step, Axes[2].Position + Axes[2].Velocity * Step);
+}
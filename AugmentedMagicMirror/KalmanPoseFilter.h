@@ -0,0 +1,36 @@
+#pragma once
+
+#include "PoseFilter.h"
+
+// Kalman filter with a constant velocity model, independently per axis. The head is assumed to move with
+// a constant velocity disturbed by random accelerations (ProcessNoise, in m^2/s^3) and to be measured
+// with a position noise of MeasurementNoise (standard deviation in m).
+class KalmanPoseFilter : public PoseFilter
+{
+public:
+	KalmanPoseFilter(_In_ float ProcessNoise = 0.1f, _In_ float MeasurementNoise = 0.005f);
+
+	void Reset() override;
+	void Update(_In_ const Vector3 & Measurement, _In_ double Time) override;
+	Vector3 Predict(_In_ double Time) const override;
+
+private:
+	static constexpr unsigned AxisCount = 3;
+
+	// Position and velocity with their symmetric 2x2 covariance, per axis
+	struct AxisState
+	{
+		float Position;
+		float Velocity;
+		float PositionVariance;
+		float Covariance;
+		float VelocityVariance;
+	};
+
+	const float ProcessNoise;
+	const float MeasurementVariance;
+
+	bool HasState;
+	double LastTime;
+	std::array<AxisState, AxisCount> Axes;
+};
@@ -4,10 +4,15 @@
 #include "stdafx.h"
 #include "Kinect.h"
 
+#include "DepthNormals.h"
 
 Kinect::Kinect(_In_ const Vector3 & Offset)
 	:Offset(Offset)
 	,RealWorldToVirutalScale(100.f) // Kinect Sensor reports its values in "Meters"; Virtual World uses "Centimeters"
+	,Region{ 0, 0, DepthImageWidth, DepthImageHeigth }
+	,TrackedBodyId(0)
+	,Pose(), IsFaceTracked(false), FaceModelRequested(true), FaceModelTime(L"Face Model", L"ms", 10)
+	,Recording(DepthImageWidth, DepthImageHeigth), IsRecording(false)
 {
 }
 
@@ -39,6 +44,59 @@ void Kinect::Update()
 	}
 }
 
+void Kinect::UpdateFace()
+{
+	for (Event & Event : Events)
+	{
+		if (Event.second == &Kinect::HighDefinitionFaceFrameRecieved)
+		{
+			CheckEvent(Event);
+		}
+	}
+}
+
+void Kinect::AddDepthFilter(_In_ DepthFilter & Filter)
+{
+	DepthFilters.push_back(&Filter);
+}
+
+void Kinect::RequestFaceModel()
+{
+	FaceModelRequested = true;
+}
+
+void Kinect::SetDepthRegion(_In_ const DepthRegion & Region)
+{
+	this->Region = Region;
+}
+
+void Kinect::MapDepthRegionToCameraSpace(_In_ const DepthFilter::DepthPixelList & DepthPixels, _In_ const CameraSpaceTable & Table, _In_ const DepthRegion & Region, _Inout_ CameraSpacePointList & Points)
+{
+	constexpr float MillimetersToMeters = 0.001f;
+	const float InvalidValue = -std::numeric_limits<float>::infinity();
+
+	unsigned Width = DepthImageWidth;
+
+	concurrency::parallel_for(Region.Top, Region.Bottom, [&](unsigned Y)
+	{
+		for (unsigned X = Region.Left; X < Region.Right; ++X)
+		{
+			size_t Index = X + Y * Width;
+			UINT16 Depth = DepthPixels[Index];
+
+			// Same convention as the coordinate mapper: pixels without depth become -inf
+			if (Depth == 0)
+			{
+				Points[Index] = { InvalidValue, InvalidValue, InvalidValue };
+				continue;
+			}
+
+			float Z = Depth * MillimetersToMeters;
+			Points[Index] = { Table[Index].X * Z, Table[Index].Y * Z, Z };
+		}
+	});
+}
+
 const Vector3 & Kinect::GetOffset() const
 {
 	return Offset;
@@ -53,6 +111,12 @@ void Kinect::KeyPressedCallback(const WPARAM & VirtualKey)
 {
 	constexpr float Step = 0.25f;
 
+	if (VirtualKey == 'R')
+	{
+		ToggleDepthRecording();
+		return;
+	}
+
 	switch (VirtualKey)
 	{
 	case 'W':
@@ -154,6 +218,8 @@ void Kinect::BodyFrameRecieved(_In_ WAITABLE_HANDLE EventHandle)
 
 	UpdateBodies(BodyFrame);
 	UpdateTrackedBody();
+	UpdateBodyJoints();
+	EstimateFacePose();
 }
 
 Microsoft::WRL::ComPtr<IBodyFrame> Kinect::GetBodyFrame(_In_ WAITABLE_HANDLE EventHandle)
@@ -179,68 +245,121 @@ void Kinect::UpdateBodies(_In_ Microsoft::WRL::ComPtr<IBodyFrame>& BodyFrame)
 
 void Kinect::UpdateTrackedBody()
 {
-	if (!UpdateCurrentTrackedBody())
-	{
-		TrackNewBody();
-	}
-}
-
-bool Kinect::UpdateCurrentTrackedBody()
-{
-	if (TrackedBody == nullptr)
-	{
-		return false;
-	}
-
-	UINT64 CurrentTrackingID;
-	Utility::ThrowOnFail(TrackedBody->get_TrackingId(&CurrentTrackingID));
+	UserArbitration::CandidateList Candidates;
 
-	auto IsTrackedBody = [=](auto Body)
+	for (auto & Body : Bodies)
 	{
 		BOOLEAN IsTracked;
 		Utility::ThrowOnFail(Body->get_IsTracked(&IsTracked));
 		if (!IsTracked)
 		{
-			return false;
+			continue;
 		}
 
+		std::array<Joint, JointType_Count> Joints;
+		Utility::ThrowOnFail(Body->GetJoints(static_cast<UINT>(Joints.size()), Joints.data()));
+
+		const Joint & Head = Joints[JointType_Head];
+		if (Head.TrackingState == TrackingState_NotTracked)
+		{
+			continue;
+		}
+
+		UINT64 TrackingId;
+		Utility::ThrowOnFail(Body->get_TrackingId(&TrackingId));
+		Candidates.push_back({ TrackingId, Head.Position });
+	}
+
+	UINT64 UserId = Arbitration.Update(Candidates, PerformanceCounter::GetTime());
+
+	if (UserId != TrackedBodyId)
+	{
+		TrackNewBody(UserId);
+	}
+
+	auto IsTrackedBody = [=](auto Body)
+	{
 		UINT64 BodyTrackingID;
 		Utility::ThrowOnFail(Body->get_TrackingId(&BodyTrackingID));
 
-		return (CurrentTrackingID == BodyTrackingID);
+		return (UserId != 0) && (UserId == BodyTrackingID);
 	};
 
 	auto Result = std::find_if(Bodies.begin(), Bodies.end(), IsTrackedBody);
 	TrackedBody = (Result != Bodies.end()) ? (*Result) : nullptr;
+}
+
+void Kinect::TrackNewBody(_In_ UINT64 TrackingId)
+{
+	TrackedBodyId = TrackingId;
+	Utility::ThrowOnFail(HighDefinitionFaceFrameSource->put_TrackingId(TrackingId));
 
-	return (TrackedBody != nullptr);
+	// The face points of a new user are placed anew from the whole face model, until its face is aligned the head joint stands in
+	IsFaceTracked = false;
+	FaceModelRequested = true;
 }
 
-void Kinect::TrackNewBody()
+void Kinect::UpdateBodyJoints()
 {
-	UINT64 NewTrackingID = 0;
+	DepthSpaceJoints.clear();
+	CameraSpaceJoints.clear();
 
-	for (auto & Body : Bodies)
+	if (TrackedBody != nullptr)
 	{
-		BOOLEAN IsTracked;
-		Utility::ThrowOnFail(Body->get_IsTracked(&IsTracked));
-		if (IsTracked)
+		std::array<Joint, JointType_Count> Joints;
+		Utility::ThrowOnFail(TrackedBody->GetJoints(static_cast<UINT>(Joints.size()), Joints.data()));
+
+		for (const Joint & BodyJoint : Joints)
 		{
-			TrackedBody = Body;
-			Utility::ThrowOnFail(Body->get_TrackingId(&NewTrackingID));
-			break;
+			if (BodyJoint.TrackingState != TrackingState_NotTracked)
+			{
+				CameraSpaceJoints.push_back(BodyJoint.Position);
+			}
 		}
+
+		DepthSpaceJoints.resize(CameraSpaceJoints.size());
+		Utility::ThrowOnFail(CoordinateMapper->MapCameraPointsToDepthSpace(static_cast<UINT>(CameraSpaceJoints.size()), CameraSpaceJoints.data(), static_cast<UINT>(DepthSpaceJoints.size()), DepthSpaceJoints.data()));
 	}
 
-	Utility::ThrowOnFail(HighDefinitionFaceFrameSource->put_TrackingId(NewTrackingID));
+	BodyJointsUpdated(DepthSpaceJoints, CameraSpaceJoints);
+}
+
+void Kinect::EstimateFacePose()
+{
+	if (IsFaceTracked || (TrackedBodyId == 0))
+	{
+		return;
+	}
+
+	// Facing the sensor, which is right beneath the mirror
+	FacePose Estimate = { {}, { 0.f, 0.f, 0.f, 1.f } };
+
+	if (Arbitration.GetHeadEstimate(TrackedBodyId, Estimate.HeadPivot))
+	{
+		FacePoseUpdated(Estimate, Offset, RealWorldToVirutalScale);
+	}
 }
 
 void Kinect::HighDefinitionFaceFrameRecieved(_In_ WAITABLE_HANDLE EventHandle)
 {
-	if (UpdateFaceModel(GetFaceFrame(EventHandle)))
+	if (!UpdateFaceModel(GetFaceFrame(EventHandle)))
 	{
-		FaceModelUpdated(FaceVertices, Offset, RealWorldToVirutalScale);
+		return;
 	}
+
+	if (FaceModelRequested)
+	{
+		FaceModelRequested = false;
+
+		FaceModelTime.Start();
+		Utility::ThrowOnFail(FaceModel->CalculateVerticesForAlignment(FaceAlignment.Get(), static_cast<UINT>(FaceVertices.size()), FaceVertices.data()));
+		FaceModelTime.Stop();
+
+		FaceModelUpdated(FaceVertices, Pose);
+	}
+
+	Arbitration.AddHeadPivot(Pose.HeadPivot);
+	FacePoseUpdated(Pose, Offset, RealWorldToVirutalScale);
 }
 
 bool Kinect::UpdateFaceModel(_In_ Microsoft::WRL::ComPtr<IHighDefinitionFaceFrame> FaceFrame)
@@ -252,14 +371,16 @@ bool Kinect::UpdateFaceModel(_In_ Microsoft::WRL::ComPtr<IHighDefinitionFaceFram
 
 	BOOLEAN IsFaceTracket;
 	Utility::ThrowOnFail(FaceFrame->get_IsFaceTracked(&IsFaceTracket));
+	IsFaceTracked = (IsFaceTracket != FALSE);
 
-	if (!IsFaceTracket)
+	if (!IsFaceTracked)
 	{
 		return false;
 	}
 
 	Utility::ThrowOnFail(FaceFrame->GetAndRefreshFaceAlignmentResult(FaceAlignment.Get()));
-	Utility::ThrowOnFail(FaceModel->CalculateVerticesForAlignment(FaceAlignment.Get(), static_cast<UINT>(FaceVertices.size()), FaceVertices.data()));
+	Utility::ThrowOnFail(FaceAlignment->get_HeadPivotPoint(&Pose.HeadPivot));
+	Utility::ThrowOnFail(FaceAlignment->get_FaceOrientation(&Pose.Orientation));
 
 	return true;
 }
@@ -289,10 +410,32 @@ void Kinect::DepthFrameRecieved(_In_ WAITABLE_HANDLE EventHandle)
 	}
 
 	DepthFrame->AccessUnderlyingBuffer(&BufferSize, &Buffer);
-	DepthVertices.resize(BufferSize);
-	CoordinateMapper->MapDepthFrameToCameraSpace(BufferSize, Buffer, static_cast<UINT>(DepthVertices.size()), DepthVertices.data());
+	DepthPixels.assign(Buffer, Buffer + BufferSize);
+
+	if (IsRecording && !Recording.AddFrame(DepthPixels))
+	{
+		ToggleDepthRecording();
+	}
+
+	for (DepthFilter * Filter : DepthFilters)
+	{
+		Filter->Apply(DepthPixels);
+	}
+
+	if (!UpdateDepthToCameraSpaceTable())
+	{
+		return;
+	}
+
+	DepthVertices.resize(DepthPixels.size());
+	DepthVertexNormals.resize(DepthPixels.size());
 
-	DepthVerticesUpdated(DepthVertices);
+	Statistics.Begin();
+	DepthNormals::MapDepthRegionToCameraSpace(DepthPixels, DepthToCameraSpaceTable, Region, DepthVertices, DepthVertexNormals, &Statistics);
+	Statistics.End();
+
+	DepthStatisticsUpdated(Statistics);
+	DepthVerticesUpdated(DepthVertices, DepthVertexNormals, Region);
 }
 
 Microsoft::WRL::ComPtr<IDepthFrame> Kinect::GetDepthFrame(_In_ WAITABLE_HANDLE EventHandle)
@@ -308,3 +451,51 @@ Microsoft::WRL::ComPtr<IDepthFrame> Kinect::GetDepthFrame(_In_ WAITABLE_HANDLE E
 	return DepthFrame;
 }
 
+bool Kinect::UpdateDepthToCameraSpaceTable()
+{
+	if (!DepthToCameraSpaceTable.empty())
+	{
+		return true;
+	}
+
+	// The table is only available once the sensor delivers frames
+	UINT32 TableEntryCount = 0;
+	PointF * Table = nullptr;
+
+	if (FAILED(CoordinateMapper->GetDepthFrameToCameraSpaceTable(&TableEntryCount, &Table)))
+	{
+		return false;
+	}
+
+	DepthToCameraSpaceTable.assign(Table, Table + TableEntryCount);
+	CoTaskMemFree(Table);
+
+	if (DepthToCameraSpaceTable.size() != DepthImageWidth * DepthImageHeigth)
+	{
+		DepthToCameraSpaceTable.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void Kinect::ToggleDepthRecording()
+{
+	if (!IsRecording)
+	{
+		Recording.Clear();
+		IsRecording = true;
+		Utility::Log(L"Depth recording started");
+		return;
+	}
+
+	IsRecording = false;
+
+	if (!Recording.Save(Utility::GetApplicationFilePath(DepthRecording::DefaultFilename)))
+	{
+		Utility::Log(L"Depth recording could not be saved!");
+		return;
+	}
+
+	Utility::Log(L"Depth recording saved");
+}
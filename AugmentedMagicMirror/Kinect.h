@@ -1,14 +1,25 @@
 #pragma once
 
 #include "Callback.h"
+#include "DepthFilter.h"
+#include "DepthRecording.h"
+#include "DepthRegion.h"
+#include "DepthStatistics.h"
+#include "FacePose.h"
+#include "PerformanceCounter.h"
+#include "UserArbitration.h"
 
 class Kinect
 {
 public:
 	typedef std::vector<CameraSpacePoint> CameraSpacePointList;
+	typedef std::vector<DepthSpacePoint> DepthSpacePointList;
+	typedef std::vector<PointF> CameraSpaceTable;
+	typedef std::vector<UINT32> NormalList;
 
 	static const unsigned DepthImageWidth = 512;
 	static const unsigned DepthImageHeigth = 424;
+	static const unsigned DepthFrameRate = 30;
 
 	Kinect(_In_ const Vector3 & Offset);
 
@@ -16,12 +27,31 @@ public:
 	void Release();
 	void Update();
 
+	// Only checks for a new face frame, to get the newest head pose right before rendering
+	void UpdateFace();
+
+	void AddDepthFilter(_In_ DepthFilter & Filter);
+
+	// The whole face model is only calculated for the next face frame after a request, and for the first face frame of a new user
+	void RequestFaceModel();
+	void SetDepthRegion(_In_ const DepthRegion & Region);
+
+	// Maps the pixels inside Region with a per pixel table of camera space rays at 1m depth; points outside Region are not touched
+	static void MapDepthRegionToCameraSpace(_In_ const DepthFilter::DepthPixelList & DepthPixels, _In_ const CameraSpaceTable & Table, _In_ const DepthRegion & Region, _Inout_ CameraSpacePointList & Points);
+
 	const Vector3 & GetOffset() const;
 	float GetRealWorldToVirutalScale() const;
 
 	Callback<Vector3> OffsetUpdated;
-	Callback<CameraSpacePointList, Vector3, float> FaceModelUpdated;
-	Callback<CameraSpacePointList> DepthVerticesUpdated;
+	Callback<FacePose, Vector3, float> FacePoseUpdated;
+
+	// Reported before the pose of the same face frame
+	Callback<CameraSpacePointList, FacePose> FaceModelUpdated;
+	Callback<CameraSpacePointList, NormalList, DepthRegion> DepthVerticesUpdated;
+	Callback<DepthStatistics> DepthStatisticsUpdated;
+
+	// The joints of the tracked body in depth image and in camera space; both are empty while no body is tracked
+	Callback<DepthSpacePointList, CameraSpacePointList> BodyJointsUpdated;
 
 	void KeyPressedCallback(_In_ const WPARAM & VirtualKey);
 	
@@ -40,18 +70,35 @@ private:
 	Microsoft::WRL::ComPtr<IBodyFrameSource> BodyFrameSource;
 	Microsoft::WRL::ComPtr<IBodyFrameReader> BodyFrameReader;
 	Microsoft::WRL::ComPtr<IBody> TrackedBody;
+	UINT64 TrackedBodyId;
 	BodyVector Bodies;
+	UserArbitration Arbitration;
+	DepthSpacePointList DepthSpaceJoints;
+	CameraSpacePointList CameraSpaceJoints;
 
 	Microsoft::WRL::ComPtr<IHighDefinitionFaceFrameSource> HighDefinitionFaceFrameSource;
 	Microsoft::WRL::ComPtr<IHighDefinitionFaceFrameReader> HighDefinitionFaceFrameReader;
 	Microsoft::WRL::ComPtr<IFaceModel> FaceModel;
 	Microsoft::WRL::ComPtr<IFaceAlignment> FaceAlignment;
 	CameraSpacePointList FaceVertices;
+	FacePose Pose;
+	bool IsFaceTracked;
+	bool FaceModelRequested;
+	PerformanceCounter FaceModelTime;
 
 	Microsoft::WRL::ComPtr<ICoordinateMapper> CoordinateMapper;
 	Microsoft::WRL::ComPtr<IDepthFrameSource> DepthFrameSource;
 	Microsoft::WRL::ComPtr<IDepthFrameReader> DepthFrameReader;
+	DepthFilter::DepthPixelList DepthPixels;
+	DepthFilterList DepthFilters;
+	CameraSpaceTable DepthToCameraSpaceTable;
+	DepthRegion Region;
 	CameraSpacePointList DepthVertices;
+	NormalList DepthVertexNormals;
+	DepthStatistics Statistics;
+
+	DepthRecording Recording;
+	bool IsRecording;
 
 	void SetupBodyFrameReader();
 	void SetupHighDefinitionFaceFrameReader();
@@ -73,8 +120,9 @@ private:
 	Microsoft::WRL::ComPtr<IBodyFrame> GetBodyFrame(_In_ WAITABLE_HANDLE EventHandle);
 	void UpdateBodies(_In_ Microsoft::WRL::ComPtr<IBodyFrame> & BodyFrame);
 	void UpdateTrackedBody();
-	bool UpdateCurrentTrackedBody();
-	void TrackNewBody();
+	void TrackNewBody(_In_ UINT64 TrackingId);
+	void UpdateBodyJoints();
+	void EstimateFacePose();
 
 	void HighDefinitionFaceFrameRecieved(_In_ WAITABLE_HANDLE EventHandle);
 	bool UpdateFaceModel(_In_ Microsoft::WRL::ComPtr<IHighDefinitionFaceFrame> FaceFrame);
@@ -82,5 +130,7 @@ private:
 
 	void DepthFrameRecieved(_In_ WAITABLE_HANDLE EventHandle);
 	Microsoft::WRL::ComPtr<IDepthFrame> GetDepthFrame(_In_ WAITABLE_HANDLE EventHandle);
+	bool UpdateDepthToCameraSpaceTable();
+	void ToggleDepthRecording();
 };
 
@@ -3,6 +3,7 @@
 
 #include "stdafx.h"
 #include "AugmentedMagicMirror.h"
+#include "Benchmark.h"
 
 int WINAPI wWinMain(_In_ HINSTANCE hInstance,
                      _In_opt_ HINSTANCE hPrevInstance,
@@ -10,7 +11,11 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance,
                      _In_ int       nCmdShow)
 {
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
+
+	if (Benchmark::IsRequested(lpCmdLine))
+	{
+		return Benchmark::Run(lpCmdLine);
+	}
 
 	AugmentedMagicMirror App(hInstance);
 
@@ -4,6 +4,11 @@
 #include "stdafx.h"
 #include "Mesh.h"
 
+size_t Mesh::UpdateVertices(_In_ const VertexList & Vertices)
+{
+	return UpdateVertices(Vertices, { { 0, Vertices.size() * sizeof(VertexList::value_type) } });
+}
+
 void Mesh::CreateCube()
 {
 	VertexList CubeVertices =
@@ -39,6 +44,7 @@ void Mesh::CreateCube()
 		1, 7, 5,
 	};
 
+	UpdateBounds(CubeVertices);
 	Create(CubeVertices, CubeIndices);
 }
 
@@ -47,11 +53,18 @@ void Mesh::CreatePlane(unsigned Width, unsigned Height)
 	size_t VerticesCount = Width * Height;
 
 	VertexList Vertices(VerticesCount);
+
+	UpdateBounds(Vertices);
+	Create(Vertices, CreatePlaneIndices(Width, Height));
+}
+
+Mesh::IndexList Mesh::CreatePlaneIndices(_In_ unsigned Width, _In_ unsigned Height)
+{
 	IndexList Indices;
 	Indices.reserve((Width - 1) * (Height - 1) * 3 * 2);
 
-	for (size_t Y = 0; Y < Height; ++Y)
-		for (size_t X = 0; X < Width; ++X)
+	for (size_t Y = 0; Y + 1 < Height; ++Y)
+		for (size_t X = 0; X + 1 < Width; ++X)
 		{
 			Index UpperLeftIndex = static_cast<Index>(X + (Y * Width));
 
@@ -64,5 +77,32 @@ void Mesh::CreatePlane(unsigned Width, unsigned Height)
 			Indices.push_back(UpperLeftIndex + Width);
 		}
 
-	Create(Vertices, Indices);
+	return Indices;
+}
+
+void Mesh::SetDrawRanges(_In_ const IndexRangeList & Ranges)
+{
+	DrawRanges = Ranges;
+}
+
+const Mesh::Bounds & Mesh::GetBounds() const
+{
+	return LocalBounds;
+}
+
+void Mesh::UpdateBounds(_In_ const VertexList & Vertices)
+{
+	if (Vertices.empty())
+	{
+		LocalBounds = {};
+		return;
+	}
+
+	LocalBounds = { Vertices.front().Position, Vertices.front().Position };
+
+	for (const Vertex & Vertex : Vertices)
+	{
+		LocalBounds.Minimum = { (std::min)(LocalBounds.Minimum.x, Vertex.Position.x), (std::min)(LocalBounds.Minimum.y, Vertex.Position.y), (std::min)(LocalBounds.Minimum.z, Vertex.Position.z) };
+		LocalBounds.Maximum = { (std::max)(LocalBounds.Maximum.x, Vertex.Position.x), (std::max)(LocalBounds.Maximum.y, Vertex.Position.y), (std::max)(LocalBounds.Maximum.z, Vertex.Position.z) };
+	}
 }
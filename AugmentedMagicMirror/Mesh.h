@@ -10,19 +10,61 @@ public:
 	{
 		DirectX::XMFLOAT3 Position;
 		DirectX::XMFLOAT4 Color;
+
+		// Octahedral packed normal, two signed normalized 16 bit values; zero means unlit
+		UINT32 Normal;
 	};
 	typedef std::vector<Vertex> VertexList;
+	typedef uint32_t Index;
+	typedef std::vector<Index> IndexList;
+
+	struct ByteRange
+	{
+		size_t Offset;
+		size_t Size;
+	};
+	typedef std::vector<ByteRange> ByteRangeList;
+
+	struct IndexRange
+	{
+		UINT First;
+		UINT Count;
+	};
+	typedef std::vector<IndexRange> IndexRangeList;
+
+	struct Bounds
+	{
+		DirectX::XMFLOAT3 Minimum;
+		DirectX::XMFLOAT3 Maximum;
+	};
 
 	virtual ~Mesh() = default; 
 	
 	void CreateCube();
 	void CreatePlane(_In_ unsigned Width, _In_ unsigned Height);
 
-	virtual void UpdateVertices(const VertexList & Vertices) = 0;
+	// Two triangles per grid cell, row by row, so the cells of a row are a contiguous range of 6 * (Width - 1) indices
+	static IndexList CreatePlaneIndices(_In_ unsigned Width, _In_ unsigned Height);
+
+	size_t UpdateVertices(_In_ const VertexList & Vertices);
+
+	// Uploads only the given byte ranges of Vertices and returns the number of bytes actually uploaded
+	virtual size_t UpdateVertices(_In_ const VertexList & Vertices, _In_ const ByteRangeList & DirtyRanges) = 0;
+
+	// Replaces the drawn indices; there may not be more of them than the mesh was created with
+	virtual void UpdateIndices(_In_ const IndexList & Indices) = 0;
+
+	// Restricts drawing to the given index ranges, each a separate draw call; an empty list draws all indices
+	void SetDrawRanges(_In_ const IndexRangeList & Ranges);
+
+	// Object space bounding box of the vertices the mesh was created with
+	const Bounds & GetBounds() const;
 
 protected:
-	typedef uint32_t Index;
-	typedef std::vector<Index> IndexList;
+	IndexRangeList DrawRanges;
+	Bounds LocalBounds = {};
+
+	void UpdateBounds(_In_ const VertexList & Vertices);
 
 	virtual void Create(_In_ const VertexList & Vertices, _In_ const IndexList & Indices) = 0;
 };
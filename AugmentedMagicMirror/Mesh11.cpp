@@ -6,7 +6,6 @@
 #include "Mesh11.h"
 
 #include "GraphicsContext11.h"
-#include "RenderingContext11.h"
 
 namespace D3DX11
 {
@@ -15,24 +14,65 @@ namespace D3DX11
 	{
 	}
 
-	void Mesh::UpdateVertices(_In_ const VertexList & Vertices)
+	size_t Mesh::UpdateVertices(_In_ const VertexList & Vertices, _In_ const ByteRangeList & DirtyRanges)
 	{
-		DeviceContext.GetDeviceContext()->UpdateSubresource(VertexBuffer.Get(), 0, nullptr, Vertices.data(), 0, 0);
+		const BYTE * VertexData = reinterpret_cast<const BYTE *>(Vertices.data());
+		size_t UploadedBytes = 0;
+
+		for (const ByteRange & Range : DirtyRanges)
+		{
+			D3D11_BOX DirtyBox = { static_cast<UINT>(Range.Offset), 0, 0, static_cast<UINT>(Range.Offset + Range.Size), 1, 1 };
+			DeviceContext.GetDeviceContext()->UpdateSubresource(VertexBuffer.Get(), 0, &DirtyBox, VertexData + Range.Offset, 0, 0);
+			UploadedBytes += Range.Size;
+		}
+
+		return UploadedBytes;
+	}
+
+	void Mesh::UpdateIndices(_In_ const IndexList & Indices)
+	{
+		if (Indices.size() > IndexCapacity)
+		{
+			Utility::Throw(L"Index buffer is too small");
+		}
+
+		if (!Indices.empty())
+		{
+			D3D11_BOX IndexBox = { 0, 0, 0, static_cast<UINT>(Indices.size() * sizeof(IndexList::value_type)), 1, 1 };
+			DeviceContext.GetDeviceContext()->UpdateSubresource(IndexBuffer.Get(), 0, &IndexBox, Indices.data(), 0, 0);
+		}
+
+		IndexCount = static_cast<UINT>(Indices.size());
 	}
 
-	void Mesh::Render(_In_ RenderingContext & RenderingContext, _In_ const TransformList & Objects) const
+	UINT Mesh::Render(_In_ const InstanceBuffer::Range & Instances, _In_ UINT InstancesPerObject) const
 	{
+		if (Instances.Count == 0)
+		{
+			return 0;
+		}
+
 		std::array<ID3D11Buffer *const, 1> VertexBuffers = { VertexBuffer.Get() };
 		std::array<UINT, 1> Offsets = { 0 };
 		DeviceContext.GetDeviceContext()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		DeviceContext.GetDeviceContext()->IASetVertexBuffers(0, 1, VertexBuffers.data(), &Stride, Offsets.data());
 		DeviceContext.GetDeviceContext()->IASetIndexBuffer(IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
-		for (const Transform & Object : Objects)
+		// The instance data steps once per object, so the start instance stays the index of the first object
+		UINT InstanceCount = Instances.Count * InstancesPerObject;
+
+		if (DrawRanges.empty())
 		{
-			RenderingContext.SetObjectMatrix(Object.GetMatrix());
-			DeviceContext.GetDeviceContext()->DrawIndexedInstanced(IndexCount, 1, 0, 0, 0);
+			DeviceContext.GetDeviceContext()->DrawIndexedInstanced(IndexCount, InstanceCount, 0, 0, Instances.First);
+			return 1;
 		}
+
+		for (const IndexRange & Range : DrawRanges)
+		{
+			DeviceContext.GetDeviceContext()->DrawIndexedInstanced(Range.Count, InstanceCount, Range.First, 0, Instances.First);
+		}
+
+		return static_cast<UINT>(DrawRanges.size());
 	}
 
 	void  Mesh::Create(_In_ const VertexList & Vertices, _In_ const IndexList & Indices)
@@ -42,6 +82,7 @@ namespace D3DX11
 
 		Stride = sizeof(VertexList::value_type);
 		IndexCount = static_cast<UINT>(Indices.size());
+		IndexCapacity = IndexCount;
 	}
 
 	void Mesh::CreateBuffer(_In_ D3D11_BIND_FLAG BindFlag, _In_ const void * InitialData, _In_ size_t Size, _Out_ Microsoft::WRL::ComPtr<ID3D11Buffer> & Buffer)
@@ -1,12 +1,11 @@
 #pragma once
 
+#include "InstanceBuffer.h"
 #include "Mesh.h"
-#include "Transform.h"
 
 namespace D3DX11
 {
 	class GraphicsContext;
-	class RenderingContext;
 
 	class Mesh : public ::Mesh
 	{
@@ -14,9 +13,13 @@ namespace D3DX11
 		Mesh(_In_ GraphicsContext & DeviceContext);
 		virtual ~Mesh() = default;
 
-		virtual void UpdateVertices(_In_ const VertexList & Vertices); 
+		using ::Mesh::UpdateVertices;
+		virtual size_t UpdateVertices(_In_ const VertexList & Vertices, _In_ const ByteRangeList & DirtyRanges);
+		virtual void UpdateIndices(_In_ const IndexList & Indices);
 		
-		void Render(_In_ RenderingContext & RenderingContext, _In_ const TransformList & Objects) const;
+		// Draws all objects of the range at once, their matrices are read from the uploaded instance buffer; each
+		// object is drawn InstancesPerObject times, e.g. once per eye. Returns the number of draw calls.
+		UINT Render(_In_ const InstanceBuffer::Range & Instances, _In_ UINT InstancesPerObject = 1) const;
 
 	private:
 		GraphicsContext & DeviceContext;
@@ -24,6 +27,7 @@ namespace D3DX11
 		Microsoft::WRL::ComPtr<ID3D11Buffer> IndexBuffer;
 		UINT Stride;
 		UINT IndexCount;
+		UINT IndexCapacity;
 
 		virtual void Create(_In_ const VertexList & Vertices, _In_ const IndexList & Indices);
 		void CreateBuffer(_In_ D3D11_BIND_FLAG BindFlag, _In_ const void * InitialData, _In_ size_t Size, _Out_ Microsoft::WRL::ComPtr<ID3D11Buffer> & Buffer);
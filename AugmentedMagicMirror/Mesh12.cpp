@@ -6,43 +6,94 @@
 #include "Mesh12.h"
 
 #include "GraphicsContext12.h"
-#include "RenderingContext12.h"
 
 namespace D3DX12
 {
 	Mesh::Mesh(_In_ GraphicsContext & DeviceContext)
-		:DeviceContext(DeviceContext)
+		:DeviceContext(DeviceContext), IsFullUploadPending(false), IsIndexUploadPending(false)
 	{
 	}
 
-	void Mesh::Render(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const RenderingContext & RenderingContext, _In_ const TransformList & Objects) const
+	void Mesh::Render(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const InstanceBuffer::Range & Instances) const
 	{
+		if (Instances.Count == 0)
+		{
+			return;
+		}
+
 		CommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		CommandList->IASetVertexBuffers(0, 1, &VertexBufferView);
 		CommandList->IASetIndexBuffer(&IndexBufferView);
 
-		for (const Transform & Object : Objects)
+		if (DrawRanges.empty())
 		{
-			RenderingContext.SetObjectMatrix(CommandList, Object.GetMatrix());
-			CommandList->DrawIndexedInstanced(IndexCount, 1, 0, 0, 0);
+			CommandList->DrawIndexedInstanced(IndexCount, Instances.Count, 0, 0, Instances.First);
+		}
+
+		for (const IndexRange & Range : DrawRanges)
+		{
+			CommandList->DrawIndexedInstanced(Range.Count, Instances.Count, Range.First, 0, Instances.First);
 		}
 	}
 
-	void Mesh::UpdateVertices(const VertexList & Vertices)
+	size_t Mesh::UpdateVertices(_In_ const VertexList & Vertices, _In_ const ByteRangeList & DirtyRanges)
 	{
 		if (UploadFence.IsBusy())
 		{
 			OutputDebugString(L"Upload is skipped!");
-			return;
+
+			// The ranges dirtied by this update are not known to the next one, so it uploads everything
+			IsFullUploadPending = true;
+			return 0;
+		}
+
+		ByteRangeList Ranges = DirtyRanges;
+		if (IsFullUploadPending)
+		{
+			Ranges = { { 0, VertexBufferView.SizeInBytes } };
+			IsFullUploadPending = false;
+		}
+
+		if (Ranges.empty() && !IsIndexUploadPending)
+		{
+			return 0;
 		}
+
 		Utility::ThrowOnFail(CommandAllocator->Reset());
 		Utility::ThrowOnFail(CommandList->Reset(CommandAllocator.Get(), nullptr));
 
-		UploadData(CommandList, VertexBuffer, VertexUploadResource, Vertices.data(), VertexBufferView.SizeInBytes);
+		if (!Ranges.empty())
+		{
+			UploadVertexRanges(CommandList, Vertices, Ranges);
+		}
+
+		if (IsIndexUploadPending)
+		{
+			UploadPendingIndices(CommandList);
+		}
 
 		Utility::ThrowOnFail(CommandList->Close());
 		DeviceContext.ExecuteCommandList(CommandList);
 		UploadFence.Set(DeviceContext.GetCommandQueue());
+
+		size_t UploadedBytes = 0;
+		for (const ByteRange & Range : Ranges)
+		{
+			UploadedBytes += Range.Size;
+		}
+
+		return UploadedBytes;
+	}
+
+	void Mesh::UpdateIndices(_In_ const IndexList & Indices)
+	{
+		if (Indices.size() > IndexCapacity)
+		{
+			Utility::Throw(L"Index buffer is too small");
+		}
+
+		PendingIndices = Indices;
+		IsIndexUploadPending = true;
 	}
 
 	void Mesh::Create(const VertexList & Vertices, const IndexList & Indices)
@@ -78,6 +129,7 @@ namespace D3DX12
 	{
 		size_t BufferSize = Indices.size() * sizeof(IndexList::value_type);
 		IndexCount = static_cast<UINT>(Indices.size());
+		IndexCapacity = IndexCount;
 
 		CreateBuffer(IndexBuffer, IndexUploadResource, BufferSize);
 
@@ -111,6 +163,66 @@ namespace D3DX12
 			IID_PPV_ARGS(&UploadResource)));
 	}
 
+	void Mesh::UploadPendingIndices(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList)
+	{
+		size_t DataSize = PendingIndices.size() * sizeof(IndexList::value_type);
+
+		if (DataSize != 0)
+		{
+			BYTE * UploadData = nullptr;
+			CD3DX12_RANGE ReadRange(0, 0);
+
+			Utility::ThrowOnFail(IndexUploadResource->Map(0, &ReadRange, reinterpret_cast<void **>(&UploadData)));
+			std::memcpy(UploadData, PendingIndices.data(), DataSize);
+			IndexUploadResource->Unmap(0, nullptr);
+
+			{
+				CD3DX12_RESOURCE_BARRIER ResourceBarrier = CD3DX12_RESOURCE_BARRIER::Transition(IndexBuffer.Get(), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, D3D12_RESOURCE_STATE_COPY_DEST);
+				CommandList->ResourceBarrier(1, &ResourceBarrier);
+			}
+
+			CommandList->CopyBufferRegion(IndexBuffer.Get(), 0, IndexUploadResource.Get(), 0, DataSize);
+
+			{
+				CD3DX12_RESOURCE_BARRIER ResourceBarrier = CD3DX12_RESOURCE_BARRIER::Transition(IndexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+				CommandList->ResourceBarrier(1, &ResourceBarrier);
+			}
+		}
+
+		IndexCount = static_cast<UINT>(PendingIndices.size());
+		IsIndexUploadPending = false;
+	}
+
+	void Mesh::UploadVertexRanges(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const VertexList & Vertices, _In_ const ByteRangeList & Ranges)
+	{
+		const BYTE * VertexData = reinterpret_cast<const BYTE *>(Vertices.data());
+		BYTE * UploadData = nullptr;
+		CD3DX12_RANGE ReadRange(0, 0);
+
+		// The upload resource is only written while the upload fence is idle, so the GPU never reads it concurrently
+		Utility::ThrowOnFail(VertexUploadResource->Map(0, &ReadRange, reinterpret_cast<void **>(&UploadData)));
+		for (const ByteRange & Range : Ranges)
+		{
+			std::memcpy(UploadData + Range.Offset, VertexData + Range.Offset, Range.Size);
+		}
+		VertexUploadResource->Unmap(0, nullptr);
+
+		{
+			CD3DX12_RESOURCE_BARRIER ResourceBarrier = CD3DX12_RESOURCE_BARRIER::Transition(VertexBuffer.Get(), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, D3D12_RESOURCE_STATE_COPY_DEST);
+			CommandList->ResourceBarrier(1, &ResourceBarrier);
+		}
+
+		for (const ByteRange & Range : Ranges)
+		{
+			CommandList->CopyBufferRegion(VertexBuffer.Get(), Range.Offset, VertexUploadResource.Get(), Range.Offset, Range.Size);
+		}
+
+		{
+			CD3DX12_RESOURCE_BARRIER ResourceBarrier = CD3DX12_RESOURCE_BARRIER::Transition(VertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+			CommandList->ResourceBarrier(1, &ResourceBarrier);
+		}
+	}
+
 	void Mesh::UploadData(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _Out_ const Microsoft::WRL::ComPtr<ID3D12Resource> & Resource, _Out_ const Microsoft::WRL::ComPtr<ID3D12Resource> & UploadResource, _In_reads_bytes_(DataSize) const void * Data, _In_ size_t DataSize)
 	{
 		{
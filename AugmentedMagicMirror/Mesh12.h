@@ -2,23 +2,27 @@
 
 #include "GPUFence12.h"
 
+#include "InstanceBuffer.h"
 #include "Mesh.h"
-#include "Transform.h"
 
 
 namespace D3DX12
 {
 	class GraphicsContext;
-	class RenderingContext;
 
 	class Mesh : public ::Mesh
 	{
 	public:
 		Mesh(_In_ GraphicsContext & DeviceContext);
 
-		void Render(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const RenderingContext & RenderingContext, _In_ const TransformList & Objects) const;
+		// Draws all objects of the range at once, their matrices are read from the instance buffer bound to the second slot
+		void Render(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const InstanceBuffer::Range & Instances) const;
 
-		virtual void UpdateVertices(const VertexList & Vertices);
+		using ::Mesh::UpdateVertices;
+		virtual size_t UpdateVertices(_In_ const VertexList & Vertices, _In_ const ByteRangeList & DirtyRanges);
+
+		// Indices are only staged and submitted together with the next vertex update, which shares the upload fence
+		virtual void UpdateIndices(_In_ const IndexList & Indices);
 
 	private:
 		GraphicsContext & DeviceContext;
@@ -34,12 +38,18 @@ namespace D3DX12
 		GPUFence UploadFence;
 
 		UINT IndexCount;
+		UINT IndexCapacity;
+		bool IsFullUploadPending;
+		IndexList PendingIndices;
+		bool IsIndexUploadPending;
 
 		virtual void Create(_In_ const VertexList & Vertices, _In_ const IndexList & Indices);
 		void CreateVertexBuffer(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const VertexList & Vertices);
 		void CreateIndexBuffer(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const IndexList & Indices);
 		void CreateBuffer(_Out_ Microsoft::WRL::ComPtr<ID3D12Resource> & Resource, _Out_ Microsoft::WRL::ComPtr<ID3D12Resource> & UploadResource, _In_ size_t  ResourceSize);
 
+		void UploadPendingIndices(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList);
+		void UploadVertexRanges(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const VertexList & Vertices, _In_ const ByteRangeList & Ranges);
 		void UploadData(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _Out_ const Microsoft::WRL::ComPtr<ID3D12Resource> & Resource, _Out_ const Microsoft::WRL::ComPtr<ID3D12Resource> & UploadResource, _In_reads_bytes_(DataSize) const void * Data, _In_ size_t DataSize);
 	};
 }
@@ -0,0 +1,203 @@
+// OcclusionDepthBuffer.cpp : Low resolution depth of the user rasterized from the depth points on the CPU
+//
+
+#include "stdafx.h"
+#include "OcclusionDepthBuffer.h"
+
+#include "Camera.h"
+
+OcclusionDepthBuffer::OcclusionDepthBuffer(_In_ Kinect & Kinect)
+	:PointCount(0), Offset(Kinect.GetOffset()), RealWorldToVirtualScale(Kinect.GetRealWorldToVirutalScale())
+	, Width(0), Height(0), RasterizeTime(L"Occlusion Depth")
+{
+	Kinect.OffsetUpdated += std::make_pair(this, &OcclusionDepthBuffer::OffsetUpdatedCallback);
+	Kinect.DepthVerticesUpdated += std::make_pair(this, &OcclusionDepthBuffer::DepthVerticesUpdatedCallback);
+}
+
+void OcclusionDepthBuffer::Rasterize(_In_ const Camera & View, _In_ unsigned TargetWidth, _In_ unsigned TargetHeight)
+{
+	RasterizeTime.Start();
+
+	Width = (std::max)(1u, TargetWidth / Downsampling);
+	Height = (std::max)(1u, TargetHeight / Downsampling);
+	RasterizedDepth.assign(Width * Height, 1.f);
+
+	// Points are placed like the depth mesh; the camera matrices are stored transposed for the shaders
+	DirectX::XMMATRIX World = DirectX::XMMatrixScaling(RealWorldToVirtualScale, RealWorldToVirtualScale, -RealWorldToVirtualScale) * DirectX::XMMatrixTranslation(Offset.X, Offset.Y, Offset.Z);
+	DirectX::XMMATRIX ViewMatrix = DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&View.GetViewMatrix()));
+	DirectX::XMMATRIX ProjectionMatrix = DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&View.GetProjectionMatrix()));
+
+	DirectX::XMFLOAT4X4 WorldViewProjection;
+	DirectX::XMStoreFloat4x4(&WorldViewProjection, World * ViewMatrix * ProjectionMatrix);
+
+	std::array<__m128, 16> Elements;
+	for (unsigned Row = 0; Row < 4; ++Row)
+		for (unsigned Column = 0; Column < 4; ++Column)
+		{
+			Elements[Row * 4 + Column] = _mm_set1_ps(WorldViewProjection.m[Row][Column]);
+		}
+
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.f);
+	const __m128 HalfWidth = _mm_set1_ps(0.5f * Width);
+	const __m128 HalfHeight = _mm_set1_ps(0.5f * Height);
+	const __m128 FloatWidth = _mm_set1_ps(static_cast<float>(Width));
+	const __m128 FloatHeight = _mm_set1_ps(static_cast<float>(Height));
+
+	alignas(16) std::array<int, 4> Columns;
+	alignas(16) std::array<int, 4> Rows;
+	alignas(16) std::array<float, 4> Depths;
+
+	for (size_t Index = 0; Index < PointCount; Index += 4)
+	{
+		__m128 X = _mm_loadu_ps(&PointsX[Index]);
+		__m128 Y = _mm_loadu_ps(&PointsY[Index]);
+		__m128 Z = _mm_loadu_ps(&PointsZ[Index]);
+
+		auto Project = [&](unsigned Column)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(X, Elements[Column]), _mm_mul_ps(Y, Elements[4 + Column])), _mm_add_ps(_mm_mul_ps(Z, Elements[8 + Column]), Elements[12 + Column]));
+		};
+
+		__m128 ClipX = Project(0);
+		__m128 ClipY = Project(1);
+		__m128 ClipZ = Project(2);
+		__m128 ClipW = Project(3);
+
+		__m128 InverseW = _mm_div_ps(One, ClipW);
+		__m128 PixelX = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ClipX, InverseW), One), HalfWidth);
+		__m128 PixelY = _mm_mul_ps(_mm_sub_ps(One, _mm_mul_ps(ClipY, InverseW)), HalfHeight);
+		__m128 PointDepth = _mm_mul_ps(ClipZ, InverseW);
+
+		__m128 Visible = _mm_and_ps(_mm_cmpgt_ps(ClipW, Zero), _mm_and_ps(_mm_cmpge_ps(PointDepth, Zero), _mm_cmplt_ps(PointDepth, One)));
+		Visible = _mm_and_ps(Visible, _mm_and_ps(_mm_cmpge_ps(PixelX, Zero), _mm_cmplt_ps(PixelX, FloatWidth)));
+		Visible = _mm_and_ps(Visible, _mm_and_ps(_mm_cmpge_ps(PixelY, Zero), _mm_cmplt_ps(PixelY, FloatHeight)));
+
+		int VisibleLanes = _mm_movemask_ps(Visible);
+
+		// The point lists are padded to whole groups of four, the padding is never visible
+		if (Index + 4 > PointCount)
+		{
+			VisibleLanes &= (1 << (PointCount - Index)) - 1;
+		}
+
+		if (VisibleLanes == 0)
+		{
+			continue;
+		}
+
+		_mm_store_si128(reinterpret_cast<__m128i *>(Columns.data()), _mm_cvttps_epi32(PixelX));
+		_mm_store_si128(reinterpret_cast<__m128i *>(Rows.data()), _mm_cvttps_epi32(PixelY));
+		_mm_store_ps(Depths.data(), PointDepth);
+
+		// SSE2 has no scatter, the visible lanes are written one at a time keeping the nearest depth
+		for (unsigned Lane = 0; Lane < 4; ++Lane)
+		{
+			if (VisibleLanes & (1 << Lane))
+			{
+				float & Target = RasterizedDepth[Columns[Lane] + Rows[Lane] * Width];
+				Target = (std::min)(Target, Depths[Lane]);
+			}
+		}
+	}
+
+	Dilate();
+
+	RasterizeTime.Stop();
+}
+
+const std::vector<float> & OcclusionDepthBuffer::GetDepth() const
+{
+	return Depth;
+}
+
+const std::vector<float> & OcclusionDepthBuffer::GetRasterizedDepth() const
+{
+	return RasterizedDepth;
+}
+
+unsigned OcclusionDepthBuffer::GetWidth() const
+{
+	return Width;
+}
+
+unsigned OcclusionDepthBuffer::GetHeight() const
+{
+	return Height;
+}
+
+size_t OcclusionDepthBuffer::GetPointCount() const
+{
+	return PointCount;
+}
+
+void OcclusionDepthBuffer::OffsetUpdatedCallback(_In_ const Vector3 & Offset)
+{
+	this->Offset = Offset;
+}
+
+void OcclusionDepthBuffer::DepthVerticesUpdatedCallback(_In_ const Kinect::CameraSpacePointList & DepthVertices, _In_ const Kinect::NormalList & Normals, _In_ const DepthRegion & Region)
+{
+	size_t Capacity = Region.GetWidth() * Region.GetHeight() + 4;
+	PointsX.resize(Capacity);
+	PointsY.resize(Capacity);
+	PointsZ.resize(Capacity);
+	PointCount = 0;
+
+	for (unsigned Y = Region.Top; Y < Region.Bottom; ++Y)
+	{
+		for (unsigned X = Region.Left; X < Region.Right; ++X)
+		{
+			const CameraSpacePoint & Point = DepthVertices[X + Y * Kinect::DepthImageWidth];
+
+			// Invalid points are -inf
+			if (!(Point.Z > 0.f))
+			{
+				continue;
+			}
+
+			PointsX[PointCount] = Point.X;
+			PointsY[PointCount] = Point.Y;
+			PointsZ[PointCount] = Point.Z;
+			++PointCount;
+		}
+	}
+
+	std::fill(PointsX.begin() + PointCount, PointsX.end(), 0.f);
+	std::fill(PointsY.begin() + PointCount, PointsY.end(), 0.f);
+	std::fill(PointsZ.begin() + PointCount, PointsZ.end(), 0.f);
+}
+
+void OcclusionDepthBuffer::Dilate()
+{
+	// Separable 3x3 minimum, horizontal into the dilation buffer and vertical into the depth
+	DilationBuffer.resize(RasterizedDepth.size());
+	Depth.resize(RasterizedDepth.size());
+
+	for (unsigned Y = 0; Y < Height; ++Y)
+	{
+		const float * Source = &RasterizedDepth[Y * Width];
+		float * Target = &DilationBuffer[Y * Width];
+
+		for (unsigned X = 0; X < Width; ++X)
+		{
+			float Minimum = Source[X];
+			Minimum = (X > 0) ? (std::min)(Minimum, Source[X - 1]) : Minimum;
+			Minimum = (X + 1 < Width) ? (std::min)(Minimum, Source[X + 1]) : Minimum;
+			Target[X] = Minimum;
+		}
+	}
+
+	for (unsigned Y = 0; Y < Height; ++Y)
+	{
+		const float * Above = &DilationBuffer[((Y > 0) ? Y - 1 : Y) * Width];
+		const float * Center = &DilationBuffer[Y * Width];
+		const float * Below = &DilationBuffer[((Y + 1 < Height) ? Y + 1 : Y) * Width];
+		float * Target = &Depth[Y * Width];
+
+		for (unsigned X = 0; X < Width; ++X)
+		{
+			Target[X] = (std::min)((std::min)(Above[X], Center[X]), Below[X]);
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "DepthRegion.h"
+#include "Kinect.h"
+#include "PerformanceCounter.h"
+
+class Camera;
+
+// Depth buffer of the user for an eye, rasterized on the CPU by projecting the depth points instead of drawing
+// the depth mesh. The buffer has a fraction of the output resolution; gaps between the projected points are closed
+// by a small min dilation, which grows the occluder by one low resolution pixel.
+class OcclusionDepthBuffer
+{
+public:
+	static constexpr unsigned Downsampling = 4;
+
+	OcclusionDepthBuffer(_In_ Kinect & Kinect);
+
+	// Depth of the points as seen through View, for an output of TargetWidth x TargetHeight pixels
+	void Rasterize(_In_ const Camera & View, _In_ unsigned TargetWidth, _In_ unsigned TargetHeight);
+
+	// Row major normalized device depth, 1 where no point was projected
+	const std::vector<float> & GetDepth() const;
+
+	// The depth before the dilation; it never reaches past the silhouette of the user, so culling against it stays
+	// conservative, but it is 1 in the gaps between the projected points
+	const std::vector<float> & GetRasterizedDepth() const;
+	unsigned GetWidth() const;
+	unsigned GetHeight() const;
+	size_t GetPointCount() const;
+
+private:
+	// The valid points of the region of interest, split into components for the SIMD projection
+	std::vector<float> PointsX;
+	std::vector<float> PointsY;
+	std::vector<float> PointsZ;
+	size_t PointCount;
+
+	Vector3 Offset;
+	float RealWorldToVirtualScale;
+
+	std::vector<float> RasterizedDepth;
+	std::vector<float> Depth;
+	std::vector<float> DilationBuffer;
+	unsigned Width;
+	unsigned Height;
+
+	PerformanceCounter RasterizeTime;
+
+	void OffsetUpdatedCallback(_In_ const Vector3 & Offset);
+	void DepthVerticesUpdatedCallback(_In_ const Kinect::CameraSpacePointList & DepthVertices, _In_ const Kinect::NormalList & Normals, _In_ const DepthRegion & Region);
+
+	void Dilate();
+};
@@ -0,0 +1,103 @@
+// OcclusionDepthPass11.cpp : Uploads the CPU occlusion depth and writes it into the depth buffer
+//
+
+#include "stdafx.h"
+#ifdef USE_D3DX11
+#include "OcclusionDepthPass11.h"
+
+#include "GraphicsContext11.h"
+
+#include "GraphicsContext.h"
+#include "OcclusionDepthBuffer.h"
+#include "Resource.h"
+
+namespace D3DX11
+{
+	OcclusionDepthPass::OcclusionDepthPass(_In_ GraphicsContext & DeviceContext)
+		:DeviceContext(DeviceContext), TextureWidth(0), TextureHeight(0)
+	{
+	}
+
+	void OcclusionDepthPass::Create()
+	{
+		Microsoft::WRL::ComPtr<ID3DBlob> VertexShaderBlob;
+		Microsoft::WRL::ComPtr<ID3DBlob> PixelShaderBlob;
+
+		GraphicsContext::LoadAndCompileShader(VertexShaderBlob, PixelShaderBlob, IDR_SHADER11, "5_0", "OcclusionVShader", "OcclusionPShader");
+
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateVertexShader(VertexShaderBlob->GetBufferPointer(), VertexShaderBlob->GetBufferSize(), nullptr, &VertexShader));
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreatePixelShader(PixelShaderBlob->GetBufferPointer(), PixelShaderBlob->GetBufferSize(), nullptr, &PixelShader));
+
+		// The pass writes depth only, so the color writes of the bound render target are masked off
+		D3D11_BLEND_DESC BlendDesc = {};
+		BlendDesc.RenderTarget[0].BlendEnable = FALSE;
+		BlendDesc.RenderTarget[0].RenderTargetWriteMask = 0;
+
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateBlendState(&BlendDesc, &DepthOnlyBlendState));
+	}
+
+	void OcclusionDepthPass::Render(_In_ const OcclusionDepthBuffer & Buffer)
+	{
+		UploadDepth(Buffer);
+
+		// The fullscreen triangle is generated from the vertex ids, without vertex buffer and input layout
+		std::array<ID3D11ShaderResourceView *const, 1> Views = { DepthView.Get() };
+		DeviceContext.GetDeviceContext()->IASetInputLayout(nullptr);
+		DeviceContext.GetDeviceContext()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		DeviceContext.GetDeviceContext()->VSSetShader(VertexShader.Get(), nullptr, 0);
+		DeviceContext.GetDeviceContext()->GSSetShader(nullptr, nullptr, 0);
+		DeviceContext.GetDeviceContext()->PSSetShader(PixelShader.Get(), nullptr, 0);
+		DeviceContext.GetDeviceContext()->PSSetShaderResources(0, 1, Views.data());
+		DeviceContext.GetDeviceContext()->OMSetBlendState(DepthOnlyBlendState.Get(), nullptr, 0xFFFFFFFF);
+
+		DeviceContext.GetDeviceContext()->Draw(3, 0);
+
+		DeviceContext.GetDeviceContext()->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+	}
+
+	void OcclusionDepthPass::CreateDepthTexture(_In_ UINT Width, _In_ UINT Height)
+	{
+		DepthView.Reset();
+		DepthTexture.Reset();
+
+		D3D11_TEXTURE2D_DESC TextureDesc = {};
+		TextureDesc.Width = Width;
+		TextureDesc.Height = Height;
+		TextureDesc.MipLevels = 1;
+		TextureDesc.ArraySize = 1;
+		TextureDesc.Format = DXGI_FORMAT_R32_FLOAT;
+		TextureDesc.SampleDesc.Count = 1;
+		TextureDesc.SampleDesc.Quality = 0;
+		TextureDesc.Usage = D3D11_USAGE_DYNAMIC;
+		TextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		TextureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		TextureDesc.MiscFlags = 0;
+
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateTexture2D(&TextureDesc, nullptr, &DepthTexture));
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateShaderResourceView(DepthTexture.Get(), nullptr, &DepthView));
+
+		TextureWidth = Width;
+		TextureHeight = Height;
+	}
+
+	void OcclusionDepthPass::UploadDepth(_In_ const OcclusionDepthBuffer & Buffer)
+	{
+		if (!DepthTexture || (TextureWidth != Buffer.GetWidth()) || (TextureHeight != Buffer.GetHeight()))
+		{
+			CreateDepthTexture(Buffer.GetWidth(), Buffer.GetHeight());
+		}
+
+		D3D11_MAPPED_SUBRESOURCE MappedSubresource = {};
+		Utility::ThrowOnFail(DeviceContext.GetDeviceContext()->Map(DepthTexture.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &MappedSubresource));
+
+		// Rows of the mapped texture may be padded
+		const std::vector<float> & Depth = Buffer.GetDepth();
+		for (UINT Row = 0; Row < TextureHeight; ++Row)
+		{
+			std::memcpy(static_cast<BYTE *>(MappedSubresource.pData) + Row * MappedSubresource.RowPitch, &Depth[Row * TextureWidth], TextureWidth * sizeof(float));
+		}
+
+		DeviceContext.GetDeviceContext()->Unmap(DepthTexture.Get(), 0);
+	}
+}
+#endif
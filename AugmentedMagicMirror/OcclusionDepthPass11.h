@@ -0,0 +1,35 @@
+#pragma once
+
+class OcclusionDepthBuffer;
+
+namespace D3DX11
+{
+	class GraphicsContext;
+
+	// Writes an OcclusionDepthBuffer into the bound depth buffer, in place of drawing the occluder mesh
+	class OcclusionDepthPass
+	{
+	public:
+		OcclusionDepthPass(_In_ GraphicsContext & DeviceContext);
+		~OcclusionDepthPass() = default;
+
+		void Create();
+
+		void Render(_In_ const OcclusionDepthBuffer & Buffer);
+
+	private:
+		GraphicsContext & DeviceContext;
+
+		Microsoft::WRL::ComPtr<ID3D11VertexShader> VertexShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> PixelShader;
+		Microsoft::WRL::ComPtr<ID3D11BlendState> DepthOnlyBlendState;
+
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> DepthTexture;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> DepthView;
+		UINT TextureWidth;
+		UINT TextureHeight;
+
+		void CreateDepthTexture(_In_ UINT Width, _In_ UINT Height);
+		void UploadDepth(_In_ const OcclusionDepthBuffer & Buffer);
+	};
+}
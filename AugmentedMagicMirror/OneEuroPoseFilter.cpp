@@ -0,0 +1,70 @@
+// OneEuroPoseFilter.cpp : Speed adaptive low pass filter for the head position
+//
+
+#include "stdafx.h"
+#include "OneEuroPoseFilter.h"
+
+#include "SimdMath.h"
+
+OneEuroPoseFilter::OneEuroPoseFilter(_In_ float MinCutoff, _In_ float Beta, _In_ float DerivativeCutoff)
+	:MinCutoff(MinCutoff), Beta(Beta), DerivativeCutoff(DerivativeCutoff)
+{
+	Reset();
+}
+
+void OneEuroPoseFilter::Reset()
+{
+	HasState = false;
+	LastTime = 0.0;
+	Position = Vector3();
+	Velocity = Vector3();
+}
+
+void OneEuroPoseFilter::Update(_In_ const Vector3 & Measurement, _In_ double Time)
+{
+	double Interval = Time - LastTime;
+
+	if (!HasState || (Interval > MaxInterval))
+	{
+		HasState = true;
+		LastTime = Time;
+		Position = Measurement;
+		Velocity = Vector3();
+		return;
+	}
+
+	// Measurements with the same time stamp carry no velocity
+	if (Interval <= 0.0)
+	{
+		return;
+	}
+
+	float FloatInterval = static_cast<float>(Interval);
+	SimdMath::Vector Measured = SimdMath::LoadFloat3(&Measurement.X);
+	SimdMath::Vector Filtered = SimdMath::LoadFloat3(&Position.X);
+
+	SimdMath::Vector MeasuredVelocity = SimdMath::Scale(SimdMath::Subtract(Measured, Filtered), 1.f / FloatInterval);
+	SimdMath::Vector FilteredVelocity = SimdMath::Lerp(SimdMath::LoadFloat3(&Velocity.X), MeasuredVelocity, GetSmoothing(DerivativeCutoff, FloatInterval));
+
+	float Speed = SimdMath::GetX(SimdMath::Length3(FilteredVelocity));
+	SimdMath::StoreFloat3(&Velocity.X, FilteredVelocity);
+	SimdMath::StoreFloat3(&Position.X, SimdMath::Lerp(Filtered, Measured, GetSmoothing(MinCutoff + Beta * Speed, FloatInterval)));
+	LastTime = Time;
+}
+
+Vector3 OneEuroPoseFilter::Predict(_In_ double Time) const
+{
+	float Step = static_cast<float>((std::min)(Time - LastTime, static_cast<double>(MaxInterval)));
+
+	Vector3 Predicted;
+	SimdMath::StoreFloat3(&Predicted.X, SimdMath::Add(SimdMath::LoadFloat3(&Position.X), SimdMath::Scale(SimdMath::LoadFloat3(&Velocity.X), Step)));
+
+	return Predicted;
+}
+
+float OneEuroPoseFilter::GetSmoothing(_In_ float Cutoff, _In_ float Interval)
+{
+	float TimeConstant = 1.f / (2.f * SimdMath::Pi * Cutoff);
+
+	return 1.f / (1.f + TimeConstant / Interval);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "PoseFilter.h"
+
+// One Euro filter (Casiez et al. 2012): a low pass whose cutoff frequency rises with the speed of the head,
+// i.e. strong smoothing at rest against jitter and little smoothing during motion against lag.
+// The cutoff follows the speed of the position as a whole, so all axes are smoothed alike.
+class OneEuroPoseFilter : public PoseFilter
+{
+public:
+	// Cutoffs in Hz, Beta in Hz per m/s
+	OneEuroPoseFilter(_In_ float MinCutoff = 0.5f, _In_ float Beta = 20.f, _In_ float DerivativeCutoff = 1.f);
+
+	void Reset() override;
+	void Update(_In_ const Vector3 & Measurement, _In_ double Time) override;
+	Vector3 Predict(_In_ double Time) const override;
+
+private:
+	const float MinCutoff;
+	const float Beta;
+	const float DerivativeCutoff;
+
+	bool HasState;
+	double LastTime;
+	Vector3 Position;
+	Vector3 Velocity;
+
+	static float GetSmoothing(_In_ float Cutoff, _In_ float Interval);
+};
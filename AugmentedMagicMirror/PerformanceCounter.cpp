@@ -0,0 +1,98 @@
+// PerformanceCounter.cpp : Collects timings or other per frame values and reports them periodically
+//
+
+#include "stdafx.h"
+#include "PerformanceCounter.h"
+
+PerformanceCounter::PerformanceCounter(_In_ const std::wstring & Name, _In_ const std::wstring & Unit, _In_ unsigned ReportInterval)
+	:Name(Name), Unit(Unit), ReportInterval(ReportInterval)
+	, StartTime(0.0)
+{
+	Reset();
+}
+
+double PerformanceCounter::GetTime()
+{
+	static const double Frequency = []()
+	{
+		LARGE_INTEGER Value;
+		QueryPerformanceFrequency(&Value);
+		return static_cast<double>(Value.QuadPart);
+	}();
+
+	LARGE_INTEGER Counter;
+	QueryPerformanceCounter(&Counter);
+
+	return static_cast<double>(Counter.QuadPart) / Frequency;
+}
+
+void PerformanceCounter::Start()
+{
+	StartTime = GetTime();
+}
+
+void PerformanceCounter::Stop()
+{
+	AddSample((GetTime() - StartTime) * 1000.0);
+}
+
+void PerformanceCounter::AddSample(_In_ double Value)
+{
+	Sum += Value;
+	Minimum = std::fmin(Minimum, Value);
+	Maximum = std::fmax(Maximum, Value);
+	++SampleCount;
+
+	// A ReportInterval of 0 disables the periodic report, e.g. for benchmarks that read the values themselves
+	if ((ReportInterval != 0) && (SampleCount >= ReportInterval))
+	{
+		Report();
+		Reset();
+	}
+}
+
+void PerformanceCounter::Reset()
+{
+	Sum = 0.0;
+	Minimum = (std::numeric_limits<double>::max)();
+	Maximum = std::numeric_limits<double>::lowest();
+	SampleCount = 0;
+}
+
+const std::wstring & PerformanceCounter::GetName() const
+{
+	return Name;
+}
+
+const std::wstring & PerformanceCounter::GetUnit() const
+{
+	return Unit;
+}
+
+unsigned PerformanceCounter::GetSampleCount() const
+{
+	return SampleCount;
+}
+
+double PerformanceCounter::GetAverage() const
+{
+	return (SampleCount > 0) ? (Sum / SampleCount) : 0.0;
+}
+
+double PerformanceCounter::GetMinimum() const
+{
+	return (SampleCount > 0) ? Minimum : 0.0;
+}
+
+double PerformanceCounter::GetMaximum() const
+{
+	return (SampleCount > 0) ? Maximum : 0.0;
+}
+
+void PerformanceCounter::Report()
+{
+	std::wstringstream Message;
+	Message << Name << L": " << GetAverage() << L" " << Unit << L" (Min: " << GetMinimum() << L", Max: " << GetMaximum() << L", Samples: " << SampleCount << L")";
+
+	Utility::Log(Message.str().c_str());
+}
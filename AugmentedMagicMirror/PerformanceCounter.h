@@ -0,0 +1,34 @@
+#pragma once
+
+class PerformanceCounter
+{
+public:
+	PerformanceCounter(_In_ const std::wstring & Name, _In_ const std::wstring & Unit = L"ms", _In_ unsigned ReportInterval = 300);
+
+	static double GetTime();
+
+	void Start();
+	void Stop();
+	void AddSample(_In_ double Value);
+	void Reset();
+
+	const std::wstring & GetName() const;
+	const std::wstring & GetUnit() const;
+	unsigned GetSampleCount() const;
+	double GetAverage() const;
+	double GetMinimum() const;
+	double GetMaximum() const;
+
+private:
+	std::wstring Name;
+	std::wstring Unit;
+	unsigned ReportInterval;
+
+	double StartTime;
+	double Sum;
+	double Minimum;
+	double Maximum;
+	unsigned SampleCount;
+
+	void Report();
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+// Filters the measured position of a tracked face point and extrapolates it, e.g. to hide the tracking latency
+class PoseFilter
+{
+public:
+	virtual ~PoseFilter() = default;
+
+	virtual void Reset() = 0;
+
+	// Adds a measured position (in camera space meters) taken at Time (in seconds); must not allocate
+	virtual void Update(_In_ const Vector3 & Measurement, _In_ double Time) = 0;
+
+	// The filtered position extrapolated to Time, e.g. the time the frame is expected to be displayed;
+	// at most MaxInterval past the last measurement, so a lost head stays where it was last expected
+	virtual Vector3 Predict(_In_ double Time) const = 0;
+
+protected:
+	// Measurements further apart than this restart the filter, e.g. after the face was lost
+	static constexpr double MaxInterval = 0.5;
+};
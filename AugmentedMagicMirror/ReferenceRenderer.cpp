@@ -0,0 +1,205 @@
+// ReferenceRenderer.cpp : Graphics backend running the vertex stage on the CPU
+//
+
+#include "stdafx.h"
+#include "ReferenceRenderer.h"
+
+#include "Camera.h"
+#include "StereoFrameCamera.h"
+
+namespace Reference
+{
+	// The matrices are stored transposed, so the shader's mul(Vector, Matrix) is a dot product with each stored row
+	static DirectX::XMFLOAT4 Multiply(_In_ const DirectX::XMFLOAT4 & Vector, _In_ const DirectX::XMFLOAT4X4 & Matrix)
+	{
+		std::array<float, 4> Result;
+
+		for (unsigned Row = 0; Row < 4; ++Row)
+		{
+			Result[Row] = Vector.x * Matrix.m[Row][0] + Vector.y * Matrix.m[Row][1] + Vector.z * Matrix.m[Row][2] + Vector.w * Matrix.m[Row][3];
+		}
+
+		return DirectX::XMFLOAT4(Result[0], Result[1], Result[2], Result[3]);
+	}
+
+	RenderingContext::RenderingContext()
+		:ViewMatrices(), ProjectionMatrices(), ObjectMatrix(), TargetSlice(0), IsStereo(false), Counts()
+	{
+	}
+
+	void RenderingContext::Prepare(_In_ const Camera & Camera, _In_ UINT Slice)
+	{
+		ViewMatrices[Slice] = Camera.GetViewMatrix();
+		ProjectionMatrices[Slice] = Camera.GetProjectionMatrix();
+		TargetSlice = Slice;
+		IsStereo = false;
+
+		++Counts.UploadCount;
+		Counts.UploadedBytes += sizeof(ViewMatrices[Slice]) + sizeof(ProjectionMatrices[Slice]);
+	}
+
+	void RenderingContext::PrepareStereo(_In_ const Camera & LeftEye, _In_ const Camera & RightEye)
+	{
+		StereoFrameCamera::StereoConstants Constants;
+		StereoFrameCamera::GetConstants(LeftEye, RightEye, Constants);
+
+		ViewMatrices = Constants.View;
+		ProjectionMatrices = Constants.Projection;
+		IsStereo = true;
+
+		++Counts.UploadCount;
+		Counts.UploadedBytes += sizeof(Constants);
+	}
+
+	void RenderingContext::SetObjectMatrix(_In_ const DirectX::XMFLOAT4X4 & ObjectMatrix)
+	{
+		this->ObjectMatrix = ObjectMatrix;
+
+		++Counts.UploadCount;
+		Counts.UploadedBytes += sizeof(ObjectMatrix);
+	}
+
+	void RenderingContext::UploadInstances(_In_ const InstanceBuffer & Instances)
+	{
+		InstanceMatrices.assign(Instances.GetData(), Instances.GetData() + Instances.GetCount());
+
+		++Counts.UploadCount;
+		Counts.UploadedBytes += Instances.GetSize();
+	}
+
+	void RenderingContext::DrawIndexed(_In_ const ::Mesh::VertexList & Vertices, _In_ const ::Mesh::IndexList & Indices, _In_ UINT IndexCount, _In_ UINT StartIndex)
+	{
+		++Counts.DrawCount;
+		TransformVertices(Vertices, Indices, IndexCount, StartIndex, ObjectMatrix, TargetSlice);
+	}
+
+	void RenderingContext::DrawIndexedInstanced(_In_ const ::Mesh::VertexList & Vertices, _In_ const ::Mesh::IndexList & Indices, _In_ UINT IndexCount, _In_ UINT StartIndex, _In_ UINT InstanceCount, _In_ UINT StartInstance)
+	{
+		UINT InstancesPerObject = IsStereo ? StereoFrameCamera::Eye_Count : 1;
+		UINT ObjectCount = (InstanceCount + InstancesPerObject - 1) / InstancesPerObject;
+
+		if (static_cast<size_t>(StartInstance) + ObjectCount > InstanceMatrices.size())
+		{
+			Utility::Throw(L"Instance range is outside the uploaded instances");
+		}
+
+		++Counts.DrawCount;
+
+		// Like the input assembler, the start instance is added after stepping
+		for (UINT Instance = 0; Instance < InstanceCount; ++Instance)
+		{
+			UINT Slice = IsStereo ? (Instance & 1) : TargetSlice;
+			TransformVertices(Vertices, Indices, IndexCount, StartIndex, InstanceMatrices[StartInstance + Instance / InstancesPerObject], Slice);
+		}
+	}
+
+	const std::vector<DirectX::XMFLOAT4> & RenderingContext::GetPositions(_In_ UINT Slice) const
+	{
+		return Positions[Slice];
+	}
+
+	const RenderingContext::Statistics & RenderingContext::GetStatistics() const
+	{
+		return Counts;
+	}
+
+	void RenderingContext::Reset()
+	{
+		for (std::vector<DirectX::XMFLOAT4> & SlicePositions : Positions)
+		{
+			SlicePositions.clear();
+		}
+
+		Counts = {};
+	}
+
+	void RenderingContext::TransformVertices(_In_ const ::Mesh::VertexList & Vertices, _In_ const ::Mesh::IndexList & Indices, _In_ UINT IndexCount, _In_ UINT StartIndex, _In_ const DirectX::XMFLOAT4X4 & World, _In_ UINT Slice)
+	{
+		Counts.VertexCount += IndexCount;
+
+		for (UINT Index = StartIndex; Index < StartIndex + IndexCount; ++Index)
+		{
+			const DirectX::XMFLOAT3 & Position = Vertices[Indices[Index]].Position;
+			DirectX::XMFLOAT4 Output(Position.x, Position.y, Position.z, 1.0f);
+
+			Output = Multiply(Output, World);
+			Output = Multiply(Output, ViewMatrices[Slice]);
+			Output = Multiply(Output, ProjectionMatrices[Slice]);
+
+			Positions[Slice].push_back(Output);
+		}
+	}
+
+	size_t Mesh::UpdateVertices(_In_ const VertexList & Vertices, _In_ const ByteRangeList & DirtyRanges)
+	{
+		const BYTE * VertexData = reinterpret_cast<const BYTE *>(Vertices.data());
+		BYTE * Target = reinterpret_cast<BYTE *>(this->Vertices.data());
+		size_t UploadedBytes = 0;
+
+		for (const ByteRange & Range : DirtyRanges)
+		{
+			std::memcpy(Target + Range.Offset, VertexData + Range.Offset, Range.Size);
+			UploadedBytes += Range.Size;
+		}
+
+		return UploadedBytes;
+	}
+
+	void Mesh::UpdateIndices(_In_ const IndexList & Indices)
+	{
+		if (Indices.size() > IndexCapacity)
+		{
+			Utility::Throw(L"Index buffer is too small");
+		}
+
+		this->Indices = Indices;
+	}
+
+	void Mesh::Render(_In_ RenderingContext & RenderingContext, _In_ const TransformList & Objects) const
+	{
+		for (const Transform & Object : Objects)
+		{
+			RenderingContext.SetObjectMatrix(Object.GetMatrix());
+
+			if (DrawRanges.empty())
+			{
+				RenderingContext.DrawIndexed(Vertices, Indices, static_cast<UINT>(Indices.size()), 0);
+			}
+
+			for (const IndexRange & Range : DrawRanges)
+			{
+				RenderingContext.DrawIndexed(Vertices, Indices, Range.Count, Range.First);
+			}
+		}
+	}
+
+	UINT Mesh::Render(_In_ RenderingContext & RenderingContext, _In_ const InstanceBuffer::Range & Instances, _In_ UINT InstancesPerObject) const
+	{
+		if (Instances.Count == 0)
+		{
+			return 0;
+		}
+
+		UINT InstanceCount = Instances.Count * InstancesPerObject;
+
+		if (DrawRanges.empty())
+		{
+			RenderingContext.DrawIndexedInstanced(Vertices, Indices, static_cast<UINT>(Indices.size()), 0, InstanceCount, Instances.First);
+			return 1;
+		}
+
+		for (const IndexRange & Range : DrawRanges)
+		{
+			RenderingContext.DrawIndexedInstanced(Vertices, Indices, Range.Count, Range.First, InstanceCount, Instances.First);
+		}
+
+		return static_cast<UINT>(DrawRanges.size());
+	}
+
+	void Mesh::Create(_In_ const VertexList & Vertices, _In_ const IndexList & Indices)
+	{
+		this->Vertices = Vertices;
+		this->Indices = Indices;
+		IndexCapacity = Indices.size();
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "InstanceBuffer.h"
+#include "Mesh.h"
+
+class Camera;
+
+// A graphics backend that runs the vertex stage of the default shader on the CPU, so the draws and uploads of a frame
+// can be counted and the transformed positions compared without a device. It offers the per object constant path the
+// graphics backends used before instancing next to the instanced one.
+namespace Reference
+{
+	class RenderingContext
+	{
+	public:
+		struct Statistics
+		{
+			size_t DrawCount;
+			size_t UploadCount;
+			size_t UploadedBytes;
+			size_t VertexCount;
+		};
+
+		static constexpr UINT SliceCount = 2;
+
+		RenderingContext();
+
+		// Draws into the given slice of the render target array
+		void Prepare(_In_ const Camera & Camera, _In_ UINT Slice = 0);
+
+		// Draws every instance once per eye into the slice of the eye, like the single pass stereo shader; the object
+		// matrices step once every two instances
+		void PrepareStereo(_In_ const Camera & LeftEye, _In_ const Camera & RightEye);
+
+		// Updates the object constants, one upload per object
+		void SetObjectMatrix(_In_ const DirectX::XMFLOAT4X4 & ObjectMatrix);
+
+		// Replaces the instance buffer, one upload per frame
+		void UploadInstances(_In_ const InstanceBuffer & Instances);
+
+		// DrawIndexed uses the object constants, DrawIndexedInstanced the uploaded instances
+		void DrawIndexed(_In_ const ::Mesh::VertexList & Vertices, _In_ const ::Mesh::IndexList & Indices, _In_ UINT IndexCount, _In_ UINT StartIndex);
+		void DrawIndexedInstanced(_In_ const ::Mesh::VertexList & Vertices, _In_ const ::Mesh::IndexList & Indices, _In_ UINT IndexCount, _In_ UINT StartIndex, _In_ UINT InstanceCount, _In_ UINT StartInstance);
+
+		// The clip space positions of all vertices drawn into a slice in the order they were drawn
+		const std::vector<DirectX::XMFLOAT4> & GetPositions(_In_ UINT Slice = 0) const;
+		const Statistics & GetStatistics() const;
+		void Reset();
+
+	private:
+		std::array<DirectX::XMFLOAT4X4, SliceCount> ViewMatrices;
+		std::array<DirectX::XMFLOAT4X4, SliceCount> ProjectionMatrices;
+		DirectX::XMFLOAT4X4 ObjectMatrix;
+		std::vector<DirectX::XMFLOAT4X4> InstanceMatrices;
+		UINT TargetSlice;
+		bool IsStereo;
+
+		std::array<std::vector<DirectX::XMFLOAT4>, SliceCount> Positions;
+		Statistics Counts;
+
+		void TransformVertices(_In_ const ::Mesh::VertexList & Vertices, _In_ const ::Mesh::IndexList & Indices, _In_ UINT IndexCount, _In_ UINT StartIndex, _In_ const DirectX::XMFLOAT4X4 & World, _In_ UINT Slice);
+	};
+
+	class Mesh : public ::Mesh
+	{
+	public:
+		using ::Mesh::UpdateVertices;
+		virtual size_t UpdateVertices(_In_ const VertexList & Vertices, _In_ const ByteRangeList & DirtyRanges);
+		virtual void UpdateIndices(_In_ const IndexList & Indices);
+
+		// One draw per object and draw range, with the object matrix set before each object
+		void Render(_In_ RenderingContext & RenderingContext, _In_ const TransformList & Objects) const;
+
+		// One draw per draw range for all objects of the range, each drawn InstancesPerObject times; returns the draws
+		UINT Render(_In_ RenderingContext & RenderingContext, _In_ const InstanceBuffer::Range & Instances, _In_ UINT InstancesPerObject = 1) const;
+
+	private:
+		VertexList Vertices;
+		IndexList Indices;
+		size_t IndexCapacity = 0;
+
+		virtual void Create(_In_ const VertexList & Vertices, _In_ const IndexList & Indices);
+	};
+}
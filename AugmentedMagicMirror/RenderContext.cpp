@@ -12,5 +12,12 @@
 RenderContext::RenderContext(_In_ Window & TargetWindow, _In_ Camera & NoseCamera, _In_ Camera & LeftEyeCamera, _In_ Camera & RighEyeCamera)
 	:TargetWindow(TargetWindow)
 	, NoseCamera(NoseCamera), LeftEyeCamera(LeftEyeCamera), RighEyeCamera(RighEyeCamera)
+	, OcclusionDepth(nullptr), OccluderMesh(nullptr)
 {
 }
+
+void RenderContext::SetOcclusionDepth(_In_ OcclusionDepthBuffer & Buffer, _In_ const Mesh & OccluderMesh)
+{
+	OcclusionDepth = &Buffer;
+	this->OccluderMesh = &OccluderMesh;
+}
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "Callback.h"
 #include "Transform.h"
 
 class Camera;
 class Mesh;
+class OcclusionDepthBuffer;
 class Window;
 
 class RenderContext;
@@ -19,11 +21,23 @@ public:
 
 	typedef std::pair<const Mesh &, const TransformList &> ObjectList;
 	typedef std::vector<ObjectList> MeshList;
-	virtual void Render(_In_ MeshList DrawCalls) = 0;
+	virtual void Render(_In_ const MeshList & DrawCalls) = 0;
+
+	// Contexts supporting it may write Buffer into the depth buffer instead of drawing OccluderMesh
+	void SetOcclusionDepth(_In_ OcclusionDepthBuffer & Buffer, _In_ const Mesh & OccluderMesh);
+
+	// Fires right before the matrices of a camera are uploaded for drawing, listeners may still update that camera
+	Callback<Camera> CameraLatching;
+
+	// Fires once for both eyes of a stereo frame instead, so listeners update them from the same state
+	Callback<Camera, Camera> StereoCameraLatching;
 
 protected:
 	Window & TargetWindow; 
 	Camera & NoseCamera;
 	Camera & LeftEyeCamera;
 	Camera & RighEyeCamera;
+
+	OcclusionDepthBuffer * OcclusionDepth;
+	const Mesh * OccluderMesh;
 };
@@ -9,13 +9,18 @@
 #include "Mesh11.h"
 
 #include "Camera.h"
+#include "OcclusionDepthBuffer.h"
+#include "StereoFrameCamera.h"
 
 namespace D3DX11
 {
 	RenderContext::RenderContext(_In_ GraphicsContext & DeviceContext, _In_ Window & TargetWindow, _In_ Camera & NoseCamera, _In_ Camera & LeftEyeCamera, _In_ Camera & RighEyeCamera)
 		: ::RenderContext(TargetWindow, NoseCamera, LeftEyeCamera, RighEyeCamera)
 		, DeviceContext(DeviceContext)
-		, StereoEnabled(false), ForceMono(false)
+		, StereoEnabled(false), ForceMono(false), UseOcclusionDepth(false), UseOcclusionCulling(false), UseFrustumCulling(true), UseSinglePassStereo(true)
+		, OcclusionPass(DeviceContext), CulledCount(0), CulledObjects(L"Culled Objects", L"count")
+		, FrustumCulledObjects(L"Frustum Culled Objects", L"count")
+		, DrawCount(0), SubmittedDraws(L"Draw Calls", L"count"), SubmitTime(L"Submit Time")
 		, Viewport({}), ScissorRect({})
 	{
 	}
@@ -33,29 +38,95 @@ namespace D3DX11
 
 		UpdateStereoStatus();
 		CreateSizeDependantResources();
+
+		OcclusionPass.Create();
 	}
 
-	void RenderContext::Render(_In_ MeshList DrawCalls)
+	void RenderContext::Render(_In_ const MeshList & DrawCalls)
 	{
+		// Latched once per frame before the submission is timed, which leaves polling for the newest head pose out of it
+		LatchCameras();
+
+		SubmitTime.Start();
+		CulledCount = 0;
+		DrawCount = 0;
+
 		if (StereoEnabled)
 		{
 			RenderStereo(DrawCalls);
 		}
 		else
 		{
-			RenderEye(DrawCalls, NoseCamera, RTVLeft);
+			RenderEye(DrawCalls, NoseCamera, RTVLeft, true);
+		}
+
+		if (UseOcclusionCulling && (OcclusionDepth != nullptr))
+		{
+			CulledObjects.AddSample(static_cast<double>(CulledCount));
 		}
 
+		SubmittedDraws.AddSample(static_cast<double>(DrawCount));
+		SubmitTime.Stop();
+
 		SwapChain->Present(0, 0);
 	}
 
-	void RenderContext::RenderStereo(_In_ MeshList DrawCalls)
+	void RenderContext::LatchCameras()
+	{
+		if (!StereoEnabled)
+		{
+			CameraLatching(NoseCamera);
+			return;
+		}
+
+		// Both eyes are latched together even when the left one is shown to both, they come from the same head pose
+		StereoCameraLatching(LeftEyeCamera, RighEyeCamera);
+	}
+
+	void RenderContext::RenderStereo(_In_ const MeshList & DrawCalls)
+	{
+		// The occluder is rasterized on the CPU for one eye at a time, which needs a pass per eye
+		bool UsesOcclusionDepth = (UseOcclusionDepth || UseOcclusionCulling) && (OcclusionDepth != nullptr);
+		if (UseSinglePassStereo && !UsesOcclusionDepth)
+		{
+			RenderBothEyes(DrawCalls);
+			return;
+		}
+
+		RenderEye(DrawCalls, LeftEyeCamera, RTVLeft, true);
+		RenderEye(DrawCalls, ForceMono ? LeftEyeCamera : RighEyeCamera, RTVRight, false);
+	}
+
+	void RenderContext::RenderBothEyes(_In_ const MeshList & DrawCalls)
 	{
-		RenderEye(DrawCalls, LeftEyeCamera, RTVLeft);
-		RenderEye(DrawCalls, ForceMono ? LeftEyeCamera : RighEyeCamera, RTVRight);
+		std::array<ID3D11RenderTargetView *const, 1> RTVs = { RTVStereo.Get() };
+		DeviceContext.GetDeviceContext()->OMSetRenderTargets(1, RTVs.data(), DSVStereo.Get());
+		DeviceContext.GetDeviceContext()->ClearRenderTargetView(RTVs[0], BackgroundColor.data());
+		DeviceContext.GetDeviceContext()->ClearDepthStencilView(DSVStereo.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+		DeviceContext.GetDeviceContext()->RSSetViewports(1, &Viewport);
+		DeviceContext.GetDeviceContext()->RSSetScissorRects(1, &ScissorRect);
+
+		Camera & RightEye = ForceMono ? LeftEyeCamera : RighEyeCamera;
+		DeviceContext.GetDefaultShader().PrepareStereo(LeftEyeCamera, RightEye);
+
+		if (UseFrustumCulling)
+		{
+			CullOutsideFrustum(DrawCalls, LeftEyeCamera);
+		}
+
+		PackInstances(DrawCalls, LeftEyeCamera, false, false);
+		DeviceContext.GetDefaultShader().UploadInstances(Instances);
+
+		// Each object is submitted once and drawn for both eyes
+		for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+		{
+			const Mesh & Mesh11 = static_cast<const Mesh &>(DrawCalls[Index].first);
+			DrawCount += Mesh11.Render(InstanceRanges[Index], StereoFrameCamera::Eye_Count);
+		}
 	}
 
-	void RenderContext::RenderEye(_In_ MeshList DrawCalls, _In_ const Camera & View, _In_ Microsoft::WRL::ComPtr<ID3D11RenderTargetView> & RTV)
+	void RenderContext::RenderEye(_In_ const MeshList & DrawCalls, _In_ const Camera & View, _In_ Microsoft::WRL::ComPtr<ID3D11RenderTargetView> & RTV, _In_ bool FirstEye)
 	{
 		std::array<ID3D11RenderTargetView *const, 1> RTVs = { RTV.Get() };
 		DeviceContext.GetDeviceContext()->OMSetRenderTargets(1, RTVs.data(), DSV.Get());
@@ -65,12 +136,102 @@ namespace D3DX11
 		DeviceContext.GetDeviceContext()->RSSetViewports(1, &Viewport);
 		DeviceContext.GetDeviceContext()->RSSetScissorRects(1, &ScissorRect);
 
+		// The occluder is rasterized on the CPU for this eye, either to write only its depth or to cull behind it
+		bool SkipOccluderMesh = UseOcclusionDepth && (OcclusionDepth != nullptr);
+		bool CullObjects = UseOcclusionCulling && (OcclusionDepth != nullptr);
+		if (SkipOccluderMesh || CullObjects)
+		{
+			OcclusionDepth->Rasterize(View, static_cast<unsigned>(Viewport.Width), static_cast<unsigned>(Viewport.Height));
+		}
+
+		if (SkipOccluderMesh)
+		{
+			OcclusionPass.Render(*OcclusionDepth);
+		}
+
+		if (CullObjects)
+		{
+			HierarchicalDepth.Build(*OcclusionDepth);
+		}
+
 		DeviceContext.GetDefaultShader().Prepare(View);
 
-		for (ObjectList & ObjectsToRender : DrawCalls)
+		if (FirstEye && UseFrustumCulling)
+		{
+			CullOutsideFrustum(DrawCalls, View);
+		}
+
+		if (FirstEye || CullObjects)
 		{
-			const Mesh & Mesh11 = static_cast<const Mesh &>(ObjectsToRender.first);
-			Mesh11.Render(DeviceContext.GetDefaultShader(), ObjectsToRender.second);
+			PackInstances(DrawCalls, View, SkipOccluderMesh, CullObjects);
+			DeviceContext.GetDefaultShader().UploadInstances(Instances);
+		}
+
+		for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+		{
+			const Mesh & Mesh11 = static_cast<const Mesh &>(DrawCalls[Index].first);
+			DrawCount += Mesh11.Render(InstanceRanges[Index]);
+		}
+	}
+
+	void RenderContext::CullOutsideFrustum(_In_ const MeshList & DrawCalls, _In_ const Camera & View)
+	{
+		ViewFrustum Frustum(View);
+
+		// Both eyes are culled at once against the union of their frusta. The right eye is resolved early for it, its
+		// own late latch only moves it by the head motion while the left eye is drawn.
+		if (StereoEnabled && !ForceMono)
+		{
+			RighEyeCamera.Resolve();
+			Frustum = ViewFrustum::Union(Frustum, ViewFrustum(RighEyeCamera));
+		}
+
+		FrustumVisibleObjects.resize(DrawCalls.size());
+		size_t FrustumCulledCount = 0;
+
+		for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+		{
+			const ObjectList & ObjectsToRender = DrawCalls[Index];
+
+			// The bounds of the occluder are not updated with its vertices
+			if (&ObjectsToRender.first == OccluderMesh)
+			{
+				continue;
+			}
+
+			FrustumCulledCount += Frustum.Cull(ObjectsToRender.first.GetBounds(), ObjectsToRender.second, FrustumVisibleObjects[Index]);
+		}
+
+		FrustumCulledObjects.AddSample(static_cast<double>(FrustumCulledCount));
+	}
+
+	void RenderContext::PackInstances(_In_ const MeshList & DrawCalls, _In_ const Camera & View, _In_ bool SkipOccluderMesh, _In_ bool CullObjects)
+	{
+		Instances.Clear();
+		InstanceRanges.clear();
+
+		for (size_t Index = 0; Index < DrawCalls.size(); ++Index)
+		{
+			const ObjectList & ObjectsToRender = DrawCalls[Index];
+
+			// A skipped occluder gets an empty range, so the ranges stay in the order of the draw calls
+			bool IsOccluder = (&ObjectsToRender.first == OccluderMesh);
+			if (SkipOccluderMesh && IsOccluder)
+			{
+				InstanceRanges.push_back(Instances.Append(nullptr, 0));
+				continue;
+			}
+
+			const TransformList & Objects = (UseFrustumCulling && !IsOccluder) ? FrustumVisibleObjects[Index] : ObjectsToRender.second;
+
+			if (CullObjects && !IsOccluder)
+			{
+				CulledCount += HierarchicalDepth.Cull(ObjectsToRender.first.GetBounds(), Objects, View, VisibleObjects);
+				InstanceRanges.push_back(Instances.Append(VisibleObjects));
+				continue;
+			}
+
+			InstanceRanges.push_back(Instances.Append(Objects));
 		}
 	}
 
@@ -99,6 +260,22 @@ namespace D3DX11
 		{
 			ForceMono = !ForceMono;
 		}
+		else if (VirtualKey == 'C')
+		{
+			UseOcclusionDepth = !UseOcclusionDepth;
+		}
+		else if (VirtualKey == 'Z')
+		{
+			UseOcclusionCulling = !UseOcclusionCulling;
+		}
+		else if (VirtualKey == 'V')
+		{
+			UseFrustumCulling = !UseFrustumCulling;
+		}
+		else if (VirtualKey == 'P')
+		{
+			UseSinglePassStereo = !UseSinglePassStereo;
+		}
 	}
 
 	void RenderContext::CreateSizeDependantResources()
@@ -125,7 +302,9 @@ namespace D3DX11
 	{
 		RTVLeft.Reset();
 		RTVRight.Reset();
+		RTVStereo.Reset();
 		DSV.Reset();
+		DSVStereo.Reset();
 
 		if (ReleaseSwapChain)
 		{
@@ -175,6 +354,11 @@ namespace D3DX11
 			RTVDesc.Texture2DArray.FirstArraySlice = 1;
 
 			Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateRenderTargetView(BackBuffer.Get(), &RTVDesc, &RTVRight));
+
+			RTVDesc.Texture2DArray.FirstArraySlice = 0;
+			RTVDesc.Texture2DArray.ArraySize = 2;
+
+			Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateRenderTargetView(BackBuffer.Get(), &RTVDesc, &RTVStereo));
 		}
 	}
 
@@ -203,6 +387,13 @@ namespace D3DX11
 		DSVDesc.Texture2D.MipSlice = 0;
 
 		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateDepthStencilView(DepthStencilBuffer.Get(), &DSVDesc, &DSV)); 
+
+		DSVDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		DSVDesc.Texture2DArray.MipSlice = 0;
+		DSVDesc.Texture2DArray.FirstArraySlice = 0;
+		DSVDesc.Texture2DArray.ArraySize = 2;
+
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateDepthStencilView(DepthStencilBuffer.Get(), &DSVDesc, &DSVStereo));
 	}
 
 	void RenderContext::UpdateCameras(_In_ const Window::WindowSize & Size)
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "HierarchicalDepthBuffer.h"
+#include "InstanceBuffer.h"
+#include "OcclusionDepthPass11.h"
+#include "PerformanceCounter.h"
 #include "RenderContext.h"
+#include "ViewFrustum.h"
 #include "Window.h"
 
 namespace D3DX11
@@ -15,7 +20,7 @@ namespace D3DX11
 
 		virtual void Initialize();
 
-		virtual void Render(_In_ MeshList DrawCalls);
+		virtual void Render(_In_ const MeshList & DrawCalls);
 
 		void OnStereoStatusChanged();
 		void OnWindowSizeChange(_In_ const Window::WindowSize & NewSize);
@@ -29,12 +34,39 @@ namespace D3DX11
 		GraphicsContext & DeviceContext;
 		bool StereoEnabled;
 		bool ForceMono;
+		bool UseOcclusionDepth;
+		bool UseOcclusionCulling;
+		bool UseFrustumCulling;
+		bool UseSinglePassStereo;
+
+		OcclusionDepthPass OcclusionPass;
+		HierarchicalDepthBuffer HierarchicalDepth;
+		TransformList VisibleObjects;
+		size_t CulledCount;
+		PerformanceCounter CulledObjects;
+
+		// The objects of each draw call inside the frustum, shared by both eyes
+		std::vector<TransformList> FrustumVisibleObjects;
+		PerformanceCounter FrustumCulledObjects;
+
+		// The object matrices of all draw calls, uploaded once and shared by both eyes unless each eye is occlusion culled
+		InstanceBuffer Instances;
+		InstanceBuffer::RangeList InstanceRanges;
+
+		// The draw calls and the CPU time to record a frame, without presenting it
+		size_t DrawCount;
+		PerformanceCounter SubmittedDraws;
+		PerformanceCounter SubmitTime;
 
 		Microsoft::WRL::ComPtr<IDXGISwapChain1> SwapChain;
 		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RTVLeft;
 		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RTVRight;
 		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> DSV;
 
+		// Both slices of the stereo back buffer and depth buffer at once, for single pass stereo
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RTVStereo;
+		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> DSVStereo;
+
 		D3D11_VIEWPORT Viewport;
 		D3D11_RECT ScissorRect;
 
@@ -47,8 +79,12 @@ namespace D3DX11
 		void CreateRenderTargets();
 		void CreateDepthStencil(_In_ const Window::WindowSize & Size);
 
-		void RenderStereo(_In_ MeshList DrawCalls);
-		void RenderEye(_In_ MeshList DrawCalls, _In_ const Camera & View, _In_ Microsoft::WRL::ComPtr<ID3D11RenderTargetView> & RTV);
+		void LatchCameras();
+		void RenderStereo(_In_ const MeshList & DrawCalls);
+		void RenderBothEyes(_In_ const MeshList & DrawCalls);
+		void RenderEye(_In_ const MeshList & DrawCalls, _In_ const Camera & View, _In_ Microsoft::WRL::ComPtr<ID3D11RenderTargetView> & RTV, _In_ bool FirstEye);
+		void CullOutsideFrustum(_In_ const MeshList & DrawCalls, _In_ const Camera & View);
+		void PackInstances(_In_ const MeshList & DrawCalls, _In_ const Camera & View, _In_ bool SkipOccluderMesh, _In_ bool CullObjects);
 
 		void UpdateCameras(_In_ const Window::WindowSize & Size);
 		void UpdateViewportAndScissorRect(_In_ const Window::WindowSize & Size);
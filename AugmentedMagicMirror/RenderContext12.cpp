@@ -17,7 +17,7 @@ namespace D3DX12
 		: ::RenderContext(TargetWindow, NoseCamera, LeftEyeCamera, RighEyeCamera)
 		, DeviceContext(DeviceContext)
 		, Viewport(), ScissorRect()
-		, RTVDescSize(0), BufferFrameIndex(0)
+		, InstanceCapacities(), RTVDescSize(0), BufferFrameIndex(0)
 	{
 	}
 
@@ -38,6 +38,11 @@ namespace D3DX12
 
 		CreateCommandList();
 
+		for (UINT i = 0; i < BufferFrameCount; ++i)
+		{
+			CreateInstanceBuffer(i, InitialInstanceCapacity);
+		}
+
 		const Window::WindowSize & WindowSize = TargetWindow.GetWindowSize();
 		NoseCamera.UpdateCamera(WindowSize);
 		UpdateViewportAndScissorRect(WindowSize);
@@ -45,7 +50,7 @@ namespace D3DX12
 		Fence.Initialize(DeviceContext.GetDevice());
 	}
 
-	void RenderContext::Render(MeshList DrawCalls)
+	void RenderContext::Render(_In_ const MeshList & DrawCalls)
 	{
 		Render({ { DeviceContext.GetDefaultShader(), DrawCalls } });
 	}
@@ -129,6 +134,50 @@ namespace D3DX12
 		Utility::ThrowOnFail(CommandList->Close());
 	}
 
+	void RenderContext::CreateInstanceBuffer(_In_ UINT FrameIndex, _In_ UINT Capacity)
+	{
+		CD3DX12_HEAP_PROPERTIES UploadHeapProperties(D3D12_HEAP_TYPE_UPLOAD);
+		CD3DX12_RESOURCE_DESC ResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(Capacity * sizeof(DirectX::XMFLOAT4X4));
+
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateCommittedResource(
+			&UploadHeapProperties,
+			D3D12_HEAP_FLAG_NONE,
+			&ResourceDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&InstanceUploadBuffers[FrameIndex])));
+
+		InstanceCapacities[FrameIndex] = Capacity;
+	}
+
+	D3D12_VERTEX_BUFFER_VIEW RenderContext::UploadInstances()
+	{
+		UINT Count = static_cast<UINT>(Instances.GetCount());
+		if (Count > InstanceCapacities[BufferFrameIndex])
+		{
+			CreateInstanceBuffer(BufferFrameIndex, (std::max)(Count, 2 * InstanceCapacities[BufferFrameIndex]));
+		}
+
+		const Microsoft::WRL::ComPtr<ID3D12Resource> & UploadBuffer = InstanceUploadBuffers[BufferFrameIndex];
+
+		if (Count != 0)
+		{
+			BYTE * UploadData = nullptr;
+			CD3DX12_RANGE ReadRange(0, 0);
+
+			Utility::ThrowOnFail(UploadBuffer->Map(0, &ReadRange, reinterpret_cast<void **>(&UploadData)));
+			std::memcpy(UploadData, Instances.GetData(), Instances.GetSize());
+			UploadBuffer->Unmap(0, nullptr);
+		}
+
+		D3D12_VERTEX_BUFFER_VIEW InstanceBufferView = {};
+		InstanceBufferView.BufferLocation = UploadBuffer->GetGPUVirtualAddress();
+		InstanceBufferView.StrideInBytes = sizeof(DirectX::XMFLOAT4X4);
+		InstanceBufferView.SizeInBytes = static_cast<UINT>(Instances.GetSize());
+
+		return InstanceBufferView;
+	}
+
 	void RenderContext::ResizeBuffers(_In_ const Window::WindowSize & NewSize)
 	{
 		ReleaseSizeDependentBuffers();
@@ -183,7 +232,7 @@ namespace D3DX12
 		return CD3DX12_CPU_DESCRIPTOR_HANDLE(RTVHeap->GetCPUDescriptorHandleForHeapStart(), BufferFrameIndex, RTVDescSize);
 	}
 
-	void RenderContext::Render(_In_ RenderParameterList DrawCalls)
+	void RenderContext::Render(_In_ const RenderParameterList & DrawCalls)
 	{
 		RenderTarget & CurrentRenderTarget = RenderTargets[BufferFrameIndex];
 		CurrentRenderTarget.BeginFrame(CommandList);
@@ -198,14 +247,22 @@ namespace D3DX12
 		CommandList->RSSetViewports(1, &Viewport);
 		CommandList->RSSetScissorRects(1, &ScissorRect);
 
-		for (RenderParameter & RenderCommand : DrawCalls)
+		// Latched once, all draw calls of the frame share the camera
+		CameraLatching(NoseCamera);
+		PackInstances(DrawCalls, ViewFrustum(NoseCamera));
+
+		D3D12_VERTEX_BUFFER_VIEW InstanceBufferView = UploadInstances();
+		CommandList->IASetVertexBuffers(1, 1, &InstanceBufferView);
+
+		size_t RangeIndex = 0;
+		for (const RenderParameter & RenderCommand : DrawCalls)
 		{
 			RenderCommand.first.Prepare(CommandList, NoseCamera);
 
-			for (ObjectList & ObjectsToRender : RenderCommand.second)
+			for (const ObjectList & ObjectsToRender : RenderCommand.second)
 			{
 				const Mesh & Mesh12 = static_cast<const Mesh &>(ObjectsToRender.first);
-				Mesh12.Render(CommandList, RenderCommand.first, ObjectsToRender.second);
+				Mesh12.Render(CommandList, InstanceRanges[RangeIndex++]);
 			}
 		}
 
@@ -214,6 +271,28 @@ namespace D3DX12
 		BufferFrameIndex = SwapChain->GetCurrentBackBufferIndex();
 	}
 
+	void RenderContext::PackInstances(_In_ const RenderParameterList & DrawCalls, _In_ const ViewFrustum & Frustum)
+	{
+		Instances.Clear();
+		InstanceRanges.clear();
+
+		for (const RenderParameter & RenderCommand : DrawCalls)
+		{
+			for (const ObjectList & ObjectsToRender : RenderCommand.second)
+			{
+				// The bounds of the occluder are not updated with its vertices
+				if (&ObjectsToRender.first == OccluderMesh)
+				{
+					InstanceRanges.push_back(Instances.Append(ObjectsToRender.second));
+					continue;
+				}
+
+				Frustum.Cull(ObjectsToRender.first.GetBounds(), ObjectsToRender.second, VisibleObjects);
+				InstanceRanges.push_back(Instances.Append(VisibleObjects));
+			}
+		}
+	}
+
 	void RenderContext::OnWindowSizeChange(_In_ const Window::WindowSize & NewSize)
 	{
 		Fence.SetAndWait(DeviceContext.GetCommandQueue());
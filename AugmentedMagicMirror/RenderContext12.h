@@ -2,7 +2,9 @@
 
 #include "RenderTarget12.h"
 
+#include "InstanceBuffer.h"
 #include "RenderContext.h"
+#include "ViewFrustum.h"
 #include "Window.h"
 
 class Camera;
@@ -20,7 +22,7 @@ namespace D3DX12
 
 		virtual void Initialize();
 
-		virtual void Render(_In_ MeshList DrawCalls);
+		virtual void Render(_In_ const MeshList & DrawCalls);
 
 		void OnWindowSizeChange(_In_ const Window::WindowSize & NewSize);
 
@@ -44,6 +46,16 @@ namespace D3DX12
 		BufferFrameArray<RenderTarget> RenderTargets;
 		GPUFence Fence;
 
+		TransformList VisibleObjects;
+
+		// The object matrices of all draw calls of a frame, copied to the upload buffer of its buffer frame. The
+		// buffer of a frame is only written after its fence has passed, so the GPU never reads it concurrently.
+		static constexpr UINT InitialInstanceCapacity = 64;
+		InstanceBuffer Instances;
+		InstanceBuffer::RangeList InstanceRanges;
+		BufferFrameArray<Microsoft::WRL::ComPtr<ID3D12Resource>> InstanceUploadBuffers;
+		BufferFrameArray<UINT> InstanceCapacities;
+
 		UINT RTVDescSize;
 		UINT BufferFrameIndex;
 
@@ -54,6 +66,8 @@ namespace D3DX12
 		void InitializeRenderTargets();
 
 		void CreateCommandList();
+		void CreateInstanceBuffer(_In_ UINT FrameIndex, _In_ UINT Capacity);
+		D3D12_VERTEX_BUFFER_VIEW UploadInstances();
 
 		void ResizeBuffers(_In_ const Window::WindowSize & NewSize);
 		void ReleaseSizeDependentBuffers();
@@ -63,8 +77,9 @@ namespace D3DX12
 
 		CD3DX12_CPU_DESCRIPTOR_HANDLE GetRTVCPUHandle();
 
-		typedef std::pair<RenderingContext &, MeshList> RenderParameter;
+		typedef std::pair<RenderingContext &, const MeshList &> RenderParameter;
 		typedef std::vector<RenderParameter> RenderParameterList;
-		void Render(_In_ RenderParameterList DrawCalls);
+		void Render(_In_ const RenderParameterList & DrawCalls);
+		void PackInstances(_In_ const RenderParameterList & DrawCalls, _In_ const ViewFrustum & Frustum);
 	};
 }
\ No newline at end of file
@@ -10,11 +10,12 @@
 #include "Camera.h"
 #include "GraphicsContext.h"
 #include "Resource.h"
+#include "StereoFrameCamera.h"
 
 namespace D3DX11
 {
 	RenderingContext::RenderingContext(_In_ GraphicsContext & DeviceContext)
-		:DeviceContext(DeviceContext)
+		:DeviceContext(DeviceContext), InstanceCapacity(0)
 	{
 	}
 
@@ -26,10 +27,12 @@ namespace D3DX11
 		GraphicsContext::LoadAndCompileShader(VertexShaderBlob, PixelShaderBlob, IDR_SHADER11, "5_0");
 
 		CreateShaders(VertexShaderBlob, PixelShaderBlob);
-		CreateInputLayout(VertexShaderBlob);
+		CreateInputLayout(VertexShaderBlob, 1, InputLayout);
+		CreateStereoShaders();
 
 		CreateConstantBuffer(CameraConstantBuffer, sizeof(CameraConstantBufferType));
-		CreateConstantBuffer(ObjectConstantBuffer, sizeof(ObjectConstantBufferType));
+		CreateConstantBuffer(StereoConstantBuffer, sizeof(StereoFrameCamera::StereoConstants));
+		CreateInstanceBuffer(InitialInstanceCapacity);
 	}
 
 	void RenderingContext::Prepare(_In_ const Camera & Camera)
@@ -38,17 +41,55 @@ namespace D3DX11
 		UpdateConstantBuffer(CameraConstantBuffer, &CameraData, sizeof(CameraData));
 
 		DeviceContext.GetDeviceContext()->VSSetShader(VertexShader.Get(), nullptr, 0);
+		DeviceContext.GetDeviceContext()->GSSetShader(nullptr, nullptr, 0);
 		DeviceContext.GetDeviceContext()->PSSetShader(PixelShader.Get(), nullptr, 0);
 
-		std::array<ID3D11Buffer*, 2> ConstantBuffers = { CameraConstantBuffer.Get(), ObjectConstantBuffer.Get() };
-		DeviceContext.GetDeviceContext()->VSSetConstantBuffers(0, 2, ConstantBuffers.data());
+		std::array<ID3D11Buffer*, 1> ConstantBuffers = { CameraConstantBuffer.Get() };
+		DeviceContext.GetDeviceContext()->VSSetConstantBuffers(0, 1, ConstantBuffers.data());
 
 		DeviceContext.GetDeviceContext()->IASetInputLayout(InputLayout.Get());
+		BindInstanceBuffer();
 	}
 
-	void RenderingContext::SetObjectMatrix(_In_ const DirectX::XMFLOAT4X4 & ObjectMatrix)
+	void RenderingContext::PrepareStereo(_In_ const Camera & LeftEye, _In_ const Camera & RightEye)
 	{
-		UpdateConstantBuffer(ObjectConstantBuffer, &ObjectMatrix, sizeof(ObjectMatrix));
+		StereoFrameCamera::StereoConstants Constants;
+		StereoFrameCamera::GetConstants(LeftEye, RightEye, Constants);
+		UpdateConstantBuffer(StereoConstantBuffer, &Constants, sizeof(Constants));
+
+		DeviceContext.GetDeviceContext()->VSSetShader(StereoVertexShader.Get(), nullptr, 0);
+		DeviceContext.GetDeviceContext()->GSSetShader(StereoGeometryShader.Get(), nullptr, 0);
+		DeviceContext.GetDeviceContext()->PSSetShader(PixelShader.Get(), nullptr, 0);
+
+		std::array<ID3D11Buffer*, 1> ConstantBuffers = { StereoConstantBuffer.Get() };
+		DeviceContext.GetDeviceContext()->VSSetConstantBuffers(1, 1, ConstantBuffers.data());
+
+		DeviceContext.GetDeviceContext()->IASetInputLayout(StereoInputLayout.Get());
+		BindInstanceBuffer();
+	}
+
+	void RenderingContext::UploadInstances(_In_ const InstanceBuffer & Instances)
+	{
+		if (Instances.GetCount() > InstanceCapacity)
+		{
+			CreateInstanceBuffer((std::max)(static_cast<UINT>(Instances.GetCount()), 2 * InstanceCapacity));
+			BindInstanceBuffer();
+		}
+
+		if (Instances.GetCount() != 0)
+		{
+			UpdateConstantBuffer(InstanceVertexBuffer, Instances.GetData(), Instances.GetSize());
+		}
+	}
+
+	void RenderingContext::BindInstanceBuffer()
+	{
+		std::array<ID3D11Buffer *const, 1> VertexBuffers = { InstanceVertexBuffer.Get() };
+		std::array<UINT, 1> Strides = { InstanceStride };
+		std::array<UINT, 1> Offsets = { 0 };
+
+		// The meshes bind their vertices to the first slot
+		DeviceContext.GetDeviceContext()->IASetVertexBuffers(1, 1, VertexBuffers.data(), Strides.data(), Offsets.data());
 	}
 
 	void RenderingContext::UpdateConstantBuffer(_Out_ Microsoft::WRL::ComPtr<ID3D11Buffer> & ConstantBuffer, _In_ const void * Data, _In_ size_t DataSize)
@@ -69,17 +110,46 @@ namespace D3DX11
 		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreatePixelShader(PixelShaderBlob->GetBufferPointer(), PixelShaderBlob->GetBufferSize(), nullptr, &PixelShader));
 	}
 
-	void RenderingContext::CreateInputLayout(_In_ const Microsoft::WRL::ComPtr<ID3DBlob> & VertexShaderBlob)
+	void RenderingContext::CreateStereoShaders()
 	{
-		std::array<D3D11_INPUT_ELEMENT_DESC, 2> InputElementDesc
+		Microsoft::WRL::ComPtr<ID3DBlob> VertexShaderBlob;
+
+		if (DeviceContext.IsRenderTargetIndexFromVertexShaderSupported())
+		{
+			GraphicsContext::LoadAndCompileShader(VertexShaderBlob, IDR_SHADER11, "vs_5_0", "StereoVShader");
+		}
+		else
+		{
+			Microsoft::WRL::ComPtr<ID3DBlob> GeometryShaderBlob;
+
+			GraphicsContext::LoadAndCompileShader(VertexShaderBlob, IDR_SHADER11, "vs_5_0", "StereoGSVShader");
+			GraphicsContext::LoadAndCompileShader(GeometryShaderBlob, IDR_SHADER11, "gs_5_0", "StereoGShader");
+
+			Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateGeometryShader(GeometryShaderBlob->GetBufferPointer(), GeometryShaderBlob->GetBufferSize(), nullptr, &StereoGeometryShader));
+		}
+
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateVertexShader(VertexShaderBlob->GetBufferPointer(), VertexShaderBlob->GetBufferSize(), nullptr, &StereoVertexShader));
+
+		// Both instances of an object read its matrix
+		CreateInputLayout(VertexShaderBlob, StereoFrameCamera::Eye_Count, StereoInputLayout);
+	}
+
+	void RenderingContext::CreateInputLayout(_In_ const Microsoft::WRL::ComPtr<ID3DBlob> & VertexShaderBlob, _In_ UINT InstancesPerObject, _Out_ Microsoft::WRL::ComPtr<ID3D11InputLayout> & Layout)
+	{
+		std::array<D3D11_INPUT_ELEMENT_DESC, 7> InputElementDesc
 		{ 
 			{
 				{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-				{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+				{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+				{ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 28, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+				{ "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, InstancesPerObject },
+				{ "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, InstancesPerObject },
+				{ "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, InstancesPerObject },
+				{ "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, InstancesPerObject }
 			} 
 		};
 
-		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateInputLayout(InputElementDesc.data(), static_cast<UINT>(InputElementDesc.size()), VertexShaderBlob->GetBufferPointer(), VertexShaderBlob->GetBufferSize(), &InputLayout));
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateInputLayout(InputElementDesc.data(), static_cast<UINT>(InputElementDesc.size()), VertexShaderBlob->GetBufferPointer(), VertexShaderBlob->GetBufferSize(), &Layout));
 	}
 
 	void RenderingContext::CreateConstantBuffer(_Out_ Microsoft::WRL::ComPtr<ID3D11Buffer> & ConstantBuffer, _In_ UINT BufferSize)
@@ -94,5 +164,17 @@ namespace D3DX11
 
 		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateBuffer(&BufferDesc, nullptr, &ConstantBuffer));
 	}
+
+	void RenderingContext::CreateInstanceBuffer(_In_ UINT Capacity)
+	{
+		D3D11_BUFFER_DESC BufferDesc = {};
+		BufferDesc.ByteWidth = Capacity * InstanceStride;
+		BufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		BufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		BufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+		Utility::ThrowOnFail(DeviceContext.GetDevice()->CreateBuffer(&BufferDesc, nullptr, &InstanceVertexBuffer));
+		InstanceCapacity = Capacity;
+	}
 }
 #endif
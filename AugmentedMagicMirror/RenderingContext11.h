@@ -1,5 +1,7 @@
 #pragma once
 
+#include "InstanceBuffer.h"
+
 class Camera;
 
 namespace D3DX11
@@ -15,7 +17,13 @@ namespace D3DX11
 		void Create();
 
 		void Prepare(_In_ const Camera & Camera);
-		void SetObjectMatrix(_In_ const DirectX::XMFLOAT4X4 & ObjectMatrix);
+
+		// Draws every instance once per eye into the slice of the render target array of the eye; the meshes are
+		// drawn with twice the instances
+		void PrepareStereo(_In_ const Camera & LeftEye, _In_ const Camera & RightEye);
+
+		// Uploads the object matrices of all draws with a single map, growing the instance buffer when needed
+		void UploadInstances(_In_ const InstanceBuffer & Instances);
 
 	private:
 		struct CameraConstantBufferType {
@@ -23,9 +31,8 @@ namespace D3DX11
 			DirectX::XMFLOAT4X4 Projection;
 		};
 
-		struct ObjectConstantBufferType {
-			DirectX::XMFLOAT4X4 Object;
-		};
+		static constexpr UINT InitialInstanceCapacity = 64;
+		static constexpr UINT InstanceStride = sizeof(DirectX::XMFLOAT4X4);
 
 		GraphicsContext & DeviceContext;
 
@@ -33,12 +40,21 @@ namespace D3DX11
 		Microsoft::WRL::ComPtr<ID3D11PixelShader> PixelShader;
 		Microsoft::WRL::ComPtr<ID3D11InputLayout> InputLayout;
 
+		Microsoft::WRL::ComPtr<ID3D11VertexShader> StereoVertexShader;
+		Microsoft::WRL::ComPtr<ID3D11GeometryShader> StereoGeometryShader;
+		Microsoft::WRL::ComPtr<ID3D11InputLayout> StereoInputLayout;
+
 		Microsoft::WRL::ComPtr<ID3D11Buffer> CameraConstantBuffer;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> ObjectConstantBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> StereoConstantBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> InstanceVertexBuffer;
+		UINT InstanceCapacity;
 		
 		void CreateShaders(_In_ const Microsoft::WRL::ComPtr<ID3DBlob> & VertexShaderBlob, _In_ const Microsoft::WRL::ComPtr<ID3DBlob> & PixelShaderBlob);
-		void CreateInputLayout(_In_ const Microsoft::WRL::ComPtr<ID3DBlob> & VertexShaderBlob);
+		void CreateStereoShaders();
+		void CreateInputLayout(_In_ const Microsoft::WRL::ComPtr<ID3DBlob> & VertexShaderBlob, _In_ UINT InstancesPerObject, _Out_ Microsoft::WRL::ComPtr<ID3D11InputLayout> & Layout);
 		void CreateConstantBuffer(_Out_ Microsoft::WRL::ComPtr<ID3D11Buffer> & ConstantBuffer, _In_ UINT BufferSize);
+		void CreateInstanceBuffer(_In_ UINT Capacity);
+		void BindInstanceBuffer();
 
 		void UpdateConstantBuffer(_Out_ Microsoft::WRL::ComPtr<ID3D11Buffer> & ConstantBuffer, _In_ const void * Data, _In_ size_t DataSize);
 	};
@@ -13,7 +13,6 @@ namespace D3DX12
 
 		void Create();
 		void Prepare(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const Camera & Camera) const;
-		void SetObjectMatrix(_In_ const Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> & CommandList, _In_ const DirectX::XMFLOAT4X4 & ObjectMatrix) const;
 
 	private:
 		static constexpr UINT Num32BitPerMatrix = 4 * 4;
@@ -0,0 +1,207 @@
+// SceneGraph.cpp : Hierarchy of objects with lazily composed world matrices
+//
+
+#include "stdafx.h"
+#include "SceneGraph.h"
+
+#include "Mesh.h"
+#include "SimdMath.h"
+
+SceneGraph::SceneGraph()
+	:StructureChanged(true)
+{
+	Clear();
+}
+
+void SceneGraph::Reserve(_In_ size_t Count)
+{
+	Parents.reserve(Count);
+	SubtreeEnds.reserve(Count);
+	Handles.reserve(Count);
+	Locals.Reserve(Count);
+	Worlds.reserve(Count);
+	Meshes.reserve(Count);
+	Dirty.reserve(Count);
+	DrawSlots.reserve(Count);
+	Positions.reserve(Count);
+}
+
+void SceneGraph::Clear()
+{
+	// Only the root remains, at the origin
+	Parents = { NoParent };
+	SubtreeEnds = { 1 };
+	Handles = { Root };
+	Worlds = { Transform().GetMatrix() };
+	Meshes = { nullptr };
+	Dirty = { 1 };
+	Positions = { 0 };
+
+	Locals.Clear();
+	Locals.Add();
+
+	DrawSlots.clear();
+	DrawCalls.clear();
+	DrawLists.clear();
+	StructureChanged = true;
+}
+
+SceneGraph::NodeHandle SceneGraph::AddNode(_In_ NodeHandle Parent, _In_ const Transform & Local, _In_opt_ const Mesh * NodeMesh)
+{
+	size_t ParentPosition = Positions[Parent];
+	size_t Position = SubtreeEnds[ParentPosition];
+	NodeHandle Handle = Positions.size();
+
+	for (size_t Ancestor = ParentPosition; Ancestor != NoParent; Ancestor = Parents[Ancestor])
+	{
+		++SubtreeEnds[Ancestor];
+	}
+
+	// The nodes behind the new one move back, none do when the nodes are added depth first
+	for (size_t Moved = Position; Moved < Handles.size(); ++Moved)
+	{
+		Parents[Moved] += (Parents[Moved] >= Position) ? 1 : 0;
+		++SubtreeEnds[Moved];
+		++Positions[Handles[Moved]];
+	}
+
+	Parents.insert(Parents.begin() + Position, ParentPosition);
+	SubtreeEnds.insert(SubtreeEnds.begin() + Position, Position + 1);
+	Handles.insert(Handles.begin() + Position, Handle);
+	Worlds.insert(Worlds.begin() + Position, Local.GetMatrix());
+	Meshes.insert(Meshes.begin() + Position, NodeMesh);
+	Dirty.insert(Dirty.begin() + Position, 1);
+	Positions.push_back(Position);
+	Locals.Add(Local.GetPosition(), Local.GetRotation(), Local.GetScale());
+
+	StructureChanged = true;
+
+	return Handle;
+}
+
+void SceneGraph::SetLocalTransform(_In_ NodeHandle Node, _In_ const Transform & Local)
+{
+	Locals.SetPosition(Node, Local.GetPosition());
+	Locals.SetRotation(Node, Local.GetRotation());
+	Locals.SetScale(Node, Local.GetScale());
+	Dirty[Positions[Node]] = 1;
+}
+
+void SceneGraph::SetLocalPosition(_In_ NodeHandle Node, _In_ const Vector3 & Position)
+{
+	Locals.SetPosition(Node, Position);
+	Dirty[Positions[Node]] = 1;
+}
+
+Transform SceneGraph::GetLocalTransform(_In_ NodeHandle Node) const
+{
+	return Transform(Locals.GetPosition(Node), Locals.GetRotation(Node), Locals.GetScale(Node));
+}
+
+size_t SceneGraph::Update()
+{
+	if (StructureChanged)
+	{
+		RebuildDrawLists();
+	}
+
+	// The changed local matrices are composed together, before the hierarchy is walked
+	Locals.Update();
+
+	size_t NodeCount = Handles.size();
+	size_t UpdatedCount = 0;
+	size_t Node = 0;
+
+	while (Node < NodeCount)
+	{
+		if (!Dirty[Node])
+		{
+			++Node;
+			continue;
+		}
+
+		// Everything below a changed node moves with it; the parents come first, so their world matrices are current
+		size_t End = SubtreeEnds[Node];
+		UpdatedCount += End - Node;
+
+		for (; Node < End; ++Node)
+		{
+			SimdMath::Matrix Local = SimdMath::LoadFloat4x4(&Locals.GetMatrix(Handles[Node]).m[0][0]);
+
+			// The matrices are stored transposed, so the parent's matrix comes first
+			if (Parents[Node] != NoParent)
+			{
+				Local = SimdMath::MatrixMultiply(SimdMath::LoadFloat4x4(&Worlds[Parents[Node]].m[0][0]), Local);
+			}
+
+			SimdMath::StoreFloat4x4(&Worlds[Node].m[0][0], Local);
+			Dirty[Node] = 0;
+
+			// The composed matrix is kept as it is, nothing is decomposed for drawing
+			if (Meshes[Node] != nullptr)
+			{
+				const std::pair<size_t, size_t> & Slot = DrawSlots[Node];
+				DrawLists[Slot.first].second[Slot.second] = Transform(Worlds[Node]);
+			}
+		}
+	}
+
+	return UpdatedCount;
+}
+
+const DirectX::XMFLOAT4X4 & SceneGraph::GetWorldMatrix(_In_ NodeHandle Node) const
+{
+	return Worlds[Positions[Node]];
+}
+
+const RenderContext::MeshList & SceneGraph::GetDrawCalls() const
+{
+	return DrawCalls;
+}
+
+size_t SceneGraph::GetNodeCount() const
+{
+	return Handles.size();
+}
+
+void SceneGraph::RebuildDrawLists()
+{
+	for (DrawList & List : DrawLists)
+	{
+		List.second.clear();
+	}
+
+	DrawSlots.resize(Handles.size());
+
+	for (size_t Node = 0; Node < Handles.size(); ++Node)
+	{
+		if (Meshes[Node] == nullptr)
+		{
+			continue;
+		}
+
+		auto IsNodeMesh = [&](const DrawList & List) { return List.first == Meshes[Node]; };
+		auto List = std::find_if(DrawLists.begin(), DrawLists.end(), IsNodeMesh);
+
+		if (List == DrawLists.end())
+		{
+			List = DrawLists.emplace(DrawLists.end(), Meshes[Node], TransformList());
+		}
+
+		DrawSlots[Node] = std::make_pair(static_cast<size_t>(List - DrawLists.begin()), List->second.size());
+		List->second.push_back(Transform(Worlds[Node]));
+	}
+
+	// Refers to the object lists, which may have moved while meshes were added
+	DrawCalls.clear();
+	DrawCalls.reserve(DrawLists.size());
+
+	for (const DrawList & List : DrawLists)
+	{
+		DrawCalls.emplace_back(*List.first, List.second);
+	}
+
+	// The slots have moved, all world transforms are written again
+	Dirty[0] = 1;
+	StructureChanged = false;
+}
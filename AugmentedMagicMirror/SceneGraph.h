@@ -0,0 +1,70 @@
+#pragma once
+
+#include "RenderContext.h"
+#include "Transform.h"
+#include "TransformArray.h"
+
+class Mesh;
+
+// Objects placed relative to their parents, e.g. a hat following the head or decorations grouped on a shelf. The nodes
+// are stored depth first in flat arrays, so the subtree of a node is the range of nodes right after it and each parent
+// comes before its children. Changing a local transform only flags the node; Update composes the changed local matrices
+// four at a time, walks the array once, skips clean nodes and recomposes the world matrices of the flagged subtrees. Nodes with a mesh are gathered into one object list
+// per mesh holding their composed world matrices, which is handed to the render context as it is.
+class SceneGraph
+{
+public:
+	// Stays valid while nodes are added, unlike the position of the node in the arrays
+	typedef size_t NodeHandle;
+	static constexpr NodeHandle Root = 0;
+
+	SceneGraph();
+
+	void Reserve(_In_ size_t Count);
+	void Clear();
+
+	// Adds the node as last child of Parent; adding the nodes depth first appends them without moving other nodes.
+	// Nodes without a mesh only group their children.
+	NodeHandle AddNode(_In_ NodeHandle Parent, _In_ const Transform & Local, _In_opt_ const Mesh * NodeMesh = nullptr);
+
+	void SetLocalTransform(_In_ NodeHandle Node, _In_ const Transform & Local);
+	void SetLocalPosition(_In_ NodeHandle Node, _In_ const Vector3 & Position);
+	Transform GetLocalTransform(_In_ NodeHandle Node) const;
+
+	// Recomposes the world matrices below changed nodes and updates the object lists; returns the number of recomposed nodes
+	size_t Update();
+
+	// Transposed like the object matrices, current as of the last Update
+	const DirectX::XMFLOAT4X4 & GetWorldMatrix(_In_ NodeHandle Node) const;
+
+	// One object list per mesh in the order the meshes were first added, current as of the last Update
+	const RenderContext::MeshList & GetDrawCalls() const;
+
+	size_t GetNodeCount() const;
+
+private:
+	typedef std::pair<const Mesh *, TransformList> DrawList;
+
+	static constexpr size_t NoParent = (std::numeric_limits<size_t>::max)();
+
+	// Per node in depth first order
+	std::vector<size_t> Parents;
+	std::vector<size_t> SubtreeEnds;
+	std::vector<NodeHandle> Handles;
+	std::vector<DirectX::XMFLOAT4X4> Worlds;
+	std::vector<const Mesh *> Meshes;
+	std::vector<UINT8> Dirty;
+
+	// Position of each node's world transform in the object lists
+	std::vector<std::pair<size_t, size_t>> DrawSlots;
+
+	// Per node by handle, new nodes are appended
+	TransformArray Locals;
+
+	std::vector<size_t> Positions;
+	std::vector<DrawList> DrawLists;
+	RenderContext::MeshList DrawCalls;
+	bool StructureChanged;
+
+	void RebuildDrawLists();
+};
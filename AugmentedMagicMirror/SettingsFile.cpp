@@ -50,24 +50,78 @@ namespace SettingsFile
 		}
 	};
 
-	static const std::wstring & GetSettingsFilePath()
+	namespace Background
 	{
-		static std::wstring Path;
+		static const std::wstring SectionName = L"Background";
 
-		if (Path.empty())
+		namespace LearnDuration
+		{
+			static const std::wstring Key = L"LearnDuration";
+			static const float Default = 5.f;
+		}
+
+		namespace DropBackground
+		{
+			static const std::wstring Key = L"DropBackground";
+			static const float Default = 1.f;
+		}
+
+		float GetLearnDuration()
+		{
+			return LoadFloat(SectionName, LearnDuration::Key, LearnDuration::Default);
+		}
+
+		bool GetDropBackground()
 		{
-			std::array<wchar_t, 1024> Buffer;
-			DWORD CharactersCopied = GetModuleFileName(nullptr, Buffer.data(), static_cast<DWORD>(Buffer.size()));
+			return LoadFloat(SectionName, DropBackground::Key, DropBackground::Default) != 0.f;
+		}
+	};
+
+	namespace HeadTracking
+	{
+		static const std::wstring SectionName = L"HeadTracking";
 
-			if (CharactersCopied == 0)
-			{
-				return Path;
-			}
+		namespace PoseFilter
+		{
+			static const std::wstring Key = L"PoseFilter";
+			static const float Default = 1.f;
+		}
 
-			Path.assign(Buffer.data(), CharactersCopied);
+		namespace Latency
+		{
+			static const std::wstring Key = L"Latency";
+			static const float Default = 0.05f;
+		}
 
-			size_t LastSlashPosition = Path.rfind(L'\\');
-			Path.replace(LastSlashPosition + 1, std::wstring::npos, Filename);
+		namespace LateLatching
+		{
+			static const std::wstring Key = L"LateLatching";
+			static const float Default = 1.f;
+		}
+
+		unsigned GetPoseFilter()
+		{
+			return static_cast<unsigned>((std::max)(LoadFloat(SectionName, PoseFilter::Key, PoseFilter::Default), 0.f));
+		}
+
+		float GetLatency()
+		{
+			return LoadFloat(SectionName, Latency::Key, Latency::Default);
+		}
+
+		bool GetLateLatching()
+		{
+			return LoadFloat(SectionName, LateLatching::Key, LateLatching::Default) != 0.f;
+		}
+	};
+
+	static const std::wstring & GetSettingsFilePath()
+	{
+		static std::wstring Path;
+
+		if (Path.empty())
+		{
+			Path = Utility::GetApplicationFilePath(Filename);
 		}
 
 		return Path;
@@ -9,5 +9,16 @@ namespace SettingsFile
 	namespace Kinect {
 		Vector3 GetKinectOffset();
 	};
+
+	namespace Background {
+		float GetLearnDuration();
+		bool GetDropBackground();
+	};
+
+	namespace HeadTracking {
+		unsigned GetPoseFilter();
+		float GetLatency();
+		bool GetLateLatching();
+	};
 };
 
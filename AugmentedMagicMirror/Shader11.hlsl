@@ -4,15 +4,24 @@ cbuffer Camera : register(b0)
 	matrix Projection;
 };
 
-cbuffer Object : register(b1)
+// Both eyes for single pass stereo, indexed by the eye of the instance
+cbuffer StereoCamera : register(b1)
 {
-	matrix World;
+	matrix StereoView[2];
+	matrix StereoProjection[2];
 };
 
 struct VSInput
 {
 	float3 Position : POSITION;
 	float3 Color : COLOR0;
+	float2 Normal : NORMAL;
+
+	// The object matrix of the instance, one row of the transposed matrix per element
+	float4 World0 : WORLD0;
+	float4 World1 : WORLD1;
+	float4 World2 : WORLD2;
+	float4 World3 : WORLD3;
 };
 
 struct PSInput
@@ -21,22 +30,121 @@ struct PSInput
 	float4 Color: COLOR;
 };
 
-PSInput VShader(VSInput Input)
+// Direction towards the light in world space, from above the viewer
+static const float3 LightDirection = normalize(float3(0.0f, 0.5f, 1.0f));
+static const float Ambient = 0.3f;
+
+float3 UnpackNormal(float2 Packed)
+{
+	float3 Normal = float3(Packed, 1.0f - abs(Packed.x) - abs(Packed.y));
+	float Fold = saturate(-Normal.z);
+	Normal.xy += (Normal.xy >= 0.0f) ? -Fold : Fold;
+
+	return normalize(Normal);
+}
+
+PSInput ShadeVertex(VSInput Input, matrix EyeView, matrix EyeProjection)
 {
 	PSInput Output;
 
+	matrix World = transpose(float4x4(Input.World0, Input.World1, Input.World2, Input.World3));
+
 	Output.Color = float4(Input.Color, 1.0f);
 
+	// A zero normal marks unlit vertices
+	if (any(Input.Normal))
+	{
+		float3 Normal = normalize(mul(float4(UnpackNormal(Input.Normal), 0.0f), World).xyz);
+		Output.Color.rgb *= Ambient + (1.0f - Ambient) * saturate(dot(Normal, LightDirection));
+	}
+
 	Output.Position = float4(Input.Position, 1.f);
 	Output.Position = mul(Output.Position, World);
-	Output.Position = mul(Output.Position, View);
-	Output.Position = mul(Output.Position, Projection);
+	Output.Position = mul(Output.Position, EyeView);
+	Output.Position = mul(Output.Position, EyeProjection);
+
+	return Output;
+}
+
+PSInput VShader(VSInput Input)
+{
+	return ShadeVertex(Input, View, Projection);
+}
+
+// Single pass stereo draws two instances per object, the even one for the left eye and the odd one for the right eye.
+// The object matrices step once every two instances, so both eyes read the matrix of the same object.
+struct StereoPSInput
+{
+	float4 Position : SV_POSITION;
+	float4 Color: COLOR;
+	uint Slice : SV_RenderTargetArrayIndex;
+};
+
+StereoPSInput StereoVShader(VSInput Input, uint InstanceId : SV_InstanceID)
+{
+	uint Eye = InstanceId & 1;
+	PSInput Shaded = ShadeVertex(Input, StereoView[Eye], StereoProjection[Eye]);
+
+	StereoPSInput Output = { Shaded.Position, Shaded.Color, Eye };
+	return Output;
+}
 
+// Devices without the render target array index from the vertex shader select the slice in a geometry shader
+struct StereoGSInput
+{
+	float4 Position : SV_POSITION;
+	float4 Color: COLOR;
+	uint Slice : SLICE;
+};
+
+StereoGSInput StereoGSVShader(VSInput Input, uint InstanceId : SV_InstanceID)
+{
+	uint Eye = InstanceId & 1;
+	PSInput Shaded = ShadeVertex(Input, StereoView[Eye], StereoProjection[Eye]);
+
+	StereoGSInput Output = { Shaded.Position, Shaded.Color, Eye };
 	return Output;
 }
 
+[maxvertexcount(3)]
+void StereoGShader(triangle StereoGSInput Input[3], inout TriangleStream<StereoPSInput> Output)
+{
+	for (uint Vertex = 0; Vertex < 3; ++Vertex)
+	{
+		StereoPSInput Element = { Input[Vertex].Position, Input[Vertex].Color, Input[Vertex].Slice };
+		Output.Append(Element);
+	}
+}
+
 float4 PShader(PSInput Input) : SV_TARGET
 {
 	return Input.Color;
 }
 
+// Occlusion depth rasterized on the CPU, written into the depth buffer by a fullscreen triangle
+Texture2D<float> OcclusionDepth : register(t0);
+
+struct OcclusionPSInput
+{
+	float4 Position : SV_POSITION;
+	float2 UV : TEXCOORD0;
+};
+
+OcclusionPSInput OcclusionVShader(uint VertexId : SV_VertexID)
+{
+	OcclusionPSInput Output;
+
+	Output.UV = float2((VertexId << 1) & 2, VertexId & 2);
+	Output.Position = float4(Output.UV * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+
+	return Output;
+}
+
+// Writes depth only, the color writes are masked off by the pass as well
+void OcclusionPShader(OcclusionPSInput Input, out float Depth : SV_Depth)
+{
+	uint Width, Height;
+	OcclusionDepth.GetDimensions(Width, Height);
+
+	Depth = OcclusionDepth.Load(int3(min(uint2(Input.UV * float2(Width, Height)), uint2(Width - 1, Height - 1)), 0));
+}
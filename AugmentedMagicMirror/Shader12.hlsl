@@ -6,17 +6,17 @@ struct CameraConstantBuffer
 
 ConstantBuffer<CameraConstantBuffer> Camera : register(b0);
 
-struct ObjectConstantBuffer
-{
-	matrix World;
-};
-
-ConstantBuffer<ObjectConstantBuffer> Object : register(b1);
-
 struct VSInput
 {
 	float3 Position : POSITION;
 	float3 Color : COLOR0;
+	float2 Normal : NORMAL;
+
+	// The object matrix of the instance, one row of the transposed matrix per element
+	float4 World0 : WORLD0;
+	float4 World1 : WORLD1;
+	float4 World2 : WORLD2;
+	float4 World3 : WORLD3;
 };
 
 struct PSInput
@@ -25,14 +25,36 @@ struct PSInput
 	float4 Color: COLOR;
 };
 
+// Direction towards the light in world space, from above the viewer
+static const float3 LightDirection = normalize(float3(0.0f, 0.5f, 1.0f));
+static const float Ambient = 0.3f;
+
+float3 UnpackNormal(float2 Packed)
+{
+	float3 Normal = float3(Packed, 1.0f - abs(Packed.x) - abs(Packed.y));
+	float Fold = saturate(-Normal.z);
+	Normal.xy += (Normal.xy >= 0.0f) ? -Fold : Fold;
+
+	return normalize(Normal);
+}
+
 PSInput VShader(VSInput Input)
 {
 	PSInput Output;
 
+	matrix World = transpose(float4x4(Input.World0, Input.World1, Input.World2, Input.World3));
+
 	Output.Color = float4(Input.Color, 1.0f);
 
+	// A zero normal marks unlit vertices
+	if (any(Input.Normal))
+	{
+		float3 Normal = normalize(mul(float4(UnpackNormal(Input.Normal), 0.0f), World).xyz);
+		Output.Color.rgb *= Ambient + (1.0f - Ambient) * saturate(dot(Normal, LightDirection));
+	}
+
 	Output.Position = float4(Input.Position, 1.f);
-	Output.Position = mul(Output.Position, Object.World);
+	Output.Position = mul(Output.Position, World);
 	Output.Position = mul(Output.Position, Camera.View);
 	Output.Position = mul(Output.Position, Camera.Projection);
 
@@ -0,0 +1,529 @@
+#pragma once
+
+// The subset of DirectXMath the cameras and the head tracking need, without Windows or DirectXMath headers so the
+// math can be built and profiled on any platform. The backend is chosen at compile time: AVX, SSE2, NEON or a scalar
+// fallback, which can be forced by defining SIMDMATH_SCALAR. Matrices use the DirectXMath conventions, i.e. row
+// vectors and row major storage, and are stored transposed for the shaders by the callers just the same.
+//
+// Every backend evaluates the operations in the order of the DirectXMath SSE2 path, which the x86 and x64 builds use,
+// so the results match DirectXMath bit for bit as long as the compiler does not contract multiplies and adds into
+// fused multiply-adds (/fp:precise, -ffp-contract=off). Normalizing a zero length vector gives zero like DirectXMath.
+
+#include <cmath>
+#include <cstring>
+
+#if !defined(SIMDMATH_SCALAR)
+#if defined(__AVX__)
+#define SIMDMATH_AVX
+#define SIMDMATH_SSE
+#include <immintrin.h>
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define SIMDMATH_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM) || defined(_M_ARM64)
+#define SIMDMATH_NEON
+#include <arm_neon.h>
+#else
+#define SIMDMATH_SCALAR
+#endif
+#endif
+
+namespace SimdMath
+{
+#if defined(SIMDMATH_SSE)
+	typedef __m128 Vector;
+#elif defined(SIMDMATH_NEON)
+	typedef float32x4_t Vector;
+#else
+	struct Vector
+	{
+		float Lanes[4];
+	};
+#endif
+
+	struct Matrix
+	{
+		Vector Rows[4];
+	};
+
+	static constexpr float Pi = 3.141592654f;
+
+	inline const wchar_t * GetBackendName()
+	{
+#if defined(SIMDMATH_AVX)
+		return L"AVX";
+#elif defined(SIMDMATH_SSE)
+		return L"SSE2";
+#elif defined(SIMDMATH_NEON)
+		return L"NEON";
+#else
+		return L"Scalar";
+#endif
+	}
+
+	// Backend primitives
+
+	inline Vector Set(float X, float Y, float Z, float W)
+	{
+#if defined(SIMDMATH_SSE)
+		return _mm_set_ps(W, Z, Y, X);
+#elif defined(SIMDMATH_NEON)
+		const float Lanes[4] = { X, Y, Z, W };
+		return vld1q_f32(Lanes);
+#else
+		return { { X, Y, Z, W } };
+#endif
+	}
+
+	inline Vector Replicate(float Value)
+	{
+#if defined(SIMDMATH_SSE)
+		return _mm_set1_ps(Value);
+#elif defined(SIMDMATH_NEON)
+		return vdupq_n_f32(Value);
+#else
+		return { { Value, Value, Value, Value } };
+#endif
+	}
+
+	inline Vector Zero()
+	{
+		return Replicate(0.f);
+	}
+
+	inline Vector LoadFloat3(const float * Source)
+	{
+		return Set(Source[0], Source[1], Source[2], 0.f);
+	}
+
+	inline Vector LoadFloat4(const float * Source)
+	{
+#if defined(SIMDMATH_SSE)
+		return _mm_loadu_ps(Source);
+#elif defined(SIMDMATH_NEON)
+		return vld1q_f32(Source);
+#else
+		return { { Source[0], Source[1], Source[2], Source[3] } };
+#endif
+	}
+
+	inline void StoreFloat4(float * Destination, Vector V)
+	{
+#if defined(SIMDMATH_SSE)
+		_mm_storeu_ps(Destination, V);
+#elif defined(SIMDMATH_NEON)
+		vst1q_f32(Destination, V);
+#else
+		std::memcpy(Destination, V.Lanes, sizeof(V.Lanes));
+#endif
+	}
+
+	inline void StoreFloat3(float * Destination, Vector V)
+	{
+		float Lanes[4];
+		StoreFloat4(Lanes, V);
+		std::memcpy(Destination, Lanes, 3 * sizeof(float));
+	}
+
+	template<unsigned Lane>
+	inline float GetLane(Vector V)
+	{
+		static_assert(Lane < 4, "A vector has four lanes");
+
+#if defined(SIMDMATH_SSE)
+		return _mm_cvtss_f32(_mm_shuffle_ps(V, V, _MM_SHUFFLE(Lane, Lane, Lane, Lane)));
+#elif defined(SIMDMATH_NEON)
+		return vgetq_lane_f32(V, Lane);
+#else
+		return V.Lanes[Lane];
+#endif
+	}
+
+	inline float GetX(Vector V) { return GetLane<0>(V); }
+	inline float GetY(Vector V) { return GetLane<1>(V); }
+	inline float GetZ(Vector V) { return GetLane<2>(V); }
+	inline float GetW(Vector V) { return GetLane<3>(V); }
+
+	// Lanes X and Y are taken from A, lanes Z and W from B, like _mm_shuffle_ps
+	template<unsigned X, unsigned Y, unsigned Z, unsigned W>
+	inline Vector Shuffle(Vector A, Vector B)
+	{
+		static_assert((X < 4) && (Y < 4) && (Z < 4) && (W < 4), "A vector has four lanes");
+
+#if defined(SIMDMATH_SSE)
+		return _mm_shuffle_ps(A, B, _MM_SHUFFLE(W, Z, Y, X));
+#elif defined(SIMDMATH_NEON)
+		float32x4_t Result = vdupq_n_f32(vgetq_lane_f32(A, X));
+		Result = vsetq_lane_f32(vgetq_lane_f32(A, Y), Result, 1);
+		Result = vsetq_lane_f32(vgetq_lane_f32(B, Z), Result, 2);
+		return vsetq_lane_f32(vgetq_lane_f32(B, W), Result, 3);
+#else
+		return { { A.Lanes[X], A.Lanes[Y], B.Lanes[Z], B.Lanes[W] } };
+#endif
+	}
+
+	template<unsigned X, unsigned Y, unsigned Z, unsigned W>
+	inline Vector Swizzle(Vector V)
+	{
+		return Shuffle<X, Y, Z, W>(V, V);
+	}
+
+#if defined(SIMDMATH_SSE)
+	inline Vector Add(Vector A, Vector B) { return _mm_add_ps(A, B); }
+	inline Vector Subtract(Vector A, Vector B) { return _mm_sub_ps(A, B); }
+	inline Vector Multiply(Vector A, Vector B) { return _mm_mul_ps(A, B); }
+	inline Vector Divide(Vector A, Vector B) { return _mm_div_ps(A, B); }
+	inline Vector Sqrt(Vector V) { return _mm_sqrt_ps(V); }
+#elif defined(SIMDMATH_NEON)
+	inline Vector Add(Vector A, Vector B) { return vaddq_f32(A, B); }
+	inline Vector Subtract(Vector A, Vector B) { return vsubq_f32(A, B); }
+	inline Vector Multiply(Vector A, Vector B) { return vmulq_f32(A, B); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+	inline Vector Divide(Vector A, Vector B) { return vdivq_f32(A, B); }
+	inline Vector Sqrt(Vector V) { return vsqrtq_f32(V); }
+#else
+	// ARMv7 NEON only estimates reciprocals and square roots, which would not match
+	inline Vector Divide(Vector A, Vector B) { return Set(GetX(A) / GetX(B), GetY(A) / GetY(B), GetZ(A) / GetZ(B), GetW(A) / GetW(B)); }
+	inline Vector Sqrt(Vector V) { return Set(std::sqrt(GetX(V)), std::sqrt(GetY(V)), std::sqrt(GetZ(V)), std::sqrt(GetW(V))); }
+#endif
+#else
+	template<typename Operation>
+	inline Vector PerLane(Vector A, Vector B, Operation Apply)
+	{
+		return { { Apply(A.Lanes[0], B.Lanes[0]), Apply(A.Lanes[1], B.Lanes[1]), Apply(A.Lanes[2], B.Lanes[2]), Apply(A.Lanes[3], B.Lanes[3]) } };
+	}
+
+	inline Vector Add(Vector A, Vector B) { return PerLane(A, B, [](float Left, float Right) { return Left + Right; }); }
+	inline Vector Subtract(Vector A, Vector B) { return PerLane(A, B, [](float Left, float Right) { return Left - Right; }); }
+	inline Vector Multiply(Vector A, Vector B) { return PerLane(A, B, [](float Left, float Right) { return Left * Right; }); }
+	inline Vector Divide(Vector A, Vector B) { return PerLane(A, B, [](float Left, float Right) { return Left / Right; }); }
+	inline Vector Sqrt(Vector V) { return PerLane(V, V, [](float Value, float) { return std::sqrt(Value); }); }
+#endif
+
+	// Zero minus the vector like XMVectorNegate, i.e. zero stays positive
+	inline Vector Negate(Vector V)
+	{
+		return Subtract(Zero(), V);
+	}
+
+	// Clears the sign like XMVectorAbs
+	inline Vector Abs(Vector V)
+	{
+#if defined(SIMDMATH_SSE)
+		return _mm_andnot_ps(_mm_set1_ps(-0.f), V);
+#elif defined(SIMDMATH_NEON)
+		return vabsq_f32(V);
+#else
+		return { { std::fabs(V.Lanes[0]), std::fabs(V.Lanes[1]), std::fabs(V.Lanes[2]), std::fabs(V.Lanes[3]) } };
+#endif
+	}
+
+	// Clears W
+	inline Vector MaskXYZ(Vector V)
+	{
+#if defined(SIMDMATH_SSE)
+		return _mm_and_ps(V, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+#elif defined(SIMDMATH_NEON)
+		return vsetq_lane_f32(0.f, V, 3);
+#else
+		return { { V.Lanes[0], V.Lanes[1], V.Lanes[2], 0.f } };
+#endif
+	}
+
+	// The lanes of V where Length is not zero, zero elsewhere
+	inline Vector SelectNonZero(Vector V, Vector Length)
+	{
+#if defined(SIMDMATH_SSE)
+		return _mm_and_ps(V, _mm_cmpneq_ps(Length, _mm_setzero_ps()));
+#elif defined(SIMDMATH_NEON)
+		return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(V), vceqq_f32(Length, vdupq_n_f32(0.f))));
+#else
+		return { { (Length.Lanes[0] != 0.f) ? V.Lanes[0] : 0.f, (Length.Lanes[1] != 0.f) ? V.Lanes[1] : 0.f, (Length.Lanes[2] != 0.f) ? V.Lanes[2] : 0.f, (Length.Lanes[3] != 0.f) ? V.Lanes[3] : 0.f } };
+#endif
+	}
+
+	// Vectors
+
+	// The dot product in all lanes, summed as (X + Y) + Z
+	inline Vector Dot3(Vector A, Vector B)
+	{
+		Vector Products = Multiply(A, B);
+		Vector Others = Swizzle<1, 2, 1, 2>(Products);
+		Vector Sum = Add(Add(Products, Others), Swizzle<1, 1, 1, 1>(Others));
+		return Swizzle<0, 0, 0, 0>(Sum);
+	}
+
+	inline Vector Cross3(Vector A, Vector B)
+	{
+		Vector A1 = Swizzle<1, 2, 0, 3>(A);
+		Vector B1 = Swizzle<2, 0, 1, 3>(B);
+		Vector A2 = Swizzle<1, 2, 0, 3>(A1);
+		Vector B2 = Swizzle<2, 0, 1, 3>(B1);
+		return MaskXYZ(Subtract(Multiply(A1, B1), Multiply(A2, B2)));
+	}
+
+	inline Vector Length3(Vector V)
+	{
+		return Sqrt(Dot3(V, V));
+	}
+
+	inline Vector Normalize3(Vector V)
+	{
+		Vector Length = Length3(V);
+		return SelectNonZero(Divide(V, Length), Length);
+	}
+
+	inline Vector Scale(Vector V, float Factor)
+	{
+		return Multiply(V, Replicate(Factor));
+	}
+
+	// V0 + (V1 - V0) * T like XMVectorLerp
+	inline Vector Lerp(Vector V0, Vector V1, float T)
+	{
+		return Add(Multiply(Subtract(V1, V0), Replicate(T)), V0);
+	}
+
+	// Quaternions
+
+	inline Vector QuaternionConjugate(Vector Q)
+	{
+		return Multiply(Q, Set(-1.f, -1.f, -1.f, 1.f));
+	}
+
+	// Rotation Q1 followed by rotation Q2, i.e. Q2 * Q1 like XMQuaternionMultiply
+	inline Vector QuaternionMultiply(Vector Q1, Vector Q2)
+	{
+		Vector Result = Multiply(Swizzle<3, 3, 3, 3>(Q2), Q1);
+		Vector Q1Shuffle = Swizzle<3, 2, 1, 0>(Q1);
+		Vector Q2X = Multiply(Multiply(Swizzle<0, 0, 0, 0>(Q2), Q1Shuffle), Set(1.f, -1.f, 1.f, -1.f));
+		Q1Shuffle = Swizzle<1, 0, 3, 2>(Q1Shuffle);
+		Vector Q2Y = Multiply(Multiply(Swizzle<1, 1, 1, 1>(Q2), Q1Shuffle), Set(1.f, 1.f, -1.f, -1.f));
+		Q1Shuffle = Swizzle<3, 2, 1, 0>(Q1Shuffle);
+		Vector Q2Z = Multiply(Multiply(Swizzle<2, 2, 2, 2>(Q2), Q1Shuffle), Set(-1.f, 1.f, 1.f, -1.f));
+
+		return Add(Add(Result, Q2X), Add(Q2Y, Q2Z));
+	}
+
+	inline Vector Vector3Rotate(Vector V, Vector Q)
+	{
+		Vector Result = QuaternionMultiply(QuaternionConjugate(Q), MaskXYZ(V));
+		return QuaternionMultiply(Result, Q);
+	}
+
+	inline Vector Vector3InverseRotate(Vector V, Vector Q)
+	{
+		Vector Result = QuaternionMultiply(Q, MaskXYZ(V));
+		return QuaternionMultiply(Result, QuaternionConjugate(Q));
+	}
+
+	// Matrices
+
+	inline Matrix MatrixSet(Vector Row0, Vector Row1, Vector Row2, Vector Row3)
+	{
+		return { { Row0, Row1, Row2, Row3 } };
+	}
+
+	inline Matrix MatrixIdentity()
+	{
+		return MatrixSet(Set(1.f, 0.f, 0.f, 0.f), Set(0.f, 1.f, 0.f, 0.f), Set(0.f, 0.f, 1.f, 0.f), Set(0.f, 0.f, 0.f, 1.f));
+	}
+
+	inline Matrix LoadFloat4x4(const float * Source)
+	{
+		return MatrixSet(LoadFloat4(Source), LoadFloat4(Source + 4), LoadFloat4(Source + 8), LoadFloat4(Source + 12));
+	}
+
+	inline void StoreFloat4x4(float * Destination, const Matrix & M)
+	{
+		for (unsigned Row = 0; Row < 4; ++Row)
+		{
+			StoreFloat4(Destination + Row * 4, M.Rows[Row]);
+		}
+	}
+
+	inline Matrix MatrixTranspose(const Matrix & M)
+	{
+		Vector Upper01 = Shuffle<0, 1, 0, 1>(M.Rows[0], M.Rows[1]);
+		Vector Lower01 = Shuffle<2, 3, 2, 3>(M.Rows[0], M.Rows[1]);
+		Vector Upper23 = Shuffle<0, 1, 0, 1>(M.Rows[2], M.Rows[3]);
+		Vector Lower23 = Shuffle<2, 3, 2, 3>(M.Rows[2], M.Rows[3]);
+
+		return MatrixSet(Shuffle<0, 2, 0, 2>(Upper01, Upper23), Shuffle<1, 3, 1, 3>(Upper01, Upper23), Shuffle<0, 2, 0, 2>(Lower01, Lower23), Shuffle<1, 3, 1, 3>(Lower01, Lower23));
+	}
+
+	// M1 * M2, each row summed as (X + Z) + (Y + W)
+	inline Matrix MatrixMultiply(const Matrix & M1, const Matrix & M2)
+	{
+#if defined(SIMDMATH_AVX)
+		// Two rows at a time
+		auto Pair = [](Vector Lower, Vector Upper) { return _mm256_insertf128_ps(_mm256_castps128_ps256(Lower), Upper, 1); };
+		auto Broadcast = [](const Matrix & M, unsigned Row, unsigned Lane)
+		{
+			const float * Lower = reinterpret_cast<const float *>(&M.Rows[Row]) + Lane;
+			const float * Upper = reinterpret_cast<const float *>(&M.Rows[Row + 1]) + Lane;
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_broadcast_ss(Lower)), _mm_broadcast_ss(Upper), 1);
+		};
+
+		__m256 Row0 = Pair(M2.Rows[0], M2.Rows[0]);
+		__m256 Row1 = Pair(M2.Rows[1], M2.Rows[1]);
+		__m256 Row2 = Pair(M2.Rows[2], M2.Rows[2]);
+		__m256 Row3 = Pair(M2.Rows[3], M2.Rows[3]);
+
+		Matrix Result;
+
+		for (unsigned Row = 0; Row < 4; Row += 2)
+		{
+			__m256 X = _mm256_mul_ps(Broadcast(M1, Row, 0), Row0);
+			__m256 Y = _mm256_mul_ps(Broadcast(M1, Row, 1), Row1);
+			__m256 Z = _mm256_mul_ps(Broadcast(M1, Row, 2), Row2);
+			__m256 W = _mm256_mul_ps(Broadcast(M1, Row, 3), Row3);
+			__m256 Sum = _mm256_add_ps(_mm256_add_ps(X, Z), _mm256_add_ps(Y, W));
+
+			Result.Rows[Row] = _mm256_castps256_ps128(Sum);
+			Result.Rows[Row + 1] = _mm256_extractf128_ps(Sum, 1);
+		}
+
+		return Result;
+#else
+		Matrix Result;
+
+		for (unsigned Row = 0; Row < 4; ++Row)
+		{
+			Vector V = M1.Rows[Row];
+			Vector X = Multiply(Swizzle<0, 0, 0, 0>(V), M2.Rows[0]);
+			Vector Y = Multiply(Swizzle<1, 1, 1, 1>(V), M2.Rows[1]);
+			Vector Z = Multiply(Swizzle<2, 2, 2, 2>(V), M2.Rows[2]);
+			Vector W = Multiply(Swizzle<3, 3, 3, 3>(V), M2.Rows[3]);
+
+			Result.Rows[Row] = Add(Add(X, Z), Add(Y, W));
+		}
+
+		return Result;
+#endif
+	}
+
+	inline Matrix MatrixScaling(float X, float Y, float Z)
+	{
+		return MatrixSet(Set(X, 0.f, 0.f, 0.f), Set(0.f, Y, 0.f, 0.f), Set(0.f, 0.f, Z, 0.f), Set(0.f, 0.f, 0.f, 1.f));
+	}
+
+	inline Matrix MatrixTranslation(float X, float Y, float Z)
+	{
+		return MatrixSet(Set(1.f, 0.f, 0.f, 0.f), Set(0.f, 1.f, 0.f, 0.f), Set(0.f, 0.f, 1.f, 0.f), Set(X, Y, Z, 1.f));
+	}
+
+	inline Matrix MatrixRotationQuaternion(Vector Q)
+	{
+		Vector Q0 = Add(Q, Q);
+		Vector Q1 = Multiply(Q, Q0);
+
+		// Diagonal: 1 - 2yy - 2zz, 1 - 2xx - 2zz, 1 - 2xx - 2yy
+		Vector Diagonal = Subtract(Subtract(Set(1.f, 1.f, 1.f, 0.f), MaskXYZ(Swizzle<1, 0, 0, 3>(Q1))), MaskXYZ(Swizzle<2, 2, 1, 3>(Q1)));
+
+		// 2xz, 2xy, 2yz against 2wy, 2wz, 2wx
+		Vector V0 = Multiply(Swizzle<0, 0, 1, 3>(Q), Swizzle<2, 1, 2, 3>(Q0));
+		Vector V1 = Multiply(Swizzle<3, 3, 3, 3>(Q), Swizzle<1, 2, 0, 3>(Q0));
+		Vector Sums = Add(V0, V1);
+		Vector Differences = Subtract(V0, V1);
+
+		// 2xy + 2wz, 2xz - 2wy, 2xy - 2wz, 2yz + 2wx
+		Vector Upper = Swizzle<0, 2, 3, 1>(Shuffle<1, 2, 0, 1>(Sums, Differences));
+
+		// 2xz + 2wy, 2yz - 2wx
+		Vector Lower = Swizzle<0, 2, 0, 2>(Shuffle<0, 0, 2, 2>(Sums, Differences));
+
+		return MatrixSet(
+			Swizzle<0, 2, 3, 1>(Shuffle<0, 3, 0, 1>(Diagonal, Upper)),
+			Swizzle<2, 0, 3, 1>(Shuffle<1, 3, 2, 3>(Diagonal, Upper)),
+			Shuffle<0, 1, 2, 3>(Lower, Diagonal),
+			Set(0.f, 0.f, 0.f, 1.f));
+	}
+
+	// Looks from Eye along Direction in a left handed system
+	inline Matrix MatrixLookToLH(Vector Eye, Vector Direction, Vector Up)
+	{
+		Vector Axis2 = Normalize3(Direction);
+		Vector Axis0 = Normalize3(Cross3(Up, Axis2));
+		Vector Axis1 = Cross3(Axis2, Axis0);
+		Vector NegatedEye = Negate(Eye);
+
+		Vector Translation0 = Dot3(Axis0, NegatedEye);
+		Vector Translation1 = Dot3(Axis1, NegatedEye);
+		Vector Translation2 = Dot3(Axis2, NegatedEye);
+
+		// The axes with the translation in W, transposed
+		auto WithTranslation = [](Vector Axis, Vector Translation) { return Shuffle<0, 1, 0, 2>(Axis, Shuffle<2, 2, 0, 0>(Axis, Translation)); };
+
+		return MatrixTranspose(MatrixSet(WithTranslation(Axis0, Translation0), WithTranslation(Axis1, Translation1), WithTranslation(Axis2, Translation2), Set(0.f, 0.f, 0.f, 1.f)));
+	}
+
+	inline Matrix MatrixLookToRH(Vector Eye, Vector Direction, Vector Up)
+	{
+		return MatrixLookToLH(Eye, Negate(Direction), Up);
+	}
+
+	inline Matrix MatrixPerspectiveOffCenterRH(float Left, float Right, float Bottom, float Top, float NearZ, float FarZ)
+	{
+		float TwoNearZ = NearZ + NearZ;
+		float ReciprocalWidth = 1.f / (Right - Left);
+		float ReciprocalHeight = 1.f / (Top - Bottom);
+		float Range = FarZ / (NearZ - FarZ);
+
+		return MatrixSet(
+			Set(TwoNearZ * ReciprocalWidth, 0.f, 0.f, 0.f),
+			Set(0.f, TwoNearZ * ReciprocalHeight, 0.f, 0.f),
+			Set((Left + Right) * ReciprocalWidth, (Top + Bottom) * ReciprocalHeight, Range, -1.f),
+			Set(0.f, 0.f, Range * NearZ, 0.f));
+	}
+
+	inline float ConvertToRadians(float Degrees)
+	{
+		return Degrees * (Pi / 180.f);
+	}
+
+	// The minimax polynomials of XMScalarSinCos, on [-pi/2, pi/2] after the same range reduction
+	inline void ScalarSinCos(float Angle, float & Sin, float & Cos)
+	{
+		constexpr float TwoPi = 6.283185307f;
+		constexpr float OneOverTwoPi = 0.159154943f;
+		constexpr float HalfPi = 1.570796327f;
+
+		float Quotient = OneOverTwoPi * Angle;
+		Quotient = static_cast<float>(static_cast<int>((Angle >= 0.f) ? (Quotient + 0.5f) : (Quotient - 0.5f)));
+		float Y = Angle - TwoPi * Quotient;
+		float Sign = 1.f;
+
+		if (Y > HalfPi)
+		{
+			Y = Pi - Y;
+			Sign = -1.f;
+		}
+		else if (Y < -HalfPi)
+		{
+			Y = -Pi - Y;
+			Sign = -1.f;
+		}
+
+		float Y2 = Y * Y;
+		Sin = (((((-2.3889859e-08f * Y2 + 2.7525562e-06f) * Y2 - 0.00019840874f) * Y2 + 0.0083333310f) * Y2 - 0.16666667f) * Y2 + 1.f) * Y;
+		Cos = Sign * ((((((-2.6051615e-07f * Y2 + 2.4760495e-05f) * Y2 - 0.0013888378f) * Y2 + 0.041666638f) * Y2 - 0.5f) * Y2 + 1.f));
+	}
+
+	inline Matrix MatrixPerspectiveFovRH(float FovAngleY, float AspectRatio, float NearZ, float FarZ)
+	{
+		float Sin;
+		float Cos;
+		ScalarSinCos(0.5f * FovAngleY, Sin, Cos);
+
+		float Height = Cos / Sin;
+		float Width = Height / AspectRatio;
+		float Range = FarZ / (NearZ - FarZ);
+
+		return MatrixSet(
+			Set(Width, 0.f, 0.f, 0.f),
+			Set(0.f, Height, 0.f, 0.f),
+			Set(0.f, 0.f, Range, -1.f),
+			Set(0.f, 0.f, Range * NearZ, 0.f));
+	}
+}
@@ -0,0 +1,73 @@
+// StereoFrameCamera.cpp : Both eyes looking through the same frame, resolved together
+//
+
+#include "stdafx.h"
+#include "StereoFrameCamera.h"
+
+StereoFrameCamera::StereoFrameCamera(_In_ const Vector3 & Position, _In_ float FrameHeight)
+	:Eyes{ { FrameCamera(Position, FrameHeight), FrameCamera(Position, FrameHeight) } }
+{
+}
+
+FrameCamera & StereoFrameCamera::GetEye(_In_ Eye Eye)
+{
+	return Eyes[Eye];
+}
+
+const FrameCamera & StereoFrameCamera::GetEye(_In_ Eye Eye) const
+{
+	return Eyes[Eye];
+}
+
+void StereoFrameCamera::Resolve()
+{
+	FrameCamera & Left = Eyes[Eye_Left];
+	FrameCamera & Right = Eyes[Eye_Right];
+
+	if (!Left.Dirty && !Right.Dirty)
+	{
+		return;
+	}
+
+	// The lanes hold the horizontal and vertical terms of the left eye, then of the right eye, so one call computes both
+	FrameCamera::ProjectionTerms Terms = FrameCamera::GetProjectionTerms(
+		SimdMath::Set(Left.FrameHalfHeight * Left.AspectRatio, Left.FrameHalfHeight, Right.FrameHalfHeight * Right.AspectRatio, Right.FrameHalfHeight),
+		SimdMath::Set(Left.Position.X, Left.Position.Y, Right.Position.X, Right.Position.Y),
+		SimdMath::Set(Left.Position.Z, Left.Position.Z, Right.Position.Z, Right.Position.Z));
+
+	for (unsigned Index = 0; Index < Eye_Count; ++Index)
+	{
+		FrameCamera & Camera = Eyes[Index];
+
+		if (!Camera.Dirty)
+		{
+			continue;
+		}
+
+		unsigned X = 2 * Index;
+		unsigned Y = X + 1;
+
+		Camera.SetMatrices(Terms.Scale[X], Terms.Scale[Y], Terms.Offset[X], Terms.Offset[Y], Terms.Range[X], Terms.DepthOffset[X]);
+		Camera.Dirty = false;
+		++Camera.ResolveCount;
+	}
+}
+
+void StereoFrameCamera::GetConstants(_Out_ StereoConstants & Constants) const
+{
+	GetConstants(Eyes[Eye_Left], Eyes[Eye_Right], Constants);
+}
+
+void StereoFrameCamera::GetConstants(_In_ const Camera & LeftEye, _In_ const Camera & RightEye, _Out_ StereoConstants & Constants)
+{
+	Constants.View = { LeftEye.GetViewMatrix(), RightEye.GetViewMatrix() };
+	Constants.Projection = { LeftEye.GetProjectionMatrix(), RightEye.GetProjectionMatrix() };
+}
+
+void StereoFrameCamera::KeyPressedCallback(const WPARAM & VirtualKey)
+{
+	for (FrameCamera & Camera : Eyes)
+	{
+		Camera.KeyPressedCallback(VirtualKey);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "FrameCamera.h"
+
+// The two eyes of the viewer looking through the same frame. Each eye stays an ordinary FrameCamera for the head
+// tracking and the render contexts, which may still resolve it alone when late latching; resolving the rig computes
+// both eyes at once, since they share the frame and only their positions differ.
+class StereoFrameCamera
+{
+public:
+	enum Eye
+	{
+		Eye_Left,
+		Eye_Right,
+		Eye_Count
+	};
+
+	// The matrices of both eyes in one constant buffer, indexed by the eye of an instance when drawing both eyes in a
+	// single pass; matches `matrix View[2]; matrix Projection[2];` in HLSL
+	struct StereoConstants
+	{
+		std::array<DirectX::XMFLOAT4X4, Eye_Count> View;
+		std::array<DirectX::XMFLOAT4X4, Eye_Count> Projection;
+	};
+
+	StereoFrameCamera(_In_ const Vector3 & Position, _In_ float FrameHeight);
+
+	FrameCamera & GetEye(_In_ Eye Eye);
+	const FrameCamera & GetEye(_In_ Eye Eye) const;
+
+	// Recalculates the outdated eyes together
+	void Resolve();
+
+	// Packs the matrices as of the last resolve of each eye
+	void GetConstants(_Out_ StereoConstants & Constants) const;
+	static void GetConstants(_In_ const Camera & LeftEye, _In_ const Camera & RightEye, _Out_ StereoConstants & Constants);
+
+	void KeyPressedCallback(const WPARAM & VirtualKey);
+
+private:
+	std::array<FrameCamera, Eye_Count> Eyes;
+};
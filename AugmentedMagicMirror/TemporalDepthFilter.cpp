@@ -0,0 +1,171 @@
+// TemporalDepthFilter.cpp : Adaptive exponential filter over consecutive depth frames with motion detection
+//
+
+#include "stdafx.h"
+#include "TemporalDepthFilter.h"
+
+namespace
+{
+	// Differences above Threshold + Depth / 2^ThresholdShift are treated as motion and reset the pixel
+	constexpr UINT16 MotionThreshold = 30;
+	constexpr int MotionThresholdShift = 6;
+
+	// Blend factors as unsigned 0.16 fixed point; confident pixels use a smaller factor
+	constexpr UINT16 MaxAlpha = 32768;
+	constexpr UINT16 MinAlpha = 6554;
+	constexpr UINT16 AlphaStep = (MaxAlpha - MinAlpha) / 15;
+
+	constexpr UINT16 MaxConfidence = 255;
+	constexpr UINT16 ConfidenceGain = 16;
+	constexpr UINT16 InvalidConfidenceDecay = 64;
+
+	inline __m128i Select(_In_ __m128i Mask, _In_ __m128i TrueValue, _In_ __m128i FalseValue)
+	{
+		return _mm_or_si128(_mm_and_si128(Mask, TrueValue), _mm_andnot_si128(Mask, FalseValue));
+	}
+}
+
+TemporalDepthFilter::TemporalDepthFilter(_In_ unsigned Width, _In_ unsigned Height)
+	:Width(Width), Height(Height)
+	, FilteredDepth(Width * Height, 0), Confidence(Width * Height, 0)
+	, Enabled(true)
+	, FilterTime(L"Temporal Depth Filter")
+{
+}
+
+void TemporalDepthFilter::Apply(_Inout_ DepthPixelList & DepthPixels)
+{
+	if (!Enabled || (DepthPixels.size() != FilteredDepth.size()))
+	{
+		return;
+	}
+
+	FilterTime.Start();
+
+	unsigned BandCount = (Height + RowsPerBand - 1) / RowsPerBand;
+
+	concurrency::parallel_for(0u, BandCount, [&](unsigned Band)
+	{
+		unsigned FirstRow = Band * RowsPerBand;
+		ApplyRows(DepthPixels, FirstRow, (std::min)(FirstRow + RowsPerBand, Height));
+	});
+
+	FilterTime.Stop();
+}
+
+void TemporalDepthFilter::Reset()
+{
+	std::fill(FilteredDepth.begin(), FilteredDepth.end(), static_cast<UINT16>(0));
+	std::fill(Confidence.begin(), Confidence.end(), static_cast<UINT8>(0));
+}
+
+const TemporalDepthFilter::ConfidenceList & TemporalDepthFilter::GetConfidence() const
+{
+	return Confidence;
+}
+
+void TemporalDepthFilter::KeyPressedCallback(_In_ const WPARAM & VirtualKey)
+{
+	if (VirtualKey == 'T')
+	{
+		Enabled = !Enabled;
+		Reset();
+	}
+}
+
+void TemporalDepthFilter::ApplyRows(_Inout_ DepthPixelList & DepthPixels, _In_ unsigned FirstRow, _In_ unsigned LastRow)
+{
+	constexpr size_t PixelsPerStep = sizeof(__m128i) / sizeof(UINT16);
+
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i AllBits = _mm_cmpeq_epi16(Zero, Zero);
+	const __m128i Threshold = _mm_set1_epi16(MotionThreshold);
+	const __m128i Alpha = _mm_set1_epi16(static_cast<short>(MaxAlpha));
+	const __m128i Step = _mm_set1_epi16(AlphaStep);
+	const __m128i Gain = _mm_set1_epi16(ConfidenceGain);
+	const __m128i Decay = _mm_set1_epi16(InvalidConfidenceDecay);
+	const __m128i ConfidenceLimit = _mm_set1_epi16(MaxConfidence);
+
+	size_t Begin = static_cast<size_t>(FirstRow) * Width;
+	size_t End = static_cast<size_t>(LastRow) * Width;
+	size_t VectorEnd = Begin + ((End - Begin) / PixelsPerStep) * PixelsPerStep;
+
+	UINT16 * Depth = DepthPixels.data();
+	UINT16 * Filtered = FilteredDepth.data();
+	UINT8 * PixelConfidence = Confidence.data();
+
+	for (size_t Index = Begin; Index < VectorEnd; Index += PixelsPerStep)
+	{
+		__m128i New = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Depth + Index));
+		__m128i Previous = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Filtered + Index));
+		__m128i PreviousConfidence = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(PixelConfidence + Index)), Zero);
+
+		__m128i IsInvalid = _mm_cmpeq_epi16(New, Zero);
+		__m128i WasInvalid = _mm_cmpeq_epi16(Previous, Zero);
+
+		// Unsigned absolute difference and motion test against a depth dependent threshold
+		__m128i Difference = _mm_or_si128(_mm_subs_epu16(New, Previous), _mm_subs_epu16(Previous, New));
+		__m128i PixelThreshold = _mm_adds_epu16(Threshold, _mm_srli_epi16(Previous, MotionThresholdShift));
+		__m128i IsMoving = _mm_xor_si128(_mm_cmpeq_epi16(_mm_subs_epu16(Difference, PixelThreshold), Zero), AllBits);
+		__m128i TakeNew = _mm_or_si128(WasInvalid, IsMoving);
+
+		// Previous + Alpha * (New - Previous), where Alpha shrinks with growing confidence
+		__m128i PixelAlpha = _mm_sub_epi16(Alpha, _mm_mullo_epi16(_mm_srli_epi16(PreviousConfidence, 4), Step));
+		__m128i BlendStep = _mm_mulhi_epu16(Difference, PixelAlpha);
+		__m128i IsIncreasing = _mm_cmpeq_epi16(_mm_subs_epu16(Previous, New), Zero);
+		__m128i Blended = Select(IsIncreasing, _mm_adds_epu16(Previous, BlendStep), _mm_subs_epu16(Previous, BlendStep));
+
+		__m128i ValidDepth = Select(TakeNew, New, Blended);
+		__m128i ValidConfidence = _mm_andnot_si128(TakeNew, _mm_min_epi16(_mm_adds_epu16(PreviousConfidence, Gain), ConfidenceLimit));
+
+		// Invalid samples keep the last value until its confidence has decayed
+		__m128i HeldConfidence = _mm_subs_epu16(PreviousConfidence, Decay);
+		__m128i HeldDepth = _mm_andnot_si128(_mm_cmpeq_epi16(HeldConfidence, Zero), Previous);
+
+		__m128i ResultDepth = Select(IsInvalid, HeldDepth, ValidDepth);
+		__m128i ResultConfidence = Select(IsInvalid, HeldConfidence, ValidConfidence);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(Depth + Index), ResultDepth);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(Filtered + Index), ResultDepth);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(PixelConfidence + Index), _mm_packus_epi16(ResultConfidence, Zero));
+	}
+
+	for (size_t Index = VectorEnd; Index < End; ++Index)
+	{
+		ApplyPixel(Depth[Index], Index);
+	}
+}
+
+void TemporalDepthFilter::ApplyPixel(_Inout_ UINT16 & Depth, _In_ size_t Index)
+{
+	UINT16 Previous = FilteredDepth[Index];
+	UINT16 PreviousConfidence = Confidence[Index];
+	UINT16 ResultConfidence;
+
+	if (Depth == 0)
+	{
+		ResultConfidence = (PreviousConfidence > InvalidConfidenceDecay) ? static_cast<UINT16>(PreviousConfidence - InvalidConfidenceDecay) : 0;
+		Depth = (ResultConfidence != 0) ? Previous : 0;
+	}
+	else
+	{
+		UINT16 Difference = static_cast<UINT16>((Depth > Previous) ? (Depth - Previous) : (Previous - Depth));
+		unsigned PixelThreshold = MotionThreshold + (Previous >> MotionThresholdShift);
+
+		if ((Previous == 0) || (Difference > PixelThreshold))
+		{
+			ResultConfidence = 0;
+		}
+		else
+		{
+			unsigned PixelAlpha = MaxAlpha - (PreviousConfidence >> 4) * AlphaStep;
+			UINT16 BlendStep = static_cast<UINT16>((Difference * PixelAlpha) >> 16);
+
+			Depth = static_cast<UINT16>((Depth >= Previous) ? (Previous + BlendStep) : (Previous - BlendStep));
+			ResultConfidence = (std::min)(static_cast<UINT16>(PreviousConfidence + ConfidenceGain), MaxConfidence);
+		}
+	}
+
+	FilteredDepth[Index] = Depth;
+	Confidence[Index] = static_cast<UINT8>(ResultConfidence);
+}
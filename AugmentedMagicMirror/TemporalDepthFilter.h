@@ -0,0 +1,35 @@
+#pragma once
+
+#include "DepthFilter.h"
+#include "PerformanceCounter.h"
+
+class TemporalDepthFilter : public DepthFilter
+{
+public:
+	typedef std::vector<UINT8> ConfidenceList;
+
+	TemporalDepthFilter(_In_ unsigned Width, _In_ unsigned Height);
+
+	virtual void Apply(_Inout_ DepthPixelList & DepthPixels);
+
+	void Reset();
+	const ConfidenceList & GetConfidence() const;
+
+	void KeyPressedCallback(_In_ const WPARAM & VirtualKey);
+
+private:
+	static constexpr unsigned RowsPerBand = 16;
+
+	const unsigned Width;
+	const unsigned Height;
+
+	// Per pixel state as structure of arrays, so the kernel streams through each array linearly
+	DepthPixelList FilteredDepth;
+	ConfidenceList Confidence;
+
+	bool Enabled;
+	PerformanceCounter FilterTime;
+
+	void ApplyRows(_Inout_ DepthPixelList & DepthPixels, _In_ unsigned FirstRow, _In_ unsigned LastRow);
+	void ApplyPixel(_Inout_ UINT16 & Depth, _In_ size_t Index);
+};
@@ -5,18 +5,41 @@
 #include "Transform.h"
 
 Transform::Transform(_In_ Vector3 Position, _In_ Quaternion Rotation, _In_ Vector3 Scale)
-	:Position(Position), Rotation(Rotation), Scale(Scale)
+	:Position(Position), Rotation(Rotation), Scale(Scale), IsDecomposed(true)
 {
 	UpdateMatrix();
 }
 
+Transform::Transform(_In_ const DirectX::XMFLOAT4X4 & Matrix)
+	:Matrix(Matrix), Position(Matrix.m[0][3], Matrix.m[1][3], Matrix.m[2][3]), IsDecomposed(false)
+{
+}
+
 const DirectX::XMFLOAT4X4 & Transform::GetMatrix() const
 {
 	return Matrix;
 }
 
+const Vector3 & Transform::GetPosition() const
+{
+	return Position;
+}
+
+const Quaternion & Transform::GetRotation() const
+{
+	Decompose();
+	return Rotation;
+}
+
+const Vector3 & Transform::GetScale() const
+{
+	Decompose();
+	return Scale;
+}
+
 void Transform::UpdatePosition(Vector3 NewPosition)
 {
+	Decompose();
 	Position = NewPosition;
 	UpdateMatrix();
 }
@@ -25,3 +48,25 @@ void Transform::UpdateMatrix()
 {
 	DirectX::XMStoreFloat4x4(&Matrix, DirectX::XMMatrixTranspose(DirectX::XMMatrixScalingFromVector(Scale) * DirectX::XMMatrixRotationQuaternion(Rotation) * DirectX::XMMatrixTranslationFromVector(Position)));
 }
+
+void Transform::Decompose() const
+{
+	if (IsDecomposed)
+	{
+		return;
+	}
+
+	DirectX::XMVECTOR DecomposedScale;
+	DirectX::XMVECTOR DecomposedRotation;
+	DirectX::XMVECTOR DecomposedPosition;
+
+	// A degenerate scale has no rotation
+	if (!DirectX::XMMatrixDecompose(&DecomposedScale, &DecomposedRotation, &DecomposedPosition, DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&Matrix))))
+	{
+		DecomposedRotation = DirectX::XMQuaternionIdentity();
+	}
+
+	Rotation.Value = DecomposedRotation;
+	Scale = DecomposedScale;
+	IsDecomposed = true;
+}
@@ -8,8 +8,15 @@ class Transform
 {
 public:
 	Transform(_In_ Vector3 Position = Vector3(), _In_ Quaternion Rotation = Quaternion(), _In_ Vector3 Scale = Vector3(1.f));
+
+	// Keeps a transposed matrix as it is, e.g. a world matrix composed down a hierarchy. The position is read from it,
+	// rotation and scale are only decomposed once they are asked for
+	explicit Transform(_In_ const DirectX::XMFLOAT4X4 & Matrix);
 	
 	const DirectX::XMFLOAT4X4 & GetMatrix() const;
+	const Vector3 & GetPosition() const;
+	const Quaternion & GetRotation() const;
+	const Vector3 & GetScale() const;
 
 	void UpdatePosition(_In_ Vector3 NewPosition);
 
@@ -17,10 +24,12 @@ private:
 	DirectX::XMFLOAT4X4 Matrix;
 
 	Vector3 Position;
-	Quaternion Rotation;
-	Vector3 Scale;
+	mutable Quaternion Rotation;
+	mutable Vector3 Scale;
+	mutable bool IsDecomposed;
 
 	void UpdateMatrix();
+	void Decompose() const;
 };
 
 
@@ -0,0 +1,224 @@
+// TransformArray.cpp : Positions, rotations and scales of many objects with batched matrix composition
+//
+
+#include "stdafx.h"
+#include "TransformArray.h"
+
+TransformArray::TransformArray(_In_ const TransformList & Transforms)
+{
+	Reserve(Transforms.size());
+
+	for (const Transform & Object : Transforms)
+	{
+		Add(Object.GetPosition(), Object.GetRotation(), Object.GetScale());
+	}
+}
+
+void TransformArray::Reserve(_In_ size_t Capacity)
+{
+	size_t PaddedCapacity = (Capacity + GroupSize - 1) & ~(GroupSize - 1);
+
+	for (std::vector<float> & Values : Components)
+	{
+		Values.reserve(PaddedCapacity);
+	}
+
+	Matrices.reserve(Capacity);
+	DirtyMasks.reserve((Capacity + BitsPerMask - 1) / BitsPerMask);
+}
+
+void TransformArray::Clear()
+{
+	for (std::vector<float> & Values : Components)
+	{
+		Values.clear();
+	}
+
+	Matrices.clear();
+	DirtyMasks.clear();
+	Count = 0;
+}
+
+size_t TransformArray::Add(_In_ const Vector3 & Position, _In_ const Quaternion & Rotation, _In_ const Vector3 & Scale)
+{
+	size_t Index = Count++;
+
+	// A new group is padded with identity transforms, which are composed but never stored
+	if ((Index % GroupSize) == 0)
+	{
+		static const std::array<float, Component_Count> Identity = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f };
+
+		for (unsigned Component = 0; Component < Component_Count; ++Component)
+		{
+			Components[Component].resize(Index + GroupSize, Identity[Component]);
+		}
+	}
+
+	if ((Index % BitsPerMask) == 0)
+	{
+		DirtyMasks.push_back(0);
+	}
+
+	Matrices.emplace_back();
+
+	SetPosition(Index, Position);
+	SetRotation(Index, Rotation);
+	SetScale(Index, Scale);
+
+	return Index;
+}
+
+void TransformArray::SetPosition(_In_ size_t Index, _In_ const Vector3 & Position)
+{
+	Components[Component_PositionX][Index] = Position.X;
+	Components[Component_PositionY][Index] = Position.Y;
+	Components[Component_PositionZ][Index] = Position.Z;
+	MarkDirty(Index);
+}
+
+void TransformArray::SetRotation(_In_ size_t Index, _In_ const Quaternion & Rotation)
+{
+	DirectX::XMFLOAT4 Value;
+	DirectX::XMStoreFloat4(&Value, Rotation);
+
+	Components[Component_RotationX][Index] = Value.x;
+	Components[Component_RotationY][Index] = Value.y;
+	Components[Component_RotationZ][Index] = Value.z;
+	Components[Component_RotationW][Index] = Value.w;
+	MarkDirty(Index);
+}
+
+void TransformArray::SetScale(_In_ size_t Index, _In_ const Vector3 & Scale)
+{
+	Components[Component_ScaleX][Index] = Scale.X;
+	Components[Component_ScaleY][Index] = Scale.Y;
+	Components[Component_ScaleZ][Index] = Scale.Z;
+	MarkDirty(Index);
+}
+
+Vector3 TransformArray::GetPosition(_In_ size_t Index) const
+{
+	return Vector3(Components[Component_PositionX][Index], Components[Component_PositionY][Index], Components[Component_PositionZ][Index]);
+}
+
+Quaternion TransformArray::GetRotation(_In_ size_t Index) const
+{
+	Quaternion Rotation;
+	Rotation.Value = DirectX::XMVectorSet(Components[Component_RotationX][Index], Components[Component_RotationY][Index], Components[Component_RotationZ][Index], Components[Component_RotationW][Index]);
+
+	return Rotation;
+}
+
+Vector3 TransformArray::GetScale(_In_ size_t Index) const
+{
+	return Vector3(Components[Component_ScaleX][Index], Components[Component_ScaleY][Index], Components[Component_ScaleZ][Index]);
+}
+
+size_t TransformArray::GetCount() const
+{
+	return Count;
+}
+
+size_t TransformArray::Update()
+{
+	size_t ChangedCount = 0;
+
+	for (size_t Mask = 0; Mask < DirtyMasks.size(); ++Mask)
+	{
+		UINT32 Dirty = DirtyMasks[Mask];
+
+		// Unchanged runs of 32 objects are skipped as a whole
+		if (Dirty == 0)
+		{
+			continue;
+		}
+
+		for (size_t Group = 0; Group < BitsPerMask; Group += GroupSize)
+		{
+			UINT32 DirtyLanes = (Dirty >> Group) & ((1u << GroupSize) - 1);
+
+			if (DirtyLanes != 0)
+			{
+				ComposeGroup(Mask * BitsPerMask + Group, DirtyLanes);
+				ChangedCount += std::bitset<GroupSize>(DirtyLanes).count();
+			}
+		}
+
+		DirtyMasks[Mask] = 0;
+	}
+
+	return ChangedCount;
+}
+
+const DirectX::XMFLOAT4X4 * TransformArray::GetMatrices() const
+{
+	return Matrices.data();
+}
+
+const DirectX::XMFLOAT4X4 & TransformArray::GetMatrix(_In_ size_t Index) const
+{
+	return Matrices[Index];
+}
+
+void TransformArray::MarkDirty(_In_ size_t Index)
+{
+	DirtyMasks[Index / BitsPerMask] |= 1u << (Index % BitsPerMask);
+}
+
+void TransformArray::ComposeGroup(_In_ size_t First, _In_ UINT32 DirtyLanes)
+{
+	auto Load = [&](Component Component) { return _mm_loadu_ps(&Components[Component][First]); };
+
+	__m128 X = Load(Component_RotationX);
+	__m128 Y = Load(Component_RotationY);
+	__m128 Z = Load(Component_RotationZ);
+	__m128 W = Load(Component_RotationW);
+
+	const __m128 One = _mm_set1_ps(1.f);
+	__m128 X2 = _mm_add_ps(X, X);
+	__m128 Y2 = _mm_add_ps(Y, Y);
+	__m128 Z2 = _mm_add_ps(Z, Z);
+
+	__m128 XX = _mm_mul_ps(X, X2);
+	__m128 YY = _mm_mul_ps(Y, Y2);
+	__m128 ZZ = _mm_mul_ps(Z, Z2);
+	__m128 XY = _mm_mul_ps(X, Y2);
+	__m128 XZ = _mm_mul_ps(X, Z2);
+	__m128 YZ = _mm_mul_ps(Y, Z2);
+	__m128 WX = _mm_mul_ps(W, X2);
+	__m128 WY = _mm_mul_ps(W, Y2);
+	__m128 WZ = _mm_mul_ps(W, Z2);
+
+	__m128 ScaleX = Load(Component_ScaleX);
+	__m128 ScaleY = Load(Component_ScaleY);
+	__m128 ScaleZ = Load(Component_ScaleZ);
+
+	// Rows of scale * rotation * translation, like XMMatrixRotationQuaternion, stored transposed: each row of the
+	// stored matrix takes one component of the scaled rotation rows and of the translation
+	std::array<__m128, 16> Elements = {
+		_mm_mul_ps(ScaleX, _mm_sub_ps(One, _mm_add_ps(YY, ZZ))), _mm_mul_ps(ScaleY, _mm_sub_ps(XY, WZ)), _mm_mul_ps(ScaleZ, _mm_add_ps(XZ, WY)), Load(Component_PositionX),
+		_mm_mul_ps(ScaleX, _mm_add_ps(XY, WZ)), _mm_mul_ps(ScaleY, _mm_sub_ps(One, _mm_add_ps(XX, ZZ))), _mm_mul_ps(ScaleZ, _mm_sub_ps(YZ, WX)), Load(Component_PositionY),
+		_mm_mul_ps(ScaleX, _mm_sub_ps(XZ, WY)), _mm_mul_ps(ScaleY, _mm_add_ps(YZ, WX)), _mm_mul_ps(ScaleZ, _mm_sub_ps(One, _mm_add_ps(XX, YY))), Load(Component_PositionZ),
+		_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), One
+	};
+
+	// Each row holds one element of the four objects, transposing a row gives that row for each object
+	for (unsigned Row = 0; Row < 4; ++Row)
+	{
+		__m128 Lane0 = Elements[Row * 4];
+		__m128 Lane1 = Elements[Row * 4 + 1];
+		__m128 Lane2 = Elements[Row * 4 + 2];
+		__m128 Lane3 = Elements[Row * 4 + 3];
+		_MM_TRANSPOSE4_PS(Lane0, Lane1, Lane2, Lane3);
+
+		const std::array<__m128, GroupSize> Lanes = { Lane0, Lane1, Lane2, Lane3 };
+
+		for (size_t Lane = 0; Lane < GroupSize; ++Lane)
+		{
+			if (DirtyLanes & (1u << Lane))
+			{
+				_mm_storeu_ps(Matrices[First + Lane].m[Row], Lanes[Lane]);
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Transform.h"
+
+// Position, rotation and scale of many objects stored component by component, i.e. as structure of arrays, so the
+// object matrices are composed four at a time with SSE. Changed objects are flagged and only groups of four holding
+// a changed object are composed on Update. The matrices are kept transposed for the shaders in one contiguous array,
+// ready to be copied into a constant or instance buffer as a whole.
+class TransformArray
+{
+public:
+	TransformArray() = default;
+	TransformArray(_In_ const TransformList & Transforms);
+
+	void Reserve(_In_ size_t Count);
+	void Clear();
+
+	// Returns the index of the new object, its matrix is composed on the next Update
+	size_t Add(_In_ const Vector3 & Position = Vector3(), _In_ const Quaternion & Rotation = Quaternion(), _In_ const Vector3 & Scale = Vector3(1.f));
+
+	void SetPosition(_In_ size_t Index, _In_ const Vector3 & Position);
+	void SetRotation(_In_ size_t Index, _In_ const Quaternion & Rotation);
+	void SetScale(_In_ size_t Index, _In_ const Vector3 & Scale);
+
+	Vector3 GetPosition(_In_ size_t Index) const;
+	Quaternion GetRotation(_In_ size_t Index) const;
+	Vector3 GetScale(_In_ size_t Index) const;
+	size_t GetCount() const;
+
+	// Composes scale, rotation and translation of the changed objects; returns the number of changed objects
+	size_t Update();
+
+	// GetCount matrices, current as of the last Update
+	const DirectX::XMFLOAT4X4 * GetMatrices() const;
+	const DirectX::XMFLOAT4X4 & GetMatrix(_In_ size_t Index) const;
+
+private:
+	enum Component
+	{
+		Component_PositionX,
+		Component_PositionY,
+		Component_PositionZ,
+		Component_RotationX,
+		Component_RotationY,
+		Component_RotationZ,
+		Component_RotationW,
+		Component_ScaleX,
+		Component_ScaleY,
+		Component_ScaleZ,
+		Component_Count
+	};
+
+	static constexpr size_t GroupSize = 4;
+	static constexpr size_t BitsPerMask = 32;
+
+	// Each component array is padded to whole groups of four
+	std::array<std::vector<float>, Component_Count> Components;
+	std::vector<DirectX::XMFLOAT4X4> Matrices;
+	std::vector<UINT32> DirtyMasks;
+	size_t Count = 0;
+
+	void MarkDirty(_In_ size_t Index);
+	void ComposeGroup(_In_ size_t First, _In_ UINT32 DirtyLanes);
+};
@@ -0,0 +1,204 @@
+// UserArbitration.cpp : Chooses the user the face tracking follows when several people are in front of the mirror
+//
+
+#include "stdafx.h"
+#include "UserArbitration.h"
+
+#include "SimdMath.h"
+
+namespace
+{
+	// The high definition face tracking works from half a meter to about two and a half meters
+	constexpr float NearestDistance = 0.5f;
+	constexpr float FarthestDistance = 2.5f;
+	constexpr float MaxLateralOffset = 1.f;
+	constexpr float DistanceWeight = 0.6f;
+
+	// A lost user reappearing within this distance of where it was lost is the same person
+	constexpr float ReacquireDistance = 0.25f;
+
+	// Smoothing of the head joints per body frame and of the learned pivot offset per face frame
+	constexpr float HeadSmoothing = 0.5f;
+	constexpr float PivotOffsetSmoothing = 0.05f;
+}
+
+UserArbitration::UserArbitration(_In_ float SwitchMargin, _In_ double SwitchDelay, _In_ double MinimumDwell, _In_ double LostGrace)
+	:SwitchMargin(SwitchMargin), SwitchDelay(SwitchDelay), MinimumDwell(MinimumDwell), LostGrace(LostGrace), HandoffCount(0)
+{
+	Reset();
+}
+
+void UserArbitration::Reset()
+{
+	Candidates.clear();
+	PivotOffset = Vector3();
+	User = 0;
+	UserSince = 0.0;
+	UserSeen = 0.0;
+	UserHead = Vector3();
+	Challenger = 0;
+	ChallengerSince = 0.0;
+}
+
+UINT64 UserArbitration::Update(_In_ const CandidateList & NewCandidates, _In_ double Time)
+{
+	std::vector<TrackedCandidate> Updated;
+	Updated.reserve(NewCandidates.size());
+
+	for (const Candidate & New : NewCandidates)
+	{
+		Vector3 Head(New.Head.X, New.Head.Y, New.Head.Z);
+
+		if (const TrackedCandidate * Known = FindCandidate(New.TrackingId))
+		{
+			SimdMath::StoreFloat3(&Head.X, SimdMath::Lerp(SimdMath::LoadFloat3(&Known->Head.X), SimdMath::LoadFloat3(&Head.X), HeadSmoothing));
+		}
+
+		Updated.push_back({ New.TrackingId, Head, GetScore({ Head.X, Head.Y, Head.Z }) });
+	}
+
+	Candidates.swap(Updated);
+
+	const TrackedCandidate * Current = FindCandidate(User);
+
+	if (Current != nullptr)
+	{
+		UserSeen = Time;
+		UserHead = Current->Head;
+	}
+	else if ((User != 0) && (Time - UserSeen < LostGrace))
+	{
+		const TrackedCandidate * Nearest = FindNearestCandidate(UserHead);
+
+		if (Nearest != nullptr)
+		{
+			User = Nearest->TrackingId;
+			UserSeen = Time;
+			UserHead = Nearest->Head;
+			Challenger = 0;
+		}
+
+		return User;
+	}
+
+	if (Candidates.empty())
+	{
+		User = 0;
+		Challenger = 0;
+		return User;
+	}
+
+	auto HasLowerScore = [](const TrackedCandidate & Left, const TrackedCandidate & Right) { return Left.Score < Right.Score; };
+	const TrackedCandidate & Best = *std::max_element(Candidates.begin(), Candidates.end(), HasLowerScore);
+
+	if (Current == nullptr)
+	{
+		Select(Best, Time);
+		return User;
+	}
+
+	// Hysteresis, the challenger has to stay clearly ahead for a while
+	if ((Best.TrackingId == User) || (Best.Score < Current->Score + SwitchMargin))
+	{
+		Challenger = 0;
+		return User;
+	}
+
+	if (Best.TrackingId != Challenger)
+	{
+		Challenger = Best.TrackingId;
+		ChallengerSince = Time;
+	}
+
+	if ((Time - ChallengerSince >= SwitchDelay) && (Time - UserSince >= MinimumDwell))
+	{
+		Select(Best, Time);
+	}
+
+	return User;
+}
+
+UINT64 UserArbitration::GetUser() const
+{
+	return User;
+}
+
+unsigned UserArbitration::GetHandoffCount() const
+{
+	return HandoffCount;
+}
+
+float UserArbitration::GetScore(_In_ const CameraSpacePoint & Head)
+{
+	float Distance = 1.f - (std::min)((std::max)((Head.Z - NearestDistance) / (FarthestDistance - NearestDistance), 0.f), 1.f);
+	float Centrality = 1.f - (std::min)(std::abs(Head.X) / MaxLateralOffset, 1.f);
+
+	return DistanceWeight * Distance + (1.f - DistanceWeight) * Centrality;
+}
+
+void UserArbitration::AddHeadPivot(_In_ const CameraSpacePoint & HeadPivot)
+{
+	const TrackedCandidate * Current = FindCandidate(User);
+
+	if (Current == nullptr)
+	{
+		return;
+	}
+
+	SimdMath::Vector Offset = SimdMath::Subtract(SimdMath::Set(HeadPivot.X, HeadPivot.Y, HeadPivot.Z, 0.f), SimdMath::LoadFloat3(&Current->Head.X));
+	SimdMath::StoreFloat3(&PivotOffset.X, SimdMath::Lerp(SimdMath::LoadFloat3(&PivotOffset.X), Offset, PivotOffsetSmoothing));
+}
+
+bool UserArbitration::GetHeadEstimate(_In_ UINT64 TrackingId, _Out_ CameraSpacePoint & HeadPivot) const
+{
+	const TrackedCandidate * Known = FindCandidate(TrackingId);
+
+	if (Known == nullptr)
+	{
+		return false;
+	}
+
+	// The offset is learned from earlier users for a new one, heads differ little
+	SimdMath::Vector Estimate = SimdMath::Add(SimdMath::LoadFloat3(&Known->Head.X), SimdMath::LoadFloat3(&PivotOffset.X));
+	HeadPivot = { SimdMath::GetX(Estimate), SimdMath::GetY(Estimate), SimdMath::GetZ(Estimate) };
+
+	return true;
+}
+
+const UserArbitration::TrackedCandidate * UserArbitration::FindCandidate(_In_ UINT64 TrackingId) const
+{
+	auto IsCandidate = [=](const TrackedCandidate & Known) { return Known.TrackingId == TrackingId; };
+	auto Result = std::find_if(Candidates.begin(), Candidates.end(), IsCandidate);
+
+	return ((TrackingId != 0) && (Result != Candidates.end())) ? &(*Result) : nullptr;
+}
+
+const UserArbitration::TrackedCandidate * UserArbitration::FindNearestCandidate(_In_ const Vector3 & Head) const
+{
+	const TrackedCandidate * Nearest = nullptr;
+	float NearestDistance = ReacquireDistance;
+
+	for (const TrackedCandidate & Known : Candidates)
+	{
+		float Distance = SimdMath::GetX(SimdMath::Length3(SimdMath::Subtract(SimdMath::LoadFloat3(&Known.Head.X), SimdMath::LoadFloat3(&Head.X))));
+
+		if (Distance < NearestDistance)
+		{
+			Nearest = &Known;
+			NearestDistance = Distance;
+		}
+	}
+
+	return Nearest;
+}
+
+void UserArbitration::Select(_In_ const TrackedCandidate & Candidate, _In_ double Time)
+{
+	HandoffCount += (User != 0) ? 1 : 0;
+
+	User = Candidate.TrackingId;
+	UserSince = Time;
+	UserSeen = Time;
+	UserHead = Candidate.Head;
+	Challenger = 0;
+}
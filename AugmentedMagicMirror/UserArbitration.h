@@ -0,0 +1,65 @@
+#pragma once
+
+// Chooses which of the bodies in front of the mirror the face tracking follows. Candidates are scored by their distance
+// to the sensor and their lateral offset from it; a better scored candidate only takes over when it stays ahead of the
+// current user by SwitchMargin for SwitchDelay seconds, and the current user has been tracked for at least MinimumDwell
+// seconds. A lost user that reappears close to where it was lost, usually with a new tracking id, is taken over without
+// a handoff; otherwise it is replaced after LostGrace seconds. The smoothed head joint of every candidate is kept as a head estimate,
+// so the cameras can follow the next user while the face alignment for it starts over.
+class UserArbitration
+{
+public:
+	struct Candidate
+	{
+		UINT64 TrackingId;
+		CameraSpacePoint Head;
+	};
+
+	typedef std::vector<Candidate> CandidateList;
+
+	UserArbitration(_In_ float SwitchMargin = 0.15f, _In_ double SwitchDelay = 0.5, _In_ double MinimumDwell = 2.0, _In_ double LostGrace = 0.5);
+
+	void Reset();
+
+	// Returns the tracking id of the user to follow, 0 without candidates
+	UINT64 Update(_In_ const CandidateList & Candidates, _In_ double Time);
+	UINT64 GetUser() const;
+	unsigned GetHandoffCount() const;
+
+	// Between 0 and 1, candidates close to the sensor and in front of it score highest
+	static float GetScore(_In_ const CameraSpacePoint & Head);
+
+	// Learns the offset from the head joint of the user to the head pivot of its aligned face
+	void AddHeadPivot(_In_ const CameraSpacePoint & HeadPivot);
+
+	// The smoothed head joint of a candidate moved by the learned offset; false for unknown candidates
+	bool GetHeadEstimate(_In_ UINT64 TrackingId, _Out_ CameraSpacePoint & HeadPivot) const;
+
+private:
+	struct TrackedCandidate
+	{
+		UINT64 TrackingId;
+		Vector3 Head;
+		float Score;
+	};
+
+	const float SwitchMargin;
+	const double SwitchDelay;
+	const double MinimumDwell;
+	const double LostGrace;
+
+	std::vector<TrackedCandidate> Candidates;
+	Vector3 PivotOffset;
+
+	UINT64 User;
+	double UserSince;
+	double UserSeen;
+	Vector3 UserHead;
+	UINT64 Challenger;
+	double ChallengerSince;
+	unsigned HandoffCount;
+
+	const TrackedCandidate * FindCandidate(_In_ UINT64 TrackingId) const;
+	const TrackedCandidate * FindNearestCandidate(_In_ const Vector3 & Head) const;
+	void Select(_In_ const TrackedCandidate & Candidate, _In_ double Time);
+};
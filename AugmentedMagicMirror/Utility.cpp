@@ -46,4 +46,22 @@ namespace Utility
 			Throw(Message.c_str());
 		}
 	}
+
+	std::wstring GetApplicationFilePath(_In_ const std::wstring & Filename)
+	{
+		std::array<wchar_t, 1024> Buffer;
+		DWORD CharactersCopied = GetModuleFileName(nullptr, Buffer.data(), static_cast<DWORD>(Buffer.size()));
+
+		if (CharactersCopied == 0)
+		{
+			return std::wstring();
+		}
+
+		std::wstring Path(Buffer.data(), CharactersCopied);
+
+		size_t LastSlashPosition = Path.rfind(L'\\');
+		Path.replace(LastSlashPosition + 1, std::wstring::npos, Filename);
+
+		return Path;
+	}
 }
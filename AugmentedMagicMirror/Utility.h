@@ -6,6 +6,8 @@ namespace Utility
 	void Throw(_In_opt_ LPCWSTR Message = nullptr);
 	void ThrowOnFail(_In_ HRESULT hr, _In_opt_ LPCWSTR Message = nullptr);
 	void ThrowOnFail(_In_ HRESULT hr, _In_ Microsoft::WRL::ComPtr<ID3DBlob> & Error);
+
+	std::wstring GetApplicationFilePath(_In_ const std::wstring & Filename);
 }
 
 struct Vector3 {
@@ -0,0 +1,224 @@
+// ViewFrustum.cpp : Culling of objects outside of what a camera sees
+//
+
+#include "stdafx.h"
+#include "ViewFrustum.h"
+
+#include "Camera.h"
+#include "SimdMath.h"
+
+ViewFrustum::ViewFrustum()
+	:Planes(), ContainsEverything(true)
+{
+}
+
+ViewFrustum::ViewFrustum(_In_ const Camera & View)
+	:ContainsEverything(false)
+{
+	// The camera matrices are stored transposed, so the rows of the stored projection times view are the columns of
+	// the view projection, from which the clip planes are combined
+	SimdMath::Matrix Columns = SimdMath::MatrixMultiply(SimdMath::LoadFloat4x4(&View.GetProjectionMatrix().m[0][0]), SimdMath::LoadFloat4x4(&View.GetViewMatrix().m[0][0]));
+
+	const std::array<SimdMath::Vector, Plane_Count> Combined = {
+		SimdMath::Add(Columns.Rows[3], Columns.Rows[0]),
+		SimdMath::Subtract(Columns.Rows[3], Columns.Rows[0]),
+		SimdMath::Add(Columns.Rows[3], Columns.Rows[1]),
+		SimdMath::Subtract(Columns.Rows[3], Columns.Rows[1]),
+		Columns.Rows[2],
+		SimdMath::Subtract(Columns.Rows[3], Columns.Rows[2])
+	};
+
+	for (unsigned Plane = 0; Plane < Plane_Count; ++Plane)
+	{
+		SimdMath::Vector Length = SimdMath::Sqrt(SimdMath::Dot3(Combined[Plane], Combined[Plane]));
+		SimdMath::StoreFloat4(&Planes[Plane].x, SimdMath::Divide(Combined[Plane], Length));
+	}
+}
+
+ViewFrustum ViewFrustum::Union(_In_ const ViewFrustum & First, _In_ const ViewFrustum & Second)
+{
+	if (First.ContainsEverything || Second.ContainsEverything)
+	{
+		return ViewFrustum();
+	}
+
+	const std::array<DirectX::XMFLOAT3, CornerCount> FirstCorners = First.GetCorners();
+	const std::array<DirectX::XMFLOAT3, CornerCount> SecondCorners = Second.GetCorners();
+
+	// How far a plane has to be pushed out to contain the corners of the other frustum
+	auto GetShortfall = [](const ViewFrustum & Frustum, PlaneIndex Plane, const std::array<DirectX::XMFLOAT3, CornerCount> & Corners)
+	{
+		float Shortfall = 0.f;
+
+		for (const DirectX::XMFLOAT3 & Corner : Corners)
+		{
+			Shortfall = (std::max)(Shortfall, -Frustum.GetDistance(Plane, Corner));
+		}
+
+		return Shortfall;
+	};
+
+	ViewFrustum Result = First;
+
+	for (unsigned Index = 0; Index < Plane_Count; ++Index)
+	{
+		PlaneIndex Plane = static_cast<PlaneIndex>(Index);
+		float FirstShortfall = GetShortfall(First, Plane, SecondCorners);
+		float SecondShortfall = GetShortfall(Second, Plane, FirstCorners);
+
+		Result.Planes[Plane] = (FirstShortfall <= SecondShortfall) ? First.Planes[Plane] : Second.Planes[Plane];
+		Result.Planes[Plane].w += (std::min)(FirstShortfall, SecondShortfall);
+	}
+
+	return Result;
+}
+
+size_t ViewFrustum::Cull(_In_ const Mesh::Bounds & LocalBounds, _In_ const TransformList & Objects, _Out_ TransformList & VisibleObjects) const
+{
+	VisibleObjects.clear();
+
+	if (ContainsEverything)
+	{
+		VisibleObjects = Objects;
+		return 0;
+	}
+
+	const DirectX::XMFLOAT3 & Minimum = LocalBounds.Minimum;
+	const DirectX::XMFLOAT3 & Maximum = LocalBounds.Maximum;
+	const std::array<float, 3> LocalCenter = { 0.5f * (Minimum.x + Maximum.x), 0.5f * (Minimum.y + Maximum.y), 0.5f * (Minimum.z + Maximum.z) };
+	const std::array<float, 3> LocalExtent = { 0.5f * (Maximum.x - Minimum.x), 0.5f * (Maximum.y - Minimum.y), 0.5f * (Maximum.z - Minimum.z) };
+
+	std::array<__m128, Plane_Count * 4> PlaneElements;
+	for (unsigned Plane = 0; Plane < Plane_Count; ++Plane)
+	{
+		PlaneElements[Plane * 4] = _mm_set1_ps(Planes[Plane].x);
+		PlaneElements[Plane * 4 + 1] = _mm_set1_ps(Planes[Plane].y);
+		PlaneElements[Plane * 4 + 2] = _mm_set1_ps(Planes[Plane].z);
+		PlaneElements[Plane * 4 + 3] = _mm_set1_ps(Planes[Plane].w);
+	}
+
+	const __m128 SignMask = _mm_set1_ps(-0.f);
+	size_t CulledCount = 0;
+
+	// Four objects at a time, each lane tests the world space box of one object against all planes
+	for (size_t First = 0; First < Objects.size(); First += 4)
+	{
+		size_t Count = (std::min)(Objects.size() - First, size_t(4));
+
+		// Affine object matrices, element by element across the lanes; missing lanes repeat the last object
+		std::array<__m128, 12> World;
+		for (unsigned Row = 0; Row < 4; ++Row)
+			for (unsigned Column = 0; Column < 3; ++Column)
+			{
+				auto Element = [&](size_t Lane) { return Objects[First + (std::min)(Lane, Count - 1)].GetMatrix().m[Column][Row]; };
+				World[Row * 3 + Column] = _mm_set_ps(Element(3), Element(2), Element(1), Element(0));
+			}
+
+		// The center is transformed, the extent grows by the absolute rotation and scale
+		std::array<__m128, 3> Center;
+		std::array<__m128, 3> Extent;
+		for (unsigned Column = 0; Column < 3; ++Column)
+		{
+			__m128 Value = World[9 + Column];
+			__m128 Size = _mm_setzero_ps();
+
+			for (unsigned Row = 0; Row < 3; ++Row)
+			{
+				Value = _mm_add_ps(Value, _mm_mul_ps(_mm_set1_ps(LocalCenter[Row]), World[Row * 3 + Column]));
+				Size = _mm_add_ps(Size, _mm_mul_ps(_mm_set1_ps(LocalExtent[Row]), _mm_andnot_ps(SignMask, World[Row * 3 + Column])));
+			}
+
+			Center[Column] = Value;
+			Extent[Column] = Size;
+		}
+
+		// A box is outside when its center lies further behind a plane than the box reaches towards it
+		__m128 Outside = _mm_setzero_ps();
+		for (unsigned Plane = 0; Plane < Plane_Count; ++Plane)
+		{
+			const __m128 * Normal = &PlaneElements[Plane * 4];
+
+			__m128 Distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Center[0], Normal[0]), _mm_mul_ps(Center[1], Normal[1])), _mm_add_ps(_mm_mul_ps(Center[2], Normal[2]), Normal[3]));
+			__m128 Reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Extent[0], _mm_andnot_ps(SignMask, Normal[0])), _mm_mul_ps(Extent[1], _mm_andnot_ps(SignMask, Normal[1]))), _mm_mul_ps(Extent[2], _mm_andnot_ps(SignMask, Normal[2])));
+
+			Outside = _mm_or_ps(Outside, _mm_cmplt_ps(_mm_add_ps(Distance, Reach), _mm_setzero_ps()));
+		}
+
+		int OutsideLanes = _mm_movemask_ps(Outside);
+
+		for (size_t Lane = 0; Lane < Count; ++Lane)
+		{
+			if (OutsideLanes & (1 << Lane))
+			{
+				++CulledCount;
+				continue;
+			}
+
+			VisibleObjects.push_back(Objects[First + Lane]);
+		}
+	}
+
+	return CulledCount;
+}
+
+ViewFrustum::Containment ViewFrustum::Classify(_In_ const Mesh::Bounds & WorldBounds) const
+{
+	if (ContainsEverything)
+	{
+		return Containment_Inside;
+	}
+
+	const DirectX::XMFLOAT3 Center = { 0.5f * (WorldBounds.Minimum.x + WorldBounds.Maximum.x), 0.5f * (WorldBounds.Minimum.y + WorldBounds.Maximum.y), 0.5f * (WorldBounds.Minimum.z + WorldBounds.Maximum.z) };
+	const DirectX::XMFLOAT3 Extent = { 0.5f * (WorldBounds.Maximum.x - WorldBounds.Minimum.x), 0.5f * (WorldBounds.Maximum.y - WorldBounds.Minimum.y), 0.5f * (WorldBounds.Maximum.z - WorldBounds.Minimum.z) };
+	Containment Result = Containment_Inside;
+
+	for (unsigned Index = 0; Index < Plane_Count; ++Index)
+	{
+		const DirectX::XMFLOAT4 & Plane = Planes[Index];
+		float Distance = GetDistance(static_cast<PlaneIndex>(Index), Center);
+		float Reach = Extent.x * std::abs(Plane.x) + Extent.y * std::abs(Plane.y) + Extent.z * std::abs(Plane.z);
+
+		if (Distance + Reach < 0.f)
+		{
+			return Containment_Outside;
+		}
+
+		Result = (Distance - Reach < 0.f) ? Containment_Intersecting : Result;
+	}
+
+	return Result;
+}
+
+std::array<DirectX::XMFLOAT3, ViewFrustum::CornerCount> ViewFrustum::GetCorners() const
+{
+	auto Load = [this](PlaneIndex Plane) { return SimdMath::LoadFloat4(&Planes[Plane].x); };
+
+	// Each corner is where a side, a bottom or top and the near or far plane meet
+	auto Intersect = [](SimdMath::Vector A, SimdMath::Vector B, SimdMath::Vector C)
+	{
+		SimdMath::Vector BC = SimdMath::Cross3(B, C);
+		SimdMath::Vector CA = SimdMath::Cross3(C, A);
+		SimdMath::Vector AB = SimdMath::Cross3(A, B);
+
+		auto Scale = [](SimdMath::Vector Direction, SimdMath::Vector Plane) { return SimdMath::Multiply(Direction, SimdMath::Swizzle<3, 3, 3, 3>(Plane)); };
+		SimdMath::Vector Sum = SimdMath::Add(SimdMath::Add(Scale(BC, A), Scale(CA, B)), Scale(AB, C));
+
+		DirectX::XMFLOAT3 Corner;
+		SimdMath::StoreFloat3(&Corner.x, SimdMath::Divide(SimdMath::Negate(Sum), SimdMath::Dot3(A, BC)));
+		return Corner;
+	};
+
+	std::array<DirectX::XMFLOAT3, CornerCount> Corners;
+	for (unsigned Corner = 0; Corner < CornerCount; ++Corner)
+	{
+		Corners[Corner] = Intersect(Load((Corner & 1) ? Plane_Right : Plane_Left), Load((Corner & 2) ? Plane_Top : Plane_Bottom), Load((Corner & 4) ? Plane_Far : Plane_Near));
+	}
+
+	return Corners;
+}
+
+float ViewFrustum::GetDistance(_In_ PlaneIndex Plane, _In_ const DirectX::XMFLOAT3 & Point) const
+{
+	const DirectX::XMFLOAT4 & Value = Planes[Plane];
+	return Value.x * Point.x + Value.y * Point.y + Value.z * Point.z + Value.w;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Mesh.h"
+#include "Transform.h"
+
+class Camera;
+
+// The six planes bounding what a camera sees, for culling objects before they are drawn. The planes are taken from
+// the camera's view projection, so they follow the skewed off-axis frustum of a frame camera. Objects are tested
+// with the world space box around their transformed local bounds, four objects at a time.
+class ViewFrustum
+{
+public:
+	enum Containment
+	{
+		Containment_Outside,
+		Containment_Intersecting,
+		Containment_Inside
+	};
+
+	// Contains everything until it is set to a camera
+	ViewFrustum();
+	ViewFrustum(_In_ const Camera & View);
+
+	// A frustum containing both frusta, built from their planes. Planes that do not contain the other frustum are
+	// pushed out until they do, which only happens when neither of the two planes contains the other frustum. The
+	// eyes looking through the same frame share the frame as near plane and the lines through its edges, so their
+	// union is exact.
+	static ViewFrustum Union(_In_ const ViewFrustum & First, _In_ const ViewFrustum & Second);
+
+	// Replaces VisibleObjects with the objects whose bounds are not completely outside and returns the number of culled objects
+	size_t Cull(_In_ const Mesh::Bounds & LocalBounds, _In_ const TransformList & Objects, _Out_ TransformList & VisibleObjects) const;
+
+	// Whether a world space box is completely outside, partly inside or completely inside, e.g. for whole subtrees of a
+	// bounding volume hierarchy; Intersecting is conservative for boxes near the edges
+	Containment Classify(_In_ const Mesh::Bounds & WorldBounds) const;
+
+private:
+	enum PlaneIndex
+	{
+		Plane_Left,
+		Plane_Right,
+		Plane_Bottom,
+		Plane_Top,
+		Plane_Near,
+		Plane_Far,
+		Plane_Count
+	};
+
+	static constexpr unsigned CornerCount = 8;
+
+	// Normalized, the normals point inside
+	std::array<DirectX::XMFLOAT4, Plane_Count> Planes;
+	bool ContainsEverything;
+
+	std::array<DirectX::XMFLOAT3, CornerCount> GetCorners() const;
+	float GetDistance(_In_ PlaneIndex Plane, _In_ const DirectX::XMFLOAT3 & Point) const;
+};
@@ -5,6 +5,11 @@
 
 #pragma once
 
+// The platform independent sources are also built with CMake, without the Windows, Direct3D and Kinect SDKs
+#ifdef USE_PORTABLE
+#include "stdafxPortable.h"
+#else
+
 #define USE_D3DX11
 
 #ifndef USE_D3DX11
@@ -20,6 +25,7 @@
 
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
+#include <emmintrin.h>
 #ifdef USE_D3DX11
 #include "stdafx11.h"
 #endif // USE_D3DX11
@@ -32,12 +38,22 @@
 #include <Kinect.h>
 #include <Kinect.Face.h>
 
+#include <ppl.h>
+
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <fstream>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <sstream>
 #include <vector>
 
 #include "Utility.h"
+
+#endif // USE_PORTABLE
@@ -4,6 +4,7 @@
 
 #include <dxgi1_2.h>
 #include <d3d11.h> 
+#include <d3d11_3.h>
 
 #pragma comment (lib, "DXGI.lib")
 #pragma comment (lib, "D3d11.lib")
@@ -0,0 +1,108 @@
+#pragma once
+
+// The prerequisites of the platform independent sources, i.e. the pose filters, the head pivot model, the head pose
+// slot, the user arbitration, the depth recording and the temporal depth filter, when they are built without the
+// Windows, Direct3D and Kinect SDKs. Stands in for the SAL annotations, the Windows types and performance counter,
+// the parallel loop of the Parallel Patterns Library, the Kinect point types and the Vector3 and log of Utility.h.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+#include <emmintrin.h>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Inout_
+#define _In_reads_(Count)
+#define _Out_writes_(Count)
+
+typedef std::uint8_t UINT8;
+typedef std::uint16_t UINT16;
+typedef std::uint32_t UINT32;
+typedef std::uint64_t UINT64;
+typedef unsigned int UINT;
+typedef std::uintptr_t WPARAM;
+typedef const wchar_t * LPCWSTR;
+
+union LARGE_INTEGER
+{
+	long long QuadPart;
+};
+
+inline int QueryPerformanceFrequency(_Out_ LARGE_INTEGER * Frequency)
+{
+	Frequency->QuadPart = std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num;
+	return 1;
+}
+
+inline int QueryPerformanceCounter(_Out_ LARGE_INTEGER * Counter)
+{
+	Counter->QuadPart = std::chrono::steady_clock::now().time_since_epoch().count();
+	return 1;
+}
+
+namespace concurrency
+{
+	// Runs the iterations one after another; the callers do not depend on their order
+	template <typename IndexType, typename FunctionType>
+	void parallel_for(_In_ IndexType First, _In_ IndexType Last, _In_ const FunctionType & Function)
+	{
+		for (IndexType Index = First; Index < Last; ++Index)
+		{
+			Function(Index);
+		}
+	}
+}
+
+struct CameraSpacePoint
+{
+	float X;
+	float Y;
+	float Z;
+};
+
+struct Vector4
+{
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+struct Vector3 {
+	float X;
+	float Y;
+	float Z;
+
+	Vector3()
+		:Vector3(0.0f) {}
+
+	Vector3(_In_ float Value)
+		:Vector3(Value, Value, Value) {}
+
+	Vector3(_In_ float X, _In_ float Y, _In_ float Z)
+		:X(X), Y(Y), Z(Z) {}
+};
+
+typedef std::vector<Vector3> Vector3List;
+
+namespace Utility
+{
+	inline void Log(_In_ LPCWSTR Message)
+	{
+		std::fwprintf(stderr, L"%ls\n", Message);
+	}
+}
@@ -0,0 +1,280 @@
+// HeadTrackingTests.cpp : Behaviour checks of the platform independent head tracking sources
+//
+
+#include "stdafx.h"
+
+#include "HeadPivotModel.h"
+#include "HeadPoseSlot.h"
+#include "KalmanPoseFilter.h"
+#include "OneEuroPoseFilter.h"
+#include "SimdMath.h"
+#include "UserArbitration.h"
+
+#include <cstdio>
+#include <functional>
+
+namespace
+{
+	unsigned FailureCount = 0;
+
+	void Check(_In_ bool Condition, _In_ const char * Description, _In_ const char * File, _In_ int Line)
+	{
+		if (!Condition)
+		{
+			std::printf("%s(%d): check failed: %s\n", File, Line, Description);
+			++FailureCount;
+		}
+	}
+
+#define CHECK(Condition) Check((Condition), #Condition, __FILE__, __LINE__)
+
+	constexpr double FrameInterval = 1.0 / 30.0;
+
+	float GetDistance(_In_ const Vector3 & Left, _In_ const Vector3 & Right)
+	{
+		return SimdMath::GetX(SimdMath::Length3(SimdMath::Subtract(SimdMath::LoadFloat3(&Left.X), SimdMath::LoadFloat3(&Right.X))));
+	}
+
+	float GetDistance(_In_ const CameraSpacePoint & Left, _In_ const CameraSpacePoint & Right)
+	{
+		return GetDistance(Vector3(Left.X, Left.Y, Left.Z), Vector3(Right.X, Right.Y, Right.Z));
+	}
+
+	// A head at rest measured with one millimeter of alternating jitter comes out steadier than measured
+	void CheckJitter(_In_ PoseFilter & Filter)
+	{
+		const Vector3 Rest(0.1f, 0.2f, 1.5f);
+		constexpr float Jitter = 0.001f;
+		float LargestOffset = 0.f;
+
+		for (unsigned Frame = 0; Frame < 90; ++Frame)
+		{
+			double Time = Frame * FrameInterval;
+			Filter.Update(Vector3(Rest.X + ((Frame & 1) ? Jitter : -Jitter), Rest.Y, Rest.Z), Time);
+
+			if (Frame >= 30)
+			{
+				LargestOffset = (std::max)(LargestOffset, GetDistance(Filter.Predict(Time), Rest));
+			}
+		}
+
+		CHECK(LargestOffset < 0.5f * Jitter);
+	}
+
+	// A head moving at constant velocity is predicted closer to where it will be than its last measurement
+	void CheckPrediction(_In_ PoseFilter & Filter, _In_ float Tolerance)
+	{
+		const Vector3 Velocity(0.3f, -0.1f, 0.2f);
+		constexpr double Latency = 0.05;
+		auto GetPosition = [&](double Time) { return Vector3(Velocity.X * static_cast<float>(Time), 0.1f + Velocity.Y * static_cast<float>(Time), 1.5f + Velocity.Z * static_cast<float>(Time)); };
+
+		double Time = 0.0;
+		for (unsigned Frame = 0; Frame < 60; ++Frame)
+		{
+			Time = Frame * FrameInterval;
+			Filter.Update(GetPosition(Time), Time);
+		}
+
+		float PredictionError = GetDistance(Filter.Predict(Time + Latency), GetPosition(Time + Latency));
+		float HoldError = GetDistance(GetPosition(Time), GetPosition(Time + Latency));
+
+		CHECK(PredictionError < HoldError);
+		CHECK(PredictionError < Tolerance);
+	}
+
+	// Measurements after a gap longer than the maximum interval restart the filter at the new measurement
+	void CheckRestart(_In_ PoseFilter & Filter)
+	{
+		for (unsigned Frame = 0; Frame < 30; ++Frame)
+		{
+			Filter.Update(Vector3(0.01f * Frame, 0.f, 1.f), Frame * FrameInterval);
+		}
+
+		const Vector3 Reappeared(-0.4f, 0.1f, 2.f);
+		double Time = 30 * FrameInterval + 1.0;
+		Filter.Update(Reappeared, Time);
+
+		CHECK(GetDistance(Filter.Predict(Time), Reappeared) == 0.f);
+		CHECK(GetDistance(Filter.Predict(Time + 0.1), Reappeared) == 0.f);
+
+		Filter.Reset();
+		Filter.Update(Reappeared, 0.0);
+		CHECK(GetDistance(Filter.Predict(0.0), Reappeared) == 0.f);
+	}
+
+	// A head lost while moving is not extrapolated further than the restart interval, it stays where it was last expected
+	void CheckPredictionHorizon(_In_ PoseFilter & Filter)
+	{
+		double Time = 0.0;
+		for (unsigned Frame = 0; Frame < 30; ++Frame)
+		{
+			Time = Frame * FrameInterval;
+			Filter.Update(Vector3(0.5f * static_cast<float>(Time), 0.f, 1.f), Time);
+		}
+
+		const Vector3 Held = Filter.Predict(Time + 0.5);
+		CHECK(GetDistance(Held, Filter.Predict(Time)) > 0.f);
+		CHECK(GetDistance(Filter.Predict(Time + 5.0), Held) == 0.f);
+		CHECK(GetDistance(Filter.Predict(Time + 3600.0), Held) == 0.f);
+	}
+
+	void CheckPoseFilters()
+	{
+		OneEuroPoseFilter OneEuro;
+		CheckJitter(OneEuro);
+		OneEuro.Reset();
+		CheckPrediction(OneEuro, 0.01f);
+		OneEuro.Reset();
+		CheckRestart(OneEuro);
+		OneEuro.Reset();
+		CheckPredictionHorizon(OneEuro);
+
+		KalmanPoseFilter Kalman;
+		CheckJitter(Kalman);
+		Kalman.Reset();
+		CheckPrediction(Kalman, 0.001f);
+		Kalman.Reset();
+		CheckRestart(Kalman);
+		Kalman.Reset();
+		CheckPredictionHorizon(Kalman);
+	}
+
+	FacePose GetPose(_In_ float X, _In_ float Y, _In_ float Z, _In_ float Yaw)
+	{
+		float Sine = std::sin(Yaw / 2.f);
+		float Cosine = std::cos(Yaw / 2.f);
+
+		return { { X, Y, Z }, { 0.f, Sine, 0.f, Cosine } };
+	}
+
+	// The fitted points follow the head pose, the model returns them where they were fitted
+	void CheckHeadPivotModel()
+	{
+		HeadPivotModel Model;
+		CHECK(!Model.IsFitted());
+
+		const FacePose FitPose = GetPose(0.05f, 0.1f, 1.2f, 0.3f);
+		const TrackedFacePoints Points = { { { 0.06f, 0.12f, 1.11f }, { 0.02f, 0.15f, 1.13f }, { 0.09f, 0.15f, 1.14f } } };
+		Model.Fit(Points, FitPose);
+		CHECK(Model.IsFitted());
+
+		TrackedFacePoints Placed;
+		Model.GetPoints(FitPose, Placed);
+
+		for (unsigned Index = 0; Index < TrackedFacePointCount; ++Index)
+		{
+			CHECK(GetDistance(Placed[Index], Points[Index]) < 1e-6f);
+		}
+
+		// Moving the head moves the points alike, turning it keeps their distances to the pivot
+		const FacePose MovedPose = GetPose(0.15f, 0.05f, 1.4f, 0.3f);
+		Model.GetPoints(MovedPose, Placed);
+
+		for (unsigned Index = 0; Index < TrackedFacePointCount; ++Index)
+		{
+			const CameraSpacePoint Expected = { Points[Index].X + 0.1f, Points[Index].Y - 0.05f, Points[Index].Z + 0.2f };
+			CHECK(GetDistance(Placed[Index], Expected) < 1e-5f);
+		}
+
+		const FacePose TurnedPose = GetPose(0.05f, 0.1f, 1.2f, -0.4f);
+		Model.GetPoints(TurnedPose, Placed);
+
+		for (unsigned Index = 0; Index < TrackedFacePointCount; ++Index)
+		{
+			CHECK(std::abs(GetDistance(Placed[Index], FitPose.HeadPivot) - GetDistance(Points[Index], FitPose.HeadPivot)) < 1e-5f);
+		}
+
+		Model.Reset();
+		CHECK(!Model.IsFitted());
+	}
+
+	void CheckUserArbitration()
+	{
+		constexpr UINT64 Near = 1;
+		constexpr UINT64 Far = 2;
+		constexpr UINT64 NearAgain = 3;
+		const CameraSpacePoint NearHead = { 0.f, 0.3f, 1.f };
+		const CameraSpacePoint FarHead = { 0.4f, 0.3f, 2.2f };
+
+		UserArbitration Arbitration;
+		CHECK(Arbitration.Update({}, 0.0) == 0);
+		CHECK(UserArbitration::GetScore(NearHead) > UserArbitration::GetScore(FarHead));
+
+		// The first user stays while the better one has not been ahead for long enough
+		double Time = 0.0;
+		CHECK(Arbitration.Update({ { Far, FarHead } }, Time) == Far);
+
+		for (; Time < 2.0; Time += FrameInterval)
+		{
+			CHECK(Arbitration.Update({ { Far, FarHead }, { Near, NearHead } }, Time) == Far);
+		}
+
+		for (; Time < 3.0; Time += FrameInterval)
+		{
+			Arbitration.Update({ { Far, FarHead }, { Near, NearHead } }, Time);
+		}
+
+		CHECK(Arbitration.GetUser() == Near);
+		CHECK(Arbitration.GetHandoffCount() == 1);
+
+		// A user reappearing with a new tracking id where it was lost is the same person
+		Arbitration.Update({ { Far, FarHead } }, Time);
+		Time += FrameInterval;
+		CHECK(Arbitration.Update({ { Far, FarHead }, { NearAgain, NearHead } }, Time) == NearAgain);
+		CHECK(Arbitration.GetHandoffCount() == 1);
+
+		// The head estimate is the smoothed head joint moved by the learned pivot offset
+		for (unsigned Frame = 0; Frame < 200; ++Frame)
+		{
+			Arbitration.AddHeadPivot({ NearHead.X, NearHead.Y + 0.1f, NearHead.Z });
+		}
+
+		CameraSpacePoint Estimate;
+		CHECK(Arbitration.GetHeadEstimate(Far, Estimate));
+		CHECK(GetDistance(Estimate, { FarHead.X, FarHead.Y + 0.1f, FarHead.Z }) < 1e-3f);
+		CHECK(!Arbitration.GetHeadEstimate(Near, Estimate));
+
+		Arbitration.Reset();
+		CHECK(Arbitration.GetUser() == 0);
+	}
+
+	// The slot hands over the newest sample once
+	void CheckHeadPoseSlot()
+	{
+		HeadPoseSlot Slot;
+		HeadPoseSlot::Sample Latched = { -1.0, {}, Vector3(), 1.f };
+		CHECK(!Slot.Latch(Latched));
+		CHECK(Latched.Time == -1.0);
+
+		for (unsigned Index = 1; Index <= 3; ++Index)
+		{
+			Slot.Publish({ static_cast<double>(Index), {}, Vector3(static_cast<float>(Index)), 1.f });
+		}
+
+		CHECK(Slot.Latch(Latched));
+		CHECK(Latched.Time == 3.0);
+		CHECK(Latched.Offset.X == 3.f);
+		CHECK(!Slot.Latch(Latched));
+
+		Slot.Publish({ 4.0, {}, Vector3(), 1.f });
+		CHECK(Slot.Latch(Latched));
+		CHECK(Latched.Time == 4.0);
+	}
+}
+
+int main()
+{
+	CheckPoseFilters();
+	CheckHeadPivotModel();
+	CheckUserArbitration();
+	CheckHeadPoseSlot();
+
+	if (FailureCount != 0)
+	{
+		std::printf("%u checks failed\n", FailureCount);
+		return 1;
+	}
+
+	std::printf("All head tracking checks passed (%ls)\n", SimdMath::GetBackendName());
+	return 0;
+}
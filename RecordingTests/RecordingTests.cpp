@@ -0,0 +1,299 @@
+// RecordingTests.cpp : Behaviour checks of storing depth recordings and of replaying them through the temporal depth filter
+//
+
+#include "stdafx.h"
+
+#include "DepthRecording.h"
+#include "TemporalDepthFilter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace
+{
+	unsigned FailureCount = 0;
+
+	void Check(_In_ bool Condition, _In_ const char * Description, _In_ const char * File, _In_ int Line)
+	{
+		if (!Condition)
+		{
+			std::printf("%s(%d): check failed: %s\n", File, Line, Description);
+			++FailureCount;
+		}
+	}
+
+#define CHECK(Condition) Check((Condition), #Condition, __FILE__, __LINE__)
+
+	constexpr unsigned Width = 32;
+	constexpr unsigned Height = 24;
+	constexpr size_t FrameCount = 6;
+
+	std::string Store(_In_ const DepthRecording & Recording)
+	{
+		std::ostringstream Stream(std::ios::binary);
+		CHECK(Recording.Save(Stream));
+
+		return Stream.str();
+	}
+
+	// The replayed recording holds the recorded frames bit for bit
+	void CheckRoundTrip()
+	{
+		const DepthRecording Recorded = DepthRecording::CreateSynthetic(Width, Height, FrameCount);
+		CHECK(Recorded.GetFrames().size() == FrameCount);
+
+		std::istringstream Stream(Store(Recorded), std::ios::binary);
+		DepthRecording Replayed(0, 0);
+
+		CHECK(Replayed.Load(Stream));
+		CHECK(Replayed.GetWidth() == Width);
+		CHECK(Replayed.GetHeight() == Height);
+		CHECK(Replayed.GetFrames() == Recorded.GetFrames());
+
+		// An empty recording is stored and replayed as well
+		std::istringstream EmptyStream(Store(DepthRecording(Width, Height)), std::ios::binary);
+		CHECK(Replayed.Load(EmptyStream));
+		CHECK(Replayed.GetFrames().empty());
+	}
+
+	// Other files and cut off recordings are not replayed
+	void CheckInvalidFiles()
+	{
+		const std::string Stored = Store(DepthRecording::CreateSynthetic(Width, Height, FrameCount));
+		DepthRecording Replayed(Width, Height);
+
+		std::string OtherMagic = Stored;
+		OtherMagic[0] ^= 0x1;
+		std::istringstream OtherMagicStream(OtherMagic, std::ios::binary);
+		CHECK(!Replayed.Load(OtherMagicStream));
+
+		std::string OtherVersion = Stored;
+		OtherVersion[4] ^= 0x1;
+		std::istringstream OtherVersionStream(OtherVersion, std::ios::binary);
+		CHECK(!Replayed.Load(OtherVersionStream));
+
+		std::istringstream TruncatedStream(Stored.substr(0, Stored.size() - 1), std::ios::binary);
+		CHECK(!Replayed.Load(TruncatedStream));
+		CHECK(Replayed.GetFrames().empty());
+
+		std::istringstream HeaderOnlyStream(Stored.substr(0, 12), std::ios::binary);
+		CHECK(!Replayed.Load(HeaderOnlyStream));
+	}
+
+	// Recording stops at the frame limit and only takes frames of its size
+	void CheckAddFrame()
+	{
+		DepthRecording Recording(Width, Height, 2);
+		const DepthRecording::Frame DepthPixels(Width * Height, 1500);
+
+		CHECK(!Recording.AddFrame(DepthRecording::Frame(Width * Height - 1, 1500)));
+		CHECK(Recording.AddFrame(DepthPixels));
+		CHECK(Recording.AddFrame(DepthPixels));
+		CHECK(!Recording.AddFrame(DepthPixels));
+		CHECK(Recording.GetFrames().size() == 2);
+
+		Recording.Clear();
+		CHECK(Recording.GetFrames().empty());
+		CHECK(Recording.AddFrame(DepthPixels));
+	}
+
+	// A scene of four column bands: a wall at rest, a wall the user steps in front of, a wall that drops out for a few frames
+	// and a wall at rest again; each with a few millimeters of noise, well below the motion threshold
+	constexpr unsigned FilterWidth = 56;
+	constexpr unsigned FilterHeight = 20;
+	constexpr size_t FilterFrameCount = 40;
+	constexpr unsigned BandWidth = FilterWidth / 4;
+	constexpr size_t EventFrame = 20;
+	constexpr size_t DropoutFrameCount = 6;
+	constexpr UINT16 RestDepth = 2000;
+	constexpr UINT16 UserDepth = 900;
+	constexpr int Noise = 8;
+
+	enum Band
+	{
+		Band_Rest,
+		Band_Jump,
+		Band_Dropout,
+		Band_RestAgain
+	};
+
+	Band GetBand(_In_ size_t Index)
+	{
+		return static_cast<Band>((Index % FilterWidth) / BandWidth);
+	}
+
+	bool IsDropout(_In_ size_t FrameIndex)
+	{
+		return (FrameIndex >= EventFrame) && (FrameIndex < EventFrame + DropoutFrameCount);
+	}
+
+	DepthRecording CreateFilterScene()
+	{
+		DepthRecording Recording(FilterWidth, FilterHeight, FilterFrameCount);
+		UINT32 RandomState = 0x9E3779B9;
+
+		for (size_t FrameIndex = 0; FrameIndex < FilterFrameCount; ++FrameIndex)
+		{
+			DepthRecording::Frame DepthPixels(FilterWidth * FilterHeight);
+
+			for (size_t Index = 0; Index < DepthPixels.size(); ++Index)
+			{
+				RandomState = RandomState * 1664525u + 1013904223u;
+				int PixelNoise = static_cast<int>(RandomState >> 24) % (2 * Noise + 1) - Noise;
+
+				Band PixelBand = GetBand(Index);
+				UINT16 Depth = ((PixelBand == Band_Jump) && (FrameIndex >= EventFrame)) ? UserDepth : RestDepth;
+
+				DepthPixels[Index] = ((PixelBand == Band_Dropout) && IsDropout(FrameIndex)) ? 0 : static_cast<UINT16>(Depth + PixelNoise);
+			}
+
+			CHECK(Recording.AddFrame(DepthPixels));
+		}
+
+		return Recording;
+	}
+
+	// Filters the frames in order, like the Kinect does with each depth frame it receives
+	DepthRecording::FrameList Replay(_In_ const DepthRecording & Recording, _Inout_ TemporalDepthFilter & Filter)
+	{
+		DepthRecording::FrameList Filtered;
+
+		for (DepthRecording::Frame DepthPixels : Recording.GetFrames())
+		{
+			Filter.Apply(DepthPixels);
+			Filtered.push_back(DepthPixels);
+		}
+
+		return Filtered;
+	}
+
+	// Replays the recording through filters of a single row narrower than one SSE2 step, which only run the scalar tail
+	DepthRecording::FrameList ReplayScalar(_In_ const DepthRecording & Recording)
+	{
+		constexpr unsigned ScalarWidth = 7;
+		const size_t PixelCount = static_cast<size_t>(Recording.GetWidth()) * Recording.GetHeight();
+
+		std::vector<TemporalDepthFilter> Filters;
+		Filters.reserve((PixelCount + ScalarWidth - 1) / ScalarWidth);
+
+		for (size_t Begin = 0; Begin < PixelCount; Begin += ScalarWidth)
+		{
+			Filters.emplace_back(static_cast<unsigned>((std::min)(PixelCount - Begin, static_cast<size_t>(ScalarWidth))), 1);
+		}
+
+		DepthRecording::FrameList Filtered;
+
+		for (DepthRecording::Frame DepthPixels : Recording.GetFrames())
+		{
+			for (size_t Begin = 0, FilterIndex = 0; Begin < PixelCount; Begin += ScalarWidth, ++FilterIndex)
+			{
+				auto First = DepthPixels.begin() + Begin;
+				auto Last = DepthPixels.begin() + (std::min)(Begin + ScalarWidth, PixelCount);
+
+				DepthRecording::Frame Pixels(First, Last);
+				Filters[FilterIndex].Apply(Pixels);
+				std::copy(Pixels.begin(), Pixels.end(), First);
+			}
+
+			Filtered.push_back(DepthPixels);
+		}
+
+		return Filtered;
+	}
+
+	// Noise at rest is damped, a step in depth is taken at once and a short dropout is held until its confidence decays
+	void CheckTemporalDepthFilter()
+	{
+		const DepthRecording Recording = CreateFilterScene();
+		const DepthRecording::FrameList & Raw = Recording.GetFrames();
+		TemporalDepthFilter Filter(FilterWidth, FilterHeight);
+		const DepthRecording::FrameList Filtered = Replay(Recording, Filter);
+
+		unsigned RawDeviation = 0;
+		unsigned FilteredDeviation = 0;
+
+		for (size_t FrameIndex = EventFrame; FrameIndex < FilterFrameCount; ++FrameIndex)
+		{
+			for (size_t Index = 0; Index < Raw[FrameIndex].size(); ++Index)
+			{
+				if ((GetBand(Index) == Band_Rest) || (GetBand(Index) == Band_RestAgain))
+				{
+					RawDeviation += std::abs(Raw[FrameIndex][Index] - RestDepth);
+					FilteredDeviation += std::abs(Filtered[FrameIndex][Index] - RestDepth);
+				}
+			}
+		}
+
+		CHECK(FilteredDeviation * 2 < RawDeviation);
+
+		// The dropout holds the last filtered depth for three frames (a confidence of 255 decays by 64 per frame), then reads invalid
+		constexpr size_t HeldFrameCount = 3;
+		bool IsJumpTaken = true;
+		bool IsDropoutHeld = true;
+		bool IsDropoutReleased = true;
+		bool IsReturnTaken = true;
+
+		for (size_t Index = 0; Index < Raw[EventFrame].size(); ++Index)
+		{
+			if (GetBand(Index) == Band_Jump)
+			{
+				IsJumpTaken = IsJumpTaken && (Filtered[EventFrame][Index] == Raw[EventFrame][Index]);
+			}
+			else if (GetBand(Index) == Band_Dropout)
+			{
+				const UINT16 LastDepth = Filtered[EventFrame - 1][Index];
+
+				for (size_t FrameIndex = EventFrame; FrameIndex < EventFrame + DropoutFrameCount; ++FrameIndex)
+				{
+					if (FrameIndex < EventFrame + HeldFrameCount)
+					{
+						IsDropoutHeld = IsDropoutHeld && (Filtered[FrameIndex][Index] == LastDepth);
+					}
+					else
+					{
+						IsDropoutReleased = IsDropoutReleased && (Filtered[FrameIndex][Index] == 0);
+					}
+				}
+
+				const size_t ReturnFrame = EventFrame + DropoutFrameCount;
+				IsReturnTaken = IsReturnTaken && (Filtered[ReturnFrame][Index] == Raw[ReturnFrame][Index]);
+			}
+		}
+
+		CHECK(IsJumpTaken);
+		CHECK(IsDropoutHeld);
+		CHECK(IsDropoutReleased);
+		CHECK(IsReturnTaken);
+	}
+
+	// The SSE2 kernel and the scalar tail filter every pixel alike
+	void CheckTemporalDepthFilterPaths()
+	{
+		const DepthRecording Scene = CreateFilterScene();
+		TemporalDepthFilter SceneFilter(FilterWidth, FilterHeight);
+		CHECK(Replay(Scene, SceneFilter) == ReplayScalar(Scene));
+
+		const DepthRecording Synthetic = DepthRecording::CreateSynthetic(FilterWidth, FilterHeight, FilterFrameCount);
+		TemporalDepthFilter SyntheticFilter(FilterWidth, FilterHeight);
+		CHECK(Replay(Synthetic, SyntheticFilter) == ReplayScalar(Synthetic));
+	}
+}
+
+int main()
+{
+	CheckRoundTrip();
+	CheckInvalidFiles();
+	CheckAddFrame();
+	CheckTemporalDepthFilter();
+	CheckTemporalDepthFilterPaths();
+
+	if (FailureCount != 0)
+	{
+		std::printf("%u checks failed\n", FailureCount);
+		return 1;
+	}
+
+	std::printf("All recording checks passed\n");
+	return 0;
+}
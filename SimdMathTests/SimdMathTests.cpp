@@ -0,0 +1,123 @@
+// SimdMathTests.cpp : Checks the portable math against the results of DirectXMath with the backend it is built with
+//
+
+#include "stdafx.h"
+
+#include "SimdMath.h"
+
+#include <cstdio>
+
+namespace
+{
+	unsigned FailureCount = 0;
+
+	void Check(_In_ bool Condition, _In_ const char * Description, _In_ const char * File, _In_ int Line)
+	{
+		if (!Condition)
+		{
+			std::printf("%s(%d): check failed: %s\n", File, Line, Description);
+			++FailureCount;
+		}
+	}
+
+#define CHECK(Condition) Check((Condition), #Condition, __FILE__, __LINE__)
+
+	typedef std::array<float, 4> Float4;
+	typedef std::array<float, 16> Float4x4;
+
+	// The results of the DirectXMath SSE2 paths without fused multiply-adds, the path of the x86 and x64 builds.
+	// They have to match exactly; zeros compare equal regardless of their sign.
+	bool IsEqual(_In_ SimdMath::Vector Result, _In_ const Float4 & Expected)
+	{
+		Float4 Stored;
+		SimdMath::StoreFloat4(Stored.data(), Result);
+
+		return Stored == Expected;
+	}
+
+	bool IsEqual(_In_ const SimdMath::Matrix & Result, _In_ const Float4x4 & Expected)
+	{
+		Float4x4 Stored;
+		SimdMath::StoreFloat4x4(Stored.data(), Result);
+
+		return Stored == Expected;
+	}
+
+	// A head tilted and turned away from the mirror, and a camera looking through the frame like the frame cameras do
+	void CheckMatrixLookToRH()
+	{
+		const Float4x4 Tilted = { { 0.805323064f, -0.251085907f, -0.537038684f, 0.f, 0.0486878268f, 0.930832207f, -0.362188846f, 0.f, 0.590833485f, 0.265531778f, 0.761845529f, 0.f, -1.87224483f, 0.887698293f, -2.66396141f, 1.f } };
+		CHECK(IsEqual(SimdMath::MatrixLookToRH(SimdMath::Set(0.3f, -1.7f, 2.9f, 0.f), SimdMath::Set(0.43f, 0.29f, -0.61f, 0.f), SimdMath::Set(-0.11f, 0.97f, 0.07f, 0.f)), Tilted));
+
+		const Float4x4 Straight = { { 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 12.5f, -4.25f, -61.f, 1.f } };
+		CHECK(IsEqual(SimdMath::MatrixLookToRH(SimdMath::Set(-12.5f, 4.25f, 61.f, 0.f), SimdMath::Set(0.f, 0.f, -1.f, 0.f), SimdMath::Set(0.f, 1.f, 0.f, 0.f)), Straight));
+	}
+
+	void CheckMatrixPerspectiveOffCenterRH()
+	{
+		const Float4x4 Small = { { 1.79487181f, 0.f, 0.f, 0.f, 0.f, 2.69230771f, 0.f, 0.f, 0.0512820408f, 0.115384594f, -1.00070047f, -1.f, 0.f, 0.f, -0.700490296f, 0.f } };
+		CHECK(IsEqual(SimdMath::MatrixPerspectiveOffCenterRH(-0.37f, 0.41f, -0.23f, 0.29f, 0.7f, 1000.f), Small));
+
+		const Float4x4 Frame = { { 1.80750012f, 0.f, 0.f, 0.f, 0.f, 3.21333361f, 0.f, 0.f, 0.453750044f, -0.486666679f, -1.05064094f, -1.f, 0.f, 0.f, -50.6408958f, 0.f } };
+		CHECK(IsEqual(SimdMath::MatrixPerspectiveOffCenterRH(-14.5666667f, 38.7666667f, -22.3f, 7.7f, 48.2f, 1000.f), Frame));
+	}
+
+	const Float4 FirstQuaternion = { { 0.1826f, -0.3651f, 0.5477f, 0.7303f } };
+	const Float4 SecondQuaternion = { { -0.2f, 0.4f, 0.1f, 0.89f } };
+
+	void CheckMatrixRotationQuaternion()
+	{
+		const Float4x4 First = { { 0.133453429f, 0.666636109f, 0.733285069f, 0.f, -0.933305144f, 0.333363891f, -0.133224964f, 0.f, -0.333245009f, -0.666636109f, 0.666718423f, 0.f, 0.f, 0.f, 0.f, 1.f } };
+		CHECK(IsEqual(SimdMath::MatrixRotationQuaternion(SimdMath::LoadFloat4(FirstQuaternion.data())), First));
+
+		const Float4x4 Second = { { 0.659999967f, 0.0179999918f, -0.752000034f, 0.f, -0.338f, 0.900000036f, -0.275999993f, 0.f, 0.671999991f, 0.436000019f, 0.600000024f, 0.f, 0.f, 0.f, 0.f, 1.f } };
+		CHECK(IsEqual(SimdMath::MatrixRotationQuaternion(SimdMath::LoadFloat4(SecondQuaternion.data())), Second));
+	}
+
+	void CheckQuaternionRotation()
+	{
+		SimdMath::Vector First = SimdMath::LoadFloat4(FirstQuaternion.data());
+		SimdMath::Vector Second = SimdMath::LoadFloat4(SecondQuaternion.data());
+
+		const Float4 FirstThenSecond = { { 0.272044003f, 0.0949810296f, 0.560462952f, 0.777757049f } };
+		const Float4 SecondThenFirst = { { -0.239135996f, -0.160618991f, 0.560503006f, 0.777757049f } };
+		CHECK(IsEqual(SimdMath::QuaternionMultiply(First, Second), FirstThenSecond));
+		CHECK(IsEqual(SimdMath::QuaternionMultiply(Second, First), SecondThenFirst));
+
+		const Float4 FirstRotated = { { 0.000273942947f, -0.799963355f, 2.49988532f, 1.1920929e-07f } };
+		const Float4 SecondRotated = { { 0.861154974f, 0.800005019f, 1.37827492f, -2.98023224e-08f } };
+		CHECK(IsEqual(SimdMath::Vector3Rotate(SimdMath::Set(1.3f, -0.6f, 2.2f, 0.f), First), FirstRotated));
+		CHECK(IsEqual(SimdMath::Vector3Rotate(SimdMath::Set(-0.45f, 0.05f, 1.75f, 0.f), Second), SecondRotated));
+	}
+
+	// An object placed in the view, and the view composed with the projection
+	void CheckMatrixMultiply()
+	{
+		const Float4x4 World = { { 0.133453429f, 0.666636109f, 0.733285069f, 0.f, -0.933305144f, 0.333363891f, -0.133224964f, 0.f, -0.333245009f, -0.666636109f, 0.666718423f, 0.f, 0.25f, -1.5f, 3.125f, 1.f } };
+		const Float4x4 View = { { 0.805323064f, -0.251085907f, -0.537038684f, 0.f, 0.0486878268f, 0.930832207f, -0.362188846f, 0.f, 0.590833485f, 0.265531778f, 0.761845529f, 0.f, -1.87224483f, 0.887698293f, -2.66396141f, 1.f } };
+		const Float4x4 Projection = { { 1.79487181f, 0.f, 0.f, 0.f, 0.f, 2.69230771f, 0.f, 0.f, 0.0512820408f, 0.115384594f, -1.00070047f, -1.f, 0.f, 0.f, -0.700490296f, 0.f } };
+
+		const Float4x4 WorldView = { { 0.573179543f, 0.781728625f, 0.245532155f, 0.f, -0.814095199f, 0.509270132f, 0.278983414f, 0.f, 0.0930926055f, -0.35981831f, 0.928350091f, 0.f, 0.102408767f, 0.25846523f, 0.125829458f, 1.f } };
+		const Float4x4 ViewProjection = { { 1.41791117f, -0.737966537f, 0.537414849f, 0.537038684f, 0.0688146278f, 2.46429586f, 0.362442553f, 0.362188846f, 1.09953928f, 0.80279851f, -0.762379169f, -0.761845529f, -3.49705291f, 2.08257675f, 1.96533728f, 2.66396141f } };
+		CHECK(IsEqual(SimdMath::MatrixMultiply(SimdMath::LoadFloat4x4(World.data()), SimdMath::LoadFloat4x4(View.data())), WorldView));
+		CHECK(IsEqual(SimdMath::MatrixMultiply(SimdMath::LoadFloat4x4(View.data()), SimdMath::LoadFloat4x4(Projection.data())), ViewProjection));
+	}
+}
+
+int main()
+{
+	CheckMatrixLookToRH();
+	CheckMatrixPerspectiveOffCenterRH();
+	CheckMatrixRotationQuaternion();
+	CheckQuaternionRotation();
+	CheckMatrixMultiply();
+
+	if (FailureCount != 0)
+	{
+		std::printf("%u checks failed (%ls)\n", FailureCount, SimdMath::GetBackendName());
+		return 1;
+	}
+
+	std::printf("All math checks passed (%ls)\n", SimdMath::GetBackendName());
+	return 0;
+}